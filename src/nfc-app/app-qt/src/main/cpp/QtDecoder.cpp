@@ -20,11 +20,15 @@
 */
 
 #include <filesystem>
+#include <mutex>
 
 #include <QDebug>
+#include <QCoreApplication>
+#include <QThreadPool>
 
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QStandardPaths>
 
 #include <rt/Event.h>
 #include <rt/Subject.h>
@@ -33,6 +37,7 @@
 #include <hw/RecordDevice.h>
 
 #include <lab/data/RawFrame.h>
+#include <lab/data/FrameCache.h>
 
 #include <lab/tasks/FourierProcessTask.h>
 #include <lab/tasks/LogicDecoderTask.h>
@@ -110,6 +115,19 @@ struct QtDecoder::Impl
    rt::Subject<hw::SignalBuffer>::Subscription adaptiveSignalSubscription;
    rt::Subject<hw::SignalBuffer>::Subscription storageSignalSubscription;
 
+   // decoded frames cache for signal files
+   lab::FrameCache frameCache;
+
+   // frames collected for cache entry while decoding signal file
+   std::mutex frameCacheMutex;
+   std::list<lab::RawFrame> frameCacheFrames;
+   lab::FrameCache::Key frameCacheKey {};
+   bool frameCacheRecording = false;
+
+   // signal file content hash runs in background, request is incremented to discard keys for cancelled reads
+   QThreadPool frameCachePool;
+   int frameCacheRequest = 0;
+
    // device names and type
    QString logicDeviceName;
    QString logicDeviceType;
@@ -195,6 +213,13 @@ struct QtDecoder::Impl
       // create signal subject
       adaptiveSignalStream = rt::Subject<hw::SignalBuffer>::name("adaptive.signal");
       storageSignalStream = rt::Subject<hw::SignalBuffer>::name("storage.signal");
+
+      // setup decoded frames cache
+      if (settings.value("settings/frameCacheEnabled", true).toBool())
+      {
+         frameCache.setDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation).toStdString() + "/frames");
+         frameCache.setSizeLimit(settings.value("settings/frameCacheSize", 512).toULongLong() << 20);
+      }
    }
 
    /*
@@ -336,18 +361,29 @@ struct QtDecoder::Impl
             doFourierConfig(event);
             break;
          }
+         case DecoderControlEvent::SignalInterest:
+         {
+            doSignalInterest(event);
+            break;
+         }
       }
    }
 
    /*
     * start decoder and receiver task
     */
-   void doStartDecode(DecoderControlEvent *event) const
+   void doStartDecode(DecoderControlEvent *event)
    {
+      // live frames are never cached
+      frameCacheCancel();
+
+      // views are cleared, full signal detail until they report new range
+      adaptiveSignalStream->interest({});
+
       // if event contains file name and sample rate start recorder
       if (event->contains("storagePath"))
       {
-         QJsonObject command {{"storagePath", event->getString("storagePath")}};
+         QJsonObject command {{"storagePath", event->getString("storagePath")}, {"compress", settings.value("settings/recordCompressed", false).toBool()}};
 
          // clear storage queue
          taskStorageClear([=] {
@@ -408,8 +444,11 @@ struct QtDecoder::Impl
    /*
     * stop all tasks to finish decoding
     */
-   void doStopDecode(DecoderControlEvent *event) const
+   void doStopDecode(DecoderControlEvent *event)
    {
+      // partial decoding is not cached
+      frameCacheCancel();
+
       // stop radio receiver task
       if (!logicDeviceType.isEmpty())
       {
@@ -549,6 +588,9 @@ struct QtDecoder::Impl
       if (event->contains("debugEnabled"))
          config["debugEnabled"] = event->getBoolean("debugEnabled");
 
+      if (event->contains("carrierTrainEnabled"))
+         config["carrierTrainEnabled"] = event->getBoolean("carrierTrainEnabled");
+
       if (event->contains("powerLevelThreshold"))
          config["powerLevelThreshold"] = event->getFloat("powerLevelThreshold");
 
@@ -648,11 +690,24 @@ struct QtDecoder::Impl
       }
    }
 
+   /*
+    * update visible signal window and resolution, resampling task skips samples that can't be shown
+    */
+   void doSignalInterest(DecoderControlEvent *event) const
+   {
+      adaptiveSignalStream->interest({event->getDouble("timeStart", 0), event->getDouble("timeEnd", 0), event->getDouble("resolution", 0)});
+   }
+
    /*
     * read frames from file
     */
-   void doReadFile(DecoderControlEvent *event) const
+   void doReadFile(DecoderControlEvent *event)
    {
+      frameCacheCancel();
+
+      // views are cleared, full signal detail until they report new range
+      adaptiveSignalStream->interest({});
+
       const QString fileName = event->getString("fileName");
       const std::filesystem::path path(fileName.toStdString());
       const QJsonObject command {{"fileName", fileName}};
@@ -668,7 +723,7 @@ struct QtDecoder::Impl
          return;
       }
 
-      if (path.extension() == ".wav")
+      if (path.extension() == ".wav" || path.extension() == ".nfz" || path.extension() == ".nfl")
       {
          hw::RecordDevice file(fileName.toStdString());
 
@@ -680,26 +735,68 @@ struct QtDecoder::Impl
 
          unsigned int channelCount = std::get<unsigned int>(file.get(hw::SignalDevice::PARAM_CHANNEL_COUNT));
 
-         // clear storage queue
-         taskStorageClear([=] {
+         if (frameCache.directory().empty() || channelCount > 2)
+         {
+            readSignalFile(command, channelCount, {});
+            return;
+         }
+
+         // cache key from signal contents and current radio decoder settings, hash reads whole file so it is not done in GUI thread
+         const std::string config = QJsonDocument(readConfig("decoder.radio")).toJson(QJsonDocument::Compact).toStdString();
+         const int request = frameCacheRequest;
+
+         frameCachePool.start([=] {
+            lab::FrameCache::Key key = lab::FrameCache::key(fileName.toStdString(), config);
+
+            // continue in GUI thread, unless file read was cancelled while hashing
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [=] {
+               if (request == frameCacheRequest)
+                  readSignalFile(command, channelCount, key);
+            }, Qt::QueuedConnection);
+         });
+      }
+   }
+
+   /*
+    * start signal file decoding, radio frames are replayed from cache if an entry exists for key
+    */
+   void readSignalFile(const QJsonObject &command, unsigned int channelCount, const lab::FrameCache::Key &key)
+   {
+      // clear storage queue
+      taskStorageClear([=] {
+
+         // if contains 4 channels... trigger logic decoder start
+         if (channelCount >= 3)
+         {
+            taskLogicDecoderStart([=] {
+               taskRecorderRead(command);
+            });
+         }
+
+         // if contains 1 or 2 channels... replay cached frames or trigger radio decoder start
+         else if (channelCount <= 2)
+         {
+            std::list<lab::RawFrame> frames;
 
-            // if contains 4 channels... trigger logic decoder start
-            if (channelCount >= 3)
+            if (!frameCache.directory().empty() && frameCache.load(key, frames))
             {
-               taskLogicDecoderStart([=] {
-                  taskRecorderRead(command);
-               });
-            }
+               for (const auto &frame: frames)
+                  radioDecoderFrameStream->next(frame);
 
-            // if contains 1 or 2 channels... trigger radio decoder start
-            else if (channelCount <= 2)
+               radioDecoderFrameStream->next({});
+
+               taskRecorderRead(command);
+            }
+            else
             {
+               frameCacheStart(key);
+
                taskRadioDecoderStart([=] {
                   taskRecorderRead(command);
                });
             }
-         });
-      }
+         }
+      });
    }
 
    /*
@@ -1089,9 +1186,59 @@ struct QtDecoder::Impl
     */
    void radioDecoderFrameEvent(const lab::RawFrame &frame)
    {
+      frameCacheUpdate(frame);
+
       QtApplication::post(new StreamFrameEvent(frame), Qt::HighEventPriority);
    }
 
+   /*
+    * start collecting decoded frames for cache entry
+    */
+   void frameCacheStart(const lab::FrameCache::Key &key)
+   {
+      std::lock_guard lock(frameCacheMutex);
+
+      frameCacheKey = key;
+      frameCacheFrames.clear();
+      frameCacheRecording = !frameCache.directory().empty() && key.content != 0;
+   }
+
+   /*
+    * discard collected frames
+    */
+   void frameCacheCancel()
+   {
+      std::lock_guard lock(frameCacheMutex);
+
+      // keys still being computed are discarded
+      frameCacheRequest++;
+
+      frameCacheFrames.clear();
+      frameCacheRecording = false;
+   }
+
+   /*
+    * collect decoded frame, cache entry is stored when end of stream is received
+    */
+   void frameCacheUpdate(const lab::RawFrame &frame)
+   {
+      std::lock_guard lock(frameCacheMutex);
+
+      if (!frameCacheRecording)
+         return;
+
+      if (frame.isValid())
+      {
+         frameCacheFrames.push_back(frame);
+         return;
+      }
+
+      frameCache.store(frameCacheKey, frameCacheFrames);
+
+      frameCacheFrames.clear();
+      frameCacheRecording = false;
+   }
+
    /*
     * setup fourier task
     */
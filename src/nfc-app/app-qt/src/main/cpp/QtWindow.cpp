@@ -24,6 +24,8 @@
 #include <QClipboard>
 #include <QComboBox>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QStyle>
 #include <QStandardPaths>
 #include <QScreen>
 #include <QRegularExpression>
@@ -32,6 +34,8 @@
 
 #include <hw/SignalType.h>
 #include <hw/SignalBuffer.h>
+#include <lab/data/FrameWriter.h>
+#include <lab/data/IsoDepAssembler.h>
 
 #include <model/StreamFilter.h>
 #include <model/StreamModel.h>
@@ -67,6 +71,17 @@
 #define DEFAULT_WINDOW_WIDTH 1024
 #define DEFAULT_WINDOW_HEIGHT 720
 
+// refresh interval when idle and while pending frames are drained, in milliseconds
+#define REFRESH_INTERVAL 500
+#define REFRESH_BACKLOG_INTERVAL 50
+
+// maximum time spent on each refresh, including view layout and paint, and minimum frames inserted per refresh
+#define REFRESH_BUDGET 16.0
+#define REFRESH_MIN_BATCH 256
+
+// signal detail requested beyond visible pixel resolution, so captured signal can still be zoomed in
+#define SIGNAL_DETAIL_ZOOM 64
+
 struct QtWindow::Impl
 {
    // application window
@@ -178,6 +193,13 @@ struct QtWindow::Impl
    // acquire timer
    QPointer<QTimer> acquireTimer;
 
+   // average model insert cost per frame and average view layout and paint cost per refresh, in milliseconds
+   double refreshFrameCost = 0;
+   double refreshPaintCost = 0;
+
+   // frame length used for current data column width
+   int refreshDataLength = 0;
+
    // Clipboard data
    QString clipboard;
 
@@ -190,6 +212,9 @@ struct QtWindow::Impl
    // fft signal stream subscription
    rt::Subject<hw::SignalBuffer>::Subscription frequencySubscription;
 
+   // fft signal stream subscription is active
+   bool frequencySubscribed = false;
+
    // signal connections
    QMetaObject::Connection decodeViewDoubleClickedConnection;
    QMetaObject::Connection decodeViewSelectionChangedConnection;
@@ -222,14 +247,8 @@ struct QtWindow::Impl
                                      refreshTimer(new QTimer()),
                                      acquireTimer(new QTimer())
    {
-      // fft signal subject stream
+      // fft signal subject stream, subscribed only while spectrum is enabled
       frequencyStream = rt::Subject<hw::SignalBuffer>::name("signal.fft");
-
-      // subscribe to signal events
-      frequencySubscription = frequencyStream->subscribe([=](const hw::SignalBuffer &buffer) {
-         if (radioDeviceStatus == RadioDeviceStatusEvent::Streaming)
-            ui->frequencyView->update(buffer);
-      });
    }
 
    ~Impl()
@@ -452,7 +471,7 @@ struct QtWindow::Impl
       acquireTimer->setSingleShot(true);
 
       // start timer
-      refreshTimer->start(500);
+      refreshTimer->start(REFRESH_INTERVAL);
 
       // pre-select time limit
       acquireLimit->setCurrentIndex(acquireLimit->findData(timeLimit));
@@ -632,7 +651,7 @@ struct QtWindow::Impl
       }
    }
 
-   void storageStatusEvent(StorageStatusEvent *event) const
+   void storageStatusEvent(StorageStatusEvent *event)
    {
       // show message on storage error
       if (event->isError())
@@ -937,10 +956,29 @@ struct QtWindow::Impl
       ui->signalLabel->setVisible(!signalPresent || !decoderEnabled);
       ui->frequencyView->setEnabled(spectrumEnabled);
 
+      // consume spectrum only while enabled, fourier task skips processing when there are no consumers
+      if (spectrumEnabled != frequencySubscribed)
+      {
+         if (spectrumEnabled)
+         {
+            frequencySubscription = frequencyStream->subscribe([=](const hw::SignalBuffer &buffer) {
+               if (radioDeviceStatus == RadioDeviceStatusEvent::Streaming)
+                  ui->frequencyView->update(buffer);
+            });
+         }
+         else
+         {
+            frequencySubscription = {};
+         }
+
+         frequencySubscribed = spectrumEnabled;
+      }
+
       // if no data is present, disable related actions
       ui->actionClear->setEnabled(signalPresent);
       ui->actionSave->setEnabled(signalPresent);
       ui->actionExport->setEnabled(signalSelected);
+      ui->actionExportApdu->setEnabled(!streamModel->assembler().exchanges().empty());
       ui->actionTime->setEnabled(signalPresent);
       ui->actionZoom->setEnabled(signalSelected);
       ui->actionWide->setEnabled(!signalWide);
@@ -1496,6 +1534,8 @@ struct QtWindow::Impl
 
       inspectDialog->clear();
 
+      QList<lab::RawFrame> frames;
+
       if (const auto firstFrame = streamFilter->frame(firstIndex))
       {
          switch (firstFrame->frameType())
@@ -1503,7 +1543,7 @@ struct QtWindow::Impl
             case lab::FrameType::NfcPollFrame:
             case lab::FrameType::IsoRequestFrame:
             {
-               inspectDialog->addFrame(*firstFrame);
+               frames.append(*firstFrame);
 
                auto secondIndex = streamFilter->index(firstIndex.row() + 1, 0);
 
@@ -1513,7 +1553,7 @@ struct QtWindow::Impl
                   {
                      if (secondFrame->frameType() == lab::FrameType::NfcListenFrame || secondFrame->frameType() == lab::FrameType::IsoResponseFrame)
                      {
-                        inspectDialog->addFrame(*secondFrame);
+                        frames.append(*secondFrame);
                      }
                   }
                }
@@ -1532,8 +1572,8 @@ struct QtWindow::Impl
                   {
                      if (secondFrame->frameType() == lab::FrameType::NfcPollFrame || secondFrame->frameType() == lab::FrameType::IsoRequestFrame)
                      {
-                        inspectDialog->addFrame(*secondFrame);
-                        inspectDialog->addFrame(*firstFrame);
+                        frames.append(*secondFrame);
+                        frames.append(*firstFrame);
                      }
                   }
                }
@@ -1543,12 +1583,14 @@ struct QtWindow::Impl
 
             default:
             {
-               inspectDialog->addFrame(*firstFrame);
+               frames.append(*firstFrame);
                break;
             }
          }
       }
 
+      inspectDialog->addFrames(frames);
+
       inspectDialog->showModal();
    }
 
@@ -1642,6 +1684,13 @@ struct QtWindow::Impl
          }
       }
 
+      // reassembled APDUs when selected frame is part of a chained exchange
+      if (auto exchange = streamFilter->exchange(firstIndex))
+      {
+         if (exchange->commandBlocks > 1 || exchange->responseBlocks > 1)
+            parserModel->append(streamModel->assembler(), *exchange);
+      }
+
       // expand protocol information
       ui->parserView->expandAll();
 
@@ -1690,12 +1739,12 @@ struct QtWindow::Impl
     */
    void openFile()
    {
-      QString fileName = Theme::openFileDialog(window, tr("Open trace file"), "", tr("Capture (*.wav *.trz)"));
+      QString fileName = Theme::openFileDialog(window, tr("Open trace file"), "", tr("Capture (*.wav *.nfz *.nfl *.trz)"));
 
       if (fileName.isEmpty())
          return;
 
-      if (!(fileName.endsWith(".wav") || fileName.endsWith(".trz")))
+      if (!(fileName.endsWith(".wav") || fileName.endsWith(".nfz") || fileName.endsWith(".nfl") || fileName.endsWith(".trz")))
       {
          Theme::messageDialog(window, tr("Unable to open file"), tr("Invalid file name: %1").arg(fileName));
          return;
@@ -1754,6 +1803,38 @@ struct QtWindow::Impl
       }
    }
 
+   void exportApdu()
+   {
+      QString path = QStandardPaths::writableLocation(QStandardPaths::HomeLocation);
+      QString date = QDateTime::currentDateTime().toString("yyyy_MM_dd-HH_mm_ss");
+      QString name = QString("%1-apdu.json").arg(date);
+
+      QString fileName = Theme::saveFileDialog(window, tr("Export APDU exchanges"), path + "/" + name, tr("APDU exchanges (*.json)"));
+
+      if (fileName.isEmpty())
+         return;
+
+      FILE *file = fopen(fileName.toLocal8Bit().constData(), "wb");
+
+      if (!file)
+      {
+         Theme::messageDialog(window, tr("Unable to export file"), tr("Can't write file: %1").arg(fileName));
+         return;
+      }
+
+      // exchanges are already reassembled by stream model, export is one pass over the table
+      const lab::IsoDepAssembler &assembler = streamModel->assembler();
+
+      lab::FrameWriter writer(file, lab::FrameWriter::Json);
+
+      for (const lab::ApduExchange &exchange: assembler.exchanges())
+         writer.write(assembler, exchange);
+
+      writer.flush();
+
+      fclose(file);
+   }
+
    void openConfig()
    {
       //   QPointer<ConfigDialog> dialog = new ConfigDialog(this);
@@ -2037,7 +2118,7 @@ struct QtWindow::Impl
       ui->decodeView->clearFilters();
    }
 
-   void refreshView() const
+   void refreshView()
    {
       if (acquireTimer->isActive())
       {
@@ -2048,20 +2129,73 @@ struct QtWindow::Impl
       }
 
       if (!streamModel->canFetchMore())
+      {
+         // back to normal rate when there is no pending frames
+         if (refreshTimer->interval() != REFRESH_INTERVAL)
+            refreshTimer->setInterval(REFRESH_INTERVAL);
+
          return;
+      }
+
+      QElapsedTimer refreshTime;
 
-      // fetch pending data from model
+      refreshTime.start();
+
+      int rows = streamModel->rowCount();
+
+      // fetch pending data from model, up to current batch limit
       streamModel->fetchMore();
 
+      int inserted = streamModel->rowCount() - rows;
+
+      qint64 insertTime = refreshTime.nsecsElapsed();
+
       // enable view if data is present
       if (!ui->decodeView->isEnabled() && streamModel->rowCount() > 0)
          ui->decodeView->setEnabled(true);
 
-      if (followEnabled)
+      if (followEnabled && inserted > 0)
          ui->decodeView->scrollToBottom();
 
-      // update view to fit all content
-      ui->decodeView->resizeColumnToContents(StreamModel::Data);
+      // model has been cleared, restart data column tracking
+      if (streamModel->maxDataLength() < refreshDataLength)
+         refreshDataLength = 0;
+
+      // widen data column only when a longer frame is received, avoids relayout on every refresh
+      if (streamModel->maxDataLength() > refreshDataLength)
+      {
+         refreshDataLength = streamModel->maxDataLength();
+
+         int margin = ui->decodeView->style()->pixelMetric(QStyle::PM_FocusFrameHMargin, nullptr, ui->decodeView) + 1;
+         int width = ui->decodeView->fontMetrics().horizontalAdvance(QString(refreshDataLength * 3 - 1, QChar('0'))) + margin * 2 + 1;
+
+         if (width > ui->decodeView->columnWidth(StreamModel::Data))
+            ui->decodeView->setColumnWidth(StreamModel::Data, width);
+      }
+
+      // layout and paint now instead of on next event loop pass, so they are part of the measured refresh
+      if (inserted > 0)
+         ui->decodeView->repaint();
+
+      // adapt next batch size to measured costs, the budget left after layout and paint is spent inserting frames
+      if (inserted > 0)
+      {
+         double frameCost = static_cast<double>(insertTime) / 1E6 / inserted;
+         double paintCost = static_cast<double>(refreshTime.nsecsElapsed() - insertTime) / 1E6;
+
+         refreshFrameCost = refreshFrameCost > 0 ? refreshFrameCost * 0.75 + frameCost * 0.25 : frameCost;
+         refreshPaintCost = refreshPaintCost > 0 ? refreshPaintCost * 0.75 + paintCost * 0.25 : paintCost;
+
+         double batch = (REFRESH_BUDGET - refreshPaintCost) / refreshFrameCost;
+
+         streamModel->setFetchLimit(static_cast<int>(std::clamp(batch, static_cast<double>(REFRESH_MIN_BATCH), 1E6)));
+      }
+
+      // refresh faster while frames remain pending to drain them in small batches
+      int interval = streamModel->canFetchMore() ? REFRESH_BACKLOG_INTERVAL : REFRESH_INTERVAL;
+
+      if (refreshTimer->interval() != interval)
+         refreshTimer->setInterval(interval);
    }
 
    void decoderSelectionChanged(const QItemSelection &selected, const QItemSelection &deselected)
@@ -2249,6 +2383,8 @@ struct QtWindow::Impl
 
          // sync radio view
          ui->radioView->setViewRange(from, to);
+
+         updateSignalInterest();
       }
       else
       {
@@ -2299,6 +2435,8 @@ struct QtWindow::Impl
 
          // sync logic view
          ui->logicView->setViewRange(from, to);
+
+         updateSignalInterest();
       }
       else
       {
@@ -2323,6 +2461,40 @@ struct QtWindow::Impl
 
       ui->logicView->setViewRange(logicFrom, logicTo);
       ui->radioView->setViewRange(radioFrom, radioTo);
+
+      updateSignalInterest();
+   }
+
+   /*
+    * Publish visible window and resolution of signal views, resampling task skips samples that can't be shown
+    */
+   void updateSignalInterest() const
+   {
+      double from = qInf();
+      double to = -qInf();
+      double resolution = qInf();
+
+      for (const AbstractPlotWidget *view: std::initializer_list<const AbstractPlotWidget *> {ui->radioView, ui->logicView})
+      {
+         if (!view->hasData() || view->width() <= 0 || view->viewSizeRange() <= 0)
+            continue;
+
+         from = qMin(from, view->viewLowerRange());
+
+         // view showing last received data must keep receiving new samples
+         to = qMax(to, view->viewUpperRange() < view->dataUpperRange() ? view->viewUpperRange() : qInf());
+
+         resolution = qMin(resolution, view->viewSizeRange() / view->width() / SIGNAL_DETAIL_ZOOM);
+      }
+
+      if (from >= to)
+         return;
+
+      QtApplication::post(new DecoderControlEvent(DecoderControlEvent::SignalInterest, {
+                             {"timeStart", from},
+                             {"timeEnd", to},
+                             {"resolution", resolution}
+                          }));
    }
 
    void parserSelectionChanged() const
@@ -2481,6 +2653,11 @@ void QtWindow::saveSelection()
    impl->saveSelected();
 }
 
+void QtWindow::exportApdu()
+{
+   impl->exportApdu();
+}
+
 void QtWindow::openConfig()
 {
    impl->openConfig();
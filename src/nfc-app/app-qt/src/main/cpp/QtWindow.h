@@ -46,6 +46,8 @@ class QtWindow : public QMainWindow
 
       void saveSelection();
 
+      void exportApdu();
+
       void openConfig();
 
       void toggleListen();
@@ -22,6 +22,9 @@
 #include <QVBoxLayout>
 #include <QTreeView>
 #include <QMouseEvent>
+#include <QScrollBar>
+#include <QSet>
+#include <QTimer>
 
 #include <QtConfig.h>
 
@@ -45,6 +48,9 @@ struct InspectDialog::Impl
 
    ParserModel *parserModel;
 
+   // top level frames already expanded, user may collapse them later
+   QSet<ProtocolFrame *> expandedFrames;
+
    explicit Impl(InspectDialog *dialog) : dialog(dialog), parserModel(new ParserModel(dialog)), ui(new Ui_InspectDialog())
    {
       setup();
@@ -67,6 +73,49 @@ struct InspectDialog::Impl
       QObject::connect(ui->infoView->selectionModel(), &QItemSelectionModel::selectionChanged, [=](const QItemSelection &selected, const QItemSelection &deselected) {
          infoSelectionChanged();
       });
+
+      // expand frames only when they become visible
+      QObject::connect(parserModel, &QAbstractItemModel::rowsInserted, [=] {
+         expandVisible();
+      });
+
+      QObject::connect(ui->infoView->verticalScrollBar(), &QScrollBar::valueChanged, [=] {
+         expandVisible();
+      });
+
+      QObject::connect(ui->infoView->verticalScrollBar(), &QScrollBar::rangeChanged, [=] {
+         expandVisible();
+      });
+   }
+
+   /*
+    * Expand top level frames inside viewport, frames below are expanded when scrolled into view
+    */
+   void expandVisible()
+   {
+      QTreeView *view = ui->infoView;
+
+      QModelIndex index = view->indexAt(QPoint(0, 0));
+
+      while (index.parent().isValid())
+         index = index.parent();
+
+      for (int row = index.isValid() ? index.row() : 0; row < parserModel->rowCount(); row++)
+      {
+         QModelIndex frameIndex = parserModel->index(row, 0);
+
+         if (view->visualRect(frameIndex).top() > view->viewport()->height())
+            break;
+
+         ProtocolFrame *frame = parserModel->entry(frameIndex);
+
+         if (!expandedFrames.contains(frame))
+         {
+            expandedFrames.insert(frame);
+
+            view->expandRecursively(frameIndex);
+         }
+      }
    }
 
    void infoSelectionChanged()
@@ -87,14 +136,7 @@ struct InspectDialog::Impl
 
    QByteArray toByteArray(const lab::RawFrame &frame)
    {
-      QByteArray data;
-
-      for (int i = 0; i < frame.limit(); i++)
-      {
-         data.append(frame[i]);
-      }
-
-      return data;
+      return {reinterpret_cast<const char *>(frame.data()), static_cast<int>(frame.limit())};
    }
 };
 
@@ -105,16 +147,25 @@ InspectDialog::InspectDialog(QWidget *parent) : QDialog(parent, Qt::WindowCloseB
 void InspectDialog::clear()
 {
    impl->parserModel->resetModel();
+   impl->expandedFrames.clear();
 }
 
 void InspectDialog::addFrame(const lab::RawFrame &frame)
 {
    impl->parserModel->append(frame);
+}
 
-   impl->ui->infoView->expandAll();
+void InspectDialog::addFrames(const QList<lab::RawFrame> &frames)
+{
+   impl->parserModel->append(frames);
 }
 
 int InspectDialog::showModal()
 {
+   // viewport has its final size once dialog is shown
+   QTimer::singleShot(0, this, [=] {
+      impl->expandVisible();
+   });
+
    return Theme::showModalInDarkMode(this);
 }
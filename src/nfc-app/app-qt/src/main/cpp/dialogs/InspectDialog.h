@@ -42,6 +42,8 @@ class InspectDialog : public QDialog
 
       void addFrame(const lab::RawFrame &data);
 
+      void addFrames(const QList<lab::RawFrame> &frames);
+
       int showModal();
 
    private:
@@ -45,6 +45,7 @@ class DecoderControlEvent : public QEvent
          RadioDeviceConfig,
          RadioDecoderConfig,
          FourierConfig,
+         SignalInterest,
       };
 
    public:
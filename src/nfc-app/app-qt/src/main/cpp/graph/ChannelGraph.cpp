@@ -29,8 +29,88 @@ struct ChannelGraph::Impl
 
    ChannelStyle style;
 
-   explicit Impl(ChannelGraph *graph) : graph(graph), offset(0)
+   QSharedPointer<SignalData> samples;
+
+   // parameters of current view
+   QCPRange viewRange;
+   int viewWidth = 0;
+   quint64 viewRevision = 0;
+
+   QVector<QCPGraphData> viewPoints;
+
+   // selected samples in time coordinates, view indexes are derived from it
+   QCPRange selectedRange;
+   bool selected = false;
+
+   explicit Impl(ChannelGraph *graph) : graph(graph), offset(0), samples(new SignalData())
+   {
+   }
+
+   /*
+    * Rebuild graph data from sample storage when visible range, plot width or samples have changed
+    */
+   void refreshView()
+   {
+      QCPRange range = graph->keyAxis()->range();
+      int width = graph->keyAxis()->axisRect()->width();
+
+      if (samples->revision() == viewRevision && range == viewRange && width == viewWidth)
+         return;
+
+      // two points per pixel column at most
+      samples->envelope(range.lower, range.upper, width, viewPoints);
+
+      graph->data()->set(viewPoints, true);
+
+      // view indexes have changed, map selection again
+      applySelection();
+
+      viewRange = range;
+      viewWidth = width;
+      viewRevision = samples->revision();
+   }
+
+   /*
+    * Select samples in time range, snapped to the first and last stored sample inside it
+    */
+   void select(const QCPRange &range)
+   {
+      selectedRange = samples->keyRange(range.lower, range.upper);
+      selected = selectedRange.size() > 0;
+
+      applySelection();
+   }
+
+   /*
+    * Update selection from view points picked by user, view points are stored samples so their keys are sample times
+    */
+   void selectView()
+   {
+      QCPDataSelection selection = graph->selection();
+
+      selected = !selection.isEmpty();
+
+      if (selected)
+         selectedRange = QCPRange(graph->data()->at(selection.span().begin())->key, graph->data()->at(selection.span().end() - 1)->key);
+   }
+
+   /*
+    * Select view points covered by selected time range
+    */
+   void applySelection()
    {
+      if (!selected)
+      {
+         if (!graph->selection().isEmpty())
+            graph->setSelection(QCPDataSelection());
+
+         return;
+      }
+
+      int startIndex = int(graph->data()->findBegin(selectedRange.lower, false) - graph->data()->constBegin());
+      int endIndex = int(graph->data()->findEnd(selectedRange.upper, false) - graph->data()->constBegin());
+
+      graph->setSelection(startIndex < endIndex ? QCPDataSelection(QCPDataRange(startIndex, endIndex)) : QCPDataSelection());
    }
 
    void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
@@ -86,7 +166,45 @@ double ChannelGraph::offset()
    return impl->offset;
 }
 
+QSharedPointer<SignalData> ChannelGraph::samples() const
+{
+   return impl->samples;
+}
+
+void ChannelGraph::setSelectedRange(const QCPRange &range)
+{
+   impl->select(range);
+}
+
+QCPRange ChannelGraph::selectedRange() const
+{
+   return impl->selected ? impl->selectedRange : QCPRange();
+}
+
+void ChannelGraph::draw(QCPPainter *painter)
+{
+   // graphs filled directly through data() are left untouched
+   if (impl->samples->revision() != 0)
+      impl->refreshView();
+
+   QCPGraph::draw(painter);
+}
+
 void ChannelGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 {
    impl->drawLegendIcon(painter, rect);
 }
+
+void ChannelGraph::selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged)
+{
+   QCPGraph::selectEvent(event, additive, details, selectionStateChanged);
+
+   impl->selectView();
+}
+
+void ChannelGraph::deselectEvent(bool *selectionStateChanged)
+{
+   QCPGraph::deselectEvent(selectionStateChanged);
+
+   impl->selectView();
+}
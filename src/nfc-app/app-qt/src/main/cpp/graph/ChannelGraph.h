@@ -25,6 +25,7 @@
 #include <3party/customplot/QCustomPlot.h>
 
 #include "ChannelStyle.h"
+#include "SignalData.h"
 
 class ChannelGraph : public QCPGraph
 {
@@ -44,8 +45,25 @@ class ChannelGraph : public QCPGraph
 
       double offset();
 
+      // compact sample storage, when not empty graph data holds only the decimated view of visible range
+      QSharedPointer<SignalData> samples() const;
+
+      // select samples in time range, kept in sample time so it survives view changes, empty range clears selection
+      void setSelectedRange(const QCPRange &range);
+
+      // time of first and last selected sample, empty range if there is no selection
+      QCPRange selectedRange() const;
+
+      void draw(QCPPainter *painter) override;
+
       void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const override;
 
+   protected:
+
+      void selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged) override;
+
+      void deselectEvent(bool *selectionStateChanged) override;
+
    private:
 
       QSharedPointer<Impl> impl;
@@ -0,0 +1,176 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <styles/Theme.h>
+
+#include "MarkerBrackets.h"
+#include "RangeLayer.h"
+
+// bracket height and distance to signal, in pixels
+#define BRACKET_LENGTH 10
+#define BRACKET_OFFSET 5
+
+/*
+ * Single layerable for all brackets, sorted by start time and drawn only inside visible key range. Label text is
+ * requested to mapper when bracket is first drawn, brackets without label are not shown.
+ */
+class BracketLayer : public RangeLayer
+{
+   public:
+
+      BracketLayer(QCustomPlot *plot, const QFont &font) : RangeLayer(plot, font, QLatin1String("overlay"))
+      {
+      }
+
+      void addBracket(double start, double end, double value, int key)
+      {
+         insertRange({start, end, value, DEFERRED_LABEL, key});
+      }
+
+   protected:
+
+      void draw(QCPPainter *painter) override
+      {
+         if (ranges.isEmpty())
+            return;
+
+         QCPAxis *keyAxis = mParentPlot->xAxis;
+         QCPAxis *valueAxis = mParentPlot->yAxis;
+
+         QCPRange visible = keyAxis->range();
+
+         // pixels per key unit
+         double scale = keyAxis->axisRect()->width() / visible.size();
+
+         int labelHeight = labelFontMetrics.height();
+
+         // nothing to draw if longest range is too narrow for any label
+         if (maxLength * scale <= labelHeight)
+            return;
+
+         painter->setFont(labelFont);
+
+         for (int index = firstVisible(visible); index < ranges.size() && ranges[index].start <= visible.upper; index++)
+         {
+            const LayerRange &range = ranges[index];
+
+            if (range.end < visible.lower || (range.end - range.start) * scale <= labelHeight)
+               continue;
+
+            const LayerLabel &label = rangeLabel(index);
+
+            if (label.text.isEmpty())
+               continue;
+
+            double left = keyAxis->coordToPixel(range.start);
+            double right = keyAxis->coordToPixel(range.end);
+            double center = (left + right) / 2;
+            double top = valueAxis->coordToPixel(range.value) - BRACKET_OFFSET - BRACKET_LENGTH;
+
+            // bracket with label over it if there is enough space
+            if (right - left > label.width)
+            {
+               drawBracket(painter, left, right, top + BRACKET_LENGTH);
+
+               painter->setPen(Theme::defaultBracketLabelColor);
+               painter->drawText(QRectF(center - label.width / 2.0, top - labelHeight * 1.5, label.width, labelHeight), Qt::AlignCenter, label.text);
+            }
+
+               // only rotated label otherwise
+            else
+            {
+               painter->save();
+               painter->translate(center, top + 5 - label.width / 2.0);
+               painter->rotate(-90);
+               painter->setPen(Theme::defaultBracketLabelColor);
+               painter->drawText(QRectF(-label.width / 2.0, -labelHeight / 2.0, label.width, labelHeight), Qt::AlignCenter, label.text);
+               painter->restore();
+            }
+         }
+      }
+
+   private:
+
+      // calligraphic bracket from left to right at base line, same shape as QCPItemBracket
+      static void drawBracket(QCPPainter *painter, double left, double right, double base)
+      {
+         QPointF width((right - left) / 2, 0);
+         QPointF length(0, BRACKET_LENGTH);
+         QPointF center((left + right) / 2, base - BRACKET_LENGTH);
+
+         QPainterPath path;
+
+         path.moveTo(center + width + length);
+         path.cubicTo(center + width - length * 0.8, center + 0.4 * width + 0.8 * length, center);
+         path.cubicTo(center - 0.4 * width + 0.8 * length, center - width - length * 0.8, center - width + length);
+         path.cubicTo(center - width - length * 0.5, center - 0.2 * width + 1.2 * length, center + length * 0.2);
+         path.cubicTo(center + 0.2 * width + 1.2 * length, center + width - length * 0.5, center + width + length);
+
+         painter->setPen(Qt::NoPen);
+         painter->setBrush(Theme::defaultBracketPen.color());
+         painter->drawPath(path);
+      }
+};
+
+struct MarkerBrackets::Impl
+{
+   QCustomPlot *plot;
+
+   QPointer<BracketLayer> layer;
+
+   explicit Impl(QCustomPlot *plot) : plot(plot), layer(new BracketLayer(plot, Theme::defaultBracketLabelFont))
+   {
+   }
+
+   ~Impl()
+   {
+      delete layer;
+   }
+};
+
+MarkerBrackets::MarkerBrackets(QCustomPlot *plot) : impl(new Impl(plot))
+{
+}
+
+const QFont &MarkerBrackets::labelFont()
+{
+   return impl->layer->labelFont;
+}
+
+void MarkerBrackets::setLabelFont(const QFont &font)
+{
+   impl->layer->setLabelFont(font);
+}
+
+void MarkerBrackets::setLabelMapper(const LabelMapper &mapper)
+{
+   impl->layer->setLabelMapper(mapper);
+}
+
+void MarkerBrackets::addBracket(double start, double end, double value, int key)
+{
+   impl->layer->addBracket(start, end, value, key);
+}
+
+void MarkerBrackets::clear()
+{
+   impl->layer->clear();
+}
@@ -19,52 +19,41 @@
 
 */
 
-#ifndef NFC_LAB_MARKERBRACKET_H
-#define NFC_LAB_MARKERBRACKET_H
+#ifndef NFC_LAB_MARKERBRACKETS_H
+#define NFC_LAB_MARKERBRACKETS_H
+
+#include <functional>
 
 #include <QSharedPointer>
 
 #include <3party/customplot/QCustomPlot.h>
 
-class MarkerBracket
+/*
+ * Frame brackets with labels for a whole capture, drawn by a single layerable that only visits frames inside the visible range
+ */
+class MarkerBrackets
 {
       struct Impl;
 
    public:
 
-      MarkerBracket(QCustomPlot *plot);
+      // label text for bracket key, called once per bracket when it is first drawn
+      typedef std::function<QString(int key)> LabelMapper;
 
-      const QPen bracketPen();
+   public:
 
-      void setBracketPen(const QPen &pen);
+      explicit MarkerBrackets(QCustomPlot *plot);
 
-      const QFont labelFont();
+      const QFont &labelFont();
 
       void setLabelFont(const QFont &font);
 
-      const QColor labelColor();
-
-      void setLabelColor(const QColor &color);
-
-      const QPen labelPen();
-
-      void setLabelPen(const QPen &pen);
-
-      const QBrush labelBrush();
-
-      void setLabelBrush(const QBrush &brush);
-
-      QPointF left() const;
-
-      void setLeft(const QPointF &point);
-
-      QPointF right() const;
-
-      void setRight(const QPointF &point);
+      void setLabelMapper(const LabelMapper &mapper);
 
-      QString text() const;
+      // bracket over range at value, label is resolved from key by mapper
+      void addBracket(double start, double end, double value, int key);
 
-      void setText(const QString &text);
+      void clear();
 
    private:
 
@@ -72,4 +61,4 @@ class MarkerBracket
 };
 
 
-#endif //NFC_LAB_MARKERBRACKET_H
+#endif //NFC_LAB_MARKERBRACKETS_H
@@ -22,129 +22,144 @@
 #include <QDebug>
 
 #include "MarkerRibbon.h"
+#include "RangeLayer.h"
 
+#include <algorithm>
 #include <utility>
 
-struct RibbonItem
+struct RibbonStyle
 {
-   QCPItemTracer *leftTracer = nullptr;
-   QCPItemTracer *rightTracer = nullptr;
-   QCPItemRect *rectMarker = nullptr;
-   QCPItemText *textLabel = nullptr;
+   int label;
+   QPen pen;
+   QBrush brush;
 };
 
-struct MarkerRibbon::Impl
+/*
+ * Single layerable for all ribbon ranges, sorted by start time and drawn only inside visible key range
+ */
+class RibbonLayer : public RangeLayer
 {
-   static const QColor defaultLabelColor;
-   static const QPen defaultLabelPen;
-   static const QBrush defaultLabelBrush;
-   static const QFont defaultLabelFont;
+   public:
 
-   QCustomPlot *plot;
+      static const QColor defaultLabelColor;
 
-   QFont labelFont;
-   QColor labelColor;
-   QFontMetrics labelFontMetrics;
-   QList<RibbonItem> elements;
+      QVector<RibbonStyle> styles;
 
-   QMetaObject::Connection rangeChangedConnection;
+      RibbonLayer(QCustomPlot *plot, const QFont &font) : RangeLayer(plot, font)
+      {
+      }
 
-   explicit Impl(QCustomPlot *plot) : plot(plot),
-                                      labelFont(defaultLabelFont),
-                                      labelColor(defaultLabelColor),
-                                      labelFontMetrics(defaultLabelFont)
-   {
-      rangeChangedConnection = QObject::connect(plot->xAxis, static_cast<void (QCPAxis::*)(const QCPRange &)>(&QCPAxis::rangeChanged), [=](const QCPRange &newRange) {
-         rangeChanged(newRange);
-      });
-   }
+      void addRange(double start, double end, const QString &label, const QPen &pen, const QBrush &brush)
+      {
+         insertRange({start, end, 0, styleIndex(labelId(label), pen, brush), 0});
+      }
 
-   ~Impl()
-   {
-      QObject::disconnect(rangeChangedConnection);
+      void clear() override
+      {
+         RangeLayer::clear();
 
-      for (const RibbonItem &item: elements)
+         styles.clear();
+      }
+
+   protected:
+
+      void draw(QCPPainter *painter) override
       {
-         plot->removeItem(item.leftTracer);
-         plot->removeItem(item.rightTracer);
-         plot->removeItem(item.rectMarker);
-         plot->removeItem(item.textLabel);
+         if (ranges.isEmpty())
+            return;
+
+         QCPAxis *keyAxis = mParentPlot->xAxis;
+
+         QCPRange visible = keyAxis->range();
+
+         double bottom = keyAxis->axisRect()->bottom() - 2;
+         double top = bottom - labelFontMetrics.height();
+
+         painter->setFont(labelFont);
+
+         // pending rectangle, consecutive ranges with same style closer than one pixel are merged
+         QRectF rect;
+         int style = -1;
+
+         for (int index = firstVisible(visible); index < ranges.size() && ranges[index].start <= visible.upper; index++)
+         {
+            const LayerRange &range = ranges[index];
+
+            if (range.end < visible.lower)
+               continue;
+
+            double left = keyAxis->coordToPixel(range.start) - 3;
+            double right = keyAxis->coordToPixel(range.end) + 3;
+
+            if (style == range.style && left <= rect.right() + 1)
+            {
+               rect.setRight(std::max(rect.right(), right));
+               continue;
+            }
+
+            if (style >= 0)
+               drawRange(painter, rect, styles[style]);
+
+            rect = QRectF(QPointF(left, top), QPointF(right, bottom));
+            style = range.style;
+         }
+
+         if (style >= 0)
+            drawRange(painter, rect, styles[style]);
       }
-   }
 
-   void addRange(double start, double end, const QString &label, const QPen &pen, const QBrush &brush)
-   {
-      RibbonItem item;
-
-      item.leftTracer = new QCPItemTracer(plot);
-      item.leftTracer->setVisible(false);
-      item.leftTracer->position->setTypeY(QCPItemPosition::ptAxisRectRatio);
-      item.leftTracer->position->setAxisRect(plot->xAxis->axisRect());
-      item.leftTracer->position->setAxes(plot->xAxis, nullptr);
-      item.leftTracer->position->setCoords(start, 1);
-
-      item.rightTracer = new QCPItemTracer(plot);
-      item.rightTracer->setVisible(false);
-      item.rightTracer->position->setTypeY(QCPItemPosition::ptAxisRectRatio);
-      item.rightTracer->position->setAxisRect(plot->xAxis->axisRect());
-      item.rightTracer->position->setAxes(plot->xAxis, nullptr);
-      item.rightTracer->position->setCoords(end, 1);
-
-      item.rectMarker = new QCPItemRect(plot);
-      item.rectMarker->setSelectable(false);
-      item.rectMarker->setPen(pen);
-      item.rectMarker->setBrush(brush);
-      item.rectMarker->setClipToAxisRect(true);
-      item.rectMarker->topLeft->setParentAnchor(item.leftTracer->position);
-      item.rectMarker->topLeft->setCoords(-3, -2);
-      item.rectMarker->bottomRight->setParentAnchor(item.rightTracer->position);
-      item.rectMarker->bottomRight->setCoords(3, -2 - labelFontMetrics.height());
-
-      item.textLabel = new QCPItemText(plot);
-      item.textLabel->setSelectable(false);
-      item.textLabel->setVisible(false);
-      item.textLabel->setFont(defaultLabelFont);
-      item.textLabel->setColor(defaultLabelColor);
-      item.textLabel->setPen(defaultLabelPen);
-      item.textLabel->setBrush(defaultLabelBrush);
-      item.textLabel->setSelectable(false);
-      item.textLabel->setClipToAxisRect(true);
-      item.textLabel->setText(label);
-      item.textLabel->setPadding({4, 0, 0, 2});
-      item.textLabel->setPositionAlignment(Qt::AlignBottom | Qt::AlignLeft);
-      item.textLabel->position->setParentAnchor(item.rectMarker->topLeft);
-      item.textLabel->position->setCoords(0, 0);
-
-      elements.append(item);
-   }
+   private:
 
-   void clear()
-   {
-      for (const RibbonItem &item: elements)
+      int styleIndex(int label, const QPen &pen, const QBrush &brush)
       {
-         plot->removeItem(item.textLabel);
-         plot->removeItem(item.rectMarker);
-         plot->removeItem(item.leftTracer);
-         plot->removeItem(item.rightTracer);
+         for (int i = 0; i < styles.size(); i++)
+         {
+            if (styles[i].label == label && styles[i].pen == pen && styles[i].brush == brush)
+               return i;
+         }
+
+         styles.append({label, pen, brush});
+
+         return styles.size() - 1;
+      }
+
+      void drawRange(QCPPainter *painter, const QRectF &rect, const RibbonStyle &style) const
+      {
+         const LayerLabel &label = labels[style.label];
+
+         painter->setPen(style.pen);
+         painter->setBrush(style.brush);
+         painter->drawRect(rect);
+
+         // show label only if fits inside range
+         if (rect.width() > label.width)
+         {
+            painter->setPen(defaultLabelColor);
+            painter->drawText(rect.adjusted(4, 0, 0, -2), Qt::AlignBottom | Qt::AlignLeft, label.text);
+         }
       }
+};
 
-      elements.clear();
+const QColor RibbonLayer::defaultLabelColor({0xF0, 0xF0, 0xF0, 0xFF});
+
+struct MarkerRibbon::Impl
+{
+   static const QFont defaultLabelFont;
+
+   QCustomPlot *plot;
+
+   QPointer<RibbonLayer> layer;
+
+   explicit Impl(QCustomPlot *plot) : plot(plot), layer(new RibbonLayer(plot, defaultLabelFont))
+   {
    }
 
-   void rangeChanged(const QCPRange &newRange)
+   ~Impl()
    {
-      for (const RibbonItem &item: elements)
-      {
-         double markerWidth = item.rectMarker->right->pixelPosition().x() - item.rectMarker->left->pixelPosition().x();
-         QSize labelWidth = labelFontMetrics.size(0, item.textLabel->text());
-         item.textLabel->setVisible(markerWidth > labelWidth.width());
-      }
+      delete layer;
    }
 };
 
-const QColor MarkerRibbon::Impl::defaultLabelColor({0xF0, 0xF0, 0xF0, 0xFF});
-const QPen MarkerRibbon::Impl::defaultLabelPen(Qt::NoPen);
-const QBrush MarkerRibbon::Impl::defaultLabelBrush(Qt::NoBrush);
 const QFont MarkerRibbon::Impl::defaultLabelFont("Roboto", 9, QFont::Bold);
 
 MarkerRibbon::MarkerRibbon(QCustomPlot *plot) : impl(new Impl(plot))
@@ -153,21 +168,20 @@ MarkerRibbon::MarkerRibbon(QCustomPlot *plot) : impl(new Impl(plot))
 
 const QFont &MarkerRibbon::labelFont()
 {
-   return impl->labelFont;
+   return impl->layer->labelFont;
 }
 
 void MarkerRibbon::setLabelFont(const QFont &font)
 {
-   impl->labelFont = font;
-   impl->labelFontMetrics = QFontMetrics(font);
+   impl->layer->setLabelFont(font);
 }
 
 void MarkerRibbon::addRange(double start, double end, const QString &label, const QPen &pen, const QBrush &brush)
 {
-   impl->addRange(start, end, label, pen, brush);
+   impl->layer->addRange(start, end, label, pen, brush);
 }
 
 void MarkerRibbon::clear()
 {
-   impl->clear();
+   impl->layer->clear();
 }
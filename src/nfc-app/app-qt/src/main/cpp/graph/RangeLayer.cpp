@@ -0,0 +1,108 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "RangeLayer.h"
+
+#include <algorithm>
+
+RangeLayer::RangeLayer(QCustomPlot *plot, const QFont &font, const QString &targetLayer) : QCPLayerable(plot, targetLayer), labelFont(font), labelFontMetrics(font)
+{
+}
+
+void RangeLayer::setLabelFont(const QFont &font)
+{
+   labelFont = font;
+   labelFontMetrics = QFontMetrics(font);
+
+   for (LayerLabel &label: labels)
+      label.width = labelFontMetrics.horizontalAdvance(label.text);
+}
+
+void RangeLayer::setLabelMapper(const LabelMapper &mapper)
+{
+   labelMapper = mapper;
+}
+
+void RangeLayer::clear()
+{
+   ranges.clear();
+   labels.clear();
+   labelIndex.clear();
+   maxLength = 0;
+}
+
+void RangeLayer::insertRange(const LayerRange &range)
+{
+   // frames are received in order, so most ranges are appended
+   if (ranges.isEmpty() || !(range < ranges.last()))
+      ranges.append(range);
+   else
+      ranges.insert(std::upper_bound(ranges.begin(), ranges.end(), range), range);
+
+   maxLength = std::max(maxLength, range.end - range.start);
+}
+
+int RangeLayer::labelId(const QString &text)
+{
+   auto it = labelIndex.constFind(text);
+
+   if (it != labelIndex.constEnd())
+      return it.value();
+
+   // label width is measured once per text
+   labels.append({text, labelFontMetrics.horizontalAdvance(text)});
+
+   labelIndex.insert(text, labels.size() - 1);
+
+   return labels.size() - 1;
+}
+
+/*
+ * Label of range at index, deferred labels are requested to mapper the first time and kept in range style, so
+ * label text is only built for ranges that are drawn at least once
+ */
+const LayerLabel &RangeLayer::rangeLabel(int index)
+{
+   LayerRange &range = ranges[index];
+
+   if (range.style == DEFERRED_LABEL)
+      range.style = labelId(labelMapper ? labelMapper(range.key) : QString());
+
+   return labels[range.style];
+}
+
+/*
+ * Index of first range that may intersect visible interval, callers stop once range start is past its upper bound
+ */
+int RangeLayer::firstVisible(const QCPRange &visible) const
+{
+   return static_cast<int>(std::lower_bound(ranges.constBegin(), ranges.constEnd(), LayerRange {visible.lower - maxLength, 0, 0, 0, 0}) - ranges.constBegin());
+}
+
+QRect RangeLayer::clipRect() const
+{
+   return mParentPlot->xAxis->axisRect()->rect();
+}
+
+void RangeLayer::applyDefaultAntialiasingHint(QCPPainter *painter) const
+{
+   applyAntialiasingHint(painter, mAntialiased, QCP::aeItems);
+}
@@ -0,0 +1,108 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef NFC_LAB_RANGELAYER_H
+#define NFC_LAB_RANGELAYER_H
+
+#include <functional>
+
+#include <QHash>
+#include <QVector>
+
+#include <3party/customplot/QCustomPlot.h>
+
+struct LayerRange
+{
+   double start;
+   double end;
+   double value;
+   int style;
+
+   // caller key for deferred label, see RangeLayer::rangeLabel
+   int key;
+
+   bool operator<(const LayerRange &other) const
+   {
+      return start < other.start;
+   }
+};
+
+struct LayerLabel
+{
+   QString text;
+   int width;
+};
+
+/*
+ * Base for markers drawn by a single layerable, keeps ranges sorted by start time so draw only visits visible ones
+ */
+class RangeLayer : public QCPLayerable
+{
+   public:
+
+      // label text for range key, called only for ranges that are drawn
+      typedef std::function<QString(int key)> LabelMapper;
+
+      // range style of labels not yet resolved by mapper
+      static constexpr int DEFERRED_LABEL = -1;
+
+   public:
+
+      QFont labelFont;
+      QFontMetrics labelFontMetrics;
+
+      RangeLayer(QCustomPlot *plot, const QFont &font, const QString &targetLayer = QString());
+
+      void setLabelFont(const QFont &font);
+
+      void setLabelMapper(const LabelMapper &mapper);
+
+      virtual void clear();
+
+   protected:
+
+      QVector<LayerRange> ranges;
+
+      // label texts measured once and shared by all ranges with same text
+      QVector<LayerLabel> labels;
+
+      // label index by text
+      QHash<QString, int> labelIndex;
+
+      LabelMapper labelMapper;
+
+      // longest range, bounds backward search for ranges starting before visible interval
+      double maxLength = 0;
+
+      void insertRange(const LayerRange &range);
+
+      int labelId(const QString &text);
+
+      const LayerLabel &rangeLabel(int index);
+
+      int firstVisible(const QCPRange &visible) const;
+
+      QRect clipRect() const override;
+
+      void applyDefaultAntialiasingHint(QCPPainter *painter) const override;
+};
+
+#endif //NFC_LAB_RANGELAYER_H
@@ -0,0 +1,519 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <hw/SignalType.h>
+
+#include "SignalData.h"
+
+// adaptive segments span at most 2^24 sample ticks, the range where float ticks are exact
+#define MAX_TICK_SPAN (1 << 24)
+
+// samples per block of range maximum index
+#define BLOCK_SHIFT 8
+#define BLOCK_SIZE (1 << BLOCK_SHIFT)
+
+struct SignalSegment
+{
+   // sample offset of segment start and sample rate
+   unsigned long long origin = 0;
+   double rate = 0;
+
+   // time of segment start and time between samples
+   double start = 0;
+   double step = 0;
+
+   // sample values
+   QVector<float> values;
+
+   // sample ticks relative to segment start, only for adaptive buffers
+   QVector<float> ticks;
+
+   // sparse table of complete block maximums, level k entry i is the maximum of blocks i to i + 2^k - 1
+   QVector<QVector<float>> blockMax;
+
+   bool adaptive = false;
+
+   SignalSegment() = default;
+
+   SignalSegment(unsigned long long origin, double rate, bool adaptive) : origin(origin), rate(rate), start(static_cast<double>(origin) / rate), step(1 / rate), adaptive(adaptive)
+   {
+   }
+
+   double time(int index) const
+   {
+      return std::fma(step, adaptive ? ticks[index] : index, start);
+   }
+
+   double end() const
+   {
+      return time(values.size() - 1);
+   }
+
+   // first sample with time >= t
+   int lowerBound(double t) const
+   {
+      if (adaptive)
+         return static_cast<int>(std::lower_bound(ticks.constBegin(), ticks.constEnd(), (t - start) * rate, [](float tick, double value) { return tick < value; }) - ticks.constBegin());
+
+      double index = std::ceil((t - start) * rate);
+
+      return index <= 0 ? 0 : index >= values.size() ? values.size() : static_cast<int>(index);
+   }
+
+   // first sample with time > t
+   int upperBound(double t) const
+   {
+      if (adaptive)
+         return static_cast<int>(std::upper_bound(ticks.constBegin(), ticks.constEnd(), (t - start) * rate, [](double value, float tick) { return value < tick; }) - ticks.constBegin());
+
+      double index = std::floor((t - start) * rate) + 1;
+
+      return index <= 0 ? 0 : index >= values.size() ? values.size() : static_cast<int>(index);
+   }
+
+   int blocks() const
+   {
+      return blockMax.isEmpty() ? 0 : blockMax[0].size();
+   }
+
+   // add blocks completed by last append to index, returns number of entries added
+   int updateIndex()
+   {
+      int added = 0;
+
+      if (blockMax.isEmpty())
+         blockMax.append(QVector<float>());
+
+      for (int block = blocks(); block < values.size() >> BLOCK_SHIFT; block++)
+      {
+         const float *data = values.constData() + (block << BLOCK_SHIFT);
+
+         // independent partial maximums, so the loop is not bound by comparison latency
+         float peak[8];
+
+         std::copy(data, data + 8, peak);
+
+         for (int i = 8; i < BLOCK_SIZE; i += 8)
+         {
+            for (int j = 0; j < 8; j++)
+               peak[j] = std::max(peak[j], data[i + j]);
+         }
+
+         blockMax[0].append(*std::max_element(peak, peak + 8));
+
+         // new block completes one entry on each level with enough blocks
+         for (int level = 1; block - (1 << level) + 1 >= 0; level++)
+         {
+            if (blockMax.size() == level)
+               blockMax.append(QVector<float>());
+
+            int index = block - (1 << level) + 1;
+
+            blockMax[level].append(std::max(blockMax[level - 1][index], blockMax[level - 1][index + (1 << (level - 1))]));
+
+            added++;
+         }
+
+         added++;
+      }
+
+      return added;
+   }
+
+   int indexSize() const
+   {
+      int size = 0;
+
+      for (const QVector<float> &level: blockMax)
+         size += level.size();
+
+      return size;
+   }
+
+   // maximum value of samples in [lo, hi), only partial blocks at both ends are scanned
+   float maximum(int lo, int hi) const
+   {
+      int first = (lo + BLOCK_SIZE - 1) >> BLOCK_SHIFT;
+      int last = std::min(hi >> BLOCK_SHIFT, blocks());
+
+      if (first >= last)
+         return *std::max_element(values.constBegin() + lo, values.constBegin() + hi);
+
+      int level = 0;
+
+      while ((2 << level) <= last - first)
+         level++;
+
+      float result = std::max(blockMax[level][first], blockMax[level][last - (1 << level)]);
+
+      if (lo < first << BLOCK_SHIFT)
+         result = std::max(result, *std::max_element(values.constBegin() + lo, values.constBegin() + (first << BLOCK_SHIFT)));
+
+      if (last << BLOCK_SHIFT < hi)
+         result = std::max(result, *std::max_element(values.constBegin() + (last << BLOCK_SHIFT), values.constBegin() + hi));
+
+      return result;
+   }
+};
+
+struct SignalData::Impl
+{
+   QVector<SignalSegment> segments;
+
+   ValueMapper mapper = [](float value) { return static_cast<double>(value); };
+
+   qint64 samples = 0;
+   qint64 memory = 0;
+   quint64 revision = 0;
+
+   void append(const hw::SignalBuffer &buffer)
+   {
+      bool adaptive;
+
+      switch (buffer.type())
+      {
+         case hw::SignalType::SIGNAL_TYPE_RAW_REAL:
+         case hw::SignalType::SIGNAL_TYPE_RAW_LOGIC:
+            adaptive = false;
+            break;
+
+         case hw::SignalType::SIGNAL_TYPE_ADV_REAL:
+         case hw::SignalType::SIGNAL_TYPE_ADV_LOGIC:
+            adaptive = true;
+            break;
+
+         default:
+            return;
+      }
+
+      // adaptive buffers are value / tick pairs
+      int count = static_cast<int>(adaptive ? buffer.limit() / 2 : buffer.elements());
+
+      if (count == 0)
+         return;
+
+      const float *data = buffer.data();
+      double rate = buffer.sampleRate();
+      unsigned long long offset = buffer.offset();
+
+      SignalSegment *last = segments.isEmpty() ? nullptr : &segments.last();
+
+      // continue last segment if it has the same layout and room, regular samples must also be contiguous
+      bool extend = last && last->adaptive == adaptive && last->rate == rate && last->values.size() + count <= SEGMENT_SIZE;
+
+      if (extend && adaptive)
+         extend = offset >= last->origin && offset - last->origin + static_cast<unsigned long long>(data[2 * count - 1]) < MAX_TICK_SPAN;
+      else if (extend)
+         extend = offset == last->origin + last->values.size();
+
+      if (!extend)
+      {
+         segments.append(SignalSegment(offset, rate, adaptive));
+         last = &segments.last();
+      }
+
+      int base = last->values.size();
+
+      last->values.resize(base + count);
+
+      if (adaptive)
+      {
+         float shift = static_cast<float>(offset - last->origin);
+
+         last->ticks.resize(base + count);
+
+         float *values = last->values.data() + base;
+         float *ticks = last->ticks.data() + base;
+
+         for (int i = 0; i < count; i++)
+         {
+            values[i] = data[2 * i + 0];
+            ticks[i] = data[2 * i + 1] + shift;
+         }
+      }
+      else
+      {
+         std::memcpy(last->values.data() + base, data, count * sizeof(float));
+      }
+
+      samples += count;
+      memory += count * sizeof(float) * (adaptive ? 2 : 1);
+      memory += last->updateIndex() * sizeof(float);
+      revision++;
+   }
+
+   void limit(qint64 maximumBytes)
+   {
+      while (segments.size() > 1 && memory > maximumBytes)
+      {
+         const SignalSegment &first = segments.first();
+
+         samples -= first.values.size();
+         memory -= (first.values.size() + first.ticks.size() + first.indexSize()) * sizeof(float);
+
+         segments.removeFirst();
+         revision++;
+      }
+   }
+
+   void clear()
+   {
+      segments.clear();
+      samples = 0;
+      memory = 0;
+      revision++;
+   }
+
+   // first segment with samples at or after t
+   int findSegment(double t) const
+   {
+      return static_cast<int>(std::lower_bound(segments.constBegin(), segments.constEnd(), t, [](const SignalSegment &segment, double value) { return segment.end() < value; }) - segments.constBegin());
+   }
+
+   QCPRange keyRange(double from, double to) const
+   {
+      double lower = INFINITY;
+      double upper = -INFINITY;
+
+      for (int s = findSegment(from); s < segments.size() && segments[s].start <= to; s++)
+      {
+         const SignalSegment &segment = segments[s];
+
+         int lo = segment.lowerBound(from);
+         int hi = segment.upperBound(to);
+
+         if (lo >= hi)
+            continue;
+
+         lower = std::min(lower, segment.time(lo));
+         upper = std::max(upper, segment.time(hi - 1));
+      }
+
+      if (lower > upper)
+         return {};
+
+      return {lower, upper};
+   }
+
+   QCPRange valueRange(double from, double to) const
+   {
+      float lower = INFINITY;
+      float upper = -INFINITY;
+
+      for (int s = findSegment(from); s < segments.size() && segments[s].start <= to; s++)
+      {
+         const SignalSegment &segment = segments[s];
+
+         int lo = segment.lowerBound(from);
+         int hi = segment.upperBound(to);
+
+         if (lo >= hi)
+            continue;
+
+         auto range = std::minmax_element(segment.values.constBegin() + lo, segment.values.constBegin() + hi);
+
+         lower = std::min(lower, *range.first);
+         upper = std::max(upper, *range.second);
+      }
+
+      if (lower > upper)
+         return {};
+
+      return {mapper(lower), mapper(upper)};
+   }
+
+   double maximum(double from, double to) const
+   {
+      float upper = -INFINITY;
+
+      for (int s = findSegment(from); s < segments.size() && segments[s].start <= to; s++)
+      {
+         const SignalSegment &segment = segments[s];
+
+         int lo = segment.lowerBound(from);
+         int hi = segment.upperBound(to);
+
+         if (lo < hi)
+            upper = std::max(upper, segment.maximum(lo, hi));
+      }
+
+      return std::isinf(upper) ? -INFINITY : mapper(upper);
+   }
+
+   void point(QVector<QCPGraphData> &points, const SignalSegment &segment, int index) const
+   {
+      points.append({segment.time(index), mapper(segment.values[index])});
+   }
+
+   void envelope(double from, double to, int buckets, QVector<QCPGraphData> &points) const
+   {
+      points.clear();
+
+      if (segments.isEmpty() || buckets <= 0 || to < from)
+         return;
+
+      int first = findSegment(from);
+      qint64 total = 0;
+
+      for (int s = first; s < segments.size() && segments[s].start <= to; s++)
+         total += segments[s].upperBound(to) - segments[s].lowerBound(from);
+
+      // last sample before range, so lines reach the left border
+      if (first < segments.size() && segments[first].lowerBound(from) > 0)
+         point(points, segments[first], segments[first].lowerBound(from) - 1);
+      else if (first > 0)
+         point(points, segments[first - 1], segments[first - 1].values.size() - 1);
+
+      double width = (to - from) / buckets;
+
+      for (int s = first; s < segments.size() && segments[s].start <= to; s++)
+      {
+         const SignalSegment &segment = segments[s];
+
+         int lo = segment.lowerBound(from);
+         int hi = segment.upperBound(to);
+
+         // few samples, plot all of them
+         if (total <= 2 * buckets)
+         {
+            for (int i = lo; i < hi; i++)
+               point(points, segment, i);
+
+            continue;
+         }
+
+         // minimum and maximum of each bucket, in time order
+         for (int i = lo; i < hi;)
+         {
+            double bucket = std::floor((segment.time(i) - from) / width);
+            int next = std::max(i + 1, std::min(hi, segment.lowerBound(from + (bucket + 1) * width)));
+
+            auto range = std::minmax_element(segment.values.constBegin() + i, segment.values.constBegin() + next);
+
+            int lower = static_cast<int>(range.first - segment.values.constBegin());
+            int upper = static_cast<int>(range.second - segment.values.constBegin());
+
+            if (lower != upper)
+            {
+               point(points, segment, std::min(lower, upper));
+               point(points, segment, std::max(lower, upper));
+            }
+            else
+            {
+               point(points, segment, lower);
+            }
+
+            i = next;
+         }
+      }
+
+      // first sample after range, so lines reach the right border
+      for (int s = first; s < segments.size(); s++)
+      {
+         int index = segments[s].upperBound(to);
+
+         if (index < segments[s].values.size())
+         {
+            point(points, segments[s], index);
+            break;
+         }
+      }
+   }
+};
+
+SignalData::SignalData() : impl(new Impl())
+{
+}
+
+void SignalData::setMapper(const ValueMapper &mapper)
+{
+   impl->mapper = mapper;
+   impl->revision++;
+}
+
+void SignalData::append(const hw::SignalBuffer &buffer)
+{
+   impl->append(buffer);
+}
+
+void SignalData::limit(qint64 maximumBytes)
+{
+   impl->limit(maximumBytes);
+}
+
+void SignalData::clear()
+{
+   impl->clear();
+}
+
+bool SignalData::isEmpty() const
+{
+   return impl->segments.isEmpty();
+}
+
+qint64 SignalData::size() const
+{
+   return impl->samples;
+}
+
+qint64 SignalData::bytes() const
+{
+   return impl->memory;
+}
+
+quint64 SignalData::revision() const
+{
+   return impl->revision;
+}
+
+double SignalData::lowerKey() const
+{
+   return impl->segments.isEmpty() ? 0 : impl->segments.first().start;
+}
+
+double SignalData::upperKey() const
+{
+   return impl->segments.isEmpty() ? 0 : impl->segments.last().end();
+}
+
+QCPRange SignalData::keyRange(double from, double to) const
+{
+   return impl->keyRange(from, to);
+}
+
+QCPRange SignalData::valueRange(double from, double to) const
+{
+   return impl->valueRange(from, to);
+}
+
+double SignalData::maximum(double from, double to) const
+{
+   return impl->maximum(from, to);
+}
+
+void SignalData::envelope(double from, double to, int buckets, QVector<QCPGraphData> &points) const
+{
+   impl->envelope(from, to, buckets, points);
+}
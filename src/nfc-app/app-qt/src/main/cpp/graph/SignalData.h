@@ -0,0 +1,104 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef NFC_LAB_SIGNALDATA_H
+#define NFC_LAB_SIGNALDATA_H
+
+#include <functional>
+
+#include <QVector>
+#include <QSharedPointer>
+
+#include <3party/customplot/QCustomPlot.h>
+
+#include <hw/SignalBuffer.h>
+
+/*
+ * Compact sample storage for signal graphs. Values are kept as floats in chunked segments that carry the
+ * sample rate and first sample offset, so times of regular buffers are derived instead of stored. Adaptive
+ * buffers also keep the sample tick of each value, relative to the segment start.
+ *
+ * Each segment also keeps a sparse table with the maximum of each complete block of samples, updated on append,
+ * so the maximum over any time range is resolved with two table lookups plus the partial blocks at both ends.
+ *
+ * Graphs do not draw from this storage directly, they request a view of the visible range decimated to
+ * a minimum / maximum pair per pixel column, see ChannelGraph.
+ */
+class SignalData
+{
+      struct Impl;
+
+   public:
+
+      // maps stored values to plot values, must be monotonic non decreasing
+      typedef std::function<double(float value)> ValueMapper;
+
+      // maximum samples per segment
+      static constexpr int SEGMENT_SIZE = 1 << 20;
+
+   public:
+
+      SignalData();
+
+      void setMapper(const ValueMapper &mapper);
+
+      // append samples from regular or adaptive buffer, buffers must be appended in time order
+      void append(const hw::SignalBuffer &buffer);
+
+      // remove oldest segments until memory used is below limit, last segment is always kept
+      void limit(qint64 maximumBytes);
+
+      void clear();
+
+      bool isEmpty() const;
+
+      // number of stored samples
+      qint64 size() const;
+
+      // memory used by samples
+      qint64 bytes() const;
+
+      // incremented on every change
+      quint64 revision() const;
+
+      // time of first and last sample
+      double lowerKey() const;
+
+      double upperKey() const;
+
+      // time of first and last sample in time range, empty range if there are no samples
+      QCPRange keyRange(double from, double to) const;
+
+      // minimum and maximum plot value in time range, empty range if there are no samples
+      QCPRange valueRange(double from, double to) const;
+
+      // maximum plot value in time range, -infinity if there are no samples
+      double maximum(double from, double to) const;
+
+      // plot points for time range, decimated to minimum and maximum per bucket when there are more samples than buckets
+      void envelope(double from, double to, int buckets, QVector<QCPGraphData> &points) const;
+
+   private:
+
+      QSharedPointer<Impl> impl;
+};
+
+#endif //NFC_LAB_SIGNALDATA_H
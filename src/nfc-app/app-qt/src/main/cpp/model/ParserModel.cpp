@@ -19,6 +19,11 @@
 
 */
 
+#include <QCoreApplication>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+
 #include <lab/data/RawFrame.h>
 
 #include <protocol/ProtocolParser.h>
@@ -31,16 +36,29 @@ struct ParserModel::Impl
    // root node
    ProtocolFrame *root;
 
-   // protocol parser
+   // protocol parser, only used from parser thread so request / response pairs are resolved across batches
    ProtocolParser *parser;
 
+   // protocol parser for frames appended one by one, runs in model thread so it never waits for pending batches
+   ProtocolParser *frameParser;
+
+   // background parser, single thread to keep frames in order
+   QThreadPool parserPool;
+
+   // frame trees parsed in background waiting to be inserted in model thread, tagged with their generation
+   QMutex parsedMutex;
+   QList<QPair<int, QList<ProtocolFrame *>>> parsedQueue;
+
+   // incremented on reset to discard batches still in progress
+   int generation = 0;
+
    // fonts
    QFont defaultFont;
    QFont requestDefaultFont;
    QFont responseDefaultFont;
    QFont fieldFont;
 
-   Impl() : root(nullptr), parser(new ProtocolParser())
+   Impl() : root(nullptr), parser(new ProtocolParser()), frameParser(new ProtocolParser())
    {
       QVector<QVariant> rootData;
 
@@ -57,14 +75,67 @@ struct ParserModel::Impl
 
       // frame fields font
       fieldFont.setItalic(true);
+
+      // parse batches sequentially
+      parserPool.setMaxThreadCount(1);
    }
 
    ~Impl()
    {
+      parserPool.waitForDone();
+
+      for (auto &batch: parsedQueue)
+         qDeleteAll(batch.second);
+
       delete parser;
+      delete frameParser;
       delete root;
    }
 
+   /*
+    * Insert parsed batches in model order, discarding batches queued before last reset
+    */
+   static void insertParsed(ParserModel *model)
+   {
+      QList<QPair<int, QList<ProtocolFrame *>>> batches;
+
+      {
+         QMutexLocker lock(&model->impl->parsedMutex);
+
+         batches.swap(model->impl->parsedQueue);
+      }
+
+      for (auto &batch: batches)
+      {
+         if (batch.first != model->impl->generation || batch.second.isEmpty())
+         {
+            qDeleteAll(batch.second);
+            continue;
+         }
+
+         int row = model->impl->root->childCount();
+
+         model->beginInsertRows(QModelIndex(), row, row + batch.second.count() - 1);
+
+         for (ProtocolFrame *child: batch.second)
+            model->impl->root->appendChild(child);
+
+         model->endInsertRows();
+      }
+   }
+
+   /*
+    * Move frame tree created by background parser to target thread, only top level objects can be moved
+    */
+   static void moveToThread(ProtocolFrame *frame, QThread *thread)
+   {
+      if (!frame->QObject::parent())
+         frame->moveToThread(thread);
+
+      for (int i = 0; i < frame->childCount(); i++)
+         moveToThread(frame->child(i), thread);
+   }
+
    QString toString(const QByteArray &value) const
    {
       QString text;
@@ -284,19 +355,89 @@ void ParserModel::resetModel()
 {
    beginResetModel();
    impl->root->clearChilds();
+   impl->generation++;
    endResetModel();
 }
 
 void ParserModel::append(const lab::RawFrame &frame)
 {
-   if (auto child = impl->parser->parse(frame))
+   auto child = impl->frameParser->parse(frame);
+
+   // batches already parsed go first, batches still in progress are inserted when finished
+   Impl::insertParsed(this);
+
+   if (child)
    {
-      beginInsertRows(QModelIndex(), 0, 0);
+      int row = impl->root->childCount();
+
+      beginInsertRows(QModelIndex(), row, row);
       impl->root->appendChild(child);
       endInsertRows();
    }
 }
 
+void ParserModel::append(const lab::IsoDepAssembler &assembler, const lab::ApduExchange &exchange)
+{
+   // parsed in model thread, so assembler is not modified while in use
+   auto child = impl->frameParser->parse(assembler, exchange);
+
+   Impl::insertParsed(this);
+
+   int count = impl->root->childCount();
+
+   if (count == 0)
+   {
+      delete child;
+      return;
+   }
+
+   if (child)
+   {
+      ProtocolFrame *parent = impl->root->child(count - 1);
+
+      int row = parent->childCount();
+
+      beginInsertRows(index(count - 1, 0), row, row);
+      parent->appendChild(child);
+      endInsertRows();
+   }
+}
+
+void ParserModel::append(const QList<lab::RawFrame> &frames)
+{
+   QPointer<ParserModel> model(this);
+   QThread *target = thread();
+   Impl *d = impl.data();
+   int generation = impl->generation;
+
+   // pool is drained before impl is destroyed, so parser thread can safely use it
+   impl->parserPool.start([=] {
+      QList<ProtocolFrame *> parsed;
+
+      for (const lab::RawFrame &frame: frames)
+      {
+         if (auto child = d->parser->parse(frame))
+         {
+            Impl::moveToThread(child, target);
+
+            parsed.append(child);
+         }
+      }
+
+      {
+         QMutexLocker lock(&d->parsedMutex);
+
+         d->parsedQueue.append({generation, parsed});
+      }
+
+      // insert in model thread, queued batches are released with impl if model is gone
+      QMetaObject::invokeMethod(QCoreApplication::instance(), [=] {
+         if (model)
+            Impl::insertParsed(model);
+      }, Qt::QueuedConnection);
+   });
+}
+
 ProtocolFrame *ParserModel::entry(const QModelIndex &index) const
 {
    if (!index.isValid())
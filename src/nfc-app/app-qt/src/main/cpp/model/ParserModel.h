@@ -38,6 +38,8 @@
 
 namespace lab {
 class RawFrame;
+class IsoDepAssembler;
+struct ApduExchange;
 }
 
 class ParserModel : public QAbstractItemModel
@@ -77,8 +79,15 @@ class ParserModel : public QAbstractItemModel
 
       void resetModel();
 
+      // parse frame in model thread, never waits for background batches
       void append(const lab::RawFrame &frame);
 
+      // attach reassembled ISO-DEP exchange to last frame in model
+      void append(const lab::IsoDepAssembler &assembler, const lab::ApduExchange &exchange);
+
+      // parse frames in background and insert all of them at once when finished
+      void append(const QList<lab::RawFrame> &frames);
+
       ProtocolFrame *entry(const QModelIndex &index) const;
 
    signals:
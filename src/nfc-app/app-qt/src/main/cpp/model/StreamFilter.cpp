@@ -23,8 +23,15 @@
 #include <QHash>
 #include <QItemSelection>
 #include <QRegularExpression>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
 #include <utility>
 
+#include <lab/data/RawFrame.h>
+#include <lab/data/IsoDepAssembler.h>
+
 #include "StreamModel.h"
 #include "StreamFilter.h"
 
@@ -36,6 +43,22 @@ struct StreamFilter::Impl
 
    QHash<int, int> rowsAccepted;
 
+   // sort keys for each column indexed by source row, filled on demand up to current row count
+   QVector<QVector<qint64>> sortKeys = QVector<QVector<qint64>>(StreamModel::Data + 1);
+
+   // interned event names, key for event column is the rank of the name in ascending order
+   QHash<QString, int> eventIds;
+
+   QVector<QString> eventNames;
+
+   QVector<qint64> eventRanks;
+
+   // source model connections for key invalidation
+   QList<QMetaObject::Connection> sourceConnections;
+
+   // empty cells sort after any value, as default proxy compare does
+   static constexpr qint64 EmptyKey = std::numeric_limits<qint64>::max();
+
    static QHash<QMetaType, int> numericTypes;
 
    static bool greater(const QVariant &threshold, const QVariant &value)
@@ -78,6 +101,20 @@ struct StreamFilter::Impl
       return false;
    }
 
+   // search bytes in reassembled command and response, matches APDUs split across chained blocks
+   static bool contains(const QVariant &filter, const lab::IsoDepAssembler &assembler, const lab::ApduExchange *exchange)
+   {
+      if (!exchange || filter.userType() != QMetaType::QByteArray)
+         return false;
+
+      QByteArray bytes = filter.toByteArray();
+
+      const auto data = reinterpret_cast<const char *>(assembler.data().data());
+
+      return QByteArray::fromRawData(data + exchange->commandOffset, exchange->commandLength).contains(bytes) ||
+             QByteArray::fromRawData(data + exchange->responseOffset, exchange->responseLength).contains(bytes);
+   }
+
    static int compare(const QVariant &v1, const QVariant &v2)
    {
       if (!v1.isValid() && v2.isValid())
@@ -137,12 +174,174 @@ struct StreamFilter::Impl
    {
       rowsAccepted.clear();
    }
+
+   void clearKeys(int first = 0)
+   {
+      for (QVector<qint64> &keys: sortKeys)
+      {
+         if (keys.size() > first)
+            keys.resize(first);
+      }
+   }
+
+   const QVector<qint64> &columnKeys(const StreamModel *model, int column)
+   {
+      QVector<qint64> &keys = sortKeys[column];
+
+      int rows = model->rowCount();
+
+      if (keys.size() >= rows)
+         return keys;
+
+      keys.reserve(rows);
+
+      for (int row = keys.size(); row < rows; row++)
+      {
+         QModelIndex index = model->index(row, column);
+
+         const lab::RawFrame *frame = model->frame(index);
+         const lab::RawFrame *prev = row > 0 ? model->frame(model->index(row - 1, column)) : nullptr;
+
+         switch (column)
+         {
+            case StreamModel::Time:
+               keys.append(timeKey(model->timeSource() == StreamModel::DateTime ? frame->dateTime() : frame->timeStart()));
+               break;
+
+            case StreamModel::Delta:
+               keys.append(prev && *prev ? timeKey(frame->timeStart() - prev->timeStart()) : EmptyKey);
+               break;
+
+            case StreamModel::Rate:
+               keys.append(index.data().isValid() ? frame->frameRate() : EmptyKey);
+               break;
+
+            case StreamModel::Tech:
+               keys.append(techKey(frame->techType()));
+               break;
+
+            case StreamModel::Event:
+               keys.append(eventId(index.data().toString()));
+               break;
+
+            default:
+               keys.append(row);
+         }
+      }
+
+      // rank event names again when new ones are found, names are kept as they repeat between captures
+      if (column == StreamModel::Event && eventRanks.size() != eventNames.size())
+         rankEvents();
+
+      return keys;
+   }
+
+   int eventId(const QString &name)
+   {
+      auto it = eventIds.constFind(name);
+
+      if (it != eventIds.constEnd())
+         return it.value();
+
+      eventIds.insert(name, eventNames.size());
+      eventNames.append(name);
+
+      return eventNames.size() - 1;
+   }
+
+   void rankEvents()
+   {
+      QVector<int> order(eventNames.size());
+
+      std::iota(order.begin(), order.end(), 0);
+
+      std::sort(order.begin(), order.end(), [this](int a, int b) {
+         return eventNames[a].compare(eventNames[b]) < 0;
+      });
+
+      eventRanks.resize(eventNames.size());
+
+      for (int rank = 0; rank < order.size(); rank++)
+         eventRanks[order[rank]] = eventNames[order[rank]].isEmpty() ? EmptyKey : rank;
+   }
+
+   static qint64 timeKey(double time)
+   {
+      // nanosecond resolution, enough for any sample rate in use
+      return std::llround(time * 1E9);
+   }
+
+   static qint64 techKey(unsigned int techType)
+   {
+      // same order as technology names shown in the model
+      switch (techType)
+      {
+         case lab::FrameTech::Iso7816Tech:
+            return 0;
+
+         case lab::FrameTech::NfcATech:
+            return 1;
+
+         case lab::FrameTech::NfcBTech:
+            return 2;
+
+         case lab::FrameTech::NfcFTech:
+            return 3;
+
+         case lab::FrameTech::NfcVTech:
+            return 4;
+      }
+
+      return EmptyKey;
+   }
 };
 
 StreamFilter::StreamFilter(QObject *parent) : QSortFilterProxyModel(parent), impl(new Impl)
 {
 }
 
+void StreamFilter::setSourceModel(QAbstractItemModel *model)
+{
+   for (const QMetaObject::Connection &connection: impl->sourceConnections)
+      disconnect(connection);
+
+   impl->sourceConnections.clear();
+   impl->clearKeys();
+
+   // keys must be dropped before the proxy maps new rows, so connect to the "about to" signals where possible
+   if (model)
+   {
+      impl->sourceConnections << connect(model, &QAbstractItemModel::rowsAboutToBeInserted, this, [=](const QModelIndex &, int first, int) {
+         impl->clearKeys(first);
+      });
+
+      impl->sourceConnections << connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, [=](const QModelIndex &, int first, int) {
+         impl->clearKeys(first);
+      });
+
+      impl->sourceConnections << connect(model, &QAbstractItemModel::modelAboutToBeReset, this, [=]() {
+         impl->clearKeys();
+      });
+
+      impl->sourceConnections << connect(model, &QAbstractItemModel::layoutAboutToBeChanged, this, [=]() {
+         impl->clearKeys();
+      });
+
+      impl->sourceConnections << connect(model, &QAbstractItemModel::dataChanged, this, [=](const QModelIndex &topLeft) {
+         impl->clearKeys(topLeft.row());
+      });
+
+      if (auto streamModel = qobject_cast<StreamModel *>(model))
+      {
+         impl->sourceConnections << connect(streamModel, &StreamModel::modelChanged, this, [=]() {
+            impl->clearKeys();
+         });
+      }
+   }
+
+   QSortFilterProxyModel::setSourceModel(model);
+}
+
 QVariant StreamFilter::headerData(int section, Qt::Orientation orientation, int role) const
 {
    if (role != Qt::UserRole + 1)
@@ -163,6 +362,8 @@ bool StreamFilter::filterAcceptsRow(int row, const QModelIndex &sourceParent) co
    // by default accept all rows
    bool rowAccepted = true;
 
+   const auto streamModel = qobject_cast<const StreamModel *>(sourceModel());
+
    // check column filters
    for (int column = 0; column < sourceModel()->columnCount(sourceParent); column++)
    {
@@ -200,7 +401,7 @@ bool StreamFilter::filterAcceptsRow(int row, const QModelIndex &sourceParent) co
                break;
 
             case Bytes:
-               columnAccepted &= Impl::contains(filter.value, value);
+               columnAccepted &= Impl::contains(filter.value, value) || (column == StreamModel::Data && streamModel && Impl::contains(filter.value, streamModel->assembler(), streamModel->exchange(index)));
                break;
 
             case List:
@@ -218,6 +419,32 @@ bool StreamFilter::filterAcceptsRow(int row, const QModelIndex &sourceParent) co
    return rowAccepted;
 }
 
+bool StreamFilter::lessThan(const QModelIndex &sourceLeft, const QModelIndex &sourceRight) const
+{
+   // frame sequence is the source row
+   if (sourceLeft.column() == StreamModel::Id)
+      return sourceLeft.row() < sourceRight.row();
+
+   const auto streamModel = qobject_cast<const StreamModel *>(sourceModel());
+
+   if (!streamModel || sourceLeft.column() < StreamModel::Time || sourceLeft.column() > StreamModel::Event)
+      return QSortFilterProxyModel::lessThan(sourceLeft, sourceRight);
+
+   // compare precomputed keys instead of formatted cell values
+   const QVector<qint64> &keys = impl->columnKeys(streamModel, sourceLeft.column());
+
+   qint64 left = keys[sourceLeft.row()];
+   qint64 right = keys[sourceRight.row()];
+
+   if (sourceLeft.column() == StreamModel::Event)
+   {
+      left = impl->eventRanks[left];
+      right = impl->eventRanks[right];
+   }
+
+   return left < right;
+}
+
 bool StreamFilter::isEnabled()
 {
    return impl->enabled;
@@ -322,5 +549,15 @@ const lab::RawFrame *StreamFilter::frame(const QModelIndex &index) const
    return {};
 }
 
+const lab::ApduExchange *StreamFilter::exchange(const QModelIndex &index) const
+{
+   if (const auto streamModel = dynamic_cast<StreamModel *>(sourceModel()))
+   {
+      return streamModel->exchange(mapToSource(index));
+   }
+
+   return {};
+}
+
 
 
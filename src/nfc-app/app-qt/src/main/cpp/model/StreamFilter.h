@@ -27,6 +27,7 @@
 
 namespace lab {
 class RawFrame;
+struct ApduExchange;
 }
 
 class StreamFilter : public QSortFilterProxyModel
@@ -52,6 +53,8 @@ class StreamFilter : public QSortFilterProxyModel
 
       explicit StreamFilter(QObject *parent = nullptr);
 
+      void setSourceModel(QAbstractItemModel *sourceModel) override;
+
       QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
 
       bool isEnabled();
@@ -80,10 +83,15 @@ class StreamFilter : public QSortFilterProxyModel
 
       const lab::RawFrame *frame(const QModelIndex &index) const;
 
+      // reassembled ISO-DEP exchange that contains the frame, nullptr if none
+      const lab::ApduExchange *exchange(const QModelIndex &index) const;
+
    protected:
 
       bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
 
+      bool lessThan(const QModelIndex &sourceLeft, const QModelIndex &sourceRight) const override;
+
    private:
 
       QSharedPointer<Impl> impl;
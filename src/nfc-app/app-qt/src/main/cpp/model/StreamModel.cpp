@@ -28,6 +28,7 @@
 #include <QReadLocker>
 
 #include <lab/data/RawFrame.h>
+#include <lab/data/IsoDepAssembler.h>
 
 #include "StreamModel.h"
 
@@ -144,6 +145,15 @@ struct StreamModel::Impl
    // frame stream
    QQueue<lab::RawFrame> stream;
 
+   // maximum frames inserted on each fetch, 0 for no limit
+   int fetchLimit = 0;
+
+   // longest frame data in model
+   int maxDataLength = 0;
+
+   // ISO-DEP exchanges over all frames in model, frame references are model rows
+   lab::IsoDepAssembler assembler;
+
    // stream lock
    QReadWriteLock lock;
 
@@ -265,6 +275,7 @@ struct StreamModel::Impl
    {
       if (frame.frameType() == lab::FrameType::NfcCarrierOn ||
          frame.frameType() == lab::FrameType::NfcCarrierOff ||
+         frame.frameType() == lab::FrameType::NfcCarrierTrain ||
          frame.frameType() == lab::FrameType::IsoVccLow ||
          frame.frameType() == lab::FrameType::IsoVccHigh ||
          frame.frameType() == lab::FrameType::IsoRstLow ||
@@ -304,6 +315,9 @@ struct StreamModel::Impl
          case lab::FrameType::NfcCarrierOff:
             return {"RF-Off"};
 
+         case lab::FrameType::NfcCarrierTrain:
+            return {"RF-Pulses"};
+
          case lab::FrameType::IsoVccLow:
             return {"VCC-Low"};
 
@@ -378,6 +392,9 @@ struct StreamModel::Impl
       if (frame.frameType() == lab::FrameType::NfcCarrierOff)
          flags.append("carrier-off");
 
+      if (frame.frameType() == lab::FrameType::NfcCarrierTrain)
+         flags.append("carrier-train");
+
       if (frame.hasFrameFlags(lab::FrameFlags::Encrypted))
          flags.append("encrypted");
 
@@ -731,26 +748,64 @@ void StreamModel::fetchMore(const QModelIndex &parent)
 {
    QReadLocker locker(&impl->lock);
 
-   beginInsertRows(QModelIndex(), impl->frames.size(), impl->frames.size() + impl->stream.size() - 1);
+   int count = impl->fetchLimit > 0 ? std::min(impl->fetchLimit, static_cast<int>(impl->stream.size())) : impl->stream.size();
 
-   while (!impl->stream.isEmpty())
+   QList<lab::RawFrame> batch;
+
+   while (count-- > 0)
    {
       lab::RawFrame frame = impl->stream.dequeue();
 
-      // find insertion point
-      auto it = std::lower_bound(impl->frames.begin(), impl->frames.end(), frame);
+      if (static_cast<int>(frame.limit()) > impl->maxDataLength)
+         impl->maxDataLength = static_cast<int>(frame.limit());
 
-      // insert frame sorted by time
-      impl->frames.insert(it - impl->frames.begin(), frame);
+      batch.append(frame);
    }
 
-   endInsertRows();
+   if (batch.isEmpty())
+      return;
+
+   // frames from different sources may arrive out of order, sorted batch is inserted in a few contiguous row ranges
+   std::stable_sort(batch.begin(), batch.end());
+
+   // exchanges before first insertion row are not affected, following ones are rebuilt after insertion
+   int first = static_cast<int>(std::lower_bound(impl->frames.begin(), impl->frames.end(), batch.first()) - impl->frames.begin());
+
+   int resume = first < impl->frames.size() ? static_cast<int>(impl->assembler.rewind(first)) : first;
+
+   for (auto next = batch.begin(); next != batch.end();)
+   {
+      // find insertion point
+      auto it = std::lower_bound(impl->frames.begin(), impl->frames.end(), *next);
+
+      int row = static_cast<int>(it - impl->frames.begin());
+
+      // following frames in batch go to the same row, up to next existing frame
+      auto last = it != impl->frames.end() ? std::upper_bound(next, batch.end(), *it) : batch.end();
+
+      // notify real rows, so views and proxies map them correctly
+      beginInsertRows(QModelIndex(), row, row + static_cast<int>(last - next) - 1);
+
+      while (next != last)
+         impl->frames.insert(row++, *next++);
+
+      // exchanges are completed before views are notified about last range
+      if (next == batch.end())
+      {
+         for (int index = resume; index < impl->frames.size(); index++)
+            impl->assembler.process(impl->frames.at(index), index);
+      }
+
+      endInsertRows();
+   }
 }
 
 void StreamModel::resetModel()
 {
    beginResetModel();
    impl->frames.clear();
+   impl->maxDataLength = 0;
+   impl->assembler.reset();
    endResetModel();
 }
 
@@ -786,6 +841,34 @@ const lab::RawFrame *StreamModel::frame(const QModelIndex &index) const
    return static_cast<lab::RawFrame *>(index.internalPointer());
 }
 
+const lab::IsoDepAssembler &StreamModel::assembler() const
+{
+   return impl->assembler;
+}
+
+const lab::ApduExchange *StreamModel::exchange(const QModelIndex &index) const
+{
+   if (!index.isValid())
+      return nullptr;
+
+   return impl->assembler.find(index.row());
+}
+
+int StreamModel::fetchLimit() const
+{
+   return impl->fetchLimit;
+}
+
+void StreamModel::setFetchLimit(int frames)
+{
+   impl->fetchLimit = frames;
+}
+
+int StreamModel::maxDataLength() const
+{
+   return impl->maxDataLength;
+}
+
 int StreamModel::timeSource() const
 {
    return impl->timeSource;
@@ -36,6 +36,8 @@
 
 namespace lab {
 class RawFrame;
+class IsoDepAssembler;
+struct ApduExchange;
 }
 
 
@@ -83,12 +85,24 @@ class StreamModel : public QAbstractTableModel
 
       void append(const lab::RawFrame &frame);
 
+      int fetchLimit() const;
+
+      void setFetchLimit(int frames);
+
+      int maxDataLength() const;
+
       int timeSource() const;
 
       void setTimeSource(TimeSource timeSource);
 
       const lab::RawFrame *frame(const QModelIndex &index) const;
 
+      // ISO-DEP exchanges reassembled over all frames in model, frame references are model rows
+      const lab::IsoDepAssembler &assembler() const;
+
+      // completed exchange that contains the frame, nullptr if none
+      const lab::ApduExchange *exchange(const QModelIndex &index) const;
+
    signals:
 
       void modelChanged();
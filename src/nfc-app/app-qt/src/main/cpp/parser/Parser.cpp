@@ -19,8 +19,77 @@
 
 */
 
+#include <algorithm>
+
 #include <parser/Parser.h>
 
+void Parser::reset()
+{
+   dissector.reset();
+}
+
+ProtocolFrame *Parser::parse(const lab::RawFrame &frame)
+{
+   // carrier and unsupported frames has no tree
+   if (!dissector.dissect(frame, nodes))
+      return nullptr;
+
+   const Node &root = nodes.front();
+
+   int flags = 0;
+
+   // frame type bits, request / response flags are taken from frame type
+   flags |= root.flags & lab::FrameDissector::SenseFrame ? ProtocolFrame::SenseFrame : 0;
+   flags |= root.flags & lab::FrameDissector::SelectionFrame ? ProtocolFrame::SelectionFrame : 0;
+   flags |= root.flags & lab::FrameDissector::ApplicationFrame ? ProtocolFrame::ApplicationFrame : 0;
+   flags |= root.flags & lab::FrameDissector::AuthFrame ? ProtocolFrame::AuthFrame : 0;
+
+   // last node seen at each depth, dissector trees are never deeper than root plus two levels
+   ProtocolFrame *path[4] = {buildRootInfo(buildRootName(root, frame), frame, flags)};
+
+   for (unsigned int i = 1; i < nodes.size(); i++)
+   {
+      const Node &node = nodes[i];
+
+      if (node.depth >= 4 || !path[node.depth - 1])
+         continue;
+
+      // fields without presentation of their own are flattened, children are shown under their parent
+      if ((path[node.depth] = buildField(root, node, frame)))
+         path[node.depth - 1]->appendChild(path[node.depth]);
+      else
+         path[node.depth] = path[node.depth - 1];
+   }
+
+   return path[0];
+}
+
+QString Parser::buildRootName(const Node &root, const lab::RawFrame &frame)
+{
+   return lab::FrameDissector::name(root.field);
+}
+
+ProtocolFrame *Parser::buildField(const Node &root, const Node &node, const lab::RawFrame &frame)
+{
+   switch (node.field)
+   {
+      // values derived from frame bits or counters are shown as numbers
+      case lab::FrameDissector::NVB:
+      case lab::FrameDissector::CID:
+      case lab::FrameDissector::MBLI:
+      case lab::FrameDissector::TL:
+         return buildChildInfo(lab::FrameDissector::name(node.field), node.value, node.offset, node.length);
+
+      default:
+         return buildChildInfo(lab::FrameDissector::name(node.field), frame, node.offset, node.length);
+   }
+}
+
+ProtocolFrame *Parser::buildByteInfo(const QString &name, unsigned int value, int bits, int start, int length)
+{
+   return buildChildInfo(name, QString("%1 [%2]").arg(value, bits / 4, 16, QChar('0')).arg(value, bits, 2, QChar('0')), start, length);
+}
+
 ProtocolFrame *Parser::buildRootInfo(const QString &name, const lab::RawFrame &frame, int flags)
 {
    QVector<QVariant> values;
@@ -82,27 +151,13 @@ ProtocolFrame *Parser::buildChildInfo(const QString &name, const QVariant &info,
 
 QByteArray Parser::toByteArray(const lab::RawFrame &frame, int from, int length)
 {
-   QByteArray data;
-
-   if (length > frame.limit())
-      length = frame.limit();
+   int limit = static_cast<int>(frame.limit());
 
-   if (from >= 0)
-   {
-      for (int i = from; i < frame.limit() && length > 0; i++, length--)
-      {
-         data.append(frame[i]);
-      }
-   }
-   else
-   {
-      for (int i = frame.limit() + from; i < frame.limit() && length > 0; i++, length--)
-      {
-         data.append(frame[i]);
-      }
-   }
+   // negative offset is relative to frame end
+   int start = std::max(0, from >= 0 ? from : limit + from);
+   int count = std::max(0, std::min(length, limit - start));
 
-   return data;
+   return {reinterpret_cast<const char *>(frame.data()) + start, count};
 }
 
 QString Parser::toString(const QByteArray &array)
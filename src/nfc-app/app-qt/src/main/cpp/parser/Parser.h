@@ -22,14 +22,37 @@
 #ifndef NFC_LAB_PARSER_H
 #define NFC_LAB_PARSER_H
 
+#include <vector>
+
 #include <lab/data/RawFrame.h>
+#include <lab/data/FrameDissector.h>
 
 #include <protocol/ProtocolFrame.h>
 
+/*
+ * Presentation adapter over lab::FrameDissector, frame structure comes from the dissector and each
+ * technology only overrides buildRootName / buildField to decorate nodes with human readable details
+ */
 struct Parser
 {
+  typedef lab::FrameDissector::Node Node;
+
+  lab::FrameDissector dissector;
+
+  std::vector<Node> nodes;
+
   virtual ~Parser() = default;
 
+  virtual void reset();
+
+  virtual ProtocolFrame *parse(const lab::RawFrame &frame);
+
+  virtual QString buildRootName(const Node &root, const lab::RawFrame &frame);
+
+  virtual ProtocolFrame *buildField(const Node &root, const Node &node, const lab::RawFrame &frame);
+
+  ProtocolFrame *buildByteInfo(const QString &name, unsigned int value, int bits, int start, int length);
+
   ProtocolFrame *buildRootInfo(const QString &name, const lab::RawFrame &frame, int flags);
 
   ProtocolFrame *buildChildInfo(const QVariant &info);
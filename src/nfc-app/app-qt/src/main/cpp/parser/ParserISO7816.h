@@ -30,25 +30,20 @@
 
 struct ParserISO7816 : Parser
 {
-   void reset();
+   // interface bytes group index while walking ATR fields
+   unsigned int atrGroup = 0;
 
-   virtual ProtocolFrame *parse(const lab::RawFrame &frame);
+   QString buildRootName(const Node &root, const lab::RawFrame &frame) override;
 
-   ProtocolFrame *parseVCC(const lab::RawFrame &frame);
+   ProtocolFrame *buildField(const Node &root, const Node &node, const lab::RawFrame &frame) override;
 
-   ProtocolFrame *parseRST(const lab::RawFrame &frame);
+   ProtocolFrame *buildATRField(const Node &node);
 
-   ProtocolFrame *parseATR(const lab::RawFrame &frame);
+   ProtocolFrame *buildPPSField(const Node &node, const lab::RawFrame &frame);
 
-   ProtocolFrame *parsePPS(const lab::RawFrame &frame);
+   ProtocolFrame *buildBlockControl(const Node &root, const Node &node);
 
-   ProtocolFrame *parseTPDU(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseIBlock(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRBlock(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseSBlock(const lab::RawFrame &frame);
+   ProtocolFrame *buildBlockInfo(const Node &root, const Node &node, const lab::RawFrame &frame);
 };
 
 #endif
@@ -23,6 +23,7 @@
 #define NFC_LAB_PARSERNFC_H
 
 #include <lab/data/RawFrame.h>
+#include <lab/data/IsoDepAssembler.h>
 
 #include <protocol/ProtocolFrame.h>
 
@@ -30,37 +31,17 @@
 
 struct ParserNfc : Parser
 {
-   enum Caps
-   {
-      IS_APDU = 1
-   };
-
-   unsigned int lastCommand = 0;
-
-   virtual void reset();
-
-   virtual ProtocolFrame *parse(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestUnknown(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseUnknown(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseAPDU(const QString &name, const lab::RawFrame &frame, int start, int length);
-
-   bool isApdu(const QByteArray &apdu);
+   QString buildRootName(const Node &root, const lab::RawFrame &frame) override;
 };
 
 struct ParserNfcIsoDep : ParserNfc
 {
-   void reset() override;
-
-   ProtocolFrame *parse(const lab::RawFrame &frame) override;
-
-   ProtocolFrame *parseIBlock(const lab::RawFrame &frame);
+   ProtocolFrame *buildField(const Node &root, const Node &node, const lab::RawFrame &frame) override;
 
-   ProtocolFrame *parseRBlock(const lab::RawFrame &frame);
+   ProtocolFrame *buildBlockControl(const Node &root, const Node &node, const lab::RawFrame &frame);
 
-   ProtocolFrame *parseSBlock(const lab::RawFrame &frame);
+   // exchange reassembled over the whole frame stream
+   ProtocolFrame *parseExchange(const lab::IsoDepAssembler &assembler, const lab::ApduExchange &exchange);
 };
 
 #endif //NFC_LAB_PARSERNFC_H
@@ -26,43 +26,19 @@
 
 struct ParserNfcA : ParserNfcIsoDep
 {
-   unsigned int frameChain = 0;
+   ProtocolFrame *buildField(const Node &root, const Node &node, const lab::RawFrame &frame) override;
 
-   void reset() override;
+   ProtocolFrame *buildATQA(const Node &node);
 
-   ProtocolFrame *parse(const lab::RawFrame &frame) override;
+   ProtocolFrame *buildSAK(const Node &node);
 
-   ProtocolFrame *parseRequestREQA(const lab::RawFrame &frame);
+   ProtocolFrame *buildRATSParam(const Node &node);
 
-   ProtocolFrame *parseResponseREQA(const lab::RawFrame &frame);
+   ProtocolFrame *buildATSField(const Node &node);
 
-   ProtocolFrame *parseRequestWUPA(const lab::RawFrame &frame);
+   ProtocolFrame *buildPPS1(const Node &node);
 
-   ProtocolFrame *parseResponseWUPA(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestSELn(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseSELn(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestRATS(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseRATS(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestHLTA(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseHLTA(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestPPSr(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponsePPSr(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestAUTH(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseAUTH(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestVASUP(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseVASUP(const lab::RawFrame &frame);
+   ProtocolFrame *buildVASUPData(const Node &node, const lab::RawFrame &frame);
 };
 
 
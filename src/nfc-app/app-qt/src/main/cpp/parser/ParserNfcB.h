@@ -26,45 +26,17 @@
 
 struct ParserNfcB : ParserNfcIsoDep
 {
-   void reset() override;
+   ProtocolFrame *buildField(const Node &root, const Node &node, const lab::RawFrame &frame) override;
 
-   ProtocolFrame *parse(const lab::RawFrame &frame) override;
+   ProtocolFrame *buildApplicationFamily(const Node &node, const lab::RawFrame &frame);
 
-   ProtocolFrame *parseRequestREQB(const lab::RawFrame &frame);
+   ProtocolFrame *buildREQBParam(const Node &node, const lab::RawFrame &frame);
 
-   ProtocolFrame *parseResponseREQB(const lab::RawFrame &frame);
+   ProtocolFrame *buildProtocolInfo(const Node &node, const lab::RawFrame &frame);
 
-   ProtocolFrame *parseRequestINIT(const lab::RawFrame &frame);
+   ProtocolFrame *buildATTRIBParam(const Node &node, const lab::RawFrame &frame);
 
-   ProtocolFrame *parseResponseINIT(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestREAD(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseREAD(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestWRITE(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseWRITE(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestGETUID(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseGETUID(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestSELECT(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseSELECT(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestATTRIB(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseATTRIB(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestHLTB(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseHLTB(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestVASUP(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseVASUP(const lab::RawFrame &frame);
+   ProtocolFrame *buildVASUPData(const Node &node, const lab::RawFrame &frame);
 };
 
 
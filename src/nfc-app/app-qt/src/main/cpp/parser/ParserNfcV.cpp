@@ -19,982 +19,41 @@
 
 */
 
-#include <lab/nfc/Nfc.h>
-
 #include <parser/ParserNfcV.h>
 
-void ParserNfcV::reset()
-{
-   ParserNfc::reset();
-}
-
-ProtocolFrame *ParserNfcV::parse(const lab::RawFrame &frame)
-{
-   ProtocolFrame *info = nullptr;
-
-   if (frame.frameType() == lab::FrameType::NfcPollFrame)
-   {
-      do
-      {
-         // Inventory Command
-         if ((info = parseRequestInventory(frame)))
-            break;
-
-         // Stay quiet command
-         if ((info = parseRequestStayQuiet(frame)))
-            break;
-
-         // Read single block
-         if ((info = parseRequestReadSingle(frame)))
-            break;
-
-         // Write single block
-         if ((info = parseRequestWriteSingle(frame)))
-            break;
-
-         // Lock block
-         if ((info = parseRequestLockBlock(frame)))
-            break;
-
-         // Read multiple blocks
-         if ((info = parseRequestReadMultiple(frame)))
-            break;
-
-         // Write multiple blocks
-         if ((info = parseRequestWriteMultiple(frame)))
-            break;
-
-         // Select
-         if ((info = parseRequestSelect(frame)))
-            break;
-
-         // Reset to Ready
-         if ((info = parseRequestResetReady(frame)))
-            break;
-
-         // Write AFI
-         if ((info = parseRequestWriteAFI(frame)))
-            break;
-
-         // Lock AFI
-         if ((info = parseRequestLockAFI(frame)))
-            break;
-
-         // Write DSFID
-         if ((info = parseRequestWriteDSFID(frame)))
-            break;
-
-         // Lock DSFID
-         if ((info = parseRequestLockDSFID(frame)))
-            break;
-
-         // System Information
-         if ((info = parseRequestSysInfo(frame)))
-            break;
-
-         // Get multiple block security status
-         if ((info = parseRequestGetSecurity(frame)))
-            break;
-
-         // generic NFC-V request frame...
-         info = parseRequestGeneric(frame);
-
-      } while (false);
-   }
-   else
-   {
-      do
-      {
-         // Inventory response
-         if ((info = parseResponseInventory(frame)))
-            break;
-
-         // Read single block
-         if ((info = parseResponseReadSingle(frame)))
-            break;
-
-         // Write single block
-         if ((info = parseResponseWriteSingle(frame)))
-            break;
-
-         // Lock block
-         if ((info = parseResponseLockBlock(frame)))
-            break;
-
-         // Read multiple blocks
-         if ((info = parseResponseReadMultiple(frame)))
-            break;
-
-         // Write multiple blocks
-         if ((info = parseResponseWriteMultiple(frame)))
-            break;
-
-         // Select
-         if ((info = parseResponseSelect(frame)))
-            break;
-
-         // Reset to Ready
-         if ((info = parseResponseResetReady(frame)))
-            break;
-
-         // Write AFI
-         if ((info = parseResponseWriteAFI(frame)))
-            break;
-
-         // Lock AFI
-         if ((info = parseResponseLockAFI(frame)))
-            break;
-
-         // Write DSFID
-         if ((info = parseResponseWriteDSFID(frame)))
-            break;
-
-         // Lock DSFID
-         if ((info = parseResponseLockDSFID(frame)))
-            break;
-
-         // System Information
-         if ((info = parseResponseSysInfo(frame)))
-            break;
-
-         // Get multiple block security status
-         if ((info = parseResponseGetSecurity(frame)))
-            break;
-
-         // generic NFC-V response frame...
-         info = parseResponseGeneric(frame);
-
-      } while (false);
-
-      lastCommand = 0;
-   }
-
-   return info;
-}
-
-/*
- * Inventory
- * Command code = 0x01
- * When receiving the Inventory request, the VICC shall perform the anticollision sequence
- */
-ProtocolFrame *ParserNfcV::parseRequestInventory(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x01)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   int offset = 2;
-
-   ProtocolFrame *root = buildRootInfo("Inventory", frame, ProtocolFrame::SelectionFrame);
-
-   // parse request flags
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-
-   // if AFI flag is set parse family
-   if ((frame[0] & 0x14) == 0x14)
-      root->appendChild(buildApplicationFamily(frame, offset++));
-
-   root->appendChild(buildChildInfo("MLEN", frame, offset, 1));
-
-   int mlen = frame[offset++];
-
-   if (mlen > 0)
-      root->appendChild(buildChildInfo("MASK", frame, offset, (mlen & 0x7) ? 1 + (mlen >> 3) : (mlen >> 3)));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * Inventory response
- */
-ProtocolFrame *ParserNfcV::parseResponseInventory(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x01)
-      return nullptr;
-
-   ProtocolFrame *root = buildRootInfo("", frame, ProtocolFrame::SenseFrame);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-   root->appendChild(buildChildInfo("DSFID", frame, 1, 1));
-   root->appendChild(buildChildInfo("UID", frame, 2, 8));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * Stay quiet command
- * When receiving the VICC shall enter the quiet state and shall NOT send back a response. There is NO response to the Stay quiet command
- */
-ProtocolFrame *ParserNfcV::parseRequestStayQuiet(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x02)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   ProtocolFrame *root = buildRootInfo("StayQuiet", frame, ProtocolFrame::SelectionFrame);
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-   root->appendChild(buildChildInfo("UID", frame, 2, 8));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * There is NO response to the Stay quiet command.
- */
-ProtocolFrame *ParserNfcV::parseResponseStayQuiet(const lab::RawFrame &frame)
-{
-   return nullptr;
-}
-
-/*
- * Read single block
- * Command code = 0x20
- * When receiving the Read single block command, the VICC shall read the requested block and send back its value in the response.
- */
-ProtocolFrame *ParserNfcV::parseRequestReadSingle(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x20)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   int offset = 2;
-
-   ProtocolFrame *root = buildRootInfo("ReadBlock", frame, ProtocolFrame::ApplicationFrame);
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-
-   // if UID flag is set parse address
-   if ((frame[0] & 0x24) == 0x20)
-   {
-      root->appendChild(buildChildInfo("UID", frame, offset, 8));
-      offset += 8;
-   }
-
-   root->appendChild(buildChildInfo("BLOCK", frame, offset, 1));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-ProtocolFrame *ParserNfcV::parseResponseReadSingle(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x20)
-      return nullptr;
-
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if (flags & 0x1)
-      root->appendChild(buildResponseError(frame, 1));
-   else
-      root->appendChild(buildChildInfo("DATA", frame, 1, frame.limit() - 3));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * Write single block
- * Command code = 0x21
- * When receiving the Write single block command, the VICC shall write the requested block with the data contained in the request and report the success of the operation in the response.
- */
-ProtocolFrame *ParserNfcV::parseRequestWriteSingle(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x21)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   int offset = 2;
-
-   ProtocolFrame *root = buildRootInfo("WriteBlock", frame, ProtocolFrame::ApplicationFrame);
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-
-   // if UID flag is set parse address
-   if ((frame[0] & 0x24) == 0x20)
-   {
-      root->appendChild(buildChildInfo("UID", frame, offset, 8));
-      offset += 8;
-   }
-
-   root->appendChild(buildChildInfo("BLOCK", frame, offset++, 1));
-   root->appendChild(buildChildInfo("DATA", frame, offset, frame.limit() - offset - 2));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-ProtocolFrame *ParserNfcV::parseResponseWriteSingle(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x21)
-      return nullptr;
-
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if (flags & 0x1)
-      root->appendChild(buildResponseError(frame, 1));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * Command code = 0x22
- * When receiving the Lock block command, the VICC shall lock permanently the requested block.
- */
-ProtocolFrame *ParserNfcV::parseRequestLockBlock(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x22)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   int offset = 2;
-
-   ProtocolFrame *root = buildRootInfo("LockBlock", frame, ProtocolFrame::ApplicationFrame);
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-
-   // if UID flag is set parse address
-   if ((frame[0] & 0x24) == 0x20)
-   {
-      root->appendChild(buildChildInfo("UID", frame, offset, 8));
-      offset += 8;
-   }
-
-   root->appendChild(buildChildInfo("BLOCK", frame, offset++, 1));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-
-}
-
-ProtocolFrame *ParserNfcV::parseResponseLockBlock(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x22)
-      return nullptr;
-
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if (flags & 0x1)
-      root->appendChild(buildResponseError(frame, 1));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * Read multiple blocks
- * Command code = 0x23
- * When receiving the Read multiple block command, the VICC shall read the requested block(s) and send back their value in the response.
- */
-ProtocolFrame *ParserNfcV::parseRequestReadMultiple(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x23)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   int offset = 2;
-
-   ProtocolFrame *root = buildRootInfo("ReadBlocks", frame, ProtocolFrame::ApplicationFrame);
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-
-   // if UID flag is set parse address
-   if ((frame[0] & 0x24) == 0x20)
-   {
-      root->appendChild(buildChildInfo("UID", frame, offset, 8));
-      offset += 8;
-   }
-
-   root->appendChild(buildChildInfo("FIRST", frame, offset++, 1));
-   root->appendChild(buildChildInfo("COUNT", frame, offset++, 1));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-ProtocolFrame *ParserNfcV::parseResponseReadMultiple(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x23)
-      return nullptr;
-
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if (flags & 0x1)
-      root->appendChild(buildResponseError(frame, 1));
-   else
-      root->appendChild(buildChildInfo("DATA", frame, 1, frame.limit() - 3));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * Write multiple blocks
- * Command code = 0x24
- * When receiving the Write multiple single block command, the VICC shall write the requested block(s) with the data contained in the request and report the success of the operation in the response
- */
-ProtocolFrame *ParserNfcV::parseRequestWriteMultiple(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x24)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   int offset = 2;
-
-   ProtocolFrame *root = buildRootInfo("WriteBlocks", frame, ProtocolFrame::ApplicationFrame);
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-
-   // if UID flag is set parse address
-   if ((frame[0] & 0x24) == 0x20)
-   {
-      root->appendChild(buildChildInfo("UID", frame, offset, 8));
-      offset += 8;
-   }
-
-   root->appendChild(buildChildInfo("FIRST", frame, offset++, 1));
-   root->appendChild(buildChildInfo("COUNT", frame, offset++, 1));
-   root->appendChild(buildChildInfo("DATA", frame, offset, frame.limit() - offset - 3));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-ProtocolFrame *ParserNfcV::parseResponseWriteMultiple(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x24)
-      return nullptr;
-
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if (flags & 0x1)
-      root->appendChild(buildResponseError(frame, 1));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * Select
- * Command code = 0x25
- * When receiving the Select command:
- *   - if the UID is equal to its own UID, the VICC shall enter the selected state and shall send a response.
- *   - if it is different, the VICC shall return to the Ready state and shall not send a response.
- */
-ProtocolFrame *ParserNfcV::parseRequestSelect(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x25)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   ProtocolFrame *root = buildRootInfo("Select", frame, ProtocolFrame::ApplicationFrame);
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-   root->appendChild(buildChildInfo("UID", frame, 2, 8));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-ProtocolFrame *ParserNfcV::parseResponseSelect(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x25)
-      return nullptr;
-
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if (flags & 0x1)
-      root->appendChild(buildResponseError(frame, 1));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-ProtocolFrame *ParserNfcV::parseRequestResetReady(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x26)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   ProtocolFrame *root = buildRootInfo("Reset", frame, ProtocolFrame::ApplicationFrame);
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-   root->appendChild(buildChildInfo("UID", frame, 2, 8));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-ProtocolFrame *ParserNfcV::parseResponseResetReady(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x26)
-      return nullptr;
-
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if (flags & 0x1)
-      root->appendChild(buildResponseError(frame, 1));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * Write AFI
- * Command code = 0x27
- * When receiving the Write AFI request, the VICC shall write the AFI value into its memory.
- */
-ProtocolFrame *ParserNfcV::parseRequestWriteAFI(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x27)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   ProtocolFrame *root = buildRootInfo("WriteAFI", frame, ProtocolFrame::ApplicationFrame);
-
-   int offset = 2;
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-
-   // if UID flag is set parse address
-   if ((frame[0] & 0x24) == 0x20)
-   {
-      root->appendChild(buildChildInfo("UID", frame, offset, 8));
-      offset += 8;
-   }
-
-   root->appendChild(buildApplicationFamily(frame, offset++));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-
-}
-
-ProtocolFrame *ParserNfcV::parseResponseWriteAFI(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x27)
-      return nullptr;
-
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if (flags & 0x1)
-      root->appendChild(buildResponseError(frame, 1));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * Lock AFI
- * Command code = 0x28
- * When receiving the Lock AFI request, the VICC shall lock the AFI value permanently into its memory.
- */
-ProtocolFrame *ParserNfcV::parseRequestLockAFI(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x28)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   ProtocolFrame *root = buildRootInfo("LockAFI", frame, ProtocolFrame::ApplicationFrame);
-
-   int offset = 2;
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-
-   // if UID flag is set parse address
-   if ((frame[0] & 0x24) == 0x20)
-   {
-      root->appendChild(buildChildInfo("UID", frame, offset, 8));
-      offset += 8;
-   }
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-
-}
-
-ProtocolFrame *ParserNfcV::parseResponseLockAFI(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x28)
-      return nullptr;
-
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if (flags & 0x1)
-      root->appendChild(buildResponseError(frame, 1));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * Write DSFID command
- * Command code = 0x29
- * When receiving the Write DSFID request, the VICC shall write the DSFID value into its memory
- */
-ProtocolFrame *ParserNfcV::parseRequestWriteDSFID(const lab::RawFrame &frame)
+ProtocolFrame *ParserNfcV::buildField(const Node &root, const Node &node, const lab::RawFrame &frame)
 {
-   if (frame[1] != 0x29)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   ProtocolFrame *root = buildRootInfo("WriteDSFID", frame, ProtocolFrame::ApplicationFrame);
-
-   int offset = 2;
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-
-   // if UID flag is set parse address
-   if ((frame[0] & 0x24) == 0x20)
+   switch (node.field)
    {
-      root->appendChild(buildChildInfo("UID", frame, offset, 8));
-      offset += 8;
-   }
-
-   root->appendChild(buildChildInfo("DSFID", frame, -2, 2));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-
-}
-
-ProtocolFrame *ParserNfcV::parseResponseWriteDSFID(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x29)
-      return nullptr;
-
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if (flags & 0x1)
-      root->appendChild(buildResponseError(frame, 1));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * Lock AFI
- * Command code = 0x28
- * When receiving the Lock AFI request, the VICC shall lock the AFI value permanently into its memory.
- */
-ProtocolFrame *ParserNfcV::parseRequestLockDSFID(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x2A)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   ProtocolFrame *root = buildRootInfo("LockDSFID", frame, ProtocolFrame::ApplicationFrame);
-
-   int offset = 2;
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-
-   // if UID flag is set parse address
-   if ((frame[0] & 0x24) == 0x20)
-   {
-      root->appendChild(buildChildInfo("UID", frame, offset, 8));
-      offset += 8;
-   }
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-ProtocolFrame *ParserNfcV::parseResponseLockDSFID(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x2A)
-      return nullptr;
-
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if (flags & 0x1)
-      root->appendChild(buildResponseError(frame, 1));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-/*
- * Get system information
- * Command code = 0x2B
- * This command allows for retrieving the system information value from the VICC.
- */
-ProtocolFrame *ParserNfcV::parseRequestSysInfo(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x2B)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   ProtocolFrame *root = buildRootInfo("SysInfo", frame, ProtocolFrame::ApplicationFrame);
-
-   int offset = 2;
-
-   root->appendChild(buildRequestFlags(frame, 0));
-   root->appendChild(buildChildInfo("CMD", frame, 1, 1));
-
-   // if UID flag is set parse address
-   if ((frame[0] & 0x24) == 0x20)
-   {
-      root->appendChild(buildChildInfo("UID", frame, offset, 8));
-      offset += 8;
-   }
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-ProtocolFrame *ParserNfcV::parseResponseSysInfo(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x2B)
-      return nullptr;
-
-   int flags = frame[0];
-   int info = frame[1];
-   int offset = 10;
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if ((flags & 1) == 0)
-   {
-      ProtocolFrame *ainfo = root->appendChild(buildChildInfo("INFO", frame, 1, 1));
-
-      if (info & 0x01)
-         ainfo->appendChild(buildChildInfo("[.......1] DSFID is supported. DSFID field is present"));
-      else
-         ainfo->appendChild(buildChildInfo("[.......0] DSFID is not supported. DSFID field is not present"));
-
-      if (info & 0x02)
-         ainfo->appendChild(buildChildInfo("[......1.] AFI is supported. AFI field is present"));
-      else
-         ainfo->appendChild(buildChildInfo("[......0.] AFI is not supported. AFI field is not present"));
-
-      if (info & 0x04)
-         ainfo->appendChild(buildChildInfo("[.....1..] Information on VICC memory size is supported. Memory size field is present"));
-      else
-         ainfo->appendChild(buildChildInfo("[.....0..] Information on VICC memory size is not supported. Memory size field is not present"));
-
-      if (info & 0x08)
-         ainfo->appendChild(buildChildInfo("[....1...] Information on IC reference is supported. IC reference field is present"));
-      else
-         ainfo->appendChild(buildChildInfo("[....0...] Information on IC reference is not supported. IC reference field is not present"));
-
-      ainfo->appendChild(buildChildInfo(QString("[%1....] Reserved for future use").arg((info >> 4) & 0x0f, 4, 2, QChar('0'))));
-
-      // tag UID
-      root->appendChild(buildChildInfo("UID", frame, 2, 8));
-
-      // DSFID field is present
-      if (info & 0x01)
-         root->appendChild(buildChildInfo("DSFID", frame, offset++, 1));
-
-      // AFI field is present
-      if (info & 0x02)
-         root->appendChild(buildApplicationFamily(frame, offset++));
-
-      // Memory size field is present
-      if (info & 0x04)
+      case lab::FrameDissector::FLAGS:
       {
-         ProtocolFrame *amem = root->appendChild(buildChildInfo("MEMORY", frame, offset, 2));
-
-         int count = frame[offset++];
-         int size = frame[offset++] & 0x1f;
+         if (frame.frameType() == lab::FrameType::NfcPollFrame)
+            return buildRequestFlags(node, frame);
 
-         amem->appendChild(buildChildInfo(QString("[%1] Number of blocks %2").arg(count, 8, 2, QChar('0')).arg(count)));
-         amem->appendChild(buildChildInfo(QString("[...%1] Block size %2 bytes").arg(size, 5, 2, QChar('0')).arg(size)));
+         return buildResponseFlags(node, frame);
       }
 
-      // IC reference field is not present
-      if (info & 0x08)
-         root->appendChild(buildChildInfo("IC", frame, offset, 1));
-   }
-   else
-   {
-      root->appendChild(buildResponseError(frame, 1));
-   }
+      case lab::FrameDissector::ERROR:
+         return buildResponseError(node, frame);
 
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
+      case lab::FrameDissector::AFI:
+         return buildApplicationFamily(node, frame);
 
-   return root;
-}
+      case lab::FrameDissector::INFO:
+         return buildSystemInfo(node, frame);
 
-/*
- * Get multiple block security status
- * Command code = 0x2C
- * When receiving the Get multiple block security status command, the VICC shall send back the block security status.
- */
-ProtocolFrame *ParserNfcV::parseRequestGetSecurity(const lab::RawFrame &frame)
-{
-   if (frame[1] != 0x2C)
-      return nullptr;
-
-   lastCommand = frame[1];
-
-   ProtocolFrame *root = buildRootInfo("GetSecurity", frame, ProtocolFrame::ApplicationFrame);
-
-   int offset = 2;
-
-   root->appendChild(buildRequestFlags(frame, 0));
-
-   // if UID flag is set parse address
-   if ((frame[0] & 0x24) == 0x20)
-   {
-      root->appendChild(buildChildInfo("UID", frame, offset, 8));
-      offset += 8;
+      case lab::FrameDissector::MEMORY:
+         return buildMemorySize(node, frame);
    }
 
-   root->appendChild(buildChildInfo("FIRST", frame, offset++, 1));
-   root->appendChild(buildChildInfo("COUNT", frame, offset++, 1));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-ProtocolFrame *ParserNfcV::parseResponseGetSecurity(const lab::RawFrame &frame)
-{
-   if (lastCommand != 0x2C)
-      return nullptr;
-
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-   root->appendChild(buildChildInfo("DATA", frame, 1, frame.limit() - 3));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-ProtocolFrame *ParserNfcV::parseRequestGeneric(const lab::RawFrame &frame)
-{
-   int cmd = frame[1]; // frame command
-
-   QString name = QString("CMD %1").arg(cmd, 2, 16, QChar('0'));
-
-   ProtocolFrame *root = buildRootInfo(name, frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-   root->appendChild(buildChildInfo("CODE", frame, 1, 1));
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
-}
-
-ProtocolFrame *ParserNfcV::parseResponseGeneric(const lab::RawFrame &frame)
-{
-   int flags = frame[0];
-
-   ProtocolFrame *root = buildRootInfo("", frame, 0);
-
-   root->appendChild(buildResponseFlags(frame, 0));
-
-   if (flags & 0x1)
-      root->appendChild(buildResponseError(frame, 1));
-   else
-      root->appendChild(buildChildInfo("PARAMS", frame, 1, frame.limit() - 3));
-
-   root->appendChild(buildChildInfo("CRC", frame, -2, 2));
-
-   return root;
+   return ParserNfc::buildField(root, node, frame);
 }
 
-ProtocolFrame *ParserNfcV::buildRequestFlags(const lab::RawFrame &frame, int offset)
+ProtocolFrame *ParserNfcV::buildRequestFlags(const Node &node, const lab::RawFrame &frame)
 {
-   int flags = frame[offset];
+   int flags = node.value;
 
-   ProtocolFrame *afrf = buildChildInfo("FLAGS", frame, offset, 1);
+   ProtocolFrame *afrf = buildChildInfo("FLAGS", frame, node.offset, node.length);
 
    if (flags & 0x01)
       afrf->appendChild(buildChildInfo("[.......1] Two sub-carriers shall be used by the VICC"));
@@ -1045,11 +104,11 @@ ProtocolFrame *ParserNfcV::buildRequestFlags(const lab::RawFrame &frame, int off
    return afrf;
 }
 
-ProtocolFrame *ParserNfcV::buildResponseFlags(const lab::RawFrame &frame, int offset)
+ProtocolFrame *ParserNfcV::buildResponseFlags(const Node &node, const lab::RawFrame &frame)
 {
-   int flags = frame[offset];
+   int flags = node.value;
 
-   ProtocolFrame *afrf = buildChildInfo("FLAGS", frame, offset, 1);
+   ProtocolFrame *afrf = buildChildInfo("FLAGS", frame, node.offset, node.length);
 
    if (flags & 0x01)
       afrf->appendChild(buildChildInfo("[.......1] Error detected. Error code is in the error field"));
@@ -1068,11 +127,11 @@ ProtocolFrame *ParserNfcV::buildResponseFlags(const lab::RawFrame &frame, int of
    return afrf;
 }
 
-ProtocolFrame *ParserNfcV::buildResponseError(const lab::RawFrame &frame, int offset)
+ProtocolFrame *ParserNfcV::buildResponseError(const Node &node, const lab::RawFrame &frame)
 {
-   int error = frame[offset];
+   int error = node.value;
 
-   ProtocolFrame *aerr = buildChildInfo("ERROR", frame, offset, 1);
+   ProtocolFrame *aerr = buildChildInfo("ERROR", frame, node.offset, node.length);
 
    if (error == 0x01)
       aerr->appendChild(buildChildInfo(QString("[%1] The command is not supported").arg(error, 8, 2, QChar('0'))));
@@ -1096,11 +155,11 @@ ProtocolFrame *ParserNfcV::buildResponseError(const lab::RawFrame &frame, int of
    return aerr;
 }
 
-ProtocolFrame *ParserNfcV::buildApplicationFamily(const lab::RawFrame &frame, int offset)
+ProtocolFrame *ParserNfcV::buildApplicationFamily(const Node &node, const lab::RawFrame &frame)
 {
-   int afi = frame[offset];
+   int afi = node.value;
 
-   ProtocolFrame *afif = buildChildInfo("AFI", frame, offset, 1);
+   ProtocolFrame *afif = buildChildInfo("AFI", frame, node.offset, node.length);
 
    if (afi == 0x00)
       afif->appendChild(buildChildInfo("[00000000] All families and sub-families"));
@@ -1137,3 +196,47 @@ ProtocolFrame *ParserNfcV::buildApplicationFamily(const lab::RawFrame &frame, in
 
    return afif;
 }
+
+ProtocolFrame *ParserNfcV::buildSystemInfo(const Node &node, const lab::RawFrame &frame)
+{
+   int info = node.value;
+
+   ProtocolFrame *ainfo = buildChildInfo("INFO", frame, node.offset, node.length);
+
+   if (info & 0x01)
+      ainfo->appendChild(buildChildInfo("[.......1] DSFID is supported. DSFID field is present"));
+   else
+      ainfo->appendChild(buildChildInfo("[.......0] DSFID is not supported. DSFID field is not present"));
+
+   if (info & 0x02)
+      ainfo->appendChild(buildChildInfo("[......1.] AFI is supported. AFI field is present"));
+   else
+      ainfo->appendChild(buildChildInfo("[......0.] AFI is not supported. AFI field is not present"));
+
+   if (info & 0x04)
+      ainfo->appendChild(buildChildInfo("[.....1..] Information on VICC memory size is supported. Memory size field is present"));
+   else
+      ainfo->appendChild(buildChildInfo("[.....0..] Information on VICC memory size is not supported. Memory size field is not present"));
+
+   if (info & 0x08)
+      ainfo->appendChild(buildChildInfo("[....1...] Information on IC reference is supported. IC reference field is present"));
+   else
+      ainfo->appendChild(buildChildInfo("[....0...] Information on IC reference is not supported. IC reference field is not present"));
+
+   ainfo->appendChild(buildChildInfo(QString("[%1....] Reserved for future use").arg((info >> 4) & 0x0f, 4, 2, QChar('0'))));
+
+   return ainfo;
+}
+
+ProtocolFrame *ParserNfcV::buildMemorySize(const Node &node, const lab::RawFrame &frame)
+{
+   int count = (node.value >> 8) & 0xff;
+   int size = node.value & 0x1f;
+
+   ProtocolFrame *amem = buildChildInfo("MEMORY", frame, node.offset, node.length);
+
+   amem->appendChild(buildChildInfo(QString("[%1] Number of blocks %2").arg(count, 8, 2, QChar('0')).arg(count)));
+   amem->appendChild(buildChildInfo(QString("[...%1] Block size %2 bytes").arg(size, 5, 2, QChar('0')).arg(size)));
+
+   return amem;
+}
@@ -26,81 +26,19 @@
 
 struct ParserNfcV : ParserNfc
 {
-   void reset() override;
+   ProtocolFrame *buildField(const Node &root, const Node &node, const lab::RawFrame &frame) override;
 
-   ProtocolFrame *parse(const lab::RawFrame &frame) override;
+   ProtocolFrame *buildRequestFlags(const Node &node, const lab::RawFrame &frame);
 
-   ProtocolFrame *parseRequestInventory(const lab::RawFrame &frame);
+   ProtocolFrame *buildResponseFlags(const Node &node, const lab::RawFrame &frame);
 
-   ProtocolFrame *parseResponseInventory(const lab::RawFrame &frame);
+   ProtocolFrame *buildResponseError(const Node &node, const lab::RawFrame &frame);
 
-   ProtocolFrame *parseRequestStayQuiet(const lab::RawFrame &frame);
+   ProtocolFrame *buildApplicationFamily(const Node &node, const lab::RawFrame &frame);
 
-   ProtocolFrame *parseResponseStayQuiet(const lab::RawFrame &frame);
+   ProtocolFrame *buildSystemInfo(const Node &node, const lab::RawFrame &frame);
 
-   ProtocolFrame *parseRequestReadSingle(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseReadSingle(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestWriteSingle(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseWriteSingle(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestLockBlock(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseLockBlock(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestReadMultiple(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseReadMultiple(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestWriteMultiple(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseWriteMultiple(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestSelect(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseSelect(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestResetReady(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseResetReady(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestWriteAFI(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseWriteAFI(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestLockAFI(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseLockAFI(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestWriteDSFID(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseWriteDSFID(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestLockDSFID(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseLockDSFID(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestSysInfo(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseSysInfo(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestGetSecurity(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseGetSecurity(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseRequestGeneric(const lab::RawFrame &frame);
-
-   ProtocolFrame *parseResponseGeneric(const lab::RawFrame &frame);
-
-   ProtocolFrame *buildRequestFlags(const lab::RawFrame &frame, int offset);
-
-   ProtocolFrame *buildResponseFlags(const lab::RawFrame &frame, int offset);
-
-   ProtocolFrame *buildResponseError(const lab::RawFrame &frame, int offset);
-
-   ProtocolFrame *buildApplicationFamily(const lab::RawFrame &frame, int offset);
+   ProtocolFrame *buildMemorySize(const Node &node, const lab::RawFrame &frame);
 };
 
 
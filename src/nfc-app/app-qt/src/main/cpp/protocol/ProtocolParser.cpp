@@ -21,7 +21,6 @@
 
 #include <parser/ParserNfcA.h>
 #include <parser/ParserNfcB.h>
-#include <parser/ParserNfcF.h>
 #include <parser/ParserNfcV.h>
 #include <parser/ParserISO7816.h>
 
@@ -33,7 +32,7 @@ struct ProtocolParser::Impl
 
    ParserNfcB nfcb;
 
-   ParserNfcF nfcf;
+   ParserNfc nfcf;
 
    ParserNfcV nfcv;
 
@@ -98,3 +97,8 @@ ProtocolFrame *ProtocolParser::parse(const lab::RawFrame &frame)
 {
    return impl->parse(frame);
 }
+
+ProtocolFrame *ProtocolParser::parse(const lab::IsoDepAssembler &assembler, const lab::ApduExchange &exchange)
+{
+   return impl->nfca.parseExchange(assembler, exchange);
+}
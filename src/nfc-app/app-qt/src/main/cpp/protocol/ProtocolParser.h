@@ -26,6 +26,7 @@
 #include <QSettings>
 
 #include <lab/data/RawFrame.h>
+#include <lab/data/IsoDepAssembler.h>
 
 class ProtocolFrame;
 
@@ -43,6 +44,9 @@ class ProtocolParser : public QObject
 
       ProtocolFrame *parse(const lab::RawFrame &frame);
 
+      // reassembled ISO-DEP exchange, returns information node to attach to its frames
+      ProtocolFrame *parse(const lab::IsoDepAssembler &assembler, const lab::ApduExchange &exchange);
+
       void reset();
 
    private:
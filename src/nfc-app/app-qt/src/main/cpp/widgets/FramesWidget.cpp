@@ -133,11 +133,29 @@ struct FramesWidget::Impl
             return {};
          case NfcCarrier:
             return tr("Carrier");
+         case NfcCarrierTrain:
+            return trainValue(data.data);
          default:
             return data.data.toHex(' ').toUpper();
       }
    }
 
+   static QString trainValue(const QByteArray &data)
+   {
+      // pulse count, period and width in nanoseconds, 32 bit big endian
+      if (data.size() < 12)
+         return tr("Pulses");
+
+      auto value = [&](int offset) {
+         return static_cast<unsigned int>(static_cast<unsigned char>(data[offset])) << 24 |
+                static_cast<unsigned int>(static_cast<unsigned char>(data[offset + 1])) << 16 |
+                static_cast<unsigned int>(static_cast<unsigned char>(data[offset + 2])) << 8 |
+                static_cast<unsigned int>(static_cast<unsigned char>(data[offset + 3]));
+      };
+
+      return tr("Pulses %1 x %2 us").arg(value(0)).arg(value(4) / 1E3, 0, 'f', 1);
+   }
+
    ChannelStyle nfcStyle(int key) const
    {
       // set channel styles
@@ -149,6 +167,9 @@ struct FramesWidget::Impl
          case NfcCarrier:
             return {Theme::defaultCarrierPen, Theme::defaultCarrierPen, Theme::defaultCarrierBrush, Theme::defaultTextPen, Theme::monospaceTextFont};
 
+         case NfcCarrierTrain:
+            return {Theme::defaultCarrierPen, Theme::defaultCarrierPen, Theme::defaultCarrierBrush, Theme::defaultTextPen, Theme::monospaceTextFont};
+
          case NfcARequest:
             return {Theme::defaultNfcAPen, Theme::defaultNfcAPen, Theme::defaultNfcABrush, Theme::defaultTextPen, Theme::monospaceTextFont};
 
@@ -371,6 +392,27 @@ struct FramesWidget::Impl
          }
       }
 
+      // add carrier pulse train as a single segment, carrier is off after last pulse
+      else if (frame->frameType() == lab::FrameType::NfcCarrierTrain)
+      {
+         // add previous carrier segment
+         if (previous != frameData->end() && previous->type >= NfcARequest)
+         {
+            frameData->add(FrameData(NfcCarrier, NfcCarrier, previous->end, frame->timeStart(), 20));
+         }
+
+         // update previous silence / carrier segment
+         else if (previous != frameData->end())
+         {
+            previous->end = frame->timeStart();
+         }
+
+         frameData->add(FrameData(NfcCarrierTrain, NfcCarrierTrain, frame->timeStart(), frame->timeEnd(), 10, toByteArray(*frame)));
+
+         // mark new silence segment
+         frameData->add(FrameData(NfcSilence, NfcSilence, frame->timeEnd(), frame->timeEnd(), 0));
+      }
+
       // add NFC frame
       else if (frame->frameType() == lab::FrameType::NfcPollFrame || frame->frameType() == lab::FrameType::NfcListenFrame)
       {
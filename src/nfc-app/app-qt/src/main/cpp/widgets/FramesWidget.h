@@ -58,6 +58,7 @@ class FramesWidget : public AbstractPlotWidget
          // NFC frame types
          NfcSilence,
          NfcCarrier,
+         NfcCarrierTrain,
          NfcARequest,
          NfcAResponse,
          NfcBRequest,
@@ -32,8 +32,9 @@
 
 #include <graph/AxisLabel.h>
 #include <graph/ChannelGraph.h>
+#include <graph/SignalData.h>
 #include <graph/MarkerRibbon.h>
-#include <graph/MarkerBracket.h>
+#include <graph/MarkerBrackets.h>
 
 #include <styles/Theme.h>
 
@@ -43,7 +44,7 @@
 
 #include "LogicWidget.h"
 
-#define MAX_SIGNAL_BUFFER (512 * 1024 * 1024 / sizeof(QCPGraphData))
+#define MAX_SIGNAL_BUFFER (512 * 1024 * 1024)
 
 struct LogicWidget::Impl
 {
@@ -60,12 +61,12 @@ struct LogicWidget::Impl
    QSharedPointer<MarkerRibbon> ribbonMarker;
    QSharedPointer<QCPAxisTickerText> logicTicker;
 
-   QList<QSharedPointer<MarkerBracket>> bracketList;
+   QSharedPointer<MarkerBrackets> bracketMarker;
 
    double height;
    double threshold;
 
-   int maximumEntries = MAX_SIGNAL_BUFFER;
+   qint64 maximumBytes = MAX_SIGNAL_BUFFER;
 
    QMetaObject::Connection rowsInsertedConnection;
    QMetaObject::Connection modelResetConnection;
@@ -75,6 +76,7 @@ struct LogicWidget::Impl
                                         scaleLabel(new AxisLabel(plot->yAxis)),
                                         ribbonMarker(new MarkerRibbon(plot)),
                                         logicTicker(new QCPAxisTickerText),
+                                        bracketMarker(new MarkerBrackets(plot)),
                                         height(0.70),
                                         threshold(0.5)
    {
@@ -95,6 +97,11 @@ struct LogicWidget::Impl
 
       // initialize legend
       plot->legend->setIconSize(60, 20);
+
+      // bracket labels are frame event names, rows are not removed until model reset clears markers
+      bracketMarker->setLabelMapper([=](int row) {
+         return streamModel ? streamModel->data(streamModel->index(row, StreamModel::Event), Qt::DisplayRole).toString() : QString();
+      });
    }
 
    ~Impl()
@@ -153,6 +160,11 @@ struct LogicWidget::Impl
       channels[id]->setSelectionDecorator(nullptr);
       channels[id]->setOffset(static_cast<double>(channels.size()));
 
+      // stored samples are mapped to channel logic levels
+      channels[id]->samples()->setMapper([this, offset = channels[id]->offset()](float value) {
+         return offset + (value < threshold ? -height / 2 : +height / 2);
+      });
+
       // set channel ticker
       logicTicker->addTick(static_cast<double>(channels.size()), style.text);
 
@@ -181,7 +193,7 @@ struct LogicWidget::Impl
    {
       for (const auto &channel: channels)
       {
-         if (channel->data()->size() > 0)
+         if (!channel->samples()->isEmpty())
             return true;
       }
 
@@ -197,51 +209,21 @@ struct LogicWidget::Impl
       if (!buffer.isValid() || !channels.contains(buffer.id()))
          return;
 
-      ChannelGraph *ch = channels[buffer.id()];
-
-      double offset = ch->offset();
-      double sampleRate = buffer.sampleRate();
-      double sampleStep = 1 / sampleRate;
-      double startTime = static_cast<double>(buffer.offset()) / sampleRate;
-
-      switch (buffer.type())
-      {
-         case hw::SignalType::SIGNAL_TYPE_RAW_LOGIC:
-         {
-            for (int i = 0; i < buffer.elements(); i++)
-            {
-               double time = std::fma(sampleStep, i, startTime);
-               double value = buffer[i];
-
-               ch->data()->add({time, offset + (value < threshold ? -height / 2 : +height / 2)});
-            }
-
-            break;
-         }
-
-         case hw::SignalType::SIGNAL_TYPE_ADV_LOGIC:
-         {
-            for (int i = 0; i < buffer.limit(); i += 2)
-            {
-               double time = std::fma(sampleStep, buffer[i + 1], startTime);
-               double value = buffer[i + 0];
-
-               ch->data()->add({time, offset + (value < threshold ? -height / 2 : +height / 2)});
-            }
+      if (buffer.type() != hw::SignalType::SIGNAL_TYPE_RAW_LOGIC && buffer.type() != hw::SignalType::SIGNAL_TYPE_ADV_LOGIC)
+         return;
 
-            break;
-         }
+      QSharedPointer<SignalData> samples = channels[buffer.id()]->samples();
 
-         default:
-            return;
-      }
+      samples->append(buffer);
 
       // remove old data when maximum memory threshold is reached
-      if (ch->data()->size() > maximumEntries)
-         ch->data()->removeBefore(ch->data()->at(ch->data()->size() - maximumEntries)->key);
+      samples->limit(maximumBytes);
+
+      if (samples->isEmpty())
+         return;
 
       // update graph
-      widget->setDataRange(ch->data()->at(0)->key, ch->data()->at(ch->data()->size() - 1)->key);
+      widget->setDataRange(samples->lowerKey(), samples->upperKey());
    }
 
    /**
@@ -250,14 +232,15 @@ struct LogicWidget::Impl
    void clear()
    {
       // clear all markers
-      bracketList.clear();
+      bracketMarker->clear();
       ribbonMarker->clear();
 
       // clear graph data
       for (const auto &channel: channels)
       {
+         channel->samples()->clear();
          channel->data()->clear();
-         channel->selection().clear();
+         channel->setSelectedRange({});
       }
 
       widget->setDataRange(0, 1E-6);
@@ -289,33 +272,16 @@ struct LogicWidget::Impl
             if (frame->techType() != lab::FrameTech::Iso7816Tech)
                continue;
 
-            QString eventName = streamModel->data(index, Qt::DisplayRole).toString();
-
-            // add bracket marker
-            if (!eventName.isEmpty())
+            // add bracket marker, event name is only requested when it is shown
+            for (auto channel: channels)
             {
-               for (auto channel: channels)
-               {
-                  if (channel->style().text != "IO")
-                     continue;
-
-                  double maxValue = 0;
-
-                  // detect maximum frame value
-                  for (auto it = channel->data()->findBegin(frame->timeStart()); it != channel->data()->findEnd(frame->timeEnd()); ++it)
-                  {
-                     if (it->value > maxValue)
-                        maxValue = it->value;
-                  }
-
-                  QSharedPointer<MarkerBracket> bracketMarker(new MarkerBracket(widget->plot()));
+               if (channel->style().text != "IO")
+                  continue;
 
-                  bracketMarker->setLeft(QPointF(frame->timeStart(), maxValue));
-                  bracketMarker->setRight(QPointF(frame->timeEnd(), maxValue));
-                  bracketMarker->setText(eventName);
+               // detect maximum frame value
+               double maxValue = qMax(0.0, channel->samples()->maximum(frame->timeStart(), frame->timeEnd()));
 
-                  bracketList.append(bracketMarker);
-               }
+               bracketMarker->addBracket(frame->timeStart(), frame->timeEnd(), maxValue, row);
             }
 
             // add frame tech to ribbon marker
@@ -348,19 +314,19 @@ struct LogicWidget::Impl
       // get current selection on any channel
       for (auto channel: channels)
       {
-         QCPDataSelection selection = channel->selection();
-
          // for empty selection no further action
-         if (selection.isEmpty())
+         if (channel->selection().isEmpty())
             continue;
 
-         // get selection size and start / end
-         double selectStart = channel->data()->at(selection.span().begin() + 1)->key;
-         double selectEnd = channel->data()->at(selection.span().end() - 1)->key;
+         // get selection start / end in sample time, graph points are only a decimated view
+         QCPRange selection = channel->selectedRange();
+
+         double selectStart = selection.lower;
+         double selectEnd = selection.upper;
 
          // begin with full data
-         double rangeStart = channel->data()->at(0)->key;
-         double rangeEnd = channel->data()->at(channel->data()->size() - 1)->key;
+         double rangeStart = channel->samples()->lowerKey();
+         double rangeEnd = channel->samples()->upperKey();
 
          // adjust to frames
          for (QModelIndex modelIndex: streamModel->modelRange(rangeStart, rangeEnd))
@@ -400,9 +366,7 @@ struct LogicWidget::Impl
             continue;
 
          // select full data frames
-         int startIndex = int(channel->data()->findBegin(rangeStart, false) - channel->data()->constBegin() + 1);
-         int endIndex = int(channel->data()->findEnd(rangeEnd, false) - channel->data()->constBegin() - 1);
-         channel->setSelection(QCPDataSelection({startIndex, endIndex}));
+         channel->setSelectedRange({rangeStart, rangeEnd});
 
          return {rangeStart, rangeEnd};
       }
@@ -420,29 +384,21 @@ struct LogicWidget::Impl
       // get current selection pn any channel
       for (auto channel: channels)
       {
-         // clear current selection
-         channel->setSelection(QCPDataSelection());
-
          // transport rect start / end to start / end in plot coordinates
          double rectStart = widget->plot()->xAxis->pixelToCoord(rect.left());
          double rectEnd = widget->plot()->xAxis->pixelToCoord(rect.right());
 
-         // get start / end index of data to be selected
-         int startIndex = static_cast<int>(channel->data()->findBegin(rectStart, false) - channel->data()->constBegin());
-         int endIndex = static_cast<int>(channel->data()->findEnd(rectEnd, false) - channel->data()->constBegin() - 1);
+         // select samples inside rect
+         channel->setSelectedRange({rectStart, rectEnd});
+
+         // finally get start / end of selected samples
+         QCPRange selection = channel->selectedRange();
 
          // only select events fully contained inside rect selection
-         if (startIndex >= endIndex)
+         if (selection.size() <= 0)
             continue;
 
-         // finally get start / end for final selection
-         double startTime = channel->data()->at(startIndex)->key;
-         double endTime = channel->data()->at(endIndex)->key;
-
-         // select data in graph
-         channel->setSelection(QCPDataSelection({startIndex, endIndex}));
-
-         return {startTime, endTime};
+         return selection;
       }
 
       return {};
@@ -461,7 +417,7 @@ struct LogicWidget::Impl
    {
       for (const auto &ch: channels)
       {
-         qInfo() << "logic channel" << ch->style().text << "samples" << ch->data()->size();
+         qInfo() << "logic channel" << ch->style().text << "samples" << ch->samples()->size() << "bytes" << ch->samples()->bytes();
       }
    }
 };
@@ -31,8 +31,9 @@
 
 #include <graph/AxisLabel.h>
 #include <graph/MarkerRibbon.h>
-#include <graph/MarkerBracket.h>
+#include <graph/MarkerBrackets.h>
 #include <graph/ChannelGraph.h>
+#include <graph/SignalData.h>
 
 #include <styles/Theme.h>
 
@@ -42,7 +43,7 @@
 
 #include "RadioWidget.h"
 
-#define MAX_SIGNAL_BUFFER (512 * 1024 * 1024 / sizeof(QCPGraphData))
+#define MAX_SIGNAL_BUFFER (512 * 1024 * 1024)
 
 struct RadioWidget::Impl
 {
@@ -50,16 +51,16 @@ struct RadioWidget::Impl
 
    QCustomPlot *plot = nullptr;
    ChannelGraph *radioGraph = nullptr;
-   QSharedPointer<QCPGraphDataContainer> signalData;
+   QSharedPointer<SignalData> signalData;
 
    StreamModel *streamModel = nullptr;
 
    QSharedPointer<AxisLabel> scaleLabel;
    QSharedPointer<MarkerRibbon> ribbonMarker;
 
-   QList<QSharedPointer<MarkerBracket>> bracketList;
+   QSharedPointer<MarkerBrackets> bracketMarker;
 
-   int maximumEntries = MAX_SIGNAL_BUFFER;
+   qint64 maximumBytes = MAX_SIGNAL_BUFFER;
 
    QMetaObject::Connection rowsInsertedConnection;
    QMetaObject::Connection modelResetConnection;
@@ -67,7 +68,8 @@ struct RadioWidget::Impl
    explicit Impl(RadioWidget *parent) : widget(parent),
                                         plot(widget->plot()),
                                         radioGraph(new ChannelGraph(plot->xAxis, plot->yAxis)),
-                                        ribbonMarker(new MarkerRibbon(plot))
+                                        ribbonMarker(new MarkerRibbon(plot)),
+                                        bracketMarker(new MarkerBrackets(plot))
    {
       // set cursor formatter
       widget->setCursorFormatter(DataFormat::time);
@@ -94,8 +96,14 @@ struct RadioWidget::Impl
       plot->legend->addElement(new QCPLayoutInset());
       plot->legend->setColumnStretchFactor(plot->legend->itemCount() - 1, 1000);
 
-      // get signal storage backend
-      signalData = radioGraph->data();
+      // get signal storage backend, values are scaled to full range
+      signalData = radioGraph->samples();
+      signalData->setMapper([](float value) { return value * 2.0; });
+
+      // bracket labels are frame event names, rows are not removed until model reset clears markers
+      bracketMarker->setLabelMapper([=](int row) {
+         return streamModel ? streamModel->data(streamModel->index(row, StreamModel::Event), Qt::DisplayRole).toString() : QString();
+      });
    }
 
    ~Impl()
@@ -153,45 +161,19 @@ struct RadioWidget::Impl
       if (!buffer.isValid())
          return;
 
-      double sampleRate = buffer.sampleRate();
-      double sampleStep = 1 / sampleRate;
-      double startTime = buffer.offset() / sampleRate;
-
-      switch (buffer.type())
-      {
-         case hw::SignalType::SIGNAL_TYPE_RAW_REAL:
-         {
-            for (int i = 0; i < buffer.elements(); i++)
-            {
-               double value = buffer[i] * 2;
-               double time = std::fma(sampleStep, i, startTime); // range = sampleStep * i + startTime
-
-               signalData->add({time, value});
-            }
-
-            break;
-         }
-
-         case hw::SignalType::SIGNAL_TYPE_ADV_REAL:
-         {
-            for (int i = 0; i < buffer.limit(); i += 2)
-            {
-               double value = buffer[i + 0] * 2;
-               double time = std::fma(sampleStep, buffer[i + 1], startTime); // range = sampleStep * buffer[i + 1] + startTime
-
-               signalData->add({time, value});
-            }
+      if (buffer.type() != hw::SignalType::SIGNAL_TYPE_RAW_REAL && buffer.type() != hw::SignalType::SIGNAL_TYPE_ADV_REAL)
+         return;
 
-            break;
-         }
-      }
+      signalData->append(buffer);
 
       // remove old data when maximum memory threshold is reached
-      if (signalData->size() > maximumEntries)
-         signalData->removeBefore(signalData->at(signalData->size() - maximumEntries)->key);
+      signalData->limit(maximumBytes);
+
+      if (signalData->isEmpty())
+         return;
 
       // update graph
-      widget->setDataRange(signalData->at(0)->key, signalData->at(signalData->size() - 1)->key);
+      widget->setDataRange(signalData->lowerKey(), signalData->upperKey());
       widget->setDataScale(0, 1);
    }
 
@@ -201,12 +183,13 @@ struct RadioWidget::Impl
    void clear()
    {
       // clear all markers
-      bracketList.clear();
+      bracketMarker->clear();
       ribbonMarker->clear();
 
       // clear graph data
       signalData->clear();
-      radioGraph->selection().clear();
+      radioGraph->data()->clear();
+      radioGraph->setSelectedRange({});
 
       // restore data range
       widget->setDataRange(0, 1E-6);
@@ -246,28 +229,11 @@ struct RadioWidget::Impl
             if (frame->frameType() == lab::FrameType::NfcCarrierOn || frame->frameType() == lab::FrameType::NfcCarrierOff)
                continue;
 
-            QString eventName = streamModel->data(index, Qt::DisplayRole).toString();
-
-            // add bracket marker
-            if (!eventName.isEmpty())
-            {
-               double maxValue = 0;
-
-               // detect maximum frame value
-               for (auto it = signalData->findBegin(frame->timeStart()); it != signalData->findEnd(frame->timeEnd()); ++it)
-               {
-                  if (it->value > maxValue)
-                     maxValue = it->value;
-               }
-
-               QSharedPointer<MarkerBracket> bracketMarker(new MarkerBracket(widget->plot()));
-
-               bracketMarker->setLeft(QPointF(frame->timeStart(), maxValue));
-               bracketMarker->setRight(QPointF(frame->timeEnd(), maxValue));
-               bracketMarker->setText(eventName);
+            // detect maximum frame value
+            double maxValue = qMax(0.0, signalData->maximum(frame->timeStart(), frame->timeEnd()));
 
-               bracketList.append(bracketMarker);
-            }
+            // add bracket marker, event name is only requested when it is shown
+            bracketMarker->addBracket(frame->timeStart(), frame->timeEnd(), maxValue, row);
 
             // add frame tech to ribbon marker
             QString techName;
@@ -311,20 +277,19 @@ struct RadioWidget::Impl
     */
    QCPRange selectByUser() const
    {
-      // get current selection
-      QCPDataSelection selection = radioGraph->selection();
-
       // for empty selection no further action
-      if (selection.isEmpty())
+      if (radioGraph->selection().isEmpty())
          return {};
 
-      // get selection size and start / end
-      double selectStart = signalData->at(selection.span().begin() + 1)->key;
-      double selectEnd = signalData->at(selection.span().end() - 1)->key;
+      // get selection start / end in sample time, graph points are only a decimated view
+      QCPRange selection = radioGraph->selectedRange();
+
+      double selectStart = selection.lower;
+      double selectEnd = selection.upper;
 
       // begin with full data
-      double rangeStart = signalData->at(0)->key;
-      double rangeEnd = signalData->at(signalData->size() - 1)->key;
+      double rangeStart = signalData->lowerKey();
+      double rangeEnd = signalData->upperKey();
 
       // adjust to frames
       for (QModelIndex modelIndex: streamModel->modelRange(rangeStart, rangeEnd))
@@ -364,9 +329,7 @@ struct RadioWidget::Impl
          return {};
 
       // select full data frames
-      int startIndex = int(signalData->findBegin(rangeStart, false) - signalData->constBegin() + 1);
-      int endIndex = int(signalData->findEnd(rangeEnd, false) - signalData->constBegin() - 1);
-      radioGraph->setSelection(QCPDataSelection({startIndex, endIndex}));
+      radioGraph->setSelectedRange({rangeStart, rangeEnd});
 
       return {rangeStart, rangeEnd};
    }
@@ -378,29 +341,15 @@ struct RadioWidget::Impl
     */
    QCPRange selectByRect(const QRect &rect) const
    {
-      // clear current selection
-      radioGraph->setSelection(QCPDataSelection());
-
       // transport rect start / end to start / end in plot coordinates
       double rectStart = widget->plot()->xAxis->pixelToCoord(rect.left());
       double rectEnd = widget->plot()->xAxis->pixelToCoord(rect.right());
 
-      // get start / end index of data to be selected
-      int startIndex = int(signalData->findBegin(rectStart, false) - signalData->constBegin());
-      int endIndex = int(signalData->findEnd(rectEnd, false) - signalData->constBegin() - 1);
-
-      // only select events fully contained inside rect selection
-      if (startIndex >= endIndex)
-         return {};
-
-      // finally get start / end for final selection
-      double startTime = signalData->at(startIndex)->key;
-      double endTime = signalData->at(endIndex)->key;
-
-      // select data in graph
-      radioGraph->setSelection(QCPDataSelection({startIndex, endIndex}));
+      // select samples fully contained inside rect selection
+      radioGraph->setSelectedRange({rectStart, rectEnd});
 
-      return {startTime, endTime};
+      // finally get start / end of selected samples, empty if none
+      return radioGraph->selectedRange();
    }
 
    /**
@@ -420,7 +369,7 @@ struct RadioWidget::Impl
 
    void dump() const
    {
-      qInfo() << "radio channel" << radioGraph->style().text << "samples" << radioGraph->data()->size();
+      qInfo() << "radio channel" << radioGraph->style().text << "samples" << signalData->size() << "bytes" << signalData->bytes();
    }
 };
 
@@ -22,6 +22,8 @@
 #ifdef __WIN32
 
 #include <windows.h>
+#include <fcntl.h>
+#include <io.h>
 
 #else
 #include <signal.h>
@@ -40,6 +42,8 @@
 #include <rt/BlockingQueue.h>
 
 #include <lab/nfc/Nfc.h>
+#include <lab/data/FrameFilter.h>
+#include <lab/data/FrameWriter.h>
 #include <lab/data/RawFrame.h>
 
 #include <lab/tasks/RadioDecoderTask.h>
@@ -53,31 +57,6 @@ struct Main
 {
    rt::Logger *log = rt::Logger::getLogger("app.main", rt::Logger::INFO_LEVEL);
 
-   // frame type catalog
-   std::map<unsigned int, std::string> frameType {
-         {lab::FrameType::NfcCarrierOff,  "CarrierOff"},
-         {lab::FrameType::NfcCarrierOn,   "CarrierOn"},
-         {lab::FrameType::NfcPollFrame,   "PCD->PICC"},
-         {lab::FrameType::NfcListenFrame, "PICC->PCD"}
-   };
-
-   // frame tech catalog
-   std::map<unsigned int, std::string> frameTech {
-         {lab::FrameTech::NoneTech, "None"},
-         {lab::FrameTech::NfcATech, "NfcA"},
-         {lab::FrameTech::NfcBTech, "NfcB"},
-         {lab::FrameTech::NfcFTech, "NfcD"},
-         {lab::FrameTech::NfcVTech, "NfcV"}
-   };
-
-   // frame rate catalog
-   std::map<unsigned int, std::string> frameRate {
-         {lab::NfcRateType::r106k, "106"},
-         {lab::NfcRateType::r212k, "212"},
-         {lab::NfcRateType::r424k, "424"},
-         {lab::NfcRateType::r848k, "848"},
-   };
-
    // default receiver paramerers
    json defaultReceiverParams = {
 
@@ -126,11 +105,15 @@ struct Main
    // frame stream queue buffer
    rt::BlockingQueue<lab::RawFrame> frameQueue;
 
+   // buffered frame output
+   std::shared_ptr<lab::FrameWriter> frameWriter;
+
    // decoder status and default parameters
    bool decoderConfigured = false;
    json decoderStatus {};
    json decoderParams {
          {"debugEnabled", false},
+         {"carrierTrainEnabled", true},
          {"nfca",         {{"enabled", true}}},
          {"nfcb",         {{"enabled", true}}},
          {"nfcf",         {{"enabled", true}}},
@@ -161,13 +144,13 @@ struct Main
       executor.submit(lab::RadioDeviceTask::construct());
 
       // create receiver streams
-      receiverStatusStream = rt::Subject<rt::Event>::name("radio.status");
-      receiverCommandStream = rt::Subject<rt::Event>::name("radio.command");
+      receiverStatusStream = rt::Subject<rt::Event>::name("radio.receiver.status");
+      receiverCommandStream = rt::Subject<rt::Event>::name("radio.receiver.command");
 
       // create decoder streams
-      decoderStatusStream = rt::Subject<rt::Event>::name("decoder.status");
-      decoderCommandStream = rt::Subject<rt::Event>::name("decoder.command");
-      decoderFrameStream = rt::Subject<lab::RawFrame>::name("decoder.frame");
+      decoderStatusStream = rt::Subject<rt::Event>::name("radio.decoder.status");
+      decoderCommandStream = rt::Subject<rt::Event>::name("radio.decoder.command");
+      decoderFrameStream = rt::Subject<lab::RawFrame>::name("radio.decoder.frame");
 
       // handler for decoder status events
       receiverStatusSubscription = receiverStatusStream->subscribe([&](const rt::Event &event) {
@@ -179,7 +162,8 @@ struct Main
          decoderStatus = json::parse(event.get<std::string>("data").value());
       });
 
-      // subscribe to decoder frames
+      // subscribe to decoder frames, only stream used here: IQ signal has no consumers and
+      // resampling / spectrum tasks are not started, so they cost nothing
       decoderFrameSubscription = decoderFrameStream->subscribe([&](const lab::RawFrame &frame) {
          frameQueue.add(frame);
       });
@@ -306,32 +290,13 @@ struct Main
       return result;
    }
 
-   void printFrame(const lab::RawFrame &frame)
+   void printMessage(const char *message)
    {
-      int offset = 0;
-      char buffer[16384];
-
-      // add datagram time
-      offset += snprintf(buffer + offset, sizeof(buffer), "%010.3f ", frame.timeStart());
-
-      // add frame type
-      offset += snprintf(buffer + offset, sizeof(buffer), "(%s) ", frameType[frame.frameType()].c_str());
-
-      // data frames
-      if (frame.frameType() == lab::FrameType::NfcPollFrame || frame.frameType() == lab::FrameType::NfcListenFrame)
-      {
-         // add tech type
-         offset += snprintf(buffer + offset, sizeof(buffer), "[%s@%.0f]: ", frameTech[frame.techType()].c_str(), roundf(float(frame.frameRate()) / 1000.0f));
-
-         // add data as HEX string
-         for (int i = 0; i < frame.size(); i++)
-         {
-            offset += snprintf(buffer + offset, sizeof(buffer) - offset, "%02X ", (unsigned int) frame[i]);
-         }
-      }
+      // keep ordering with pending frames
+      frameWriter->flush();
 
-      // send to stdout
-      fprintf(stdout, "%s\n", buffer);
+      // structured formats keep stdout clean
+      fprintf(frameWriter->format() == lab::FrameWriter::Text ? stdout : stderr, "%s\n", message);
    }
 
    void finish()
@@ -350,9 +315,12 @@ struct Main
    {
       int opt;
       int nsecs = -1;
+      int format = lab::FrameWriter::Text;
+      bool dissect = false;
+      bool assemble = false;
       char *endptr = nullptr;
 
-      while ((opt = getopt(argc, argv, "vdp:t:")) != -1)
+      while ((opt = getopt(argc, argv, "vdxacp:t:f:o:")) != -1)
       {
          switch (opt)
          {
@@ -377,6 +345,27 @@ struct Main
                break;
             }
 
+               // enable protocol dissection
+            case 'x':
+            {
+               dissect = true;
+               break;
+            }
+
+               // reassemble ISO-DEP APDU exchanges
+            case 'a':
+            {
+               assemble = true;
+               break;
+            }
+
+               // report every carrier edge
+            case 'c':
+            {
+               decoderParams["carrierTrainEnabled"] = false;
+               break;
+            }
+
                // enable protocols
             case 'p':
             {
@@ -403,6 +392,35 @@ struct Main
                break;
             }
 
+               // filter decoded frames
+            case 'f':
+            {
+               if (!lab::FrameFilter().compile(optarg))
+               {
+                  printf("Invalid value for 'f' argument\n");
+                  showUsage();
+                  return -1;
+               }
+
+               decoderParams["frameFilter"] = optarg;
+               break;
+            }
+
+               // output format
+            case 'o':
+            {
+               format = lab::FrameWriter::format(optarg);
+
+               if (format < 0)
+               {
+                  printf("Invalid value for 'o' argument\n");
+                  showUsage();
+                  return -1;
+               }
+
+               break;
+            }
+
             default: /* '?' */
                printf("Unknown option '%c'\n", (char) opt);
                showUsage();
@@ -410,6 +428,17 @@ struct Main
          }
       }
 
+#ifdef __WIN32
+      // binary output must not translate line endings
+      if (format == lab::FrameWriter::Binary)
+         _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+      // frames are flushed on buffer size or time interval, not on every loop
+      frameWriter = std::make_shared<lab::FrameWriter>(stdout, format);
+      frameWriter->setDissect(dissect);
+      frameWriter->setAssemble(assemble);
+
       // get start time
       auto start = std::chrono::steady_clock::now();
 
@@ -431,44 +460,52 @@ struct Main
          // check receiver status
          if (checkReceiverStatus() < 0)
          {
-            fprintf(stdout, "Finish capture, invalid receiver!\n");
+            printMessage("Finish capture, invalid receiver!");
             finish();
          }
 
          // check decoder status
          if (checkDecoderStatus() < 0)
          {
-            fprintf(stdout, "Finish capture, invalid decoder!\n");
+            printMessage("Finish capture, invalid decoder!");
             finish();
          }
 
          // wait until time limit reached and exit
          if (nsecs > 0 && (std::chrono::steady_clock::now() - start) > std::chrono::seconds(nsecs))
          {
-            fprintf(stdout, "Finish capture, time limit reached!\n");
+            printMessage("Finish capture, time limit reached!");
             finish();
          }
 
          // process received frames
          while (auto frame = frameQueue.get())
          {
-            printFrame(frame.value());
+            frameWriter->write(frame.value());
          }
 
-         // flush console output
-         fflush(stdout);
+         // flush console output if interval elapsed
+         frameWriter->poll();
       }
 
+      // write remaining frames and pending exchange
+      frameWriter->close();
+
       return 0;
    }
 
    static void showUsage()
    {
-      printf("Usage: [-v] [-d] [-p nfca,nfcb,nfcf,nfcv] [-t nsecs]\n");
+      printf("Usage: [-v] [-d] [-x] [-a] [-c] [-p nfca,nfcb,nfcf,nfcv] [-t nsecs] [-f expression] [-o text|json|csv|binary]\n");
       printf("\tv: verbose mode, write logging information to stderr\n");
       printf("\td: debug mode, write WAV file with raw decoding signals (highly affected performance!)\n");
+      printf("\tx: dissect frames, adds command and fields to text, json and csv output\n");
+      printf("\ta: reassemble ISO-DEP APDU exchanges, adds one record per command / response pair to text and json output\n");
+      printf("\tc: report each carrier on / off edge, by default periodic short carrier pulses are reported as one carrier-train frame\n");
       printf("\tp: enable protocols, by default all are enabled\n");
       printf("\tt: stop capture after number of seconds\n");
+      printf("\tf: only show frames matching filter, for example \"tech == nfca and not type == carrier-on\"\n");
+      printf("\to: output format, text by default, json and csv write one frame per line, binary writes raw frame records\n");
    }
 
 } *app;
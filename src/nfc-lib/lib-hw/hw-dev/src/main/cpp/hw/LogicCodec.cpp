@@ -0,0 +1,170 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <hw/LogicCodec.h>
+
+// channel coding types
+#define CHANNEL_RUNS 0
+#define CHANNEL_VERBATIM 1
+
+namespace hw {
+
+static void putVarint(std::vector<unsigned char> &data, unsigned int value)
+{
+   while (value >= 0x80)
+   {
+      data.push_back(static_cast<unsigned char>(value | 0x80));
+      value >>= 7;
+   }
+
+   data.push_back(static_cast<unsigned char>(value));
+}
+
+static bool getVarint(const unsigned char *&data, const unsigned char *end, unsigned int &value)
+{
+   value = 0;
+
+   for (unsigned int shift = 0; data < end && shift < 32; shift += 7)
+   {
+      unsigned char byte = *data++;
+
+      value |= static_cast<unsigned int>(byte & 0x7f) << shift;
+
+      if (!(byte & 0x80))
+         return true;
+   }
+
+   return false;
+}
+
+static void encodeChannel(const int *x, unsigned int n, unsigned int stride, std::vector<unsigned char> &data)
+{
+   // count transitions to select coding, each run takes at least two bytes
+   unsigned int changes = 0;
+
+   for (unsigned int i = 1; i < n; i++)
+   {
+      if (x[i * stride] != x[(i - 1) * stride])
+         changes++;
+   }
+
+   if (changes * 2 + 6 >= n)
+   {
+      data.push_back(CHANNEL_VERBATIM);
+
+      for (unsigned int i = 0; i < n; i++)
+         data.push_back(static_cast<unsigned char>(x[i * stride]));
+
+      return;
+   }
+
+   data.push_back(CHANNEL_RUNS);
+
+   putVarint(data, changes);
+
+   data.push_back(static_cast<unsigned char>(x[0]));
+
+   // run length of current value followed by next value, last run extends to block end
+   unsigned int start = 0;
+
+   for (unsigned int i = 1; i < n; i++)
+   {
+      if (x[i * stride] != x[(i - 1) * stride])
+      {
+         putVarint(data, i - start);
+
+         data.push_back(static_cast<unsigned char>(x[i * stride]));
+
+         start = i;
+      }
+   }
+}
+
+static bool decodeChannel(const unsigned char *&data, const unsigned char *end, unsigned int n, unsigned int stride, int *x)
+{
+   if (data >= end)
+      return false;
+
+   if (*data++ == CHANNEL_VERBATIM)
+   {
+      if (static_cast<unsigned int>(end - data) < n)
+         return false;
+
+      for (unsigned int i = 0; i < n; i++)
+         x[i * stride] = *data++;
+
+      return true;
+   }
+
+   unsigned int changes;
+
+   if (!getVarint(data, end, changes) || data >= end)
+      return false;
+
+   int value = *data++;
+
+   unsigned int position = 0;
+
+   for (unsigned int c = 0; c < changes; c++)
+   {
+      unsigned int length;
+
+      if (!getVarint(data, end, length) || data >= end || length == 0 || length > n - position)
+         return false;
+
+      for (unsigned int i = position; i < position + length; i++)
+         x[i * stride] = value;
+
+      position += length;
+      value = *data++;
+   }
+
+   for (unsigned int i = position; i < n; i++)
+      x[i * stride] = value;
+
+   return true;
+}
+
+void LogicCodec::encode(SignalCodec::Block &block, unsigned int channels)
+{
+   block.data.clear();
+
+   for (unsigned int c = 0; c < channels; c++)
+      encodeChannel(block.samples.data() + c, block.frames, channels, block.data);
+}
+
+bool LogicCodec::decode(SignalCodec::Block &block, unsigned int channels)
+{
+   const unsigned char *data = block.data.data();
+   const unsigned char *end = data + block.data.size();
+
+   block.samples.resize(block.frames * channels);
+
+   for (unsigned int c = 0; c < channels; c++)
+   {
+      if (!decodeChannel(data, end, block.frames, channels, block.samples.data() + c))
+         return false;
+   }
+
+   return data == end;
+}
+
+}
@@ -23,6 +23,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <queue>
 #include <fstream>
 #include <iostream>
@@ -35,6 +36,9 @@
 #include <hw/SignalType.h>
 #include <hw/SignalBuffer.h>
 #include <hw/RecordDevice.h>
+#include <hw/RecordWriter.h>
+#include <hw/SignalCodec.h>
+#include <hw/LogicCodec.h>
 
 #define BUFFER_SIZE (1024)
 #define AUDIO_FORMAT_PCM (1)
@@ -46,6 +50,15 @@
 #define WAVE_TYPE_ID 0x45564157 // "WAVE"
 #define META_INFO_ID 0x6174656D // "meta"
 
+#define CODEC_MAGIC_ID 0x5A43464E // "NFCZ"
+#define CODEC_VERSION (1)
+#define CODEC_BLOCK_FRAMES (32768)
+#define CODEC_EXTENSION ".nfz"
+
+#define LOGIC_MAGIC_ID 0x4C43464E // "NFCL"
+#define LOGIC_BLOCK_FRAMES (262144)
+#define LOGIC_EXTENSION ".nfl"
+
 #define CHUNK_STRING(v) static_cast<char>(v & 0xFF), static_cast<char>(v >> 8 & 0xFF), static_cast<char>(v >> 16 & 0xFF), static_cast<char>(v >> 24 & 0xFF)
 
 namespace hw {
@@ -91,6 +104,32 @@ struct DATAChunk
    FILEChunk chunk;
 };
 
+/*
+ * Compressed container header, followed by coded blocks and block offset index
+ */
+struct CODECHeader
+{
+   unsigned int magic; // 4 bytes
+   unsigned short version; // 2 bytes
+   unsigned short numChannels; // 2 bytes
+   unsigned int sampleRate; // 4 bytes
+   unsigned short bitsPerSample; // 2 bytes
+   unsigned short reserved; // 2 bytes
+   unsigned int epoch; // 4 bytes
+   unsigned int blockFrames; // 4 bytes
+   unsigned int blockCount; // 4 bytes
+   unsigned int padding; // 4 bytes
+   unsigned long long sampleCount; // 8 bytes
+   unsigned long long indexOffset; // 8 bytes
+   unsigned int keys[8]; // 32 bytes
+};
+
+struct CODECBlock
+{
+   unsigned int size; // coded bytes
+   unsigned int frames; // samples per channel
+};
+
 struct FILEHeader
 {
    RIFFChunk riff {}; // 12 bytes
@@ -116,10 +155,28 @@ struct RecordDevice::Impl
    unsigned int sampleOffset {};
    unsigned int channelCount {};
    unsigned int streamTime {};
+   std::streamoff dataOffset {};
    std::vector<int> channelKeys {};
 
+   // file for reading
    std::fstream file;
 
+   // asynchronous writer for recording
+   RecordWriter writer;
+
+   // compressed container
+   bool codecFormat = false;
+   bool codecLogic = false;
+   bool codecEof = false;
+   unsigned int codecBlockFrames = CODEC_BLOCK_FRAMES;
+   unsigned int codecNext = 0;
+   unsigned int codecSkip = 0;
+   unsigned int codecPosition = 0;
+   unsigned long long codecFrames = 0;
+   std::vector<int> codecSamples;
+   std::vector<unsigned long long> codecIndex;
+   std::vector<SignalCodec::Block> codecBlocks;
+
    explicit Impl(std::string name) : name(std::move(name)), sampleSize(16), sampleRate(44100), sampleType(1), channelCount(1)
    {
       log->debug("created RecordDevice for name [{}]", {this->name});
@@ -152,6 +209,25 @@ struct RecordDevice::Impl
       sampleCount = 0;
       sampleOffset = 0;
 
+      // compressed format is selected by file extension for writing and by file contents for reading
+      codecLogic = mode == Write && path.size() > 4 && path.compare(path.size() - 4, 4, LOGIC_EXTENSION) == 0;
+      codecFormat = codecLogic || (mode == Write && path.size() > 4 && path.compare(path.size() - 4, 4, CODEC_EXTENSION) == 0);
+      codecBlockFrames = codecLogic ? LOGIC_BLOCK_FRAMES : CODEC_BLOCK_FRAMES;
+      codecEof = false;
+      codecNext = 0;
+      codecSkip = 0;
+      codecPosition = 0;
+      codecFrames = 0;
+      codecSamples.clear();
+      codecIndex.clear();
+      codecBlocks.clear();
+
+      if (codecFormat && sampleSize != (codecLogic ? 8 : 16))
+      {
+         log->warn("compressed format only supports {} bit samples", {codecLogic ? 8 : 16});
+         return false;
+      }
+
       switch (mode)
       {
          case Write:
@@ -160,21 +236,19 @@ struct RecordDevice::Impl
             rt::FileSystem::truncateFile(path);
 
             // open for writing
-            file.open(path, std::ios::out | std::ios::binary);
-
-            if (file.is_open())
+            if (writer.open(path))
             {
                streamTime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 
-               if (!writeHeader())
+               if (!(codecFormat ? writeCodecHeader() : writeHeader()))
                {
-                  file.close();
+                  writer.close();
                }
             }
 
-            log->debug("open successfully, current file offset: {}", {static_cast<unsigned long long>(file.tellp())});
+            log->debug("open successfully, current file offset: {}", {writer.length()});
 
-            return file.is_open();
+            return writer.isOpen();
          }
 
          case Read:
@@ -204,37 +278,51 @@ struct RecordDevice::Impl
 
    void close()
    {
-      if (file.is_open())
+      if (writer.isOpen())
       {
          log->debug("close RecordDevice for name [{}]", {name});
 
-         if (openMode == Write)
+         // store pending blocks and index, then patch header with final sizes
+         if (codecFormat)
+         {
+            codecFlush(true);
+            writeCodecIndex();
+            writeCodecHeader();
+         }
+         else
          {
             writeHeader();
          }
 
+         writer.close();
+      }
+
+      if (file.is_open())
+      {
+         log->debug("close RecordDevice for name [{}]", {name});
+
          file.close();
       }
    }
 
    bool isOpen() const
    {
-      return file.is_open();
+      return file.is_open() || writer.isOpen();
    }
 
    bool isEof() const
    {
-      return file.eof();
+      return codecFormat ? codecEof : file.eof();
    }
 
    bool isReady() const
    {
-      return file.good();
+      return writer.isOpen() ? writer.isReady() : file.good();
    }
 
    bool isStreaming() const
    {
-      return file.is_open();
+      return file.is_open() || writer.isOpen();
    }
 
    int read(SignalBuffer &buffer)
@@ -244,6 +332,9 @@ struct RecordDevice::Impl
 
       log->debug("reading {} bytes from offset {}", {buffer.size(), static_cast<unsigned long long>(file.tellp())});
 
+      if (codecFormat)
+         return readCodecSamples(buffer, static_cast<float>(codecLogic ? 255 : 1 << 15));
+
       switch (sampleSize)
       {
          case 8:
@@ -262,10 +353,13 @@ struct RecordDevice::Impl
 
    int write(SignalBuffer &buffer)
    {
-      if (!file.is_open())
+      if (!writer.isOpen())
          return -1;
 
-      log->debug("writing {} bytes to offset {}", {buffer.size(), static_cast<unsigned long long>(file.tellp())});
+      log->debug("writing {} bytes to offset {}", {buffer.size(), writer.length()});
+
+      if (codecFormat)
+         return writeCodecSamples(buffer, static_cast<float>(codecLogic ? 255 : 1 << 15));
 
       switch (sampleSize)
       {
@@ -334,7 +428,7 @@ struct RecordDevice::Impl
             // write buffered block
             if (converted == BUFFER_SIZE)
             {
-               file.write(reinterpret_cast<const char *>(block), sizeof(block));
+               writer.write(block, sizeof(block));
                converted = 0;
             }
          }
@@ -343,15 +437,325 @@ struct RecordDevice::Impl
       // write last remaining block
       if (converted)
       {
-         file.write(reinterpret_cast<const char *>(block), converted * sizeof(T));
+         writer.write(block, converted * sizeof(T));
+      }
+
+      sampleCount += buffer.position();
+      sampleOffset += buffer.position();
+
+      return static_cast<int>(buffer.position());
+   }
+
+   /*
+    * Decode next batch of blocks in parallel and stream them to buffer
+    */
+   int readCodecSamples(SignalBuffer &buffer, float scale)
+   {
+      while (buffer.available())
+      {
+         if (codecPosition == codecSamples.size() && !codecDecode())
+            break;
+
+         unsigned int length = std::min<unsigned int>(buffer.available(), codecSamples.size() - codecPosition);
+
+         const int *samples = codecSamples.data() + codecPosition;
+
+         float *vector = buffer.pull(length);
+
+         for (unsigned int i = 0; i < length; i++)
+            vector[i] = static_cast<float>(samples[i]) / scale;
+
+         codecPosition += length;
+      }
+
+      buffer.flip();
+
+      sampleOffset += buffer.limit();
+
+      codecEof = codecPosition == codecSamples.size() && codecNext >= codecIndex.size();
+
+      return static_cast<int>(buffer.limit());
+   }
+
+   bool codecDecode()
+   {
+      unsigned int count = std::min<unsigned int>(SignalCodec::threads(), codecIndex.size() - codecNext);
+
+      if (!count)
+         return false;
+
+      codecBlocks.resize(count);
+
+      bool valid = true;
+
+      for (auto &block: codecBlocks)
+      {
+         CODECBlock header {};
+
+         if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+         {
+            valid = false;
+            break;
+         }
+
+         block.frames = fromLittleEndian<unsigned int>(header.frames);
+         block.data.resize(fromLittleEndian<unsigned int>(header.size));
+
+         if (!file.read(reinterpret_cast<char *>(block.data.data()), static_cast<std::streamsize>(block.data.size())))
+         {
+            valid = false;
+            break;
+         }
+      }
+
+      // logic blocks are cheap to decode, radio blocks are decoded in parallel
+      if (valid && codecLogic)
+      {
+         for (auto &block: codecBlocks)
+            valid = valid && LogicCodec::decode(block, channelCount);
+      }
+      else if (valid)
+      {
+         valid = SignalCodec::decode(codecBlocks, channelCount, sampleSize);
       }
 
+      // corrupted or truncated file finish streaming
+      if (!valid)
+      {
+         log->error("corrupted block data near block {}", {codecNext});
+         codecNext = codecIndex.size();
+         return false;
+      }
+
+      codecSamples.clear();
+
+      for (const auto &block: codecBlocks)
+         codecSamples.insert(codecSamples.end(), block.samples.begin(), block.samples.end());
+
+      codecNext += count;
+      codecPosition = std::min<unsigned int>(codecSkip, codecSamples.size());
+      codecSkip = 0;
+
+      return true;
+   }
+
+   /*
+    * Collect samples in blocks, full batches are coded in parallel and written
+    */
+   int writeCodecSamples(SignalBuffer &buffer, float scale)
+   {
+      const unsigned int blockSamples = codecBlockFrames * channelCount;
+
+      buffer.stream([this, &scale, &blockSamples](const float *value, int stride) {
+
+         for (int c = 0; c < stride; c++)
+         {
+            codecSamples.push_back(static_cast<short>(value[c] * scale));
+
+            if (codecSamples.size() == blockSamples)
+               codecFlush(false);
+         }
+      });
+
       sampleCount += buffer.position();
       sampleOffset += buffer.position();
 
       return static_cast<int>(buffer.position());
    }
 
+   void codecFlush(bool last)
+   {
+      // move pending samples to a new block
+      if (codecSamples.size() >= channelCount)
+      {
+         SignalCodec::Block block;
+
+         block.frames = codecSamples.size() / channelCount;
+         block.samples.swap(codecSamples);
+         block.samples.resize(block.frames * channelCount);
+
+         codecBlocks.push_back(std::move(block));
+
+         codecSamples.clear();
+         codecSamples.reserve(codecBlockFrames * channelCount);
+      }
+
+      if (codecBlocks.empty() || (!last && codecBlocks.size() < SignalCodec::threads()))
+         return;
+
+      if (codecLogic)
+      {
+         for (auto &block: codecBlocks)
+            LogicCodec::encode(block, channelCount);
+      }
+      else
+      {
+         SignalCodec::encode(codecBlocks, channelCount, sampleSize);
+      }
+
+      for (const auto &block: codecBlocks)
+      {
+         CODECBlock header {toLittleEndian<unsigned int>(block.data.size()), toLittleEndian<unsigned int>(block.frames)};
+
+         codecIndex.push_back(writer.length());
+         codecFrames += block.frames;
+
+         writer.write(&header, sizeof(header));
+         writer.write(block.data.data(), block.data.size());
+      }
+
+      codecBlocks.clear();
+   }
+
+   bool writeCodecIndex()
+   {
+      std::vector<unsigned long long> index;
+
+      for (unsigned long long offset: codecIndex)
+         index.push_back(toLittleEndian<unsigned long long>(offset));
+
+      return writer.write(index.data(), index.size() * sizeof(unsigned long long));
+   }
+
+   bool writeCodecHeader()
+   {
+      log->debug("write RecordDevice compressed header for name [{}]", {name});
+
+      const unsigned long long length = writer.length();
+
+      CODECHeader header {};
+
+      header.magic = toLittleEndian<unsigned int>(codecLogic ? LOGIC_MAGIC_ID : CODEC_MAGIC_ID);
+      header.version = toLittleEndian<unsigned short>(CODEC_VERSION);
+      header.numChannels = toLittleEndian<unsigned short>(channelCount);
+      header.sampleRate = toLittleEndian<unsigned int>(sampleRate);
+      header.bitsPerSample = toLittleEndian<unsigned short>(sampleSize);
+      header.epoch = toLittleEndian<unsigned int>(streamTime);
+      header.blockFrames = toLittleEndian<unsigned int>(codecBlockFrames);
+      header.blockCount = toLittleEndian<unsigned int>(codecIndex.size());
+      header.sampleCount = toLittleEndian<unsigned long long>(codecFrames);
+
+      // index is stored after last block when closing
+      header.indexOffset = toLittleEndian<unsigned long long>(length ? length - codecIndex.size() * sizeof(unsigned long long) : 0);
+
+      for (unsigned int i = 0; i < channelCount && i < channelKeys.size(); i++)
+         header.keys[i] = toLittleEndian<int>(channelKeys[i]);
+
+      return length ? writer.patch(&header, sizeof(header), 0) : writer.write(&header, sizeof(header));
+   }
+
+   bool readCodecHeader()
+   {
+      log->debug("read RecordDevice compressed header for name [{}]", {name});
+
+      CODECHeader header {};
+
+      file.seekg(0);
+
+      if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+         return false;
+
+      if (fromLittleEndian<unsigned short>(header.version) != CODEC_VERSION || fromLittleEndian<unsigned short>(header.bitsPerSample) != (codecLogic ? 8 : 16) || !header.blockFrames)
+      {
+         log->error("unsupported compressed format version {}", {header.version});
+         return false;
+      }
+
+      sampleType = SAMPLE_TYPE_FLOAT;
+      sampleRate = fromLittleEndian<unsigned int>(header.sampleRate);
+      sampleSize = fromLittleEndian<unsigned short>(header.bitsPerSample);
+      channelCount = fromLittleEndian<unsigned short>(header.numChannels);
+      streamTime = fromLittleEndian<unsigned int>(header.epoch);
+      sampleCount = fromLittleEndian<unsigned long long>(header.sampleCount);
+      codecBlockFrames = fromLittleEndian<unsigned int>(header.blockFrames);
+      dataOffset = sizeof(header);
+
+      channelKeys.clear();
+
+      for (unsigned int key: header.keys)
+         channelKeys.push_back(static_cast<int>(key));
+
+      if (unsigned long long indexOffset = fromLittleEndian<unsigned long long>(header.indexOffset))
+      {
+         codecIndex.resize(fromLittleEndian<unsigned int>(header.blockCount));
+
+         file.seekg(static_cast<std::streamoff>(indexOffset));
+
+         if (!file.read(reinterpret_cast<char *>(codecIndex.data()), static_cast<std::streamsize>(codecIndex.size() * sizeof(unsigned long long))))
+            return false;
+
+         for (auto &offset: codecIndex)
+            offset = fromLittleEndian<unsigned long long>(offset);
+      }
+      else
+      {
+         // recording was not closed, rebuild index from block headers
+         log->warn("missing block index, scanning file");
+
+         CODECBlock block {};
+
+         sampleCount = 0;
+
+         for (std::streamoff offset = dataOffset; file.seekg(offset) && file.read(reinterpret_cast<char *>(&block), sizeof(block)); offset += static_cast<std::streamoff>(sizeof(block) + block.size))
+         {
+            codecIndex.push_back(offset);
+            sampleCount += fromLittleEndian<unsigned int>(block.frames);
+         }
+
+         // last block may be incomplete
+         file.clear();
+         file.seekg(0, std::ios::end);
+
+         if (!codecIndex.empty() && codecIndex.back() + sizeof(block) + block.size > static_cast<unsigned long long>(file.tellg()))
+         {
+            codecIndex.pop_back();
+            sampleCount -= block.frames;
+         }
+      }
+
+      file.clear();
+      file.seekg(dataOffset);
+
+      log->debug("compressed file with {} blocks, {} samples", {codecIndex.size(), sampleCount});
+
+      return true;
+   }
+
+   bool seek(unsigned int offset)
+   {
+      if (!file.is_open() || openMode != Read)
+         return false;
+
+      // clear EOF condition from previous reads
+      file.clear();
+
+      if (codecFormat)
+      {
+         unsigned int block = offset / (codecBlockFrames * channelCount);
+
+         if (block >= codecIndex.size() || !file.seekg(static_cast<std::streamoff>(codecIndex[block])))
+            return false;
+
+         // samples before offset are skipped after decoding block
+         codecNext = block;
+         codecSkip = offset - block * codecBlockFrames * channelCount;
+         codecSamples.clear();
+         codecPosition = 0;
+         codecEof = false;
+
+         sampleOffset = offset;
+
+         return true;
+      }
+
+      if (!file.seekg(dataOffset + static_cast<std::streamoff>(offset) * (sampleSize / 8)))
+         return false;
+
+      sampleOffset = offset;
+
+      return true;
+   }
+
    bool readHeader()
    {
       log->debug("read RecordDevice header for name [{}]", {name});
@@ -365,6 +769,14 @@ struct RecordDevice::Impl
       if (!file.read(reinterpret_cast<char *>(&riff), sizeof(riff)))
          return false;
 
+      // compressed radio or logic container
+      if (riff.chunk.id == CODEC_MAGIC_ID || riff.chunk.id == LOGIC_MAGIC_ID)
+      {
+         codecLogic = riff.chunk.id == LOGIC_MAGIC_ID;
+
+         return codecFormat = readCodecHeader();
+      }
+
       // trace RIFF chunk
       traceRiffChunk(riff);
 
@@ -466,6 +878,7 @@ struct RecordDevice::Impl
                // initialize values
                sampleCount = entry.size / (channelCount * sampleSize / 8);
                sampleOffset = 0;
+               dataOffset = file.tellg();
 
                if (streamTime == 0)
                {
@@ -500,7 +913,7 @@ struct RecordDevice::Impl
       log->debug("write RecordDevice header for name [{}]", {name});
 
       // get current file offset written
-      const int length = file.tellp();
+      const unsigned long long length = writer.length();
 
       FILEHeader header {};
 
@@ -528,18 +941,15 @@ struct RecordDevice::Impl
       header.list.meta.epoch = toLittleEndian<unsigned int>(streamTime);
 
       // write channels ids
-      for (int i = 0; i < channelCount && i < channelKeys.size(); i++)
+      for (unsigned int i = 0; i < channelCount && i < channelKeys.size(); i++)
          header.list.meta.keys[i] = toLittleEndian<int>(channelKeys[i]);
 
       // update data format chunk
       header.data.chunk.id = DATA_CHUNK_ID;
       header.data.chunk.size = toLittleEndian<unsigned int>(length > sizeof(FILEHeader) ? length - sizeof(FILEHeader) : 0);
 
-      // jump to file start
-      file.seekp(0);
-
-      // write file header
-      file.write(reinterpret_cast<char *>(&header), sizeof(header));
+      // write initial file header or patch it with final sizes
+      bool written = length ? writer.patch(&header, sizeof(header), 0) : writer.write(&header, sizeof(header));
 
       // write logging info
       traceRiffChunk(header.riff);
@@ -547,7 +957,7 @@ struct RecordDevice::Impl
       traceListChunk(header.list);
       traceDataChunk(header.data);
 
-      return file.good();
+      return written;
    }
 
    void traceRiffChunk(const RIFFChunk &riff) const
@@ -655,6 +1065,15 @@ rt::Variant RecordDevice::get(int id, int channel) const
       case PARAM_CHANNEL_KEYS:
          return impl->channelKeys;
 
+      case PARAM_WRITE_THROUGHPUT:
+         return impl->writer.throughput();
+
+      case PARAM_WRITE_STALLS:
+         return impl->writer.stalls();
+
+      case PARAM_WRITE_WAITS:
+         return impl->writer.waits();
+
       default:
          return {};
    }
@@ -708,6 +1127,16 @@ bool RecordDevice::set(int id, const rt::Variant &value, int channel)
          impl->log->error("invalid value type for PARAM_CHANNEL_COUNT");
          return false;
       }
+      case PARAM_SAMPLE_OFFSET:
+      {
+         if (auto v = std::get_if<unsigned int>(&value))
+         {
+            return impl->seek(*v);
+         }
+
+         impl->log->error("invalid value type for PARAM_SAMPLE_OFFSET");
+         return false;
+      }
       case PARAM_STREAM_TIME:
       {
          if (auto v = std::get_if<unsigned int>(&value))
@@ -730,6 +1159,17 @@ bool RecordDevice::set(int id, const rt::Variant &value, int channel)
          impl->log->error("invalid value type for PARAM_CHANNEL_KEYS");
          return false;
       }
+      case PARAM_WRITE_DELAY:
+      {
+         if (auto v = std::get_if<unsigned int>(&value))
+         {
+            impl->writer.setWriteDelay(*v);
+            return true;
+         }
+
+         impl->log->error("invalid value type for PARAM_WRITE_DELAY");
+         return false;
+      }
       default:
          impl->log->warn("unknown or unsupported configuration id {}", {id});
          return false;
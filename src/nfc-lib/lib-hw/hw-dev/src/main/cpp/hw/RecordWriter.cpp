@@ -0,0 +1,465 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#include <rt/Logger.h>
+
+#include <hw/RecordWriter.h>
+
+#ifdef _WIN32
+#include <io.h>
+#endif
+
+// block memory alignment, required for direct I/O
+#define BLOCK_ALIGN (4096)
+
+// preallocated file extent size
+#define EXTENT_SIZE (64 << 20)
+
+namespace hw {
+
+struct RecordWriter::Impl
+{
+   rt::Logger *log = rt::Logger::getLogger("hw.RecordWriter");
+
+   // ring configuration
+   unsigned int blockSize;
+   unsigned int blockCount;
+
+   // aligned ring blocks
+   std::vector<unsigned char *> blocks;
+
+   // ring indexes, head is filled by caller, tail is stored by writer thread
+   unsigned int head = 0;
+   unsigned int tail = 0;
+   unsigned int pending = 0;
+
+   // bytes filled in head block
+   unsigned int fill = 0;
+
+   // file status
+   int fileDesc = -1;
+   bool direct = false;
+   unsigned long long fileOffset = 0;
+   unsigned long long fileExtent = 0;
+
+   // total bytes appended by caller
+   unsigned long long totalBytes = 0;
+
+   // writer thread control
+   std::thread writer;
+   std::mutex mutex;
+   std::condition_variable blockReady;
+   std::condition_variable blockFree;
+   bool shutdown = false;
+   std::atomic<bool> failed {false};
+
+   // statistics
+   std::atomic<unsigned long long> storedBytes {0};
+   std::atomic<unsigned int> waitCount {0};
+   std::atomic<unsigned int> writeDelay {0};
+   std::chrono::steady_clock::time_point openTime;
+   std::vector<int> stallCount;
+
+   Impl(unsigned int blockSize, unsigned int blockCount) : blockSize((blockSize + BLOCK_ALIGN - 1) & ~(BLOCK_ALIGN - 1)), blockCount(blockCount < 2 ? 2 : blockCount)
+   {
+   }
+
+   ~Impl()
+   {
+      close();
+
+      for (auto block: blocks)
+         ::operator delete(block, std::align_val_t(BLOCK_ALIGN));
+   }
+
+   bool open(const std::string &path)
+   {
+      close();
+
+      int flags = O_WRONLY | O_CREAT | O_TRUNC;
+
+#ifdef _WIN32
+      flags |= O_BINARY;
+#endif
+
+#ifdef O_DIRECT
+      // try direct I/O first, not all filesystems support it
+      fileDesc = ::open(path.c_str(), flags | O_DIRECT, 0644);
+      direct = fileDesc >= 0;
+#endif
+
+      if (fileDesc < 0)
+         fileDesc = ::open(path.c_str(), flags, 0644);
+
+      if (fileDesc < 0)
+      {
+         log->error("unable to open file [{}]: {}", {path, std::string(std::strerror(errno))});
+         return false;
+      }
+
+      log->debug("open file [{}], direct I/O {}", {path, direct});
+
+      // ring is allocated on first open, devices used only for reading never need it
+      if (blocks.empty())
+      {
+         for (unsigned int i = 0; i < blockCount; i++)
+            blocks.push_back(static_cast<unsigned char *>(::operator new(blockSize, std::align_val_t(BLOCK_ALIGN))));
+      }
+
+      // reset status
+      head = 0;
+      tail = 0;
+      pending = 0;
+      fill = 0;
+      fileOffset = 0;
+      fileExtent = 0;
+      totalBytes = 0;
+      shutdown = false;
+      failed = false;
+      storedBytes = 0;
+      waitCount = 0;
+      stallCount.assign(std::size(STALL_BUCKETS) + 1, 0);
+      openTime = std::chrono::steady_clock::now();
+
+      writer = std::thread([this] { run(); });
+
+      return true;
+   }
+
+   void close()
+   {
+      if (fileDesc < 0)
+         return;
+
+      // store remaining data
+      flush();
+
+      // stop writer thread
+      {
+         std::lock_guard lock(mutex);
+         shutdown = true;
+      }
+
+      blockReady.notify_all();
+
+      if (writer.joinable())
+         writer.join();
+
+      // release preallocated space beyond written data
+      if (::ftruncate(fileDesc, static_cast<off_t>(fileOffset)) != 0)
+         log->warn("unable to truncate file to {} bytes", {fileOffset});
+
+      ::close(fileDesc);
+
+      fileDesc = -1;
+
+      log->info("closed file, {} bytes written at {.2} MB/s, stalls {}, waits {}", {fileOffset, throughput(), stallCount, waitCount.load()});
+   }
+
+   bool write(const void *data, unsigned int size)
+   {
+      if (fileDesc < 0 || failed)
+         return false;
+
+      auto src = static_cast<const unsigned char *>(data);
+
+      while (size)
+      {
+         unsigned int chunk = std::min(size, blockSize - fill);
+
+         std::memcpy(blocks[head] + fill, src, chunk);
+
+         fill += chunk;
+         src += chunk;
+         size -= chunk;
+         totalBytes += chunk;
+
+         // submit full block to writer thread
+         if (fill == blockSize)
+         {
+            std::unique_lock lock(mutex);
+
+            head = (head + 1) % blockCount;
+            pending++;
+            fill = 0;
+
+            blockReady.notify_one();
+
+            // all blocks pending, caller must wait for a free one
+            if (pending == blockCount)
+            {
+               waitCount++;
+
+               blockFree.wait(lock, [this] { return pending < blockCount || failed; });
+            }
+         }
+      }
+
+      return !failed;
+   }
+
+   bool patch(const void *data, unsigned int size, unsigned long long offset)
+   {
+      if (fileDesc < 0)
+         return false;
+
+      // store all pending data before patching
+      flush();
+
+      // patches are not aligned, even if data ends on a block boundary and flush stored nothing
+      {
+         std::lock_guard lock(mutex);
+
+         disableDirect();
+      }
+
+      return writeAt(data, size, offset);
+   }
+
+   /*
+    * Wait for all submitted blocks and store partial head block from caller thread
+    */
+   void flush()
+   {
+      std::unique_lock lock(mutex);
+
+      blockFree.wait(lock, [this] { return pending == 0 || failed; });
+
+      if (!fill)
+         return;
+
+      // partial blocks and patches are not aligned, disable direct I/O from now on
+      disableDirect();
+
+      if (writeAt(blocks[head], fill, fileOffset))
+      {
+         fileOffset += fill;
+         storedBytes += fill;
+      }
+
+      fill = 0;
+   }
+
+   /*
+    * Writer thread, store pending blocks in order
+    */
+   void run()
+   {
+      std::unique_lock lock(mutex);
+
+      while (true)
+      {
+         blockReady.wait(lock, [this] { return pending > 0 || shutdown; });
+
+         if (!pending)
+            break;
+
+         unsigned char *block = blocks[tail];
+
+         // block contents are not modified until released, so store it without lock
+         lock.unlock();
+
+         preallocate(fileOffset + blockSize);
+
+         auto start = std::chrono::steady_clock::now();
+
+         if (unsigned int delay = writeDelay)
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+
+         bool stored = writeAt(block, blockSize, fileOffset);
+
+         auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+#if defined(POSIX_FADV_DONTNEED)
+         // drop written pages from cache, recorded data is not read back
+         if (stored && !direct)
+            ::posix_fadvise(fileDesc, static_cast<off_t>(fileOffset), blockSize, POSIX_FADV_DONTNEED);
+#endif
+
+         lock.lock();
+
+         unsigned int bucket = 0;
+
+         while (bucket < std::size(STALL_BUCKETS) && elapsed >= STALL_BUCKETS[bucket])
+            bucket++;
+
+         stallCount[bucket]++;
+
+         if (stored)
+         {
+            fileOffset += blockSize;
+            storedBytes += blockSize;
+         }
+         else
+         {
+            failed = true;
+         }
+
+         tail = (tail + 1) % blockCount;
+         pending--;
+
+         blockFree.notify_all();
+      }
+   }
+
+   void preallocate(unsigned long long length)
+   {
+#ifdef __linux__
+      if (length <= fileExtent)
+         return;
+
+      unsigned long long extent = fileExtent + EXTENT_SIZE;
+
+      // reserve next extent without changing visible file size
+      if (::fallocate(fileDesc, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(fileExtent), EXTENT_SIZE) != 0)
+         log->debug("preallocation not supported: {}", {std::string(std::strerror(errno))});
+
+      fileExtent = extent;
+#endif
+   }
+
+   void disableDirect()
+   {
+#ifdef O_DIRECT
+      if (direct)
+      {
+         ::fcntl(fileDesc, F_SETFL, ::fcntl(fileDesc, F_GETFL) & ~O_DIRECT);
+
+         direct = false;
+      }
+#endif
+   }
+
+   bool writeAt(const void *data, unsigned int size, unsigned long long offset)
+   {
+      auto src = static_cast<const unsigned char *>(data);
+
+      while (size)
+      {
+#ifdef _WIN32
+         if (_lseeki64(fileDesc, static_cast<long long>(offset), SEEK_SET) < 0)
+            return false;
+
+         int written = ::_write(fileDesc, src, size);
+#else
+         ssize_t written = ::pwrite(fileDesc, src, size, static_cast<off_t>(offset));
+#endif
+
+         if (written < 0)
+         {
+            if (errno == EINTR)
+               continue;
+
+            log->error("write failed at offset {}: {}", {offset, std::string(std::strerror(errno))});
+
+            return false;
+         }
+
+         src += written;
+         size -= written;
+         offset += written;
+      }
+
+      return true;
+   }
+
+   double throughput() const
+   {
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - openTime).count();
+
+      return elapsed > 0 ? static_cast<double>(storedBytes) / elapsed / 1E6 : 0;
+   }
+};
+
+RecordWriter::RecordWriter(unsigned int blockSize, unsigned int blockCount) : impl(std::make_shared<Impl>(blockSize, blockCount))
+{
+}
+
+bool RecordWriter::open(const std::string &path)
+{
+   return impl->open(path);
+}
+
+void RecordWriter::close()
+{
+   impl->close();
+}
+
+bool RecordWriter::isOpen() const
+{
+   return impl->fileDesc >= 0;
+}
+
+bool RecordWriter::isReady() const
+{
+   return impl->fileDesc >= 0 && !impl->failed;
+}
+
+bool RecordWriter::write(const void *data, unsigned int size)
+{
+   return impl->write(data, size);
+}
+
+bool RecordWriter::patch(const void *data, unsigned int size, unsigned long long offset)
+{
+   return impl->patch(data, size, offset);
+}
+
+unsigned long long RecordWriter::length() const
+{
+   return impl->totalBytes;
+}
+
+double RecordWriter::throughput() const
+{
+   return impl->throughput();
+}
+
+std::vector<int> RecordWriter::stalls() const
+{
+   std::lock_guard lock(impl->mutex);
+
+   return impl->stallCount;
+}
+
+unsigned int RecordWriter::waits() const
+{
+   return impl->waitCount;
+}
+
+void RecordWriter::setWriteDelay(unsigned int milliseconds)
+{
+   impl->writeDelay = milliseconds;
+}
+
+}
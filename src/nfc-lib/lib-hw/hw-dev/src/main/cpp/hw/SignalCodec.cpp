@@ -0,0 +1,574 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#if defined(__SSE2__) && defined(USE_SSE2)
+
+#include <emmintrin.h>
+
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+#include <rt/ThreadPool.h>
+
+#include <hw/SignalCodec.h>
+
+// subframe types, fixed predictor types follow with order added
+#define SUBFRAME_CONSTANT 0
+#define SUBFRAME_VERBATIM 1
+#define SUBFRAME_FIXED 2
+
+// subframe type field size
+#define SUBFRAME_TYPE_BITS 3
+
+// Rice parameter field size and maximum value
+#define RICE_PARAM_BITS 5
+#define RICE_PARAM_MAX 30
+
+// unary quotient escape, value follows as raw 32 bits
+#define RICE_ESCAPE 24
+
+// maximum parallel coding threads
+#define MAX_THREADS 8
+
+namespace hw {
+
+/*
+ * MSB first bit writer
+ */
+struct BitWriter
+{
+   std::vector<unsigned char> &data;
+
+   unsigned long long cache = 0;
+   unsigned int count = 0;
+
+   explicit BitWriter(std::vector<unsigned char> &data) : data(data)
+   {
+   }
+
+   // write up to 32 bits
+   void put(unsigned int value, unsigned int bits)
+   {
+      if (!bits)
+         return;
+
+      cache = cache << bits | (value & (0xFFFFFFFFu >> (32 - bits)));
+      count += bits;
+
+      while (count >= 8)
+      {
+         count -= 8;
+         data.push_back(static_cast<unsigned char>(cache >> count));
+      }
+   }
+
+   void rice(unsigned int value, unsigned int k)
+   {
+      unsigned int q = value >> k;
+
+      if (q < RICE_ESCAPE)
+      {
+         // quotient zeros, stop bit and remainder in one write when possible
+         if (q + 1 + k <= 32)
+         {
+            put((1u << k) | (value & ((1u << k) - 1)), q + 1 + k);
+         }
+         else
+         {
+            put(1, q + 1);
+            put(value, k);
+         }
+      }
+      else
+      {
+         put(1, RICE_ESCAPE + 1);
+         put(value, 32);
+      }
+   }
+
+   void flush()
+   {
+      if (count)
+         put(0, 8 - count);
+   }
+};
+
+/*
+ * MSB first bit reader, reads past end return zeros and are reported by overrun()
+ */
+struct BitReader
+{
+   const unsigned char *data;
+   const unsigned int size;
+
+   unsigned long long cache = 0;
+   unsigned int count = 0;
+   unsigned int offset = 0;
+
+   BitReader(const unsigned char *data, unsigned int size) : data(data), size(size)
+   {
+   }
+
+   void refill()
+   {
+      while (count <= 56)
+      {
+         unsigned long long value = offset < size ? data[offset] : 0;
+
+         cache |= value << (56 - count);
+         count += 8;
+         offset++;
+      }
+   }
+
+   // read up to 32 bits
+   unsigned int get(unsigned int bits)
+   {
+      if (!bits)
+         return 0;
+
+      if (count < bits)
+         refill();
+
+      auto value = static_cast<unsigned int>(cache >> (64 - bits));
+
+      cache <<= bits;
+      count -= bits;
+
+      return value;
+   }
+
+   int getSigned(unsigned int bits)
+   {
+      unsigned int value = get(bits);
+
+      // sign extend
+      return static_cast<int>(value << (32 - bits)) >> (32 - bits);
+   }
+
+   unsigned int rice(unsigned int k)
+   {
+      if (count < RICE_ESCAPE + 1 + 32)
+         refill();
+
+      // cache is never empty after refill unless stream is corrupted
+      unsigned int q = cache ? __builtin_clzll(cache) : 64;
+
+      if (q > RICE_ESCAPE)
+      {
+         offset = size + 8;
+         return 0;
+      }
+
+      cache <<= q + 1;
+      count -= q + 1;
+
+      if (q == RICE_ESCAPE)
+         return get(32);
+
+      return q << k | get(k);
+   }
+
+   bool overrun() const
+   {
+      return static_cast<unsigned long long>(offset) * 8 - count > static_cast<unsigned long long>(size) * 8;
+   }
+};
+
+static unsigned int zigzag(int value)
+{
+   return static_cast<unsigned int>(value << 1) ^ static_cast<unsigned int>(value >> 31);
+}
+
+static int unzigzag(unsigned int value)
+{
+   return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+}
+
+/*
+ * Sum of absolute residuals for each fixed predictor order, used to select best order
+ */
+static void estimateOrders(const int *x, unsigned int n, unsigned long long *sums)
+{
+   std::fill_n(sums, SignalCodec::MAX_ORDER + 1, 0);
+
+   unsigned int i = SignalCodec::MAX_ORDER;
+
+#if defined(__SSE2__) && defined(USE_SSE2)
+
+   // 16 bit samples give order 4 residuals up to 2^19, partial sums are flushed before 32 bit lanes overflow
+   while (i + 4 <= n)
+   {
+      __m128i s0 = _mm_setzero_si128();
+      __m128i s1 = _mm_setzero_si128();
+      __m128i s2 = _mm_setzero_si128();
+      __m128i s3 = _mm_setzero_si128();
+      __m128i s4 = _mm_setzero_si128();
+
+      for (unsigned int j = 0; j < 2048 && i + 4 <= n; j++, i += 4)
+      {
+         __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i));
+         __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i - 1));
+         __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i - 2));
+         __m128i a3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i - 3));
+         __m128i a4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i - 4));
+
+         // successive differences
+         __m128i e1 = _mm_sub_epi32(a0, a1);
+         __m128i f1 = _mm_sub_epi32(a1, a2);
+         __m128i g1 = _mm_sub_epi32(a2, a3);
+         __m128i h1 = _mm_sub_epi32(a3, a4);
+         __m128i e2 = _mm_sub_epi32(e1, f1);
+         __m128i f2 = _mm_sub_epi32(f1, g1);
+         __m128i g2 = _mm_sub_epi32(g1, h1);
+         __m128i e3 = _mm_sub_epi32(e2, f2);
+         __m128i f3 = _mm_sub_epi32(f2, g2);
+         __m128i e4 = _mm_sub_epi32(e3, f3);
+
+#define ABS_EPI32(v) _mm_sub_epi32(_mm_xor_si128(v, _mm_srai_epi32(v, 31)), _mm_srai_epi32(v, 31))
+
+         s0 = _mm_add_epi32(s0, ABS_EPI32(a0));
+         s1 = _mm_add_epi32(s1, ABS_EPI32(e1));
+         s2 = _mm_add_epi32(s2, ABS_EPI32(e2));
+         s3 = _mm_add_epi32(s3, ABS_EPI32(e3));
+         s4 = _mm_add_epi32(s4, ABS_EPI32(e4));
+
+#undef ABS_EPI32
+      }
+
+      alignas(16) unsigned int lanes[5][4];
+
+      _mm_store_si128(reinterpret_cast<__m128i *>(lanes[0]), s0);
+      _mm_store_si128(reinterpret_cast<__m128i *>(lanes[1]), s1);
+      _mm_store_si128(reinterpret_cast<__m128i *>(lanes[2]), s2);
+      _mm_store_si128(reinterpret_cast<__m128i *>(lanes[3]), s3);
+      _mm_store_si128(reinterpret_cast<__m128i *>(lanes[4]), s4);
+
+      for (int o = 0; o <= 4; o++)
+         sums[o] += static_cast<unsigned long long>(lanes[o][0]) + lanes[o][1] + lanes[o][2] + lanes[o][3];
+   }
+
+#endif
+
+   for (; i < n; i++)
+   {
+      int e0 = x[i];
+      int e1 = e0 - x[i - 1];
+      int e2 = e1 - (x[i - 1] - x[i - 2]);
+      int e3 = e2 - (x[i - 1] - 2 * x[i - 2] + x[i - 3]);
+      int e4 = e3 - (x[i - 1] - 3 * x[i - 2] + 3 * x[i - 3] - x[i - 4]);
+
+      sums[0] += std::abs(e0);
+      sums[1] += std::abs(e1);
+      sums[2] += std::abs(e2);
+      sums[3] += std::abs(e3);
+      sums[4] += std::abs(e4);
+   }
+}
+
+/*
+ * Fixed predictor residuals, zigzag mapped
+ */
+static void computeResiduals(const int *x, unsigned int n, unsigned int order, unsigned int *r)
+{
+   switch (order)
+   {
+      case 0:
+         for (unsigned int i = 0; i < n; i++)
+            r[i] = zigzag(x[i]);
+         break;
+      case 1:
+         for (unsigned int i = 1; i < n; i++)
+            r[i] = zigzag(x[i] - x[i - 1]);
+         break;
+      case 2:
+         for (unsigned int i = 2; i < n; i++)
+            r[i] = zigzag(x[i] - 2 * x[i - 1] + x[i - 2]);
+         break;
+      case 3:
+         for (unsigned int i = 3; i < n; i++)
+            r[i] = zigzag(x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3]);
+         break;
+      case 4:
+         for (unsigned int i = 4; i < n; i++)
+            r[i] = zigzag(x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4]);
+         break;
+   }
+}
+
+/*
+ * Best Rice parameter for residual partition, starting from mean estimate
+ */
+static unsigned int riceParameter(const unsigned int *r, unsigned int n)
+{
+   unsigned long long sum = 0;
+
+   for (unsigned int i = 0; i < n; i++)
+      sum += r[i];
+
+   unsigned int mean = static_cast<unsigned int>(sum / n);
+
+   unsigned int estimate = 0;
+
+   while (estimate < RICE_PARAM_MAX && (mean >> estimate) > 1)
+      estimate++;
+
+   unsigned int best = estimate;
+   unsigned long long bestBits = ~0ULL;
+
+   for (unsigned int k = estimate > 0 ? estimate - 1 : 0; k <= estimate + 1 && k <= RICE_PARAM_MAX; k++)
+   {
+      unsigned long long bits = static_cast<unsigned long long>(n) * (k + 1);
+
+      for (unsigned int i = 0; i < n; i++)
+         bits += r[i] >> k;
+
+      if (bits < bestBits)
+      {
+         best = k;
+         bestBits = bits;
+      }
+   }
+
+   return best;
+}
+
+static void encodeChannel(const int *x, unsigned int n, unsigned int bits, std::vector<unsigned int> &residuals, BitWriter &writer)
+{
+   // constant channel, usual for idle inputs
+   if (std::all_of(x, x + n, [v = x[0]](int s) { return s == v; }))
+   {
+      writer.put(SUBFRAME_CONSTANT, SUBFRAME_TYPE_BITS);
+      writer.put(x[0], bits);
+      return;
+   }
+
+   unsigned int order = 0;
+
+   if (n > SignalCodec::MAX_ORDER)
+   {
+      unsigned long long sums[SignalCodec::MAX_ORDER + 1];
+
+      estimateOrders(x, n, sums);
+
+      order = std::min_element(sums, sums + SignalCodec::MAX_ORDER + 1) - sums;
+   }
+
+   residuals.resize(n);
+
+   computeResiduals(x, n, order, residuals.data());
+
+   // choose Rice parameters and compute coded size
+   std::vector<unsigned int> params;
+
+   unsigned long long coded = SUBFRAME_TYPE_BITS + order * bits;
+
+   for (unsigned int p = order; p < n; p += SignalCodec::PARTITION_SIZE)
+   {
+      unsigned int length = std::min(SignalCodec::PARTITION_SIZE, n - p);
+      unsigned int k = riceParameter(residuals.data() + p, length);
+
+      params.push_back(k);
+
+      coded += RICE_PARAM_BITS + static_cast<unsigned long long>(length) * (k + 1);
+
+      for (unsigned int i = p; i < p + length; i++)
+         coded += residuals[i] >> k;
+   }
+
+   // noise like signal, store raw samples
+   if (coded >= SUBFRAME_TYPE_BITS + static_cast<unsigned long long>(n) * bits)
+   {
+      writer.put(SUBFRAME_VERBATIM, SUBFRAME_TYPE_BITS);
+
+      for (unsigned int i = 0; i < n; i++)
+         writer.put(x[i], bits);
+
+      return;
+   }
+
+   writer.put(SUBFRAME_FIXED + order, SUBFRAME_TYPE_BITS);
+
+   // warm-up samples
+   for (unsigned int i = 0; i < order; i++)
+      writer.put(x[i], bits);
+
+   for (unsigned int p = order, index = 0; p < n; p += SignalCodec::PARTITION_SIZE, index++)
+   {
+      unsigned int length = std::min(SignalCodec::PARTITION_SIZE, n - p);
+      unsigned int k = params[index];
+
+      writer.put(k, RICE_PARAM_BITS);
+
+      for (unsigned int i = p; i < p + length; i++)
+         writer.rice(residuals[i], k);
+   }
+}
+
+static bool decodeChannel(BitReader &reader, unsigned int n, unsigned int bits, int *x)
+{
+   unsigned int type = reader.get(SUBFRAME_TYPE_BITS);
+
+   if (type == SUBFRAME_CONSTANT)
+   {
+      std::fill_n(x, n, reader.getSigned(bits));
+      return !reader.overrun();
+   }
+
+   if (type == SUBFRAME_VERBATIM)
+   {
+      for (unsigned int i = 0; i < n; i++)
+         x[i] = reader.getSigned(bits);
+
+      return !reader.overrun();
+   }
+
+   unsigned int order = type - SUBFRAME_FIXED;
+
+   if (order > SignalCodec::MAX_ORDER || order > n)
+      return false;
+
+   for (unsigned int i = 0; i < order; i++)
+      x[i] = reader.getSigned(bits);
+
+   for (unsigned int p = order; p < n; p += SignalCodec::PARTITION_SIZE)
+   {
+      unsigned int end = std::min(p + SignalCodec::PARTITION_SIZE, n);
+      unsigned int k = reader.get(RICE_PARAM_BITS);
+
+      if (k > RICE_PARAM_MAX)
+         return false;
+
+      // prediction is serial, each order has its own loop to keep it tight
+      switch (order)
+      {
+         case 0:
+            for (unsigned int i = p; i < end; i++)
+               x[i] = unzigzag(reader.rice(k));
+            break;
+         case 1:
+            for (unsigned int i = p; i < end; i++)
+               x[i] = unzigzag(reader.rice(k)) + x[i - 1];
+            break;
+         case 2:
+            for (unsigned int i = p; i < end; i++)
+               x[i] = unzigzag(reader.rice(k)) + 2 * x[i - 1] - x[i - 2];
+            break;
+         case 3:
+            for (unsigned int i = p; i < end; i++)
+               x[i] = unzigzag(reader.rice(k)) + 3 * x[i - 1] - 3 * x[i - 2] + x[i - 3];
+            break;
+         case 4:
+            for (unsigned int i = p; i < end; i++)
+               x[i] = unzigzag(reader.rice(k)) + 4 * x[i - 1] - 6 * x[i - 2] + 4 * x[i - 3] - x[i - 4];
+            break;
+      }
+
+      if (reader.overrun())
+         return false;
+   }
+
+   return true;
+}
+
+void SignalCodec::encode(Block &block, unsigned int channels, unsigned int bits)
+{
+   std::vector<int> channel(block.frames);
+   std::vector<unsigned int> residuals;
+
+   block.data.clear();
+   block.data.reserve(block.frames * channels * bits / 16);
+
+   BitWriter writer(block.data);
+
+   for (unsigned int c = 0; c < channels; c++)
+   {
+      // deinterleave channel samples
+      for (unsigned int i = 0; i < block.frames; i++)
+         channel[i] = block.samples[i * channels + c];
+
+      encodeChannel(channel.data(), block.frames, bits, residuals, writer);
+   }
+
+   writer.flush();
+}
+
+bool SignalCodec::decode(Block &block, unsigned int channels, unsigned int bits)
+{
+   block.samples.resize(block.frames * channels);
+
+   BitReader reader(block.data.data(), block.data.size());
+
+   if (channels == 1)
+      return decodeChannel(reader, block.frames, bits, block.samples.data());
+
+   std::vector<int> channel(block.frames);
+
+   for (unsigned int c = 0; c < channels; c++)
+   {
+      if (!decodeChannel(reader, block.frames, bits, channel.data()))
+         return false;
+
+      // interleave channel samples
+      for (unsigned int i = 0; i < block.frames; i++)
+         block.samples[i * channels + c] = channel[i];
+   }
+
+   return true;
+}
+
+// coding threads are created once and shared by all codec users, calling thread takes part in each run
+static rt::ThreadPool &codecPool()
+{
+   static rt::ThreadPool pool(SignalCodec::threads() - 1);
+
+   return pool;
+}
+
+void SignalCodec::encode(std::vector<Block> &blocks, unsigned int channels, unsigned int bits)
+{
+   codecPool().run(blocks.size(), [&](unsigned int index) {
+      encode(blocks[index], channels, bits);
+   });
+}
+
+bool SignalCodec::decode(std::vector<Block> &blocks, unsigned int channels, unsigned int bits)
+{
+   std::vector<char> result(blocks.size(), true);
+
+   codecPool().run(blocks.size(), [&](unsigned int index) {
+      result[index] = decode(blocks[index], channels, bits);
+   });
+
+   return std::all_of(result.begin(), result.end(), [](char ok) { return ok; });
+}
+
+unsigned int SignalCodec::threads()
+{
+   static const unsigned int count = std::clamp(std::thread::hardware_concurrency(), 1u, static_cast<unsigned int>(MAX_THREADS));
+
+   return count;
+}
+
+}
@@ -19,25 +19,29 @@
 
 */
 
-#ifndef NFC_LAB_PARSERNFCF_H
-#define NFC_LAB_PARSERNFCF_H
+#ifndef DEV_LOGICCODEC_H
+#define DEV_LOGICCODEC_H
 
-#include <parser/ParserNfc.h>
+#include <hw/SignalCodec.h>
 
-struct ParserNfcF : ParserNfc
-{
-   void reset() override;
-
-   ProtocolFrame *parse(const lab::RawFrame &frame) override;
-
-   ProtocolFrame *parseRequestREQC(const lab::RawFrame &frame);
+namespace hw {
 
-   ProtocolFrame *parseResponseREQC(const lab::RawFrame &frame);
+/*
+ * Lossless codec for 8 bit logic samples that change rarely. Each block is coded per channel as the list of
+ * value transitions, with the run length of each value stored as varint, or verbatim when the channel changes
+ * too often for runs to pay off. Blocks are independent, so they can be decoded from any position.
+ */
+class LogicCodec
+{
+   public:
 
-   ProtocolFrame *parseRequestGeneric(const lab::RawFrame &frame);
+      // encode block samples into block data
+      static void encode(SignalCodec::Block &block, unsigned int channels);
 
-   ProtocolFrame *parseResponseGeneric(const lab::RawFrame &frame);
+      // decode block data into block samples, frames must be set, returns false if data is corrupted
+      static bool decode(SignalCodec::Block &block, unsigned int channels);
 };
 
+}
 
-#endif //NFC_LAB_PARSERNFCF_H
+#endif
@@ -30,6 +30,19 @@ class RecordDevice : public SignalDevice
 {
    struct Impl;
 
+   public:
+
+      enum Params
+      {
+         // asynchronous writer statistics
+         PARAM_WRITE_THROUGHPUT = 2001,
+         PARAM_WRITE_STALLS = 2002,
+         PARAM_WRITE_WAITS = 2003,
+
+         // artificial write latency in milliseconds, for testing
+         PARAM_WRITE_DELAY = 2004
+      };
+
    public:
 
       explicit RecordDevice(const std::string &name);
@@ -0,0 +1,85 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DEV_RECORDWRITER_H
+#define DEV_RECORDWRITER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hw {
+
+/*
+ * Asynchronous file writer, data is appended to a fixed ring of aligned blocks that are
+ * stored to disk by a dedicated writer thread, so caller is never blocked by storage latency
+ * unless the whole ring is pending
+ */
+class RecordWriter
+{
+      struct Impl;
+
+   public:
+
+      // stall histogram bucket limits, in milliseconds
+      static constexpr unsigned int STALL_BUCKETS[] = {1, 4, 16, 64, 256};
+
+   public:
+
+      explicit RecordWriter(unsigned int blockSize = 1 << 20, unsigned int blockCount = 8);
+
+      bool open(const std::string &path);
+
+      void close();
+
+      bool isOpen() const;
+
+      bool isReady() const;
+
+      // append data to current block, returns false on write error
+      bool write(const void *data, unsigned int size);
+
+      // overwrite already written data (file header), waits until all pending blocks are stored
+      bool patch(const void *data, unsigned int size, unsigned long long offset);
+
+      // total bytes appended
+      unsigned long long length() const;
+
+      // sustained throughput in MB/s since open
+      double throughput() const;
+
+      // number of block writes for each STALL_BUCKETS latency range, last entry counts writes over the last limit
+      std::vector<int> stalls() const;
+
+      // number of times the caller had to wait for a free block
+      unsigned int waits() const;
+
+      // add artificial delay to each block write, to simulate slow storage
+      void setWriteDelay(unsigned int milliseconds);
+
+   private:
+
+      std::shared_ptr<Impl> impl;
+};
+
+}
+
+#endif
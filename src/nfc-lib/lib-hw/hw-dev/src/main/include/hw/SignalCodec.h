@@ -0,0 +1,76 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DEV_SIGNALCODEC_H
+#define DEV_SIGNALCODEC_H
+
+#include <vector>
+
+namespace hw {
+
+/*
+ * Lossless codec for integer samples up to 16 bits, in the style of FLAC. Each block is coded per channel
+ * as constant, verbatim or fixed polynomial predictor (order 0 to 4) with residuals stored as partitioned
+ * Rice codes. Blocks are independent, so they can be coded in parallel and decoded from any position.
+ */
+class SignalCodec
+{
+   public:
+
+      // highest predictor order
+      static constexpr unsigned int MAX_ORDER = 4;
+
+      // residuals per Rice partition
+      static constexpr unsigned int PARTITION_SIZE = 1024;
+
+      struct Block
+      {
+         // interleaved samples
+         std::vector<int> samples;
+
+         // encoded data
+         std::vector<unsigned char> data;
+
+         // samples per channel
+         unsigned int frames = 0;
+      };
+
+   public:
+
+      // encode block samples into block data
+      static void encode(Block &block, unsigned int channels, unsigned int bits);
+
+      // decode block data into block samples, frames must be set, returns false if data is corrupted
+      static bool decode(Block &block, unsigned int channels, unsigned int bits);
+
+      // encode blocks in parallel on shared coding threads
+      static void encode(std::vector<Block> &blocks, unsigned int channels, unsigned int bits);
+
+      // decode blocks in parallel on shared coding threads, returns false if any block is corrupted
+      static bool decode(std::vector<Block> &blocks, unsigned int channels, unsigned int bits);
+
+      // number of threads used for parallel coding
+      static unsigned int threads();
+};
+
+}
+
+#endif
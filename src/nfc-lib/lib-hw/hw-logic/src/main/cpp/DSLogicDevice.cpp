@@ -33,6 +33,7 @@
 #include <hw/SignalType.h>
 
 #include <hw/logic/DSLogicDevice.h>
+#include <hw/logic/LogicRunSplitter.h>
 
 #include "DSLogicInternal.h"
 
@@ -128,6 +129,11 @@ struct DSLogicDevice::Impl
     */
    std::vector<SignalBuffer> buffers;
 
+   /*
+    * Run-length decoder for all channels, only used in RLE mode
+    */
+   LogicRunSplitter runSplitter;
+
    /*
     * Control commands.
     */
@@ -451,6 +457,17 @@ struct DSLogicDevice::Impl
          }
       }
 
+      // prepare run-length decoders, one for each enabled channel
+      std::vector<unsigned int> runChannels;
+
+      if (rleCompress)
+      {
+         for (const auto &buffer: buffers)
+            runChannels.push_back(buffer.id());
+      }
+
+      runSplitter.reset(runChannels, CHANNEL_BUFFER_SIZE, samplerate);
+
       // setup usb transfers
       usbTransfer(handler);
 
@@ -490,6 +507,14 @@ struct DSLogicDevice::Impl
          usb.cancelTransfer(transfer);
       }
 
+      // report bandwidth saved by hardware compression
+      if (runSplitter.channels() && currentSamples)
+      {
+         unsigned long long rawBytes = currentSamples / 8 * validChannels;
+
+         log->info("RLE transfer {} bytes for {} samples ({} bytes uncompressed), saved {.1}%", {currentBytes, currentSamples, rawBytes, 100.0 - 100.0 * currentBytes / rawBytes});
+      }
+
       deviceStatus = STATUS_STOP;
 
       return true;
@@ -1899,6 +1924,10 @@ struct DSLogicDevice::Impl
 
    std::vector<SignalBuffer> splitBuffers(Usb::Transfer *transfer)
    {
+      // compressed data must be expanded first, decoders are only created when capture starts in RLE mode
+      if (runSplitter.channels())
+         return splitRunLength(transfer);
+
       std::vector<SignalBuffer> result;
 
       // get channel index to be processed from data buffer
@@ -1956,6 +1985,20 @@ struct DSLogicDevice::Impl
       return result;
    }
 
+   std::vector<SignalBuffer> splitRunLength(Usb::Transfer *transfer)
+   {
+      std::vector<SignalBuffer> result;
+
+      // expand run words, buffers are returned once all channels reach same offset
+      runSplitter.split(transfer->data, transfer->actual, result);
+
+      // update current samples and bytes
+      currentSamples = runSplitter.samples();
+      currentBytes += transfer->actual;
+
+      return result;
+   }
+
    bool isReady()
    {
       return usbRead(rd_cmd_fw_version);
@@ -0,0 +1,165 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#if defined(__SSE2__) && defined(USE_SSE2)
+
+#include <emmintrin.h>
+
+#endif
+
+#include <algorithm>
+
+#include <hw/logic/LogicRunLength.h>
+
+namespace hw {
+
+/*
+ * Fill samples with constant level, runs are usually long so wide stores pay off
+ */
+static void fillRun(float *dst, float value, unsigned int count)
+{
+#if defined(__SSE2__) && defined(USE_SSE2)
+
+   __m128 v = _mm_set1_ps(value);
+
+   unsigned int i = 0;
+
+   for (; i + 16 <= count; i += 16)
+   {
+      _mm_storeu_ps(dst + i + 0, v);
+      _mm_storeu_ps(dst + i + 4, v);
+      _mm_storeu_ps(dst + i + 8, v);
+      _mm_storeu_ps(dst + i + 12, v);
+   }
+
+   for (; i + 4 <= count; i += 4)
+   {
+      _mm_storeu_ps(dst + i, v);
+   }
+
+   for (; i < count; i++)
+   {
+      dst[i] = value;
+   }
+
+#else
+
+   std::fill_n(dst, count, value);
+
+#endif
+}
+
+void LogicRunLength::encode(const unsigned char *data, unsigned int samples, std::vector<unsigned short> &words)
+{
+   unsigned int i = 0;
+
+   while (i < samples)
+   {
+      bool level = data[i >> 3] >> (i & 7) & 1;
+
+      unsigned int start = i++;
+
+      while (i < samples && i - start < RUN_MAX)
+      {
+         // skip whole bytes while level is constant
+         if ((i & 7) == 0 && i + 8 <= samples && i - start + 8 <= RUN_MAX && data[i >> 3] == (level ? 0xFF : 0x00))
+            i += 8;
+         else if ((data[i >> 3] >> (i & 7) & 1) == level)
+            i++;
+         else
+            break;
+      }
+
+      words.push_back(static_cast<unsigned short>((level ? RUN_LEVEL : 0) | (i - start - 1)));
+   }
+}
+
+unsigned int LogicRunLength::expand(const unsigned short *words, unsigned int count, SignalBuffer &buffer)
+{
+   unsigned int consumed = 0;
+
+   while (buffer.available())
+   {
+      // load next run
+      if (!runPending)
+      {
+         if (consumed == count)
+            break;
+
+         runLevel = words[consumed] & RUN_LEVEL;
+         runPending = (words[consumed] & RUN_LENGTH) + 1;
+
+         consumed++;
+      }
+
+      unsigned int length = std::min(runPending, buffer.available());
+
+      fillRun(buffer.pull(length), runLevel ? 1.0f : 0.0f, length);
+
+      runPending -= length;
+      runPosition += length;
+   }
+
+   return consumed;
+}
+
+void LogicRunLength::edges(const unsigned short *words, unsigned int count, std::vector<unsigned long long> &edges)
+{
+   for (unsigned int i = 0; i < count; i++)
+   {
+      bool level = words[i] & RUN_LEVEL;
+
+      // consecutive runs may have same level when previous one reached maximum length
+      if (level != edgeLevel)
+      {
+         edges.push_back(edgePosition);
+         edgeLevel = level;
+      }
+
+      edgePosition += (words[i] & RUN_LENGTH) + 1;
+   }
+}
+
+unsigned int LogicRunLength::pending() const
+{
+   return runPending;
+}
+
+bool LogicRunLength::level() const
+{
+   return runLevel;
+}
+
+unsigned long long LogicRunLength::position() const
+{
+   return runPosition;
+}
+
+void LogicRunLength::reset()
+{
+   runLevel = false;
+   edgeLevel = false;
+   runPending = 0;
+   runPosition = 0;
+   edgePosition = 0;
+}
+
+}
@@ -0,0 +1,215 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include <hw/SignalType.h>
+
+#include <hw/logic/LogicRunSplitter.h>
+
+namespace hw {
+
+void LogicRunSplitter::interleave(const std::vector<std::vector<unsigned short>> &channels, std::vector<unsigned char> &data)
+{
+   size_t wordCount = 0;
+
+   for (const auto &words: channels)
+      wordCount = std::max(wordCount, words.size());
+
+   // all channels fill complete atoms
+   wordCount = (wordCount + ATOM_WORDS - 1) / ATOM_WORDS * ATOM_WORDS;
+
+   std::vector<std::vector<unsigned short>> padded(channels.size());
+
+   for (size_t c = 0; c < channels.size(); c++)
+   {
+      size_t extra = wordCount - channels[c].size();
+
+      for (unsigned short word: channels[c])
+      {
+         unsigned int level = word & LogicRunLength::RUN_LEVEL;
+         unsigned int length = (word & LogicRunLength::RUN_LENGTH) + 1;
+
+         // split run in pieces until required words are added
+         unsigned int pieces = static_cast<unsigned int>(std::min<size_t>(extra + 1, length));
+
+         for (unsigned int p = 0; p < pieces; p++)
+         {
+            unsigned int piece = length / pieces + (p < length % pieces ? 1 : 0);
+
+            padded[c].push_back(static_cast<unsigned short>(level | (piece - 1)));
+         }
+
+         extra -= pieces - 1;
+      }
+   }
+
+   for (size_t a = 0; a < wordCount; a += ATOM_WORDS)
+   {
+      for (const auto &words: padded)
+      {
+         for (size_t w = a; w < a + ATOM_WORDS && w < words.size(); w++)
+         {
+            // run words are little-endian
+            data.push_back(words[w] & 0xff);
+            data.push_back(words[w] >> 8);
+         }
+      }
+   }
+}
+
+void LogicRunSplitter::reset(const std::vector<unsigned int> &channels, unsigned int size, unsigned int rate)
+{
+   channelIds = channels;
+   bufferSize = size;
+   sampleRate = rate;
+   channel = 0;
+   atomFill = 0;
+   totalBytes = 0;
+   totalSamples = 0;
+
+   decoders.assign(channelIds.size(), {});
+   completed.assign(channelIds.size(), {});
+
+   buffers.clear();
+
+   for (unsigned int id: channelIds)
+      buffers.emplace_back(bufferSize, 1, 1, sampleRate, 0, 0, SignalType::SIGNAL_TYPE_RAW_LOGIC, id);
+}
+
+/*
+ * Call handler with channel index and run words of each complete atom, joining atoms split between transfers
+ */
+template <typename Handler>
+void LogicRunSplitter::atoms(const unsigned char *data, unsigned int length, Handler &&handler)
+{
+   unsigned short words[ATOM_WORDS];
+
+   unsigned int i = 0;
+
+   totalBytes += length;
+
+   // complete atom from previous transfer
+   if (atomFill)
+   {
+      unsigned int count = std::min(ATOM_SIZE - atomFill, length);
+
+      std::memcpy(atom + atomFill, data, count);
+
+      atomFill += count;
+      i += count;
+
+      if (atomFill < ATOM_SIZE)
+         return;
+
+      std::memcpy(words, atom, ATOM_SIZE);
+
+      handler(channel, words);
+
+      channel = (channel + 1) % channelIds.size();
+      atomFill = 0;
+   }
+
+   for (; i + ATOM_SIZE <= length; i += ATOM_SIZE)
+   {
+      std::memcpy(words, data + i, ATOM_SIZE);
+
+      handler(channel, words);
+
+      channel = (channel + 1) % channelIds.size();
+   }
+
+   // keep remaining bytes for next transfer
+   atomFill = length - i;
+
+   std::memcpy(atom, data + i, atomFill);
+}
+
+void LogicRunSplitter::split(const unsigned char *data, unsigned int length, std::vector<SignalBuffer> &result)
+{
+   if (channelIds.empty())
+      return;
+
+   atoms(data, length, [this](unsigned int c, const unsigned short *words) {
+
+      unsigned int consumed = 0;
+
+      while (true)
+      {
+         consumed += decoders[c].expand(words + consumed, ATOM_WORDS - consumed, buffers[c]);
+
+         // buffer not full, all runs consumed
+         if (buffers[c].available())
+            break;
+
+         buffers[c].flip();
+
+         completed[c].push_back(buffers[c]);
+
+         buffers[c] = SignalBuffer(bufferSize, 1, 1, sampleRate, decoders[c].position(), 0, SignalType::SIGNAL_TYPE_RAW_LOGIC, channelIds[c]);
+
+         if (consumed == ATOM_WORDS && !decoders[c].pending())
+            break;
+      }
+   });
+
+   // emit buffers once all channels are completed, channels progress at different rates
+   while (std::all_of(completed.begin(), completed.end(), [](const std::list<SignalBuffer> &list) { return !list.empty(); }))
+   {
+      for (auto &list: completed)
+      {
+         result.push_back(list.front());
+         list.pop_front();
+      }
+
+      totalSamples += bufferSize;
+   }
+}
+
+void LogicRunSplitter::edges(const unsigned char *data, unsigned int length, std::vector<std::vector<unsigned long long>> &result)
+{
+   if (channelIds.empty())
+      return;
+
+   result.resize(channelIds.size());
+
+   atoms(data, length, [this, &result](unsigned int c, const unsigned short *words) {
+      decoders[c].edges(words, ATOM_WORDS, result[c]);
+   });
+}
+
+unsigned int LogicRunSplitter::channels() const
+{
+   return channelIds.size();
+}
+
+unsigned long long LogicRunSplitter::bytes() const
+{
+   return totalBytes;
+}
+
+unsigned long long LogicRunSplitter::samples() const
+{
+   return totalSamples;
+}
+
+}
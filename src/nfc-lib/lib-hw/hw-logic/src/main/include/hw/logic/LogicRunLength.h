@@ -0,0 +1,87 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef LOGIC_LOGICRUNLENGTH_H
+#define LOGIC_LOGICRUNLENGTH_H
+
+#include <vector>
+
+#include <hw/SignalBuffer.h>
+
+namespace hw {
+
+/*
+ * Run-length decoder for compressed logic channels. Each channel stream is a sequence of 16 bit
+ * little-endian run words, bit 15 is the sample level and bits 0-14 the run length minus one.
+ * Runs may span transfers and output buffers, so one decoder instance is required per channel.
+ */
+class LogicRunLength
+{
+   public:
+
+      // run word fields
+      static constexpr unsigned int RUN_LEVEL = 0x8000;
+      static constexpr unsigned int RUN_LENGTH = 0x7FFF;
+
+      // maximum samples per run word
+      static constexpr unsigned int RUN_MAX = RUN_LENGTH + 1;
+
+   public:
+
+      /*
+       * Encode packed samples (8 samples per byte, LSB first) to run words, used for testing and bandwidth estimation
+       */
+      static void encode(const unsigned char *data, unsigned int samples, std::vector<unsigned short> &words);
+
+      /*
+       * Expand run words into buffer until all words are consumed or buffer is full, returns number of words consumed.
+       * Partial run remains pending and is written first on next call.
+       */
+      unsigned int expand(const unsigned short *words, unsigned int count, SignalBuffer &buffer);
+
+      /*
+       * Convert run words to edge list, each entry is the absolute sample position where level changes
+       */
+      void edges(const unsigned short *words, unsigned int count, std::vector<unsigned long long> &edges);
+
+      // pending samples of current run
+      unsigned int pending() const;
+
+      // current level
+      bool level() const;
+
+      // total decoded samples
+      unsigned long long position() const;
+
+      void reset();
+
+   private:
+
+      bool runLevel = false;
+      bool edgeLevel = false;
+      unsigned int runPending = 0;
+      unsigned long long runPosition = 0;
+      unsigned long long edgePosition = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef LOGIC_LOGICRUNSPLITTER_H
+#define LOGIC_LOGICRUNSPLITTER_H
+
+#include <list>
+#include <vector>
+
+#include <hw/SignalBuffer.h>
+
+#include <hw/logic/LogicRunLength.h>
+
+namespace hw {
+
+/*
+ * Demultiplexer for compressed logic transfers. Device data is a sequence of 8 byte atoms, each one holding 4 run words
+ * for one channel, with atoms interleaved by channel as in uncompressed mode. Atoms may span transfers.
+ */
+class LogicRunSplitter
+{
+   public:
+
+      // atom size in bytes and run words
+      static constexpr unsigned int ATOM_SIZE = 8;
+      static constexpr unsigned int ATOM_WORDS = ATOM_SIZE / sizeof(unsigned short);
+
+   public:
+
+      /*
+       * Interleave channel run words into atoms as sent by device, used for testing. Channels must have the same number
+       * of samples, runs of channels with fewer words are split so all of them fill the same number of atoms.
+       */
+      static void interleave(const std::vector<std::vector<unsigned short>> &channels, std::vector<unsigned char> &data);
+
+      /*
+       * Prepare decoders for a new capture, one per channel identifier
+       */
+      void reset(const std::vector<unsigned int> &channels, unsigned int bufferSize, unsigned int sampleRate);
+
+      /*
+       * Expand transfer data, completed buffers are held until all channels reach the same offset and then appended
+       * to result as one group in channel order
+       */
+      void split(const unsigned char *data, unsigned int length, std::vector<SignalBuffer> &result);
+
+      /*
+       * Convert transfer data to absolute sample positions where level changes, one list per channel. A capture must be
+       * processed either with split or with edges, not both.
+       */
+      void edges(const unsigned char *data, unsigned int length, std::vector<std::vector<unsigned long long>> &result);
+
+      // number of channels
+      unsigned int channels() const;
+
+      // compressed bytes received
+      unsigned long long bytes() const;
+
+      // samples per channel emitted in complete buffer groups
+      unsigned long long samples() const;
+
+   private:
+
+      template <typename Handler>
+      void atoms(const unsigned char *data, unsigned int length, Handler &&handler);
+
+      std::vector<unsigned int> channelIds;
+      std::vector<LogicRunLength> decoders;
+      std::vector<SignalBuffer> buffers;
+      std::vector<std::list<SignalBuffer>> completed;
+
+      // partial atom pending from previous transfer
+      unsigned char atom[ATOM_SIZE] {};
+      unsigned int atomFill = 0;
+
+      unsigned int bufferSize = 0;
+      unsigned int sampleRate = 0;
+      unsigned int channel = 0;
+
+      unsigned long long totalBytes = 0;
+      unsigned long long totalSamples = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,531 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
+#include <functional>
+#include <algorithm>
+#include <vector>
+
+#include <rt/Logger.h>
+
+#include <lab/data/FrameCache.h>
+
+namespace lab {
+
+// entry file header
+constexpr unsigned int CACHE_MAGIC = 0x4643464E; // "NFCF"
+constexpr unsigned int CACHE_VERSION = 2;
+
+// content hash read block size
+constexpr unsigned long long HASH_BLOCK = 1 << 20;
+
+// 64 bit FNV-1a
+constexpr unsigned long long HASH_OFFSET = 0xCBF29CE484222325ULL;
+constexpr unsigned long long HASH_PRIME = 0x100000001B3ULL;
+
+static unsigned long long hashBytes(unsigned long long hash, const void *data, size_t length)
+{
+   const auto *ptr = static_cast<const unsigned char *>(data);
+
+   for (size_t i = 0; i < length; i++)
+   {
+      hash ^= ptr[i];
+      hash *= HASH_PRIME;
+   }
+
+   return hash;
+}
+
+// FNV-1a over 64 bit words, trailing bytes are hashed one by one
+static unsigned long long hashWords(unsigned long long hash, const void *data, size_t length)
+{
+   const auto *ptr = static_cast<const unsigned char *>(data);
+
+   size_t words = length / sizeof(unsigned long long);
+
+   for (size_t i = 0; i < words; i++)
+   {
+      unsigned long long value;
+
+      std::memcpy(&value, ptr + i * sizeof(value), sizeof(value));
+
+      hash ^= value;
+      hash *= HASH_PRIME;
+   }
+
+   return hashBytes(hash, ptr + words * sizeof(unsigned long long), length % sizeof(unsigned long long));
+}
+
+template <typename T>
+static void writeValue(std::vector<unsigned char> &buffer, T value)
+{
+   const auto *ptr = reinterpret_cast<const unsigned char *>(&value);
+
+   buffer.insert(buffer.end(), ptr, ptr + sizeof(T));
+}
+
+template <typename T>
+static bool readValue(const unsigned char *&ptr, const unsigned char *end, T &value)
+{
+   if (end - ptr < static_cast<long>(sizeof(T)))
+      return false;
+
+   std::memcpy(&value, ptr, sizeof(T));
+
+   ptr += sizeof(T);
+
+   return true;
+}
+
+struct FrameCache::Impl
+{
+   rt::Logger *log = rt::Logger::getLogger("decoder.FrameCache");
+
+   std::string directory;
+
+   unsigned long long sizeLimit = 0;
+
+   Impl(const std::string &directory, unsigned long long sizeLimit) : directory(directory), sizeLimit(sizeLimit)
+   {
+   }
+
+   std::filesystem::path entryPath(const Key &key) const
+   {
+      char name[64];
+
+      snprintf(name, sizeof(name), "%016llx-%016llx.frames", key.content, key.config);
+
+      return std::filesystem::path(directory) / name;
+   }
+
+   bool load(const Key &key, std::list<RawFrame> &frames) const
+   {
+      std::error_code ec;
+
+      std::filesystem::path path = entryPath(key);
+
+      if (directory.empty() || !std::filesystem::is_regular_file(path, ec))
+         return false;
+
+      std::ifstream input(path, std::ios::binary);
+
+      std::vector<unsigned char> buffer((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+      input.close();
+
+      std::list<RawFrame> result;
+
+      if (!decode(key, buffer, result))
+      {
+         log->warn("remove corrupted cache entry {}", {path.string()});
+
+         std::filesystem::remove(path, ec);
+
+         return false;
+      }
+
+      // refresh entry access time for eviction order
+      std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+      log->info("loaded {} frames from cache entry {}", {result.size(), path.string()});
+
+      frames.splice(frames.end(), result);
+
+      return true;
+   }
+
+   bool store(const Key &key, const std::list<RawFrame> &frames)
+   {
+      std::error_code ec;
+
+      if (directory.empty())
+         return false;
+
+      std::vector<unsigned char> buffer;
+
+      encode(key, frames, buffer);
+
+      // entries bigger than whole cache are not stored
+      if (sizeLimit && buffer.size() > sizeLimit)
+      {
+         log->info("cache entry size {} exceeds limit {}, not stored", {buffer.size(), sizeLimit});
+         return false;
+      }
+
+      std::filesystem::create_directories(directory, ec);
+
+      std::filesystem::path path = entryPath(key);
+      std::filesystem::path temp = path.string() + ".tmp";
+
+      // write to temporary file and rename, so partial entries are never visible
+      {
+         std::ofstream output(temp, std::ios::binary | std::ios::trunc);
+
+         output.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+
+         if (!output.good())
+         {
+            log->warn("unable to write cache entry {}", {temp.string()});
+
+            output.close();
+
+            std::filesystem::remove(temp, ec);
+
+            return false;
+         }
+      }
+
+      std::filesystem::rename(temp, path, ec);
+
+      if (ec)
+      {
+         log->warn("unable to rename cache entry {}: {}", {path.string(), ec.message()});
+
+         std::filesystem::remove(temp, ec);
+
+         return false;
+      }
+
+      log->info("stored {} frames in cache entry {}, {} bytes", {frames.size(), path.string(), buffer.size()});
+
+      evict();
+
+      return true;
+   }
+
+   int remove(const std::function<bool(const std::filesystem::path &)> &filter) const
+   {
+      std::error_code ec;
+
+      int removed = 0;
+
+      for (const auto &entry: list())
+      {
+         if (filter(entry.path()) && std::filesystem::remove(entry.path(), ec))
+            removed++;
+      }
+
+      return removed;
+   }
+
+   int evict() const
+   {
+      if (!sizeLimit)
+         return 0;
+
+      std::error_code ec;
+
+      std::vector<std::filesystem::directory_entry> entries = list();
+
+      unsigned long long total = 0;
+
+      for (const auto &entry: entries)
+         total += entry.file_size(ec);
+
+      if (total <= sizeLimit)
+         return 0;
+
+      // least recently used first
+      std::sort(entries.begin(), entries.end(), [](const std::filesystem::directory_entry &a, const std::filesystem::directory_entry &b) {
+         std::error_code ec;
+         return a.last_write_time(ec) < b.last_write_time(ec);
+      });
+
+      int removed = 0;
+
+      for (const auto &entry: entries)
+      {
+         if (total <= sizeLimit)
+            break;
+
+         unsigned long long length = entry.file_size(ec);
+
+         if (std::filesystem::remove(entry.path(), ec))
+         {
+            log->info("evict cache entry {}, {} bytes", {entry.path().string(), length});
+
+            total -= length;
+            removed++;
+         }
+      }
+
+      return removed;
+   }
+
+   std::vector<std::filesystem::directory_entry> list() const
+   {
+      std::error_code ec;
+
+      std::vector<std::filesystem::directory_entry> entries;
+
+      if (directory.empty() || !std::filesystem::is_directory(directory, ec))
+         return entries;
+
+      for (const auto &entry: std::filesystem::directory_iterator(directory, ec))
+      {
+         if (entry.is_regular_file(ec) && entry.path().extension() == ".frames")
+            entries.push_back(entry);
+      }
+
+      return entries;
+   }
+
+   static void encode(const Key &key, const std::list<RawFrame> &frames, std::vector<unsigned char> &buffer)
+   {
+      writeValue<unsigned int>(buffer, CACHE_MAGIC);
+      writeValue<unsigned int>(buffer, CACHE_VERSION);
+      writeValue<unsigned int>(buffer, key.version);
+      writeValue<unsigned long long>(buffer, key.size);
+      writeValue<long long>(buffer, key.modified);
+      writeValue<unsigned long long>(buffer, key.content);
+      writeValue<unsigned long long>(buffer, key.config);
+      writeValue<unsigned int>(buffer, frames.size());
+
+      for (const auto &frame: frames)
+      {
+         writeValue<unsigned short>(buffer, frame.techType());
+         writeValue<unsigned short>(buffer, frame.frameType());
+         writeValue<unsigned short>(buffer, frame.framePhase());
+         writeValue<unsigned short>(buffer, frame.frameFlags());
+         writeValue<unsigned int>(buffer, frame.frameRate());
+         writeValue<unsigned int>(buffer, frame.sampleRate());
+         writeValue<unsigned long long>(buffer, frame.sampleStart());
+         writeValue<unsigned long long>(buffer, frame.sampleEnd());
+         writeValue<double>(buffer, frame.timeStart());
+         writeValue<double>(buffer, frame.timeEnd());
+         writeValue<double>(buffer, frame.dateTime());
+         writeValue<unsigned short>(buffer, frame.limit());
+
+         for (unsigned int i = 0; i < frame.limit(); i++)
+            buffer.push_back(frame[i]);
+      }
+   }
+
+   static bool decode(const Key &key, const std::vector<unsigned char> &buffer, std::list<RawFrame> &frames)
+   {
+      const unsigned char *ptr = buffer.data();
+      const unsigned char *end = buffer.data() + buffer.size();
+
+      unsigned int magic, format, count;
+      Key stored {};
+
+      if (!readValue(ptr, end, magic) || !readValue(ptr, end, format) || !readValue(ptr, end, stored.version) || !readValue(ptr, end, stored.size) ||
+          !readValue(ptr, end, stored.modified) || !readValue(ptr, end, stored.content) || !readValue(ptr, end, stored.config) || !readValue(ptr, end, count))
+         return false;
+
+      // entries from other cache format, decoder version or signal file state are stale
+      if (magic != CACHE_MAGIC || format != CACHE_VERSION || stored != key)
+         return false;
+
+      for (unsigned int n = 0; n < count; n++)
+      {
+         unsigned short techType, frameType, framePhase, frameFlags, length;
+         unsigned int frameRate, sampleRate;
+         unsigned long long sampleStart, sampleEnd;
+         double timeStart, timeEnd, dateTime;
+
+         if (!readValue(ptr, end, techType) || !readValue(ptr, end, frameType) || !readValue(ptr, end, framePhase) || !readValue(ptr, end, frameFlags) ||
+             !readValue(ptr, end, frameRate) || !readValue(ptr, end, sampleRate) || !readValue(ptr, end, sampleStart) || !readValue(ptr, end, sampleEnd) ||
+             !readValue(ptr, end, timeStart) || !readValue(ptr, end, timeEnd) || !readValue(ptr, end, dateTime) || !readValue(ptr, end, length))
+            return false;
+
+         if (end - ptr < length)
+            return false;
+
+         RawFrame frame(length);
+
+         frame.setTechType(techType);
+         frame.setFrameType(frameType);
+         frame.setFramePhase(framePhase);
+         frame.setFrameFlags(frameFlags);
+         frame.setFrameRate(frameRate);
+         frame.setSampleRate(sampleRate);
+         frame.setSampleStart(sampleStart);
+         frame.setSampleEnd(sampleEnd);
+         frame.setTimeStart(timeStart);
+         frame.setTimeEnd(timeEnd);
+         frame.setDateTime(dateTime);
+
+         if (length)
+            frame.put(ptr, length);
+
+         frame.flip();
+
+         frames.push_back(frame);
+
+         ptr += length;
+      }
+
+      return ptr == end;
+   }
+};
+
+FrameCache::FrameCache() : impl(std::make_shared<Impl>("", 0))
+{
+}
+
+FrameCache::FrameCache(const std::string &directory, unsigned long long sizeLimit) : impl(std::make_shared<Impl>(directory, sizeLimit))
+{
+}
+
+unsigned long long FrameCache::contentHash(const std::string &file)
+{
+   std::error_code ec;
+
+   unsigned long long size = std::filesystem::file_size(file, ec);
+
+   if (ec)
+      return 0;
+
+   std::ifstream input(file, std::ios::binary);
+
+   if (!input.is_open())
+      return 0;
+
+   std::vector<char> block(HASH_BLOCK);
+
+   unsigned long long hash = hashBytes(HASH_OFFSET, &size, sizeof(size));
+
+   // whole file, any change in signal must give a different entry
+   while (input.good())
+   {
+      input.read(block.data(), static_cast<std::streamsize>(block.size()));
+
+      hash = hashWords(hash, block.data(), input.gcount());
+   }
+
+   return input.bad() ? 0 : hash;
+}
+
+unsigned long long FrameCache::configHash(const std::string &config)
+{
+   return hashBytes(HASH_OFFSET, config.data(), config.size());
+}
+
+FrameCache::Key FrameCache::key(const std::string &file, const std::string &config)
+{
+   std::error_code ec;
+
+   Key key {DECODER_VERSION, 0, 0, 0, configHash(config)};
+
+   key.size = std::filesystem::file_size(file, ec);
+
+   if (ec)
+      return key;
+
+   key.modified = static_cast<long long>(std::filesystem::last_write_time(file, ec).time_since_epoch().count());
+
+   if (ec)
+      return key;
+
+   key.content = contentHash(file);
+
+   return key;
+}
+
+const std::string &FrameCache::directory() const
+{
+   return impl->directory;
+}
+
+void FrameCache::setDirectory(const std::string &directory)
+{
+   impl->directory = directory;
+}
+
+unsigned long long FrameCache::sizeLimit() const
+{
+   return impl->sizeLimit;
+}
+
+void FrameCache::setSizeLimit(unsigned long long sizeLimit)
+{
+   impl->sizeLimit = sizeLimit;
+}
+
+bool FrameCache::contains(const Key &key) const
+{
+   std::error_code ec;
+
+   return !impl->directory.empty() && std::filesystem::is_regular_file(impl->entryPath(key), ec);
+}
+
+bool FrameCache::load(const Key &key, std::list<RawFrame> &frames)
+{
+   return impl->load(key, frames);
+}
+
+bool FrameCache::store(const Key &key, const std::list<RawFrame> &frames)
+{
+   return impl->store(key, frames);
+}
+
+bool FrameCache::invalidate(const Key &key)
+{
+   std::error_code ec;
+
+   return !impl->directory.empty() && std::filesystem::remove(impl->entryPath(key), ec);
+}
+
+int FrameCache::invalidate(unsigned long long content)
+{
+   char prefix[32];
+
+   snprintf(prefix, sizeof(prefix), "%016llx-", content);
+
+   return impl->remove([&](const std::filesystem::path &path) {
+      return path.filename().string().rfind(prefix, 0) == 0;
+   });
+}
+
+int FrameCache::evict()
+{
+   return impl->evict();
+}
+
+void FrameCache::clear()
+{
+   impl->remove([](const std::filesystem::path &) {
+      return true;
+   });
+}
+
+unsigned long long FrameCache::size() const
+{
+   std::error_code ec;
+
+   unsigned long long total = 0;
+
+   for (const auto &entry: impl->list())
+      total += entry.file_size(ec);
+
+   return total;
+}
+
+int FrameCache::entries() const
+{
+   return static_cast<int>(impl->list().size());
+}
+
+}
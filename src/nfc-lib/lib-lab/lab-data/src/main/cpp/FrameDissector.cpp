@@ -0,0 +1,1247 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <algorithm>
+
+#include <lab/data/FrameDissector.h>
+
+namespace lab {
+
+// same order as FrameDissector::Field
+static const char *FIELD_NAMES[] = {
+      "(unk)", "",
+      "REQA", "WUPA", "HLTA", "SEL1", "SEL2", "SEL3", "RATS", "PPS", "AUTH(A)", "AUTH(B)", "VASUP-A", "ATQA", "SAK", "ATS", "ATV-A",
+      "REQB", "WUPB", "ATTRIB", "HLTB", "INIT", "READ", "WRITE", "GET UID", "SELECT", "VASUP-B", "ATQB",
+      "REQC", "ATQC", "CMD",
+      "Inventory", "StayQuiet", "ReadBlock", "WriteBlock", "LockBlock", "ReadBlocks", "WriteBlocks", "Select", "Reset", "WriteAFI", "LockAFI", "WriteDSFID", "LockDSFID", "SysInfo", "GetSecurity", "CMD",
+      "I-Block", "R(ACK)", "R(NACK)", "S-Block", "VCC", "RST", "ATR", "TPDU",
+      "ACK", "AFI", "APDU", "APP", "BCC", "BLOCK", "CID", "CLA", "CMD", "COUNT", "CRC", "CT", "DATA", "DSFID", "ERROR", "FLAGS", "FIRST", "HEADER", "HIST", "IC", "ID", "INF", "INFO", "INS", "LC", "LE", "LEN", "LRC", "MASK", "MBLI", "MEMORY", "MLEN", "NAD", "NULL", "NVB",
+      "P1", "P2", "P3", "PARAM", "PARAM1", "PARAM2", "PARAM3", "PARAM4", "PARAMS", "PCB", "PPS0", "PPS1", "PROTO", "PUPI", "SW", "T0", "TA", "TB", "TC", "TD", "TL", "TS", "TCK", "TOKEN", "UID"
+};
+
+static_assert(sizeof(FIELD_NAMES) / sizeof(FIELD_NAMES[0]) == FrameDissector::FieldCount, "field names out of sync");
+
+struct FrameDissector::Impl
+{
+   typedef bool (Impl::*Handler)();
+
+   /*
+    * Dispatch table for one technology, requests indexed by command code, responses by last command
+    */
+   struct Dispatch
+   {
+      Handler request[256];
+      Handler response[256];
+   };
+
+   // output nodes for current frame
+   std::vector<Node> *nodes = nullptr;
+
+   // current frame contents
+   const unsigned char *data = nullptr;
+   unsigned int size = 0;
+
+   // last request command and its technology, -1 if none
+   int lastCommand = -1;
+   unsigned int lastTech = 0;
+   unsigned int lastFlags = 0;
+
+   // first AUTH command for two pass Mifare authentication
+   int frameChain = 0;
+
+   void reset()
+   {
+      lastCommand = -1;
+      lastTech = 0;
+      lastFlags = 0;
+      frameChain = 0;
+   }
+
+   unsigned int dissect(const RawFrame &frame, std::vector<Node> &out)
+   {
+      out.clear();
+
+      if (frame.frameType() == NfcCarrierOn || frame.frameType() == NfcCarrierOff || frame.frameType() == NfcCarrierTrain)
+         return 0;
+
+      nodes = &out;
+      data = frame.limit() > 0 ? frame.data() : nullptr;
+      size = frame.limit();
+
+      switch (frame.techType())
+      {
+         case NfcATech:
+            dissectNfcA(frame);
+            break;
+         case NfcBTech:
+            dissectNfc(frame, nfcb(), 0, &Impl::isoDep, &Impl::isoDep);
+            break;
+         case NfcFTech:
+            dissectNfc(frame, nfcf(), 1, &Impl::requestCmdF, nullptr);
+            break;
+         case NfcVTech:
+            dissectNfc(frame, nfcv(), 1, &Impl::requestCmdV, &Impl::responseCmdV);
+            break;
+         case Iso7816Tech:
+            dissectIso7816(frame);
+            break;
+         default:
+            root(isPoll(frame) ? Unknown : Response, 0);
+            break;
+      }
+
+      // root covers whole frame and keeps the command code, NFC-F and NFC-V frames start with length or flags
+      unsigned int codeOffset = frame.techType() == NfcFTech || frame.techType() == NfcVTech ? 1 : 0;
+
+      if (!out.empty() && size > codeOffset)
+         out.front().value = data[codeOffset];
+
+      return out.size();
+   }
+
+   static bool isPoll(const RawFrame &frame)
+   {
+      return frame.frameType() == NfcPollFrame || frame.frameType() == IsoRequestFrame;
+   }
+
+   /*
+    * Generic NFC flow, command code at given offset selects the request handler and the last command
+    * selects the response handler, handlers reject frames with unexpected length before adding nodes.
+    * Unmatched requests and responses go to the technology fallbacks, if any.
+    */
+   void dissectNfc(const RawFrame &frame, const Dispatch &table, unsigned int codeOffset, Handler requestFallback, Handler responseFallback)
+   {
+      bool encrypted = frame.hasFrameFlags(Encrypted);
+
+      if (isPoll(frame))
+      {
+         Handler handler = size > codeOffset && !encrypted ? table.request[data[codeOffset]] : nullptr;
+
+         lastCommand = -1;
+
+         if (handler && (this->*handler)())
+         {
+            lastCommand = data[codeOffset];
+            lastTech = frame.techType();
+            lastFlags = nodes->front().flags & ~RequestFrame;
+         }
+         else if (encrypted || !(this->*requestFallback)())
+         {
+            root(Unknown, 0);
+         }
+      }
+      else
+      {
+         Handler handler = lastCommand >= 0 && lastTech == frame.techType() && !encrypted ? table.response[lastCommand] : nullptr;
+
+         if (!handler || !(this->*handler)())
+         {
+            if (encrypted || !responseFallback || !(this->*responseFallback)())
+               root(Response, 0);
+         }
+
+         lastCommand = -1;
+      }
+   }
+
+   void dissectNfcA(const RawFrame &frame)
+   {
+      // second part of Mifare AUTH carries the reader token
+      if (isPoll(frame) && (frameChain == 0x60 || frameChain == 0x61))
+      {
+         root(frameChain == 0x60 ? AUTHA : AUTHB, AuthFrame);
+         child(TOKEN, 0, size);
+         frameChain = 0;
+         return;
+      }
+
+      dissectNfc(frame, nfca(), 0, &Impl::isoDep, &Impl::isoDep);
+   }
+
+   void dissectIso7816(const RawFrame &frame)
+   {
+      switch (frame.frameType())
+      {
+         case IsoVccLow:
+         case IsoVccHigh:
+            root(VCC, 0);
+            return;
+
+         case IsoRstLow:
+         case IsoRstHigh:
+            root(RST, 0);
+            return;
+
+         case IsoATRFrame:
+            isoATR();
+            return;
+      }
+
+      if (isoPPS() || isoTPDU(frame) || isoBlock())
+         return;
+
+      root(isPoll(frame) ? Unknown : Response, 0);
+   }
+
+   /*
+    * Dispatch tables, built once
+    */
+   static const Dispatch &nfca()
+   {
+      static const Dispatch table = [] {
+         Dispatch t {};
+         t.request[0x26] = &Impl::requestREQA;
+         t.request[0x52] = &Impl::requestWUPA;
+         t.request[0x50] = &Impl::requestHLTA;
+         t.request[0x93] = t.request[0x95] = t.request[0x97] = &Impl::requestSELn;
+         t.request[0xE0] = &Impl::requestRATS;
+         t.request[0x60] = t.request[0x61] = &Impl::requestAUTH;
+         t.request[0x6A] = &Impl::requestVASUPA;
+         t.response[0x26] = t.response[0x52] = &Impl::responseATQA;
+         t.response[0x93] = t.response[0x95] = t.response[0x97] = &Impl::responseSELn;
+         t.response[0xE0] = &Impl::responseRATS;
+         t.response[0x6A] = &Impl::responseVASUPA;
+
+         for (int code = 0xD0; code <= 0xDF; code++)
+         {
+            t.request[code] = &Impl::requestPPS;
+            t.response[code] = &Impl::responseEmpty;
+         }
+
+         t.response[0x50] = t.response[0x60] = t.response[0x61] = &Impl::responseEmpty;
+
+         return t;
+      }();
+
+      return table;
+   }
+
+   static const Dispatch &nfcb()
+   {
+      static const Dispatch table = [] {
+         Dispatch t {};
+         t.request[0x05] = &Impl::requestREQB;
+         t.request[0x06] = &Impl::requestINIT;
+         t.request[0x08] = &Impl::requestREAD;
+         t.request[0x09] = &Impl::requestWRITE;
+         t.request[0x0B] = &Impl::requestGETUID;
+         t.request[0x0E] = &Impl::requestSELECT;
+         t.request[0x1D] = &Impl::requestATTRIB;
+         t.request[0x50] = &Impl::requestHLTB;
+         t.request[0x6A] = &Impl::requestVASUPB;
+         t.response[0x05] = t.response[0x6A] = &Impl::responseATQB;
+         t.response[0x06] = &Impl::responseINIT;
+         t.response[0x08] = &Impl::responseREAD;
+         t.response[0x09] = t.response[0x50] = &Impl::responseEmpty;
+         t.response[0x0B] = t.response[0x0E] = &Impl::responseUID;
+         t.response[0x1D] = &Impl::responseATTRIB;
+         return t;
+      }();
+
+      return table;
+   }
+
+   static const Dispatch &nfcf()
+   {
+      static const Dispatch table = [] {
+         Dispatch t {};
+         t.request[0x00] = &Impl::requestREQC;
+         t.response[0x00] = &Impl::responseREQC;
+         return t;
+      }();
+
+      return table;
+   }
+
+   static const Dispatch &nfcv()
+   {
+      static const Dispatch table = [] {
+         Dispatch t {};
+         t.request[0x01] = &Impl::requestInventory;
+         t.request[0x02] = &Impl::requestStayQuiet;
+
+         for (int code = 0x20; code <= 0x2C; code++)
+         {
+            t.request[code] = &Impl::requestCommandV;
+            t.response[code] = &Impl::responseCommandV;
+         }
+
+         t.response[0x01] = &Impl::responseInventory;
+         t.response[0x2B] = &Impl::responseSysInfo;
+         return t;
+      }();
+
+      return table;
+   }
+
+   /*
+    * Node emission
+    */
+   void root(unsigned int field, unsigned int flags)
+   {
+      nodes->push_back({static_cast<unsigned short>(field), 0, static_cast<unsigned char>(flags), 0, static_cast<unsigned short>(size), 0});
+   }
+
+   // child field, negative offset counts from frame end, discarded if it does not fit in the frame
+   Node *child(unsigned int field, int offset, int length, unsigned int depth = 1)
+   {
+      if (offset < 0)
+         offset += static_cast<int>(size);
+
+      if (offset < 0 || length <= 0 || offset + length > static_cast<int>(size))
+         return nullptr;
+
+      unsigned int value = 0;
+
+      if (length <= 4)
+      {
+         for (int i = 0; i < length; i++)
+            value = value << 8 | data[offset + i];
+      }
+
+      nodes->push_back({static_cast<unsigned short>(field), static_cast<unsigned char>(depth), 0, static_cast<unsigned short>(offset), static_cast<unsigned short>(length), value});
+
+      return &nodes->back();
+   }
+
+   void crc()
+   {
+      child(CRC, -2, 2);
+   }
+
+   /*
+    * NFC-A
+    */
+   bool requestREQA()
+   {
+      if (size != 1)
+         return false;
+
+      root(REQA, RequestFrame | SenseFrame);
+
+      return true;
+   }
+
+   bool requestWUPA()
+   {
+      if (size != 1)
+         return false;
+
+      root(WUPA, RequestFrame | SenseFrame);
+
+      return true;
+   }
+
+   bool requestHLTA()
+   {
+      if (size != 4)
+         return false;
+
+      root(HLTA, RequestFrame | SenseFrame);
+      crc();
+
+      return true;
+   }
+
+   bool requestSELn()
+   {
+      if (size < 2)
+         return false;
+
+      unsigned int nvb = data[1] >> 4;
+
+      root(data[0] == 0x93 ? SEL1 : data[0] == 0x95 ? SEL2 : SEL3, RequestFrame | SelectionFrame);
+
+      // number of valid bytes, upper nibble only
+      child(NVB, 1, 1)->value = nvb;
+
+      if (nvb == 7 && size >= 9)
+      {
+         // cascade tag
+         if (data[2] == 0x88)
+         {
+            child(CT, 2, 1);
+            child(UID, 3, 3);
+         }
+         else
+         {
+            child(UID, 2, 4);
+         }
+
+         child(BCC, 6, 1);
+         crc();
+      }
+
+      return true;
+   }
+
+   bool requestRATS()
+   {
+      if (size != 4)
+         return false;
+
+      root(RATS, RequestFrame | SelectionFrame);
+      child(PARAM, 1, 1);
+      crc();
+
+      return true;
+   }
+
+   bool requestPPS()
+   {
+      if (size != 5)
+         return false;
+
+      root(PPS, RequestFrame | SelectionFrame);
+      child(CID, 0, 1)->value = data[0] & 0x0F;
+      child(PPS0, 1, 1);
+
+      if (data[1] & 0x10)
+         child(PPS1, 2, 1);
+
+      crc();
+
+      return true;
+   }
+
+   bool requestAUTH()
+   {
+      if (size != 4)
+         return false;
+
+      root(data[0] == 0x60 ? AUTHA : AUTHB, RequestFrame | AuthFrame);
+      child(BLOCK, 1, 1);
+      crc();
+
+      frameChain = data[0];
+
+      return true;
+   }
+
+   bool requestVASUPA()
+   {
+      if (size < 4)
+         return false;
+
+      root(VASUPA, RequestFrame | SenseFrame);
+      child(PARAM, 1, 1);
+      child(DATA, 2, size - 4);
+      crc();
+
+      return true;
+   }
+
+   bool responseATQA()
+   {
+      if (size != 2)
+         return false;
+
+      root(Response, ResponseFrame | lastFlags);
+
+      // transmitted LSB first
+      child(ATQA, 0, 2)->value = data[1] << 8 | data[0];
+
+      return true;
+   }
+
+   bool responseSELn()
+   {
+      root(Response, ResponseFrame | lastFlags);
+
+      if (size == 5)
+      {
+         // cascade tag
+         if (data[0] == 0x88)
+         {
+            child(CT, 0, 1);
+            child(UID, 1, 3);
+         }
+         else
+         {
+            child(UID, 0, 4);
+         }
+
+         child(BCC, 4, 1);
+      }
+      else if (size == 3)
+      {
+         child(SAK, 0, 1);
+         child(CRC, 1, 2);
+      }
+
+      return true;
+   }
+
+   bool responseRATS()
+   {
+      if (size < 3)
+         return false;
+
+      unsigned int tl = data[0];
+
+      root(Response, ResponseFrame | lastFlags);
+      child(TL, 0, 1);
+
+      if (child(ATS, 1, size - 3) && tl > 1 && tl <= size - 2)
+      {
+         unsigned int t0 = data[1];
+         unsigned int offset = 2;
+
+         child(T0, 1, 1, 2);
+
+         if ((t0 & 0x10) && offset < tl)
+            child(TA, offset++, 1, 2);
+
+         if ((t0 & 0x20) && offset < tl)
+            child(TB, offset++, 1, 2);
+
+         if ((t0 & 0x40) && offset < tl)
+            child(TC, offset++, 1, 2);
+
+         if (offset < tl)
+            child(HIST, offset, tl - offset, 2);
+      }
+
+      crc();
+
+      return true;
+   }
+
+   bool responseVASUPA()
+   {
+      if (size != 2)
+         return false;
+
+      root(Response, ResponseFrame | lastFlags);
+
+      // transmitted LSB first
+      child(ATV, 0, 2)->value = data[1] << 8 | data[0];
+
+      return true;
+   }
+
+   // response without contents other than CRC
+   bool responseEmpty()
+   {
+      root(Response, ResponseFrame | lastFlags);
+      crc();
+
+      return true;
+   }
+
+   /*
+    * NFC-B
+    */
+   bool requestREQB()
+   {
+      if (size != 5)
+         return false;
+
+      root(data[2] & 0x08 ? WUPB : REQB, RequestFrame | SenseFrame);
+      child(AFI, 1, 1);
+      child(PARAM, 2, 1);
+      crc();
+
+      return true;
+   }
+
+   bool requestINIT()
+   {
+      if (size < 2 || data[1] != 0x00)
+         return false;
+
+      root(INIT, RequestFrame | SelectionFrame);
+      crc();
+
+      return true;
+   }
+
+   bool requestREAD()
+   {
+      if (size != 4)
+         return false;
+
+      root(READ, RequestFrame | ApplicationFrame);
+      child(BLOCK, 1, 1);
+      crc();
+
+      return true;
+   }
+
+   bool requestWRITE()
+   {
+      if (size != 8)
+         return false;
+
+      root(WRITE, RequestFrame | ApplicationFrame);
+      child(BLOCK, 1, 1);
+      child(DATA, 2, 4);
+      crc();
+
+      return true;
+   }
+
+   bool requestGETUID()
+   {
+      if (size != 3)
+         return false;
+
+      root(GETUID, RequestFrame | SelectionFrame);
+      crc();
+
+      return true;
+   }
+
+   bool requestSELECT()
+   {
+      if (size != 4)
+         return false;
+
+      root(SELECT, RequestFrame | SelectionFrame);
+      child(ID, 1, 1);
+      crc();
+
+      return true;
+   }
+
+   bool requestATTRIB()
+   {
+      if (size < 11)
+         return false;
+
+      root(ATTRIB, RequestFrame | SenseFrame);
+      child(ID, 1, 4);
+      child(PARAM1, 5, 1);
+      child(PARAM2, 6, 1);
+      child(PARAM3, 7, 1);
+      child(PARAM4, 8, 1);
+      child(INF, 9, size - 11);
+      crc();
+
+      return true;
+   }
+
+   bool requestHLTB()
+   {
+      if (size != 7)
+         return false;
+
+      root(HLTB, RequestFrame | SenseFrame);
+      child(PUPI, 1, 4);
+      crc();
+
+      return true;
+   }
+
+   bool requestVASUPB()
+   {
+      if (size < 4)
+         return false;
+
+      root(VASUPB, RequestFrame | SenseFrame);
+      child(PARAM, 1, 1);
+      child(DATA, 2, size - 4);
+      crc();
+
+      return true;
+   }
+
+   bool responseATQB()
+   {
+      if (size < 12)
+         return false;
+
+      root(Response, ResponseFrame | lastFlags);
+
+      if (Node *atqb = child(ATQB, 0, size - 2))
+      {
+         atqb->value = data[0];
+
+         child(PUPI, 1, 4, 2);
+         child(APP, 5, 4, 2);
+         child(PROTO, 9, size - 11, 2);
+      }
+
+      crc();
+
+      return true;
+   }
+
+   bool responseINIT()
+   {
+      root(Response, ResponseFrame | lastFlags);
+      child(ID, 0, 1);
+      crc();
+
+      return true;
+   }
+
+   bool responseREAD()
+   {
+      root(Response, ResponseFrame | lastFlags);
+      child(DATA, 0, 4);
+      crc();
+
+      return true;
+   }
+
+   bool responseUID()
+   {
+      root(Response, ResponseFrame | lastFlags);
+      child(UID, 0, 8);
+      crc();
+
+      return true;
+   }
+
+   bool responseATTRIB()
+   {
+      if (size < 3)
+         return false;
+
+      root(Response, ResponseFrame | lastFlags);
+      child(MBLI, 0, 1)->value = data[0] >> 4;
+      child(CID, 0, 1)->value = data[0] & 0x0F;
+      child(INF, 1, size - 3);
+      crc();
+
+      return true;
+   }
+
+   /*
+    * NFC-F, first byte is frame length and second command code
+    */
+   bool requestREQC()
+   {
+      if (size != 8)
+         return false;
+
+      root(REQC, RequestFrame | SenseFrame);
+      child(LEN, 0, 1);
+      child(CMD, 1, 1);
+      child(PARAM, 2, 4);
+      crc();
+
+      return true;
+   }
+
+   bool requestCmdF()
+   {
+      if (size < 2)
+         return false;
+
+      root(CMDF, RequestFrame);
+      child(LEN, 0, 1);
+      child(CMD, 1, 1);
+
+      // commands other than polling are addressed by IDm
+      if (child(UID, 2, 8))
+         child(DATA, 10, size - 12);
+
+      crc();
+
+      return true;
+   }
+
+   bool responseREQC()
+   {
+      if (size < 18)
+         return false;
+
+      root(Response, ResponseFrame | lastFlags);
+      child(LEN, 0, 1);
+      child(ATQC, 1, 1);
+      child(UID, 2, 8);
+      child(PARAM, 10, 8);
+      crc();
+
+      return true;
+   }
+
+   /*
+    * NFC-V, first byte is request flags and second command code
+    */
+   unsigned int requestHeaderV()
+   {
+      child(FLAGS, 0, 1);
+      child(CMD, 1, 1);
+
+      // addressed requests include UID
+      if ((data[0] & 0x24) == 0x20 && child(UID, 2, 8))
+         return 10;
+
+      return 2;
+   }
+
+   bool requestInventory()
+   {
+      if (size < 5)
+         return false;
+
+      root(Inventory, RequestFrame | SelectionFrame);
+
+      child(FLAGS, 0, 1);
+      child(CMD, 1, 1);
+
+      unsigned int offset = 2;
+
+      if ((data[0] & 0x14) == 0x14)
+         child(AFI, offset++, 1);
+
+      if (Node *mlen = child(MLEN, offset++, 1))
+      {
+         unsigned int bits = mlen->value;
+
+         child(MASK, offset, (bits >> 3) + ((bits & 0x7) ? 1 : 0));
+      }
+
+      crc();
+
+      return true;
+   }
+
+   bool requestStayQuiet()
+   {
+      if (size != 12)
+         return false;
+
+      root(StayQuiet, RequestFrame | SelectionFrame);
+      child(FLAGS, 0, 1);
+      child(CMD, 1, 1);
+      child(UID, 2, 8);
+      crc();
+
+      return true;
+   }
+
+   // commands 0x20 to 0x2C, parameters after optional UID depend only on command code
+   bool requestCommandV()
+   {
+      static const unsigned short names[] = {ReadBlock, WriteBlock, LockBlock, ReadBlocks, WriteBlocks, SelectV, ResetV, WriteAFI, LockAFI, WriteDSFID, LockDSFID, SysInfo, GetSecurity};
+
+      if (size < 4)
+         return false;
+
+      unsigned int code = data[1];
+
+      root(names[code - 0x20], RequestFrame | (code == 0x25 ? SelectionFrame : ApplicationFrame));
+
+      unsigned int offset = requestHeaderV();
+
+      switch (code)
+      {
+         case 0x20:
+         case 0x22:
+            child(BLOCK, offset, 1);
+            break;
+
+         case 0x21:
+            child(BLOCK, offset, 1);
+            child(DATA, offset + 1, static_cast<int>(size - offset) - 3);
+            break;
+
+         case 0x23:
+         case 0x2C:
+            child(FIRST, offset, 1);
+            child(COUNT, offset + 1, 1);
+            break;
+
+         case 0x24:
+            child(FIRST, offset, 1);
+            child(COUNT, offset + 1, 1);
+            child(DATA, offset + 2, static_cast<int>(size - offset) - 4);
+            break;
+
+         case 0x27:
+            child(AFI, offset, 1);
+            break;
+
+         case 0x29:
+            child(DSFID, offset, 1);
+            break;
+      }
+
+      crc();
+
+      return true;
+   }
+
+   bool requestCmdV()
+   {
+      if (size < 4)
+         return false;
+
+      root(CMDV, RequestFrame);
+
+      unsigned int offset = requestHeaderV();
+
+      child(DATA, offset, static_cast<int>(size - offset) - 2);
+      crc();
+
+      return true;
+   }
+
+   // NFC-V responses do not take request type, only inventory answers are sense frames
+   bool responseInventory()
+   {
+      if (size != 12)
+         return false;
+
+      root(Response, ResponseFrame | SenseFrame);
+      child(FLAGS, 0, 1);
+      child(DSFID, 1, 1);
+      child(UID, 2, 8);
+      crc();
+
+      return true;
+   }
+
+   bool responseCommandV()
+   {
+      if (size < 3)
+         return false;
+
+      root(Response, ResponseFrame);
+      child(FLAGS, 0, 1);
+
+      if (data[0] & 0x01)
+         child(ERROR, 1, 1);
+      else
+         child(DATA, 1, size - 3);
+
+      crc();
+
+      return true;
+   }
+
+   bool responseSysInfo()
+   {
+      if (size < 3)
+         return false;
+
+      root(Response, ResponseFrame);
+      child(FLAGS, 0, 1);
+
+      if (data[0] & 0x01)
+      {
+         child(ERROR, 1, 1);
+      }
+      else if (child(INFO, 1, 1) && child(UID, 2, 8))
+      {
+         unsigned int info = data[1];
+         unsigned int offset = 10;
+
+         // optional fields announced by information flags, in this order
+         if (info & 0x01)
+            child(DSFID, offset++, 1);
+
+         if (info & 0x02)
+            child(AFI, offset++, 1);
+
+         if (info & 0x04)
+         {
+            child(MEMORY, offset, 2);
+            offset += 2;
+         }
+
+         if (info & 0x08)
+            child(IC, offset, 1);
+      }
+
+      crc();
+
+      return true;
+   }
+
+   // response to unknown or custom command
+   bool responseCmdV()
+   {
+      if (size < 3)
+         return false;
+
+      root(Response, ResponseFrame);
+      child(FLAGS, 0, 1);
+
+      if (data[0] & 0x01)
+         child(ERROR, 1, 1);
+      else
+         child(PARAMS, 1, size - 3);
+
+      crc();
+
+      return true;
+   }
+
+   /*
+    * ISO-DEP blocks, shared by NFC-A and NFC-B
+    */
+   bool isoDep()
+   {
+      if (size < 3)
+         return false;
+
+      unsigned int pcb = data[0];
+      unsigned int offset = 1;
+
+      if ((pcb & 0xE2) == 0x02 && size >= 4)
+         root(IBlock, ApplicationFrame);
+      else if ((pcb & 0xE6) == 0xA2 && size == 3)
+         root(pcb & 0x10 ? RNack : RAck, ApplicationFrame);
+      else if ((pcb & 0xC7) == 0xC2 && size <= 4)
+         root(SBlock, ApplicationFrame);
+      else
+         return false;
+
+      child(PCB, 0, 1);
+
+      // CID in lower nibble
+      if (pcb & 0x08)
+      {
+         if (Node *cid = child(CID, offset++, 1))
+            cid->value &= 0x0F;
+      }
+
+      // NAD only allowed in I-blocks
+      if ((pcb & 0xC0) == 0x00 && (pcb & 0x04))
+         child(NAD, offset++, 1);
+
+      if (offset + 2 < size)
+      {
+         unsigned int length = size - offset - 2;
+
+         if ((pcb & 0xC0) == 0x00)
+         {
+            if (isApdu(offset, length))
+               apdu(offset, length);
+            else
+               child(DATA, offset, length);
+         }
+         else
+         {
+            child(INF, offset, length);
+         }
+      }
+
+      crc();
+
+      return true;
+   }
+
+   bool isApdu(unsigned int offset, unsigned int length) const
+   {
+      // CLA INS P1 P2 LC, followed by LC bytes and optional LE
+      return length >= 5 && length >= data[offset + 4] + 5u && length <= data[offset + 4] + 6u;
+   }
+
+   void apdu(unsigned int offset, unsigned int length)
+   {
+      unsigned int lc = data[offset + 4];
+
+      child(APDU, offset, length);
+      child(CLA, offset, 1, 2);
+      child(INS, offset + 1, 1, 2);
+      child(P1, offset + 2, 1, 2);
+      child(P2, offset + 3, 1, 2);
+      child(LC, offset + 4, 1, 2);
+
+      if (length > lc + 5)
+         child(LE, offset + length - 1, 1, 2);
+
+      if (lc > 0)
+         child(DATA, offset + 5, lc, 2);
+   }
+
+   /*
+    * ISO7816
+    */
+   void isoATR()
+   {
+      root(ATR, 0);
+
+      if (!child(TS, 0, 1) || !child(T0, 1, 1))
+         return;
+
+      unsigned int y = data[1] >> 4;
+      unsigned int k = data[1] & 0x0F;
+      unsigned int offset = 2;
+      bool tck = false;
+
+      // follow interface bytes chain, each TD announces the next group
+      while (y && offset < size)
+      {
+         if ((y & 1) && offset < size)
+            child(TA, offset++, 1);
+
+         if ((y & 2) && offset < size)
+            child(TB, offset++, 1);
+
+         if ((y & 4) && offset < size)
+            child(TC, offset++, 1);
+
+         if ((y & 8) && offset < size)
+         {
+            unsigned int td = data[offset];
+
+            child(TD, offset++, 1);
+
+            tck |= (td & 0x0F) != 0;
+            y = td >> 4;
+         }
+         else
+         {
+            y = 0;
+         }
+      }
+
+      if (k > 0 && child(HIST, offset, std::min(k, size > offset ? size - offset : 0)))
+         offset += k;
+
+      if (tck)
+         child(TCK, offset, 1);
+   }
+
+   bool isoPPS()
+   {
+      if (size < 3 || size > 6 || data[0] != 0xFF)
+         return false;
+
+      unsigned int pps0 = data[1];
+      unsigned int offset = 2;
+
+      root(PPS, 0);
+      child(PPS0, 1, 1);
+
+      // PPS1 to PPS3, only PPS1 has a dedicated field
+      for (unsigned int mask = 0x10; mask <= 0x40; mask <<= 1)
+      {
+         if ((pps0 & mask) && offset < size - 1)
+            child(mask == 0x10 ? PPS1 : PARAM, offset++, 1);
+      }
+
+      child(TCK, -1, 1);
+
+      return true;
+   }
+
+   bool isoTPDU(const RawFrame &frame)
+   {
+      if (frame.frameType() != IsoExchangeFrame || size < 5)
+         return false;
+
+      unsigned int ins = data[1];
+      unsigned int p3 = data[4];
+
+      root(TPDU, 0);
+      child(HEADER, 0, 5);
+      child(CLA, 0, 1, 2);
+      child(INS, 1, 1, 2);
+      child(P1, 2, 1, 2);
+      child(P2, 3, 1, 2);
+      child(P3, 4, 1, 2);
+
+      for (unsigned int offset = 5; offset < size; offset++)
+      {
+         unsigned int proc = data[offset];
+
+         // NULL procedure byte, card requests more time
+         if (proc == 0x60)
+         {
+            child(NullByte, offset, 1);
+            continue;
+         }
+
+         // status word ends the exchange
+         if ((proc & 0xF0) == 0x60 || (proc & 0xF0) == 0x90)
+         {
+            child(SW, offset, 2);
+            break;
+         }
+
+         // ACK with INS, all remaining data follows
+         if (proc == ins)
+         {
+            child(ACK, offset, 1);
+            child(DATA, offset + 1, std::min(p3, size - offset - 1));
+            offset += p3;
+         }
+
+         // ACK with complemented INS, only one byte follows
+         else if (proc == (ins ^ 0xFF))
+         {
+            child(ACK, offset, 1);
+            child(DATA, offset + 1, 1);
+            offset += 1;
+         }
+      }
+
+      return true;
+   }
+
+   bool isoBlock()
+   {
+      if (size < 4)
+         return false;
+
+      unsigned int pcb = data[1];
+      unsigned int len = data[2];
+
+      if (!(pcb & 0x80))
+         root(IBlock, ApplicationFrame);
+      else if ((pcb & 0xC0) == 0x80)
+         root(pcb & 0x10 ? RNack : RAck, ApplicationFrame);
+      else
+         root(SBlock, ApplicationFrame);
+
+      child(NAD, 0, 1);
+      child(PCB, 1, 1);
+      child(LEN, 2, 1);
+      child(INF, 3, len);
+
+      // epilogue is LRC or CRC
+      if (3 + len == size - 1)
+         child(LRC, -1, 1);
+      else
+         crc();
+
+      return true;
+   }
+};
+
+FrameDissector::FrameDissector() : impl(std::make_shared<Impl>())
+{
+}
+
+void FrameDissector::reset()
+{
+   impl->reset();
+}
+
+unsigned int FrameDissector::dissect(const RawFrame &frame, std::vector<Node> &nodes)
+{
+   return impl->dissect(frame, nodes);
+}
+
+const char *FrameDissector::name(unsigned int field)
+{
+   return field < FieldCount ? FIELD_NAMES[field] : "";
+}
+
+}
@@ -0,0 +1,594 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <cctype>
+#include <cstdlib>
+#include <map>
+
+#include <rt/Logger.h>
+
+#include <lab/data/FrameFilter.h>
+
+namespace lab {
+
+enum FilterKind
+{
+   FilterTech,
+   FilterType,
+   FilterPhase,
+   FilterFlags,
+   FilterLength,
+   FilterRate,
+   FilterTime,
+   FilterByte,
+   FilterStarts,
+   FilterContains
+};
+
+enum FilterOp
+{
+   OpEqual,
+   OpNotEqual,
+   OpLess,
+   OpLessEqual,
+   OpGreater,
+   OpGreaterEqual
+};
+
+struct FilterPredicate
+{
+   int kind;
+   int op;
+   bool negate;
+   unsigned int index;
+   unsigned int mask;
+   double value;
+   unsigned int patternOffset;
+   unsigned int patternLength;
+};
+
+struct FilterClause
+{
+   // clause text for statistics
+   std::string text;
+
+   // predicates joined by "or"
+   std::vector<FilterPredicate> predicates;
+
+   // dropped frames
+   unsigned long long dropped;
+};
+
+static const std::map<std::string, unsigned int> filterTechNames {
+   {"nfca", NfcATech},
+   {"nfcb", NfcBTech},
+   {"nfcf", NfcFTech},
+   {"nfcv", NfcVTech},
+   {"iso7816", Iso7816Tech},
+};
+
+static const std::map<std::string, unsigned int> filterTypeNames {
+   {"poll", NfcPollFrame},
+   {"listen", NfcListenFrame},
+   {"carrier-on", NfcCarrierOn},
+   {"carrier-off", NfcCarrierOff},
+   {"carrier-train", NfcCarrierTrain},
+   {"vcc-low", IsoVccLow},
+   {"vcc-high", IsoVccHigh},
+   {"rst-low", IsoRstLow},
+   {"rst-high", IsoRstHigh},
+   {"atr", IsoATRFrame},
+   {"request", IsoRequestFrame},
+   {"response", IsoResponseFrame},
+   {"exchange", IsoExchangeFrame},
+};
+
+static const std::map<std::string, unsigned int> filterPhaseNames {
+   {"carrier", NfcCarrierPhase},
+   {"selection", NfcSelectionPhase},
+   {"application", NfcApplicationPhase},
+};
+
+static const std::map<std::string, unsigned int> filterFlagNames {
+   {"short", ShortFrame},
+   {"encrypted", Encrypted},
+   {"truncated", Truncated},
+   {"parity-error", ParityError},
+   {"crc-error", CrcError},
+   {"sync-error", SyncError},
+};
+
+static const std::map<std::string, int> filterOpNames {
+   {"==", OpEqual},
+   {"!=", OpNotEqual},
+   {"<", OpLess},
+   {"<=", OpLessEqual},
+   {">", OpGreater},
+   {">=", OpGreaterEqual},
+};
+
+struct FrameFilter::Impl
+{
+   rt::Logger *log = rt::Logger::getLogger("decoder.FrameFilter");
+
+   // source expression
+   std::string expression;
+
+   // compiled clauses joined by "and"
+   std::vector<FilterClause> clauses;
+
+   // byte patterns for all predicates
+   std::vector<unsigned char> patterns;
+
+   // accepted frames
+   unsigned long long accepted = 0;
+
+   /*
+    * Expression compiler, tokens are consumed from source string
+    */
+   struct Compiler
+   {
+      const std::string &source;
+
+      std::vector<FilterClause> clauses;
+
+      std::vector<unsigned char> patterns;
+
+      std::string error;
+
+      size_t position = 0;
+
+      explicit Compiler(const std::string &source) : source(source)
+      {
+      }
+
+      bool compile()
+      {
+         while (true)
+         {
+            skipSpaces();
+
+            if (position == source.size())
+               break;
+
+            if (!clauses.empty() && !accept("and") && !accept("&&"))
+               return fail("expected 'and'");
+
+            if (!parseClause())
+               return false;
+         }
+
+         return true;
+      }
+
+      bool parseClause()
+      {
+         FilterClause clause {};
+
+         skipSpaces();
+
+         size_t start = position;
+
+         do
+         {
+            FilterPredicate predicate {};
+
+            if (!parsePredicate(predicate))
+               return false;
+
+            clause.predicates.push_back(predicate);
+         }
+         while (accept("or") || accept("||"));
+
+         clause.text = source.substr(start, position - start);
+
+         while (!clause.text.empty() && std::isspace(static_cast<unsigned char>(clause.text.back())))
+            clause.text.pop_back();
+
+         clauses.push_back(clause);
+
+         return true;
+      }
+
+      bool parsePredicate(FilterPredicate &predicate)
+      {
+         predicate.mask = 0xFF;
+
+         while (accept("not") || accept("!"))
+            predicate.negate = !predicate.negate;
+
+         std::string name = nextWord();
+
+         if (name == "tech")
+            return parseNamed(predicate, FilterTech, filterTechNames);
+
+         if (name == "type")
+            return parseNamed(predicate, FilterType, filterTypeNames);
+
+         if (name == "phase")
+            return parseNamed(predicate, FilterPhase, filterPhaseNames);
+
+         if (name == "length" || name == "len")
+            return parseCompare(predicate, FilterLength);
+
+         if (name == "rate")
+            return parseCompare(predicate, FilterRate);
+
+         if (name == "time")
+            return parseCompare(predicate, FilterTime);
+
+         if (name == "data")
+            return parseData(predicate);
+
+         auto flag = filterFlagNames.find(name);
+
+         if (flag != filterFlagNames.end())
+         {
+            predicate.kind = FilterFlags;
+            predicate.value = flag->second;
+            return true;
+         }
+
+         return fail("unknown predicate '" + name + "'");
+      }
+
+      bool parseNamed(FilterPredicate &predicate, int kind, const std::map<std::string, unsigned int> &names)
+      {
+         predicate.kind = kind;
+
+         if (!parseOp(predicate) || (predicate.op != OpEqual && predicate.op != OpNotEqual))
+            return fail("expected '==' or '!='");
+
+         std::string name = nextWord();
+
+         auto entry = names.find(name);
+
+         if (entry == names.end())
+            return fail("unknown value '" + name + "'");
+
+         predicate.value = entry->second;
+
+         return true;
+      }
+
+      bool parseCompare(FilterPredicate &predicate, int kind)
+      {
+         predicate.kind = kind;
+
+         if (!parseOp(predicate))
+            return fail("expected comparison operator");
+
+         return parseNumber(predicate.value);
+      }
+
+      bool parseData(FilterPredicate &predicate)
+      {
+         // data[i] [& mask] op value
+         if (accept("["))
+         {
+            double index;
+
+            if (!parseNumber(index) || !accept("]"))
+               return fail("expected 'data[index]'");
+
+            predicate.kind = FilterByte;
+            predicate.index = static_cast<unsigned int>(index);
+
+            if (accept("&"))
+            {
+               double mask;
+
+               if (!parseNumber(mask))
+                  return false;
+
+               predicate.mask = static_cast<unsigned int>(mask);
+            }
+
+            if (!parseOp(predicate))
+               return fail("expected comparison operator");
+
+            return parseNumber(predicate.value);
+         }
+
+         std::string name = nextWord();
+
+         if (name == "starts")
+            predicate.kind = FilterStarts;
+         else if (name == "contains")
+            predicate.kind = FilterContains;
+         else
+            return fail("expected 'starts', 'contains' or '[' after 'data'");
+
+         std::string hex = nextWord();
+
+         if (hex.empty() || hex.size() % 2 || hex.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+            return fail("invalid hex pattern '" + hex + "'");
+
+         predicate.patternOffset = patterns.size();
+         predicate.patternLength = hex.size() / 2;
+
+         for (size_t i = 0; i < hex.size(); i += 2)
+            patterns.push_back(static_cast<unsigned char>(std::strtoul(hex.substr(i, 2).c_str(), nullptr, 16)));
+
+         return true;
+      }
+
+      bool parseOp(FilterPredicate &predicate)
+      {
+         skipSpaces();
+
+         // two char operators first
+         for (int length = 2; length > 0; length--)
+         {
+            auto entry = filterOpNames.find(source.substr(position, length));
+
+            if (entry != filterOpNames.end())
+            {
+               predicate.op = entry->second;
+               position += length;
+               return true;
+            }
+         }
+
+         return false;
+      }
+
+      bool parseNumber(double &value)
+      {
+         skipSpaces();
+
+         const char *start = source.c_str() + position;
+         char *end = nullptr;
+
+         // hexadecimal values are integers, decimal values may have fraction for time
+         if (source.compare(position, 2, "0x") == 0 || source.compare(position, 2, "0X") == 0)
+            value = static_cast<double>(std::strtoul(start, &end, 16));
+         else
+            value = std::strtod(start, &end);
+
+         if (end == start)
+            return fail("expected number");
+
+         position += end - start;
+
+         return true;
+      }
+
+      bool accept(const std::string &token)
+      {
+         skipSpaces();
+
+         if (source.compare(position, token.size(), token) != 0)
+            return false;
+
+         // words must not be followed by other word characters
+         if (std::isalpha(static_cast<unsigned char>(token[0])) && position + token.size() < source.size() && isWordChar(source[position + token.size()]))
+            return false;
+
+         position += token.size();
+
+         return true;
+      }
+
+      std::string nextWord()
+      {
+         skipSpaces();
+
+         size_t start = position;
+
+         while (position < source.size() && isWordChar(source[position]))
+            position++;
+
+         return source.substr(start, position - start);
+      }
+
+      void skipSpaces()
+      {
+         while (position < source.size() && std::isspace(static_cast<unsigned char>(source[position])))
+            position++;
+      }
+
+      bool fail(const std::string &message)
+      {
+         if (error.empty())
+            error = message + " at position " + std::to_string(position);
+
+         return false;
+      }
+
+      static bool isWordChar(char c)
+      {
+         return std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_';
+      }
+   };
+
+   bool compile(const std::string &value)
+   {
+      Compiler compiler(value);
+
+      if (!compiler.compile())
+      {
+         log->warn("invalid filter expression [{}]: {}", {value, compiler.error});
+         return false;
+      }
+
+      expression = value;
+      clauses = std::move(compiler.clauses);
+      patterns = std::move(compiler.patterns);
+      accepted = 0;
+
+      log->info("frame filter set to [{}] with {} clauses", {expression, clauses.size()});
+
+      return true;
+   }
+
+   bool matches(const RawFrame &frame)
+   {
+      for (auto &clause: clauses)
+      {
+         bool match = false;
+
+         for (const auto &predicate: clause.predicates)
+         {
+            if ((match = evaluate(predicate, frame) != predicate.negate))
+               break;
+         }
+
+         if (!match)
+         {
+            clause.dropped++;
+            return false;
+         }
+      }
+
+      accepted++;
+
+      return true;
+   }
+
+   bool evaluate(const FilterPredicate &predicate, const RawFrame &frame) const
+   {
+      switch (predicate.kind)
+      {
+         case FilterTech:
+            return compare(frame.techType(), predicate.op, predicate.value);
+
+         case FilterType:
+            return compare(frame.frameType(), predicate.op, predicate.value);
+
+         case FilterPhase:
+            return compare(frame.framePhase(), predicate.op, predicate.value);
+
+         case FilterFlags:
+            return frame.hasFrameFlags(static_cast<unsigned int>(predicate.value));
+
+         case FilterLength:
+            return compare(frame.limit(), predicate.op, predicate.value);
+
+         case FilterRate:
+            return compare(frame.frameRate(), predicate.op, predicate.value);
+
+         case FilterTime:
+            return compare(frame.timeStart(), predicate.op, predicate.value);
+
+         case FilterByte:
+            return predicate.index < frame.limit() && compare(frame[predicate.index] & predicate.mask, predicate.op, predicate.value);
+
+         case FilterStarts:
+            return predicate.patternLength <= frame.limit() && matchAt(frame, 0, predicate);
+
+         case FilterContains:
+         {
+            for (unsigned int offset = 0; offset + predicate.patternLength <= frame.limit(); offset++)
+            {
+               if (matchAt(frame, offset, predicate))
+                  return true;
+            }
+
+            return false;
+         }
+
+         default:
+            return false;
+      }
+   }
+
+   bool matchAt(const RawFrame &frame, unsigned int offset, const FilterPredicate &predicate) const
+   {
+      for (unsigned int i = 0; i < predicate.patternLength; i++)
+      {
+         if (frame[offset + i] != patterns[predicate.patternOffset + i])
+            return false;
+      }
+
+      return true;
+   }
+
+   static bool compare(double a, int op, double b)
+   {
+      switch (op)
+      {
+         case OpEqual:
+            return a == b;
+         case OpNotEqual:
+            return a != b;
+         case OpLess:
+            return a < b;
+         case OpLessEqual:
+            return a <= b;
+         case OpGreater:
+            return a > b;
+         case OpGreaterEqual:
+            return a >= b;
+         default:
+            return false;
+      }
+   }
+};
+
+FrameFilter::FrameFilter() : impl(std::make_shared<Impl>())
+{
+}
+
+bool FrameFilter::compile(const std::string &expression)
+{
+   return impl->compile(expression);
+}
+
+bool FrameFilter::matches(const RawFrame &frame)
+{
+   return impl->matches(frame);
+}
+
+bool FrameFilter::isEmpty() const
+{
+   return impl->clauses.empty();
+}
+
+const std::string &FrameFilter::expression() const
+{
+   return impl->expression;
+}
+
+unsigned long long FrameFilter::accepted() const
+{
+   return impl->accepted;
+}
+
+std::vector<std::pair<std::string, unsigned long long>> FrameFilter::dropped() const
+{
+   std::vector<std::pair<std::string, unsigned long long>> result;
+
+   for (const auto &clause: impl->clauses)
+      result.emplace_back(clause.text, clause.dropped);
+
+   return result;
+}
+
+void FrameFilter::resetCounters()
+{
+   impl->accepted = 0;
+
+   for (auto &clause: impl->clauses)
+      clause.dropped = 0;
+}
+
+}
@@ -0,0 +1,737 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include <lab/data/FrameWriter.h>
+
+namespace lab {
+
+constexpr unsigned int STREAM_MAGIC = 0x53434E46; // "NFCS"
+constexpr unsigned int STREAM_VERSION = 1;
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+static const unsigned long long POWERS_OF_TEN[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+static const char *textTypeName(unsigned int type)
+{
+   switch (type)
+   {
+      case NfcCarrierOff:
+         return "CarrierOff";
+      case NfcCarrierOn:
+         return "CarrierOn";
+      case NfcCarrierTrain:
+         return "CarrierTrain";
+      case NfcPollFrame:
+         return "PCD->PICC";
+      case NfcListenFrame:
+         return "PICC->PCD";
+      default:
+         return "";
+   }
+}
+
+static const char *textTechName(unsigned int tech)
+{
+   switch (tech)
+   {
+      case NoneTech:
+         return "None";
+      case NfcATech:
+         return "NfcA";
+      case NfcBTech:
+         return "NfcB";
+      case NfcFTech:
+         return "NfcF";
+      case NfcVTech:
+         return "NfcV";
+      default:
+         return "";
+   }
+}
+
+// names shared with frame filter expressions
+static const char *typeName(unsigned int type)
+{
+   switch (type)
+   {
+      case NfcCarrierOff:
+         return "carrier-off";
+      case NfcCarrierOn:
+         return "carrier-on";
+      case NfcCarrierTrain:
+         return "carrier-train";
+      case NfcPollFrame:
+         return "poll";
+      case NfcListenFrame:
+         return "listen";
+      case IsoVccLow:
+         return "vcc-low";
+      case IsoVccHigh:
+         return "vcc-high";
+      case IsoRstLow:
+         return "rst-low";
+      case IsoRstHigh:
+         return "rst-high";
+      case IsoATRFrame:
+         return "atr";
+      case IsoRequestFrame:
+         return "request";
+      case IsoResponseFrame:
+         return "response";
+      case IsoExchangeFrame:
+         return "exchange";
+      default:
+         return "";
+   }
+}
+
+static const char *techName(unsigned int tech)
+{
+   switch (tech)
+   {
+      case NoneTech:
+         return "none";
+      case NfcATech:
+         return "nfca";
+      case NfcBTech:
+         return "nfcb";
+      case NfcFTech:
+         return "nfcf";
+      case NfcVTech:
+         return "nfcv";
+      case Iso7816Tech:
+         return "iso7816";
+      default:
+         return "";
+   }
+}
+
+static const char *phaseName(unsigned int phase)
+{
+   switch (phase)
+   {
+      case NfcCarrierPhase:
+         return "carrier";
+      case NfcSelectionPhase:
+         return "selection";
+      case NfcApplicationPhase:
+         return "application";
+      default:
+         return "";
+   }
+}
+
+static unsigned int bigEndian(const RawFrame &frame, unsigned int offset)
+{
+   return static_cast<unsigned int>(frame[offset]) << 24 | frame[offset + 1] << 16 | frame[offset + 2] << 8 | frame[offset + 3];
+}
+
+struct FrameWriter::Impl
+{
+   FILE *stream;
+
+   int format;
+
+   // output buffer and write position
+   std::vector<char> buffer;
+   unsigned int position = 0;
+
+   // flush interval and last flush time
+   std::chrono::milliseconds flushInterval;
+   std::chrono::steady_clock::time_point flushTime;
+
+   // stream header pending
+   bool header = true;
+
+   // protocol dissection, nodes are reused between frames
+   bool dissect = false;
+   FrameDissector dissector;
+   std::vector<FrameDissector::Node> nodes;
+
+   // APDU assembly, frame index is the position in output stream
+   bool assemble = false;
+   IsoDepAssembler assembler;
+
+   unsigned long long frames = 0;
+   unsigned long long exchanges = 0;
+   unsigned long long bytes = 0;
+
+   Impl(FILE *stream, int format, unsigned int bufferSize, unsigned int flushInterval) : stream(stream), format(format), buffer(bufferSize > 0 ? bufferSize : 1), flushInterval(flushInterval), flushTime(std::chrono::steady_clock::now())
+   {
+   }
+
+   ~Impl()
+   {
+      flush();
+   }
+
+   void write(const RawFrame &frame)
+   {
+      if (dissect && format != Binary)
+         dissector.dissect(frame, nodes);
+
+      // worst case record size, 3 characters per data byte plus fixed fields and dissection nodes
+      reserve(256 + frame.limit() * 3 + (dissect ? nodes.size() * 96 + frame.limit() * 2 : 0));
+
+      if (header)
+         writeHeader();
+
+      switch (format)
+      {
+         case Json:
+            writeJson(frame);
+            break;
+         case Csv:
+            writeCsv(frame);
+            break;
+         case Binary:
+            writeBinary(frame);
+            break;
+         default:
+            writeText(frame);
+            break;
+      }
+
+      // exchanges completed by this frame
+      if (assemble && (format == Text || format == Json))
+         writeCompleted(assembler.process(frame, static_cast<unsigned int>(frames)));
+
+      frames++;
+
+      poll();
+   }
+
+   void write(const IsoDepAssembler &source, const ApduExchange &exchange)
+   {
+      reserve(256 + (exchange.commandLength + exchange.responseLength) * 2);
+
+      if (header)
+         writeHeader();
+
+      switch (format)
+      {
+         case Json:
+            writeJson(source, exchange);
+            break;
+         case Text:
+            writeText(source, exchange);
+            break;
+         default:
+            return;
+      }
+
+      exchanges++;
+   }
+
+   void writeCompleted(int completed)
+   {
+      const std::vector<ApduExchange> &list = assembler.exchanges();
+
+      for (unsigned int i = list.size() - completed; i < list.size(); i++)
+         write(assembler, list[i]);
+   }
+
+   void close()
+   {
+      if (assemble && (format == Text || format == Json))
+         writeCompleted(assembler.flush());
+
+      flush();
+   }
+
+   bool poll()
+   {
+      if (position == 0 || std::chrono::steady_clock::now() - flushTime < flushInterval)
+         return false;
+
+      flush();
+
+      return true;
+   }
+
+   void flush()
+   {
+      if (position > 0)
+      {
+         bytes += fwrite(buffer.data(), 1, position, stream);
+
+         position = 0;
+      }
+
+      fflush(stream);
+
+      flushTime = std::chrono::steady_clock::now();
+   }
+
+   void reserve(unsigned int size)
+   {
+      if (position + size <= buffer.size())
+         return;
+
+      flush();
+
+      if (size > buffer.size())
+         buffer.resize(size);
+   }
+
+   void writeHeader()
+   {
+      header = false;
+
+      switch (format)
+      {
+         case Csv:
+            putString(dissect ? "time,end,type,tech,phase,rate,flags,data,dissect\n" : "time,end,type,tech,phase,rate,flags,data\n");
+            break;
+         case Binary:
+            putValue<unsigned int>(STREAM_MAGIC);
+            putValue<unsigned int>(STREAM_VERSION);
+            break;
+         default:
+            break;
+      }
+   }
+
+   void writeText(const RawFrame &frame)
+   {
+      // same layout as "%010.3f (%s) [%s@%.0f]: %02X ..."
+      putFixed(frame.timeStart(), 3, 10);
+      putChar(' ');
+      putChar('(');
+      putString(textTypeName(frame.frameType()));
+      putChar(')');
+      putChar(' ');
+
+      if (frame.frameType() == NfcPollFrame || frame.frameType() == NfcListenFrame)
+      {
+         putChar('[');
+         putString(textTechName(frame.techType()));
+         putChar('@');
+         putDecimal((frame.frameRate() + 500) / 1000);
+         putChar(']');
+         putChar(':');
+         putChar(' ');
+
+         for (unsigned int i = 0; i < frame.limit(); i++)
+         {
+            putHex(frame[i]);
+            putChar(' ');
+         }
+      }
+
+      // pulse count, period and width of carrier pulse train
+      else if (frame.frameType() == NfcCarrierTrain && frame.limit() >= 12)
+      {
+         putString("pulses=");
+         putDecimal(bigEndian(frame, 0));
+         putString(" period=");
+         putFixed(bigEndian(frame, 4) / 1E3, 3, 0);
+         putString("us width=");
+         putFixed(bigEndian(frame, 8) / 1E3, 3, 0);
+         putString("us ");
+      }
+
+      // command name and top level fields as NAME=HEX
+      if (dissect && !nodes.empty())
+      {
+         const char *command = FrameDissector::name(nodes.front().field);
+
+         putChar('|');
+
+         // responses have no command name
+         if (*command)
+         {
+            putChar(' ');
+            putString(command);
+         }
+
+         for (unsigned int i = 1; i < nodes.size(); i++)
+         {
+            const FrameDissector::Node &node = nodes[i];
+
+            if (node.depth != 1)
+               continue;
+
+            putChar(' ');
+            putString(FrameDissector::name(node.field));
+            putChar('=');
+
+            for (unsigned int n = 0; n < node.length; n++)
+               putHex(frame[node.offset + n]);
+         }
+      }
+
+      putChar('\n');
+   }
+
+   void writeJson(const RawFrame &frame)
+   {
+      putString("{\"time\":");
+      putFixed(frame.timeStart(), 6, 0);
+      putString(",\"end\":");
+      putFixed(frame.timeEnd(), 6, 0);
+      putString(",\"type\":\"");
+      putString(typeName(frame.frameType()));
+      putString("\",\"tech\":\"");
+      putString(techName(frame.techType()));
+      putString("\",\"phase\":\"");
+      putString(phaseName(frame.framePhase()));
+      putString("\",\"rate\":");
+      putDecimal(frame.frameRate());
+      putString(",\"flags\":");
+      putDecimal(frame.frameFlags());
+      putString(",\"data\":\"");
+
+      for (unsigned int i = 0; i < frame.limit(); i++)
+         putHex(frame[i]);
+
+      putChar('"');
+
+      if (dissect)
+      {
+         putString(",\"dissect\":[");
+
+         for (unsigned int i = 0; i < nodes.size(); i++)
+         {
+            const FrameDissector::Node &node = nodes[i];
+
+            if (i > 0)
+               putChar(',');
+
+            putString("{\"field\":\"");
+            putString(FrameDissector::name(node.field));
+            putString("\",\"depth\":");
+            putDecimal(node.depth);
+            putString(",\"offset\":");
+            putDecimal(node.offset);
+            putString(",\"length\":");
+            putDecimal(node.length);
+            putString(",\"value\":");
+            putDecimal(node.value);
+            putChar('}');
+         }
+
+         putChar(']');
+      }
+
+      putString("}\n");
+   }
+
+   void writeCsv(const RawFrame &frame)
+   {
+      putFixed(frame.timeStart(), 6, 0);
+      putChar(',');
+      putFixed(frame.timeEnd(), 6, 0);
+      putChar(',');
+      putString(typeName(frame.frameType()));
+      putChar(',');
+      putString(techName(frame.techType()));
+      putChar(',');
+      putString(phaseName(frame.framePhase()));
+      putChar(',');
+      putDecimal(frame.frameRate());
+      putChar(',');
+      putDecimal(frame.frameFlags());
+      putChar(',');
+
+      for (unsigned int i = 0; i < frame.limit(); i++)
+         putHex(frame[i]);
+
+      if (dissect)
+      {
+         putChar(',');
+
+         if (!nodes.empty())
+            putString(FrameDissector::name(nodes.front().field));
+      }
+
+      putChar('\n');
+   }
+
+   void writeText(const IsoDepAssembler &source, const ApduExchange &exchange)
+   {
+      // same prefix as frame lines, followed by frame range and reassembled APDUs
+      putFixed(exchange.timeStart, 3, 10);
+      putString(" (APDU) [");
+      putDecimal(exchange.commandFirst);
+      putChar('-');
+      putDecimal(exchange.responseBlocks ? exchange.responseLast : exchange.commandLast);
+      putString("]: > ");
+      putData(source, exchange.commandOffset, exchange.commandLength);
+      putString(" < ");
+      putData(source, exchange.responseOffset, exchange.responseLength);
+
+      if (exchange.commandBlocks > 1 || exchange.responseBlocks > 1)
+      {
+         putString(" blocks=");
+         putDecimal(exchange.commandBlocks);
+         putChar('+');
+         putDecimal(exchange.responseBlocks);
+      }
+
+      if (exchange.waitExtensions)
+      {
+         putString(" wtx=");
+         putDecimal(exchange.waitExtensions);
+      }
+
+      if (exchange.retransmissions)
+      {
+         putString(" retransmissions=");
+         putDecimal(exchange.retransmissions);
+      }
+
+      if (exchange.flags & ApduExchange::ResponseMissing)
+         putString(" response-missing");
+
+      if (exchange.flags & ApduExchange::ChainBroken)
+         putString(" chain-broken");
+
+      if (exchange.flags & ApduExchange::CrcError)
+         putString(" crc-error");
+
+      putChar('\n');
+   }
+
+   void writeJson(const IsoDepAssembler &source, const ApduExchange &exchange)
+   {
+      putString("{\"apdu\":{\"time\":");
+      putFixed(exchange.timeStart, 6, 0);
+      putString(",\"end\":");
+      putFixed(exchange.timeEnd, 6, 0);
+      putString(",\"first\":");
+      putDecimal(exchange.commandFirst);
+      putString(",\"last\":");
+      putDecimal(exchange.responseBlocks ? exchange.responseLast : exchange.commandLast);
+      putString(",\"command\":\"");
+      putData(source, exchange.commandOffset, exchange.commandLength);
+      putString("\",\"response\":\"");
+      putData(source, exchange.responseOffset, exchange.responseLength);
+      putString("\",\"commandBlocks\":");
+      putDecimal(exchange.commandBlocks);
+      putString(",\"responseBlocks\":");
+      putDecimal(exchange.responseBlocks);
+      putString(",\"wtx\":");
+      putDecimal(exchange.waitExtensions);
+      putString(",\"retransmissions\":");
+      putDecimal(exchange.retransmissions);
+      putString(",\"flags\":");
+      putDecimal(exchange.flags);
+      putString("}}\n");
+   }
+
+   void writeBinary(const RawFrame &frame)
+   {
+      putValue<unsigned short>(frame.techType());
+      putValue<unsigned short>(frame.frameType());
+      putValue<unsigned short>(frame.framePhase());
+      putValue<unsigned short>(frame.frameFlags());
+      putValue<unsigned int>(frame.frameRate());
+      putValue<unsigned int>(frame.sampleRate());
+      putValue<unsigned long long>(frame.sampleStart());
+      putValue<unsigned long long>(frame.sampleEnd());
+      putValue<double>(frame.timeStart());
+      putValue<double>(frame.timeEnd());
+      putValue<double>(frame.dateTime());
+      putValue<unsigned short>(frame.limit());
+
+      for (unsigned int i = 0; i < frame.limit(); i++)
+         putChar(static_cast<char>(frame[i]));
+   }
+
+   template <typename T>
+   void putValue(T value)
+   {
+      std::memcpy(buffer.data() + position, &value, sizeof(T));
+
+      position += sizeof(T);
+   }
+
+   void putChar(char c)
+   {
+      buffer[position++] = c;
+   }
+
+   void putString(const char *str)
+   {
+      while (*str)
+         buffer[position++] = *str++;
+   }
+
+   void putHex(unsigned int value)
+   {
+      buffer[position++] = HEX_DIGITS[(value >> 4) & 0xf];
+      buffer[position++] = HEX_DIGITS[value & 0xf];
+   }
+
+   void putData(const IsoDepAssembler &source, unsigned int offset, unsigned int length)
+   {
+      const std::vector<unsigned char> &data = source.data();
+
+      for (unsigned int i = 0; i < length; i++)
+         putHex(data[offset + i]);
+   }
+
+   void putDecimal(unsigned long long value, unsigned int width = 0)
+   {
+      char digits[24];
+      unsigned int count = 0;
+
+      do
+      {
+         digits[count++] = static_cast<char>('0' + value % 10);
+         value /= 10;
+      }
+      while (value > 0);
+
+      // zero padding up to width
+      while (count < width)
+         digits[count++] = '0';
+
+      while (count > 0)
+         buffer[position++] = digits[--count];
+   }
+
+   // fixed point number with zero padding to total width, equivalent to "%0<width>.<decimals>f"
+   void putFixed(double value, unsigned int decimals, unsigned int width)
+   {
+      if (!std::isfinite(value))
+      {
+         putChar('0');
+         return;
+      }
+
+      if (std::signbit(value) && value != 0)
+      {
+         putChar('-');
+         value = -value;
+         width = width > 0 ? width - 1 : 0;
+      }
+
+      unsigned long long scale = POWERS_OF_TEN[decimals];
+      unsigned long long scaled = std::llround(value * static_cast<double>(scale));
+      unsigned int integerWidth = width > decimals + 1 ? width - decimals - 1 : 0;
+
+      putDecimal(scaled / scale, integerWidth);
+
+      if (decimals > 0)
+      {
+         putChar('.');
+         putDecimal(scaled % scale, decimals);
+      }
+   }
+};
+
+FrameWriter::FrameWriter(FILE *stream, int format, unsigned int bufferSize, unsigned int flushInterval) : impl(std::make_shared<Impl>(stream, format, bufferSize, flushInterval))
+{
+}
+
+int FrameWriter::format(const std::string &name)
+{
+   if (name == "text")
+      return Text;
+
+   if (name == "json")
+      return Json;
+
+   if (name == "csv")
+      return Csv;
+
+   if (name == "binary")
+      return Binary;
+
+   return -1;
+}
+
+int FrameWriter::format() const
+{
+   return impl->format;
+}
+
+void FrameWriter::setDissect(bool enabled)
+{
+   impl->dissect = enabled;
+}
+
+bool FrameWriter::dissect() const
+{
+   return impl->dissect;
+}
+
+void FrameWriter::setAssemble(bool enabled)
+{
+   impl->assemble = enabled;
+}
+
+bool FrameWriter::assemble() const
+{
+   return impl->assemble;
+}
+
+void FrameWriter::write(const RawFrame &frame)
+{
+   impl->write(frame);
+}
+
+void FrameWriter::write(const IsoDepAssembler &assembler, const ApduExchange &exchange)
+{
+   impl->write(assembler, exchange);
+
+   impl->poll();
+}
+
+void FrameWriter::close()
+{
+   impl->close();
+}
+
+bool FrameWriter::poll()
+{
+   return impl->poll();
+}
+
+void FrameWriter::flush()
+{
+   impl->flush();
+}
+
+unsigned long long FrameWriter::frames() const
+{
+   return impl->frames;
+}
+
+unsigned long long FrameWriter::exchanges() const
+{
+   return impl->exchanges;
+}
+
+unsigned long long FrameWriter::bytes() const
+{
+   return impl->bytes;
+}
+
+}
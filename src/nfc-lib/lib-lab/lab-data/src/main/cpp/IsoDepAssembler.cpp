@@ -0,0 +1,417 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <algorithm>
+
+#include <lab/data/IsoDepAssembler.h>
+
+namespace lab {
+
+struct IsoDepAssembler::Impl
+{
+   enum State
+   {
+      Idle = 0,
+      CommandChain = 1,
+      AwaitResponse = 2,
+      ResponseChain = 3
+   };
+
+   // completed exchanges
+   std::vector<ApduExchange> exchanges;
+
+   // APDU contents for all exchanges
+   std::vector<unsigned char> pool;
+
+   // exchange under construction
+   ApduExchange current;
+
+   // reassembly state
+   int state = Idle;
+
+   // block number of last accepted I-block for each side, -1 if none
+   int commandBlock = -1;
+   int responseBlock = -1;
+
+   // size of last accepted I-block payload for each side, to detect retransmissions
+   unsigned int commandTail = 0;
+   unsigned int responseTail = 0;
+
+   /*
+    * Idle state saved just before the first block of each exchange, allows to resume
+    * reassembly from that frame when frames are inserted later in the stream
+    */
+   struct Checkpoint
+   {
+      unsigned int index;
+      unsigned int exchanges;
+      unsigned int pool;
+      int commandBlock;
+      int responseBlock;
+      unsigned int commandTail;
+      unsigned int responseTail;
+
+      // last completed exchange, its counters may be updated by frames after it
+      ApduExchange previous;
+   };
+
+   std::vector<Checkpoint> checkpoints;
+
+   void reset()
+   {
+      exchanges.clear();
+      pool.clear();
+      checkpoints.clear();
+      current = {};
+      state = Idle;
+      commandBlock = -1;
+      responseBlock = -1;
+      commandTail = 0;
+      responseTail = 0;
+   }
+
+   int process(const RawFrame &frame, unsigned int index)
+   {
+      // carrier lost, pending exchange is finished
+      if (frame.frameType() == NfcCarrierOff || frame.frameType() == NfcCarrierOn || frame.frameType() == NfcCarrierTrain)
+         return finish();
+
+      // only NFC-A and NFC-B use ISO-DEP
+      if (frame.techType() != NfcATech && frame.techType() != NfcBTech)
+         return 0;
+
+      // new selection, pending exchange is finished
+      if (frame.framePhase() == NfcSelectionPhase)
+         return finish();
+
+      if (frame.frameType() != NfcPollFrame && frame.frameType() != NfcListenFrame)
+         return 0;
+
+      // encrypted or too short frames can't be ISO-DEP blocks
+      if (frame.hasFrameFlags(Encrypted) || frame.limit() < 3)
+         return 0;
+
+      // corrupted blocks are not accepted, they will be repeated
+      if (frame.hasFrameFlags(CrcError))
+      {
+         if (state != Idle)
+            current.flags |= ApduExchange::CrcError;
+
+         return 0;
+      }
+
+      int pcb = frame[0];
+
+      if (frame.frameType() == NfcPollFrame)
+      {
+         // I-Block from reader
+         if ((pcb & 0xE2) == 0x02)
+            return commandIBlock(frame, index, pcb);
+
+         // S-Block DESELECT from reader finish current exchange, WTX responses are ignored
+         if ((pcb & 0xC7) == 0xC2)
+            return (pcb & 0x30) == 0x00 ? finish() : 0;
+
+         // R-Blocks only acknowledge chaining
+         if ((pcb & 0xE6) == 0xA2)
+            return 0;
+
+         // any other command finish current exchange
+         return finish();
+      }
+
+      // I-Block from card
+      if ((pcb & 0xE2) == 0x02)
+         return responseIBlock(frame, index, pcb);
+
+      // S-Block WTX request from card
+      if ((pcb & 0xC7) == 0xC2 && (pcb & 0x30) == 0x30)
+      {
+         if (state != Idle)
+            current.waitExtensions++;
+         else if (!exchanges.empty())
+            exchanges.back().waitExtensions++;
+      }
+
+      return 0;
+   }
+
+   int commandIBlock(const RawFrame &frame, unsigned int index, int pcb)
+   {
+      int completed = 0;
+
+      unsigned int offset = payloadOffset(pcb);
+
+      if (frame.limit() < offset + 2)
+         return 0;
+
+      unsigned int length = frame.limit() - offset - 2;
+
+      // repeated block, same block number and contents than last accepted one
+      if ((state == CommandChain || state == AwaitResponse) && commandBlock == (pcb & 1) && isRepeated(frame, offset, length, current.commandOffset + current.commandLength - commandTail, commandTail))
+      {
+         current.retransmissions++;
+         return 0;
+      }
+
+      // new command, previous exchange is finished
+      if (state != CommandChain)
+      {
+         // reassembly can be resumed here only if no exchange is pending before this frame
+         if (state == Idle)
+            checkpoints.push_back({index, static_cast<unsigned int>(exchanges.size()), static_cast<unsigned int>(pool.size()), commandBlock, responseBlock, commandTail, responseTail, exchanges.empty() ? ApduExchange() : exchanges.back()});
+
+         completed = finish();
+
+         current = {};
+         current.commandOffset = pool.size();
+         current.commandFirst = index;
+         current.timeStart = frame.timeStart();
+      }
+
+      append(frame, offset, length);
+
+      current.commandLength += length;
+      current.commandLast = index;
+      current.commandBlocks++;
+      current.timeEnd = frame.timeEnd();
+
+      commandBlock = pcb & 1;
+      commandTail = length;
+
+      // chaining bit set, more blocks follow
+      state = pcb & 0x10 ? CommandChain : AwaitResponse;
+
+      return completed;
+   }
+
+   int responseIBlock(const RawFrame &frame, unsigned int index, int pcb)
+   {
+      unsigned int offset = payloadOffset(pcb);
+
+      if (frame.limit() < offset + 2)
+         return 0;
+
+      unsigned int length = frame.limit() - offset - 2;
+
+      // response without command
+      if (state == Idle)
+      {
+         // repeated last response
+         if (!exchanges.empty() && responseBlock == (pcb & 1))
+            exchanges.back().retransmissions++;
+
+         return 0;
+      }
+
+      // repeated block, same block number and contents than last accepted one
+      if (state == ResponseChain && responseBlock == (pcb & 1) && isRepeated(frame, offset, length, current.responseOffset + current.responseLength - responseTail, responseTail))
+      {
+         current.retransmissions++;
+         return 0;
+      }
+
+      // response during command chaining, chain is broken
+      if (state == CommandChain)
+         current.flags |= ApduExchange::ChainBroken;
+
+      // first response block
+      if (state != ResponseChain)
+      {
+         current.responseOffset = pool.size();
+         current.responseFirst = index;
+      }
+
+      append(frame, offset, length);
+
+      current.responseLength += length;
+      current.responseLast = index;
+      current.responseBlocks++;
+      current.timeEnd = frame.timeEnd();
+
+      responseBlock = pcb & 1;
+      responseTail = length;
+
+      // chaining bit set, more blocks follow
+      if (pcb & 0x10)
+      {
+         state = ResponseChain;
+         return 0;
+      }
+
+      exchanges.push_back(current);
+
+      state = Idle;
+
+      return 1;
+   }
+
+   unsigned int rewind(unsigned int index)
+   {
+      // last exchange started at or before index, frames before it are not affected
+      auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), index, [](unsigned int value, const Checkpoint &checkpoint) {
+         return value < checkpoint.index;
+      });
+
+      if (it == checkpoints.begin())
+      {
+         reset();
+         return 0;
+      }
+
+      const Checkpoint checkpoint = *--it;
+
+      checkpoints.erase(it, checkpoints.end());
+      exchanges.resize(checkpoint.exchanges);
+      pool.resize(checkpoint.pool);
+
+      if (!exchanges.empty())
+         exchanges.back() = checkpoint.previous;
+
+      current = {};
+      state = Idle;
+      commandBlock = checkpoint.commandBlock;
+      responseBlock = checkpoint.responseBlock;
+      commandTail = checkpoint.commandTail;
+      responseTail = checkpoint.responseTail;
+
+      return checkpoint.index;
+   }
+
+   int finish()
+   {
+      if (state == Idle)
+         return 0;
+
+      if (state == CommandChain || state == ResponseChain)
+         current.flags |= ApduExchange::ChainBroken;
+
+      if (state == CommandChain || state == AwaitResponse)
+         current.flags |= ApduExchange::ResponseMissing;
+
+      exchanges.push_back(current);
+
+      state = Idle;
+
+      return 1;
+   }
+
+   void append(const RawFrame &frame, unsigned int offset, unsigned int length)
+   {
+      for (unsigned int i = 0; i < length; i++)
+         pool.push_back(frame[offset + i]);
+   }
+
+   bool isRepeated(const RawFrame &frame, unsigned int offset, unsigned int length, unsigned int start, unsigned int tail) const
+   {
+      if (length != tail)
+         return false;
+
+      for (unsigned int i = 0; i < length; i++)
+      {
+         if (frame[offset + i] != pool[start + i])
+            return false;
+      }
+
+      return true;
+   }
+
+   static unsigned int payloadOffset(int pcb)
+   {
+      // skip PCB, CID and NAD
+      return 1 + (pcb & 0x08 ? 1 : 0) + (pcb & 0x04 ? 1 : 0);
+   }
+};
+
+IsoDepAssembler::IsoDepAssembler() : impl(std::make_shared<Impl>())
+{
+}
+
+void IsoDepAssembler::reset()
+{
+   impl->reset();
+}
+
+int IsoDepAssembler::process(const RawFrame &frame, unsigned int index)
+{
+   return impl->process(frame, index);
+}
+
+unsigned int IsoDepAssembler::rewind(unsigned int index)
+{
+   return impl->rewind(index);
+}
+
+int IsoDepAssembler::process(const std::list<RawFrame> &frames)
+{
+   int completed = 0;
+
+   unsigned int index = 0;
+
+   for (const auto &frame: frames)
+      completed += impl->process(frame, index++);
+
+   return completed;
+}
+
+int IsoDepAssembler::flush()
+{
+   return impl->finish();
+}
+
+const std::vector<ApduExchange> &IsoDepAssembler::exchanges() const
+{
+   return impl->exchanges;
+}
+
+const ApduExchange *IsoDepAssembler::find(unsigned int index) const
+{
+   // exchanges are stored in stream order, last one starting at or before index
+   auto it = std::upper_bound(impl->exchanges.begin(), impl->exchanges.end(), index, [](unsigned int value, const ApduExchange &exchange) {
+      return value < exchange.commandFirst;
+   });
+
+   if (it == impl->exchanges.begin())
+      return nullptr;
+
+   --it;
+
+   unsigned int last = it->responseBlocks ? it->responseLast : it->commandLast;
+
+   return index <= last ? &*it : nullptr;
+}
+
+const std::vector<unsigned char> &IsoDepAssembler::data() const
+{
+   return impl->pool;
+}
+
+std::vector<unsigned char> IsoDepAssembler::command(const ApduExchange &exchange) const
+{
+   return {impl->pool.begin() + exchange.commandOffset, impl->pool.begin() + exchange.commandOffset + exchange.commandLength};
+}
+
+std::vector<unsigned char> IsoDepAssembler::response(const ApduExchange &exchange) const
+{
+   return {impl->pool.begin() + exchange.responseOffset, impl->pool.begin() + exchange.responseOffset + exchange.responseLength};
+}
+
+}
@@ -0,0 +1,127 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DATA_FRAMECACHE_H
+#define DATA_FRAMECACHE_H
+
+#include <list>
+#include <memory>
+#include <string>
+
+#include <lab/data/RawFrame.h>
+
+namespace lab {
+
+/*
+ * Persistent cache of decoded frames. Each entry is a binary file in cache directory keyed by signal
+ * content hash and decoder configuration hash, so reopening same capture with same settings can skip
+ * the decoding pass. Content hash covers the whole file, and the entry header records the decoder
+ * version, file size and modification time of the signal, so an entry is only reused when all of
+ * them match the key.
+ *
+ * Least recently used entries are evicted when total size exceeds the configured limit.
+ */
+class FrameCache
+{
+      struct Impl;
+
+   public:
+
+      // decoder output version, must be increased when decoding same signal with same settings gives different frames
+      static constexpr unsigned int DECODER_VERSION = 1;
+
+      struct Key
+      {
+         unsigned int version;
+         unsigned long long size;
+         long long modified;
+         unsigned long long content;
+         unsigned long long config;
+
+         bool operator==(const Key &other) const
+         {
+            return version == other.version && size == other.size && modified == other.modified && content == other.content && config == other.config;
+         }
+
+         bool operator!=(const Key &other) const
+         {
+            return !operator==(other);
+         }
+      };
+
+   public:
+
+      FrameCache();
+
+      FrameCache(const std::string &directory, unsigned long long sizeLimit);
+
+      // hash of whole signal file contents, zero if file can't be read
+      static unsigned long long contentHash(const std::string &file);
+
+      // hash of decoder configuration, must be canonical serialized (sorted keys, compact) json
+      static unsigned long long configHash(const std::string &config);
+
+      // build key for signal file and decoder configuration, content is zero if file can't be read
+      static Key key(const std::string &file, const std::string &config);
+
+      const std::string &directory() const;
+
+      void setDirectory(const std::string &directory);
+
+      unsigned long long sizeLimit() const;
+
+      void setSizeLimit(unsigned long long sizeLimit);
+
+      // check if entry exists for key
+      bool contains(const Key &key) const;
+
+      // load cached frames, corrupted entries are removed
+      bool load(const Key &key, std::list<RawFrame> &frames);
+
+      // store frames and evict older entries to fit size limit
+      bool store(const Key &key, const std::list<RawFrame> &frames);
+
+      // remove entry for key
+      bool invalidate(const Key &key);
+
+      // remove all entries for signal content, returns number of removed entries
+      int invalidate(unsigned long long content);
+
+      // remove least recently used entries until size limit is reached, returns number of removed entries
+      int evict();
+
+      // remove all entries
+      void clear();
+
+      // total size of cache entries
+      unsigned long long size() const;
+
+      // number of cache entries
+      int entries() const;
+
+   private:
+
+      std::shared_ptr<Impl> impl;
+};
+
+}
+
+#endif
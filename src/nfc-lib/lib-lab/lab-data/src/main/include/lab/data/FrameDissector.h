@@ -0,0 +1,224 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DATA_FRAMEDISSECTOR_H
+#define DATA_FRAMEDISSECTOR_H
+
+#include <memory>
+#include <vector>
+
+#include <lab/data/RawFrame.h>
+
+namespace lab {
+
+/*
+ * Headless protocol dissector for NFC-A/B/F/V, ISO-DEP and ISO7816 frames, without any GUI dependency.
+ *
+ * Each technology resolves commands with a 256 entry table indexed by command code, and responses with
+ * a second table indexed by the last command seen, instead of trying candidate parsers one by one. The
+ * result is a flat tree in pre-order of fixed size nodes, root first at depth 0, written into a caller
+ * supplied vector that is reused between frames so bulk dissection does not allocate.
+ */
+class FrameDissector
+{
+      struct Impl;
+
+   public:
+
+      enum Field
+      {
+         // generic roots
+         Unknown = 0,
+         Response,
+
+         // NFC-A commands and responses
+         REQA,
+         WUPA,
+         HLTA,
+         SEL1,
+         SEL2,
+         SEL3,
+         RATS,
+         PPS,
+         AUTHA,
+         AUTHB,
+         VASUPA,
+         ATQA,
+         SAK,
+         ATS,
+         ATV,
+
+         // NFC-B commands and responses
+         REQB,
+         WUPB,
+         ATTRIB,
+         HLTB,
+         INIT,
+         READ,
+         WRITE,
+         GETUID,
+         SELECT,
+         VASUPB,
+         ATQB,
+
+         // NFC-F commands and responses
+         REQC,
+         ATQC,
+         CMDF,
+
+         // NFC-V commands
+         Inventory,
+         StayQuiet,
+         ReadBlock,
+         WriteBlock,
+         LockBlock,
+         ReadBlocks,
+         WriteBlocks,
+         SelectV,
+         ResetV,
+         WriteAFI,
+         LockAFI,
+         WriteDSFID,
+         LockDSFID,
+         SysInfo,
+         GetSecurity,
+         CMDV,
+
+         // ISO-DEP and ISO7816 blocks
+         IBlock,
+         RAck,
+         RNack,
+         SBlock,
+         VCC,
+         RST,
+         ATR,
+         TPDU,
+
+         // frame fields
+         ACK,
+         AFI,
+         APDU,
+         APP,
+         BCC,
+         BLOCK,
+         CID,
+         CLA,
+         CMD,
+         COUNT,
+         CRC,
+         CT,
+         DATA,
+         DSFID,
+         ERROR,
+         FLAGS,
+         FIRST,
+         HEADER,
+         HIST,
+         IC,
+         ID,
+         INF,
+         INFO,
+         INS,
+         LC,
+         LE,
+         LEN,
+         LRC,
+         MASK,
+         MBLI,
+         MEMORY,
+         MLEN,
+         NAD,
+         NullByte,
+         NVB,
+         P1,
+         P2,
+         P3,
+         PARAM,
+         PARAM1,
+         PARAM2,
+         PARAM3,
+         PARAM4,
+         PARAMS,
+         PCB,
+         PPS0,
+         PPS1,
+         PROTO,
+         PUPI,
+         SW,
+         T0,
+         TA,
+         TB,
+         TC,
+         TD,
+         TL,
+         TS,
+         TCK,
+         TOKEN,
+         UID,
+
+         FieldCount
+      };
+
+      enum Flags
+      {
+         RequestFrame = 0x01,
+         ResponseFrame = 0x02,
+         SenseFrame = 0x04,
+         SelectionFrame = 0x08,
+         ApplicationFrame = 0x10,
+         AuthFrame = 0x20
+      };
+
+      /*
+       * Dissection tree node, offset and length are in frame bytes, value holds the command code for the
+       * root and the field contents for fields up to 4 bytes, as big endian integer unless noted
+       */
+      struct Node
+      {
+         unsigned short field;
+         unsigned char depth;
+         unsigned char flags;
+         unsigned short offset;
+         unsigned short length;
+         unsigned int value;
+      };
+
+   public:
+
+      FrameDissector();
+
+      // clear protocol state, must be called on each new capture
+      void reset();
+
+      // dissect frame replacing nodes contents, returns number of nodes, 0 for carrier frames
+      unsigned int dissect(const RawFrame &frame, std::vector<Node> &nodes);
+
+      // field name
+      static const char *name(unsigned int field);
+
+   private:
+
+      std::shared_ptr<Impl> impl;
+};
+
+}
+
+#endif
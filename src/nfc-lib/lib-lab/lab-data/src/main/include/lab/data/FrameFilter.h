@@ -0,0 +1,85 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DATA_FRAMEFILTER_H
+#define DATA_FRAMEFILTER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <lab/data/RawFrame.h>
+
+namespace lab {
+
+/*
+ * Compiled frame filter expression, evaluated without allocations before frames are published.
+ *
+ * Expression is a list of clauses joined by "and", each clause a list of predicates joined by "or",
+ * any predicate can be negated with "not" or "!". A frame is dropped by the first clause that does
+ * not match, and counted for that clause. Supported predicates:
+ *
+ *   tech == nfca | nfcb | nfcf | nfcv | iso7816
+ *   type == poll | listen | carrier-on | carrier-off | atr | request | response | exchange
+ *   phase == carrier | selection | application
+ *   crc-error | parity-error | sync-error | truncated | encrypted | short
+ *   length <op> N, rate <op> N, time <op> seconds
+ *   data[i] <op> N, data[i] & MASK <op> N
+ *   data starts HEX, data contains HEX
+ *
+ * where <op> is one of == != < <= > >=, for example:
+ *
+ *   tech == nfca and type != carrier-on and type != carrier-off and not data[0] == 0x26
+ */
+class FrameFilter
+{
+      struct Impl;
+
+   public:
+
+      FrameFilter();
+
+      // compile new expression, on error previous filter is kept, empty expression accept all frames
+      bool compile(const std::string &expression);
+
+      // check if frame must be published, updates clause counters
+      bool matches(const RawFrame &frame);
+
+      bool isEmpty() const;
+
+      const std::string &expression() const;
+
+      // number of frames accepted
+      unsigned long long accepted() const;
+
+      // number of frames dropped by each clause, paired with clause text
+      std::vector<std::pair<std::string, unsigned long long>> dropped() const;
+
+      void resetCounters();
+
+   private:
+
+      std::shared_ptr<Impl> impl;
+};
+
+}
+
+#endif
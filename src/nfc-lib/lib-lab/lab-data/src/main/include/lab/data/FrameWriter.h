@@ -0,0 +1,121 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DATA_FRAMEWRITER_H
+#define DATA_FRAMEWRITER_H
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include <lab/data/FrameDissector.h>
+#include <lab/data/IsoDepAssembler.h>
+#include <lab/data/RawFrame.h>
+
+namespace lab {
+
+/*
+ * Buffered frame output for console tools. Frames are formatted with hand written number and hex
+ * converters into a reusable buffer that is written to the stream only when it reaches the size
+ * threshold or when the flush interval has elapsed, avoiding per frame stdio locking and flushing.
+ *
+ * Binary format starts with "NFCS" magic and version followed by one record per frame with the same
+ * layout used by frame cache entries, all values in host byte order.
+ *
+ * When dissection is enabled text lines end with the command and top level fields, json records get
+ * a "dissect" array with the full node tree and csv rows a "dissect" column with the command name.
+ *
+ * When APDU assembly is enabled frames are also passed to an ISO-DEP reassembler, each completed
+ * exchange is written after the frame that completes it with the indexes of its first and last frame
+ * in the output stream. Exchanges are written as "(APDU)" text lines and "apdu" json records, csv
+ * and binary output have fixed frame layouts and do not include them.
+ */
+class FrameWriter
+{
+      struct Impl;
+
+   public:
+
+      enum Format
+      {
+         Text = 0,
+         Json = 1,
+         Csv = 2,
+         Binary = 3
+      };
+
+      // default buffer size before forcing a flush
+      static constexpr unsigned int DEFAULT_BUFFER_SIZE = 1 << 20;
+
+      // default flush interval in milliseconds
+      static constexpr unsigned int DEFAULT_FLUSH_INTERVAL = 250;
+
+   public:
+
+      explicit FrameWriter(FILE *stream, int format = Text, unsigned int bufferSize = DEFAULT_BUFFER_SIZE, unsigned int flushInterval = DEFAULT_FLUSH_INTERVAL);
+
+      // format from name (text, json, csv or binary), -1 if unknown
+      static int format(const std::string &name);
+
+      int format() const;
+
+      // enable protocol dissection for text, json and csv formats, must be set before first write
+      void setDissect(bool enabled);
+
+      bool dissect() const;
+
+      // enable ISO-DEP APDU assembly for text and json formats, must be set before first write
+      void setAssemble(bool enabled);
+
+      bool assemble() const;
+
+      // format frame into output buffer, flush if size or time thresholds are reached
+      void write(const RawFrame &frame);
+
+      // format APDU exchange from given assembler into output buffer
+      void write(const IsoDepAssembler &assembler, const ApduExchange &exchange);
+
+      // write pending APDU exchange, if any, and flush output
+      void close();
+
+      // flush if there is pending output and flush interval has elapsed, returns true if flushed
+      bool poll();
+
+      // write pending output to stream
+      void flush();
+
+      // number of frames written
+      unsigned long long frames() const;
+
+      // number of APDU exchanges written
+      unsigned long long exchanges() const;
+
+      // number of bytes sent to stream
+      unsigned long long bytes() const;
+
+   private:
+
+      std::shared_ptr<Impl> impl;
+};
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef DATA_ISODEPASSEMBLER_H
+#define DATA_ISODEPASSEMBLER_H
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include <lab/data/RawFrame.h>
+
+namespace lab {
+
+/*
+ * Complete ISO-DEP command / response pair, APDU contents are stored in assembler data pool
+ */
+struct ApduExchange
+{
+   enum Flags
+   {
+      // no response received before next command, deselect or carrier loss
+      ResponseMissing = 0x01,
+
+      // chaining interrupted before last block
+      ChainBroken = 0x02,
+
+      // some block received with CRC error
+      CrcError = 0x04,
+   };
+
+   // command APDU in data pool
+   unsigned int commandOffset = 0;
+   unsigned int commandLength = 0;
+
+   // response APDU in data pool
+   unsigned int responseOffset = 0;
+   unsigned int responseLength = 0;
+
+   // index of first and last frame for each side in frame stream
+   unsigned int commandFirst = 0;
+   unsigned int commandLast = 0;
+   unsigned int responseFirst = 0;
+   unsigned int responseLast = 0;
+
+   // command and response blocks, including chained ones
+   unsigned int commandBlocks = 0;
+   unsigned int responseBlocks = 0;
+
+   // waiting time extensions requested by card
+   unsigned int waitExtensions = 0;
+
+   // repeated blocks ignored
+   unsigned int retransmissions = 0;
+
+   // exchange time bounds
+   double timeStart = 0;
+   double timeEnd = 0;
+
+   // status flags
+   unsigned int flags = 0;
+};
+
+/*
+ * Streaming ISO-DEP (ISO/IEC 14443-4) reassembler, follows PCB chaining, block numbers, R/S-blocks and WTX
+ * across the whole frame stream and produces a table of complete APDU exchanges with frame references
+ */
+class IsoDepAssembler
+{
+      struct Impl;
+
+   public:
+
+      IsoDepAssembler();
+
+      void reset();
+
+      // process next frame of stream, index is the frame reference stored in exchanges, returns number of new completed exchanges
+      int process(const RawFrame &frame, unsigned int index);
+
+      // process whole frame list in one pass, frames are referenced by list position
+      int process(const std::list<RawFrame> &frames);
+
+      // discard state from the exchange containing frame index onwards, returns the frame index where processing must be resumed
+      unsigned int rewind(unsigned int index);
+
+      // close pending exchange, if any
+      int flush();
+
+      // completed exchanges
+      const std::vector<ApduExchange> &exchanges() const;
+
+      // completed exchange that contains the frame with given index, nullptr if none
+      const ApduExchange *find(unsigned int index) const;
+
+      // APDU data pool
+      const std::vector<unsigned char> &data() const;
+
+      // command and response contents
+      std::vector<unsigned char> command(const ApduExchange &exchange) const;
+
+      std::vector<unsigned char> response(const ApduExchange &exchange) const;
+
+   private:
+
+      std::shared_ptr<Impl> impl;
+};
+
+}
+
+#endif
@@ -49,6 +49,7 @@ enum FrameType
    NfcCarrierOn = 0x0101,
    NfcPollFrame = 0x0102,
    NfcListenFrame = 0x0103,
+   NfcCarrierTrain = 0x0104,
 
    // ISO Frame types
    IsoVccLow = 0x200,
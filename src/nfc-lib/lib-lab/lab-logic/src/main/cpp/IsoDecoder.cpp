@@ -51,7 +51,7 @@ struct IsoDecoder::Impl
 
    inline void initialize();
 
-   inline std::list<RawFrame> nextFrames(hw::SignalBuffer &samples);
+   inline void nextFrames(hw::SignalBuffer &samples, std::vector<RawFrame> &frames);
 };
 
 IsoDecoder::IsoDecoder() : impl(std::make_shared<Impl>())
@@ -93,7 +93,16 @@ void IsoDecoder::setEnableISO7816(bool enabled)
 
 std::list<RawFrame> IsoDecoder::nextFrames(hw::SignalBuffer samples)
 {
-   return impl->nextFrames(samples);
+   std::vector<RawFrame> frames;
+
+   impl->nextFrames(samples, frames);
+
+   return {frames.begin(), frames.end()};
+}
+
+void IsoDecoder::nextFrames(hw::SignalBuffer samples, std::vector<RawFrame> &frames)
+{
+   impl->nextFrames(samples, frames);
 }
 
 long IsoDecoder::sampleRate() const
@@ -164,11 +173,8 @@ void IsoDecoder::Impl::cleanup()
       decoder.debug.reset();
 }
 
-std::list<RawFrame> IsoDecoder::Impl::nextFrames(hw::SignalBuffer &samples)
+void IsoDecoder::Impl::nextFrames(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
 {
-   // detected frames
-   std::list<RawFrame> frames;
-
    // only process valid sample buffer
    if (samples)
    {
@@ -213,8 +219,6 @@ std::list<RawFrame> IsoDecoder::Impl::nextFrames(hw::SignalBuffer &samples)
 
    if (decoder.debug)
       decoder.debug->write();
-
-   return frames;
 }
 
 }
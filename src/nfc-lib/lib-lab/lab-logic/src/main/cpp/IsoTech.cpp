@@ -19,6 +19,8 @@
 
 */
 
+#include <algorithm>
+
 #include <rt/Logger.h>
 
 #include "IsoTech.h"
@@ -115,6 +117,56 @@ bool IsoDecoderStatus::nextSample(hw::SignalBuffer &buffer)
    return false;
 }
 
+// skip samples that can not change decoder state, stops before first sample with an edge in any watched channel
+unsigned int IsoDecoderStatus::skipSamples(unsigned int clock, unsigned int watch)
+{
+   // debug requires all samples, and first sample initializes edge detection
+   if (debug || !signalCache || signalClock == 0 || clock <= signalClock + 1)
+      return 0;
+
+   const unsigned int stride = signalCache.stride();
+   const unsigned int limit = std::min(clock - signalClock - 1, signalCache.available() / stride);
+   const float *data = signalCache.data() + signalCache.position();
+
+   unsigned int skipped = 0;
+
+   while (skipped < limit)
+   {
+      bool changed = false;
+
+      for (unsigned int i = 0; i < stride; i++)
+      {
+         if ((watch >> i) & 1)
+            changed |= data[i] != sampleLast[i];
+      }
+
+      if (changed)
+         break;
+
+      data += stride;
+      skipped++;
+   }
+
+   if (skipped)
+   {
+      signalCache.pull(skipped * stride);
+
+      // last skipped sample becomes reference for next edge detection
+      data -= stride;
+
+      for (unsigned int i = 0; i < stride; i++)
+      {
+         sampleData[i] = data[i];
+         sampleEdge[i] = 0;
+         sampleLast[i] = sampleData[i];
+      }
+
+      signalClock += skipped;
+   }
+
+   return skipped;
+}
+
 bool IsoDecoderStatus::hasSamples(const hw::SignalBuffer &buffer) const
 {
    return signalCache.offset() != buffer.offset();
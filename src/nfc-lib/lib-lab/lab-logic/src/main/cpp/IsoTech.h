@@ -236,6 +236,9 @@ struct IsoDecoderStatus
    // process next sample from signal buffer
    bool nextSample(hw::SignalBuffer &buffer);
 
+   // skip samples before given clock while watched channels (bit mask) remain unchanged, returns number of skipped samples
+   unsigned int skipSamples(unsigned int clock, unsigned int watch);
+
    // check if there are samples remain to process in buffer
    bool hasSamples(const hw::SignalBuffer &samples) const;
 };
@@ -19,6 +19,8 @@
 
 */
 
+#include <algorithm>
+#include <climits>
 #include <cmath>
 #include <cstring>
 #include <functional>
@@ -241,7 +243,7 @@ struct Iso7816::Impl : IsoTech
       resetModulation();
    }
 
-   bool detect(std::list<RawFrame> &frames)
+   bool detect(std::vector<RawFrame> &frames)
    {
       detectLines(frames);
 
@@ -266,7 +268,7 @@ struct Iso7816::Impl : IsoTech
    /*
     * Detect changes in VCC and RST lines
     */
-   void detectLines(std::list<RawFrame> &frames) const
+   void detectLines(std::vector<RawFrame> &frames) const
    {
       float vccEdge = decoder->sampleEdge[CH_VCC];
       float resetEdge = decoder->sampleEdge[CH_RST];
@@ -307,7 +309,7 @@ struct Iso7816::Impl : IsoTech
    /*
     * Wait for VCC and reset line to go UP
     */
-   bool detectReset(std::list<RawFrame> &frames)
+   bool detectReset(std::vector<RawFrame> &frames)
    {
       float vccValue = decoder->sampleData[CH_VCC];
       float resetEdge = decoder->sampleEdge[CH_RST];
@@ -325,7 +327,7 @@ struct Iso7816::Impl : IsoTech
    /*
     * Search for first and second IO fall edges to detect ETU
     */
-   bool detectSync(std::list<RawFrame> &frames)
+   bool detectSync(std::vector<RawFrame> &frames)
    {
       float dataEdge = decoder->sampleEdge[CH_IO];
       float resetEdge = decoder->sampleEdge[CH_RST];
@@ -398,7 +400,7 @@ struct Iso7816::Impl : IsoTech
    /*
     * Complete the reception of TS byte and detect convention
     */
-   bool detectTS(std::list<RawFrame> &frames)
+   bool detectTS(std::vector<RawFrame> &frames)
    {
       switch (decodeCharacter())
       {
@@ -450,7 +452,7 @@ struct Iso7816::Impl : IsoTech
    /*
     * Decode ATR frame
     */
-   bool detectATR(std::list<RawFrame> &frames)
+   bool detectATR(std::vector<RawFrame> &frames)
    {
       int result = ResultInvalid;
 
@@ -520,7 +522,7 @@ struct Iso7816::Impl : IsoTech
    /*
     * Decode next request / response frame
     */
-   void decode(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+   void decode(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
    {
       switch (protocolStatus.protocolType)
       {
@@ -544,7 +546,7 @@ struct Iso7816::Impl : IsoTech
    /*
     * Decode T0 protocol stream
     */
-   void decodeStreamT0(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+   void decodeStreamT0(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
    {
       while (decoder->nextSample(samples))
       {
@@ -588,13 +590,16 @@ struct Iso7816::Impl : IsoTech
             // return request frame data
             return;
          }
+
+         // jump to next sample where character decoding can progress
+         skipSamples();
       }
    }
 
    /*
     * Decode T1 protocol stream
     */
-   void decodeStreamT1(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+   void decodeStreamT1(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
    {
       while (decoder->nextSample(samples))
       {
@@ -638,20 +643,54 @@ struct Iso7816::Impl : IsoTech
             // return request frame data
             return;
          }
+
+         // jump to next sample where character decoding can progress
+         skipSamples();
       }
    }
 
    /*
     * Decode other protocol stream
     */
-   void decodeStreamTx(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+   void decodeStreamTx(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
    {
       while (decoder->nextSample(samples))
       {
          detectLines(frames);
+
+         // only VCC and RST changes are reported
+         decoder->skipSamples(UINT_MAX, 1 << CH_RST | 1 << CH_VCC);
       }
    }
 
+   /*
+    * Skip samples where decodeSymbol can not change its state, only edges on VCC and RST lines (and I/O line
+    * while waiting for start bit) must be processed before reaching next guard, timeout or bit sampling point
+    */
+   void skipSamples() const
+   {
+      unsigned int watch = 1 << CH_RST | 1 << CH_VCC;
+      unsigned int clock = UINT_MAX;
+
+      // during guard time I/O line is ignored
+      if (modulationStatus.searchStartTime && decoder->signalClock + 1 < modulationStatus.searchStartTime)
+      {
+         decoder->skipSamples(modulationStatus.searchStartTime, watch);
+         return;
+      }
+
+      if (modulationStatus.searchEndTime)
+         clock = std::min(clock, modulationStatus.searchEndTime);
+
+      // between bit sampling points I/O line is ignored, otherwise watch for start bit edge
+      if (modulationStatus.searchSyncTime)
+         clock = std::min(clock, modulationStatus.searchSyncTime);
+      else
+         watch |= 1 << CH_IO;
+
+      decoder->skipSamples(clock, watch);
+   }
+
    /*
     * Decode one T0 TPDU frame
     */
@@ -1560,7 +1599,7 @@ void Iso7816::initialize(unsigned int sampleRate)
 /*
  * Detect ISO7816 modulation
  */
-bool Iso7816::detect(std::list<RawFrame> &frames)
+bool Iso7816::detect(std::vector<RawFrame> &frames)
 {
    return self->detect(frames);
 }
@@ -1568,7 +1607,7 @@ bool Iso7816::detect(std::list<RawFrame> &frames)
 /*
  * Decode next poll or listen frame
  */
-void Iso7816::decode(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+void Iso7816::decode(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
 {
    self->decode(samples, frames);
 }
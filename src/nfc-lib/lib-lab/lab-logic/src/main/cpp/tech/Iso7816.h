@@ -22,7 +22,7 @@
 #ifndef LOGIC_ISO7816_H
 #define LOGIC_ISO7816_H
 
-#include <list>
+#include <vector>
 
 #include <hw/SignalBuffer.h>
 
@@ -44,9 +44,9 @@ struct Iso7816
 
    void initialize(unsigned int sampleRate);
 
-   bool detect(std::list<RawFrame> &frames);
+   bool detect(std::vector<RawFrame> &frames);
 
-   void decode(hw::SignalBuffer &samples, std::list<RawFrame> &frames);
+   void decode(hw::SignalBuffer &samples, std::vector<RawFrame> &frames);
 };
 
 }
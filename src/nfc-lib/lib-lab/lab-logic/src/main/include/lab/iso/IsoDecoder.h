@@ -23,6 +23,7 @@
 #define LOGIC_ISODECODER_H
 
 #include <list>
+#include <vector>
 
 #include <hw/SignalBuffer.h>
 
@@ -44,6 +45,9 @@ class IsoDecoder
 
       std::list<RawFrame> nextFrames(hw::SignalBuffer samples);
 
+      // append detected frames to caller owned vector, reusing its capacity between calls
+      void nextFrames(hw::SignalBuffer samples, std::vector<RawFrame> &frames);
+
       bool isDebugEnabled() const;
 
       void setEnableDebug(bool enabled);
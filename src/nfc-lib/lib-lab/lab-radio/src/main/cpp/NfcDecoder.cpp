@@ -20,6 +20,7 @@
 */
 
 #include <rt/Logger.h>
+#include <rt/ThreadPool.h>
 
 #include <lab/nfc/Nfc.h>
 #include <lab/nfc/NfcDecoder.h>
@@ -30,6 +31,7 @@
 #include <tech/NfcV.h>
 
 #include <cmath>
+#include <thread>
 
 namespace lab {
 
@@ -42,9 +44,68 @@ struct NfcDecoder::Impl
    static constexpr int ENABLED_NFCF = 1 << 2;
    static constexpr int ENABLED_NFCV = 1 << 3;
 
+   static constexpr unsigned int CHECKPOINT_VERSION = 5;
+
+   // minimum number of periodic pulses reported as a single carrier pulse train
+   static constexpr unsigned int CARRIER_TRAIN_PULSES = 3;
+
+   // longest carrier pulse considered part of a train, in seconds
+   static constexpr double CARRIER_PULSE_WIDTH = 1E-3;
+
+   // longest time between pulses of a train, in seconds
+   static constexpr double CARRIER_PULSE_PERIOD = 1.0;
+
+   // short carrier pulse, times are sample clocks
+   struct CarrierPulse
+   {
+      unsigned int on;
+      unsigned int off;
+   };
+
+   /*
+    * Tracks unmodulated short carrier pulses, as generated by readers with low power card detection. Edges of
+    * short pulses are held back until they are known to be part of a periodic train, reported as one frame,
+    * or released as individual carrier frames otherwise. Plain data, it is saved with decoder checkpoints.
+    */
+   struct CarrierTrain
+   {
+      // carrier on time of current pulse if not released yet, 0 if none
+      unsigned int pulseOn;
+
+      // first pulses, held until train is confirmed
+      CarrierPulse pulses[CARRIER_TRAIN_PULSES];
+
+      // number of pulses in current train
+      unsigned int count;
+
+      // first and last pulse times
+      unsigned int firstOn;
+      unsigned int lastOn;
+      unsigned int lastOff;
+
+      // average time between pulses
+      unsigned int period;
+
+      // sum of pulse widths
+      unsigned long long widthSum;
+
+      // signal clock when current pulse or train expires, 0 if nothing is pending
+      unsigned int expireClock;
+   };
+
    // debug disabled by default
    int debugEnabled = false;
 
+   // carrier pulse trains reported as single frame by default
+   bool carrierTrainEnabled = true;
+
+   // pulse train limits, in samples
+   unsigned int carrierPulseWidth = 0;
+   unsigned int carrierPulsePeriod = 0;
+
+   // carrier pulse train status
+   CarrierTrain carrierTrain {};
+
    // all tech enabled by default
    int enabledTech = ENABLED_NFCA | ENABLED_NFCB | ENABLED_NFCF | ENABLED_NFCV;
 
@@ -63,15 +124,61 @@ struct NfcDecoder::Impl
    // global decoder status
    NfcDecoderStatus decoder;
 
+   // samples between checkpoints, 0 to disable
+   unsigned int checkpointInterval = 0;
+
+   // signal clock for next checkpoint
+   unsigned long long checkpointClock = 0;
+
+   // checkpoints pending to be collected
+   std::list<Checkpoint> checkpointList;
+
+   // shared front end for parameter sweep
+   std::vector<NfcFrontEndSample> frontEndData;
+
+   // samples are being skipped without frame search
+   bool frameSkip = false;
+
+   // threads for parameter sweep decoders, created on first sweep
+   std::shared_ptr<rt::ThreadPool> sweepPool;
+
    Impl();
 
    inline void cleanup();
 
    inline void initialize();
 
-   inline std::list<RawFrame> nextFrames(hw::SignalBuffer &samples);
+   inline void nextFrames(hw::SignalBuffer &samples, std::vector<RawFrame> &frames);
+
+   inline std::vector<std::list<RawFrame>> nextFrames(hw::SignalBuffer &samples, std::vector<NfcDecoder> &sweep);
+
+   inline void skipFrames(hw::SignalBuffer &samples);
+
+   inline void detectCarrier(std::vector<RawFrame> &frames);
+
+   inline void carrierEdge(unsigned int type, unsigned int time, std::vector<RawFrame> &frames);
+
+   inline void carrierModulated(std::vector<RawFrame> &frames);
+
+   inline void carrierExpired(std::vector<RawFrame> &frames);
+
+   inline void addCarrierPulse(unsigned int on, unsigned int off, std::vector<RawFrame> &frames);
+
+   inline void releaseCarrierPulse(std::vector<RawFrame> &frames);
+
+   inline void flushCarrierTrain(std::vector<RawFrame> &frames);
+
+   inline void updateCarrierExpire();
+
+   inline bool isCarrierPeriodic(unsigned int on) const;
+
+   inline void addCarrierFrame(unsigned int type, unsigned int time, std::vector<RawFrame> &frames) const;
+
+   inline void addCarrierTrainFrame(std::vector<RawFrame> &frames) const;
+
+   inline Checkpoint saveCheckpoint() const;
 
-   inline void detectCarrier(std::list<RawFrame> &frames);
+   inline bool loadCheckpoint(const Checkpoint &checkpoint);
 };
 
 NfcDecoder::NfcDecoder() : impl(std::make_shared<Impl>())
@@ -90,7 +197,56 @@ void NfcDecoder::cleanup()
 
 std::list<RawFrame> NfcDecoder::nextFrames(hw::SignalBuffer samples)
 {
-   return impl->nextFrames(samples);
+   std::vector<RawFrame> frames;
+
+   impl->nextFrames(samples, frames);
+
+   return {frames.begin(), frames.end()};
+}
+
+void NfcDecoder::nextFrames(hw::SignalBuffer samples, std::vector<RawFrame> &frames)
+{
+   impl->nextFrames(samples, frames);
+}
+
+std::vector<std::list<RawFrame>> NfcDecoder::nextFrames(hw::SignalBuffer samples, std::vector<NfcDecoder> &sweep)
+{
+   return impl->nextFrames(samples, sweep);
+}
+
+void NfcDecoder::skipFrames(hw::SignalBuffer samples)
+{
+   impl->skipFrames(samples);
+}
+
+std::list<NfcDecoder::Checkpoint> NfcDecoder::nextCheckpoints()
+{
+   std::list<Checkpoint> checkpoints;
+
+   checkpoints.swap(impl->checkpointList);
+
+   return checkpoints;
+}
+
+NfcDecoder::Checkpoint NfcDecoder::saveCheckpoint() const
+{
+   return impl->saveCheckpoint();
+}
+
+bool NfcDecoder::loadCheckpoint(const Checkpoint &checkpoint)
+{
+   return impl->loadCheckpoint(checkpoint);
+}
+
+unsigned int NfcDecoder::checkpointInterval() const
+{
+   return impl->checkpointInterval;
+}
+
+void NfcDecoder::setCheckpointInterval(unsigned int samples)
+{
+   impl->checkpointInterval = samples;
+   impl->checkpointClock = samples;
 }
 
 bool NfcDecoder::isDebugEnabled() const
@@ -103,6 +259,36 @@ void NfcDecoder::setEnableDebug(bool enabled)
    impl->debugEnabled = enabled;
 }
 
+bool NfcDecoder::isCarrierTrainEnabled() const
+{
+   return impl->carrierTrainEnabled;
+}
+
+void NfcDecoder::setEnableCarrierTrain(bool enabled)
+{
+   impl->carrierTrainEnabled = enabled;
+}
+
+bool NfcDecoder::isGuardSkipEnabled() const
+{
+   return impl->decoder.guardSkip;
+}
+
+void NfcDecoder::setEnableGuardSkip(bool enabled)
+{
+   impl->decoder.guardSkip = enabled;
+}
+
+bool NfcDecoder::isPreambleScanEnabled() const
+{
+   return impl->decoder.preambleScan;
+}
+
+void NfcDecoder::setEnablePreambleScan(bool enabled)
+{
+   impl->decoder.preambleScan = enabled;
+}
+
 bool NfcDecoder::isNfcAEnabled() const
 {
    return impl->enabledTech & Impl::ENABLED_NFCA;
@@ -328,6 +514,10 @@ void NfcDecoder::Impl::initialize()
       decoder.signalLowThreshold = decoder.powerLevelThreshold / 1.25f;
       decoder.signalHighThreshold = decoder.powerLevelThreshold * 1.25f;
 
+      // configure carrier pulse train limits
+      carrierPulseWidth = static_cast<unsigned int>(CARRIER_PULSE_WIDTH * decoder.sampleRate);
+      carrierPulsePeriod = static_cast<unsigned int>(CARRIER_PULSE_PERIOD * decoder.sampleRate);
+
       // configure NFC-A decoder
       nfca.initialize(decoder.sampleRate);
 
@@ -357,6 +547,16 @@ void NfcDecoder::Impl::initialize()
 
    // starts without modulation
    decoder.modulation = nullptr;
+
+   // starts without pending carrier pulses
+   carrierTrain = {};
+
+   // restart checkpoint generation
+   checkpointClock = checkpointInterval;
+   checkpointList.clear();
+
+   // starts searching frames
+   frameSkip = false;
 }
 
 /**
@@ -369,13 +569,10 @@ void NfcDecoder::Impl::cleanup()
 }
 
 /**
- * Extract next frames from signal buffer
+ * Extract next frames from signal buffer and append them to frames vector
  */
-std::list<RawFrame> NfcDecoder::Impl::nextFrames(hw::SignalBuffer &samples)
+void NfcDecoder::Impl::nextFrames(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
 {
-   // detected frames
-   std::list<RawFrame> frames;
-
    // only process valid sample buffer
    if (samples.isValid())
    {
@@ -387,6 +584,13 @@ std::list<RawFrame> NfcDecoder::Impl::nextFrames(hw::SignalBuffer &samples)
          initialize();
       }
 
+      // frame search resumes after skipped samples
+      frameSkip = false;
+
+      // NFC-F preamble candidates for whole block
+      if (enabledTech & ENABLED_NFCF)
+         nfcf.scan(samples);
+
       if (decoder.debug)
          decoder.debug->begin(samples.elements());
 
@@ -415,6 +619,10 @@ std::list<RawFrame> NfcDecoder::Impl::nextFrames(hw::SignalBuffer &samples)
                if ((enabledTech & ENABLED_NFCV) && nfcv.detect())
                   break;
             }
+
+            // current carrier pulse is modulated, release it as individual frames
+            if (decoder.modulation)
+               carrierModulated(frames);
          }
 
          if (decoder.bitrate)
@@ -443,33 +651,129 @@ std::list<RawFrame> NfcDecoder::Impl::nextFrames(hw::SignalBuffer &samples)
 
       if (decoder.debug)
          decoder.debug->write();
+
+      // emit checkpoint at buffer boundary, where all decoder status is stored in tech structures
+      if (checkpointInterval && decoder.signalClock >= checkpointClock)
+      {
+         checkpointList.push_back(saveCheckpoint());
+
+         checkpointClock = (decoder.signalClock / checkpointInterval + 1) * static_cast<unsigned long long>(checkpointInterval);
+      }
    }
 
       // if sample buffer is not valid only process remain carrier detector
    else
    {
-      RawFrame carrierFrame = RawFrame(NfcAnyTech, decoder.carrierOnTime ? NfcCarrierOn : NfcCarrierOff);
-
-      carrierFrame.setFramePhase(NfcCarrierPhase);
-      carrierFrame.setSampleStart(decoder.signalClock);
-      carrierFrame.setSampleEnd(decoder.signalClock);
-      carrierFrame.setSampleRate(decoder.sampleRate);
-      carrierFrame.setTimeStart(static_cast<double>(decoder.signalClock) / static_cast<double>(decoder.sampleRate));
-      carrierFrame.setTimeEnd(static_cast<double>(decoder.signalClock) / static_cast<double>(decoder.sampleRate));
-      carrierFrame.setDateTime(decoder.streamTime + carrierFrame.timeStart());
-      carrierFrame.flip();
-
-      frames.push_back(carrierFrame);
+      // release pending carrier pulses before final carrier status
+      carrierModulated(frames);
+      flushCarrierTrain(frames);
+
+      addCarrierFrame(decoder.carrierOnTime ? NfcCarrierOn : NfcCarrierOff, decoder.signalClock, frames);
+   }
+}
+
+/**
+ * Process signal front end only, frame in progress and pending carrier pulses are dropped
+ */
+void NfcDecoder::Impl::skipFrames(hw::SignalBuffer &samples)
+{
+   if (!samples.isValid())
+      return;
+
+   // re-configure decoder parameters on sample rate changes
+   if (decoder.sampleRate != samples.sampleRate())
+   {
+      decoder.sampleRate = samples.sampleRate();
+
+      initialize();
+   }
+
+   // protocol decoders restart from scratch, frame in progress can not be completed
+   if (!frameSkip)
+   {
+      nfca.initialize(decoder.sampleRate);
+      nfcb.initialize(decoder.sampleRate);
+      nfcf.initialize(decoder.sampleRate);
+      nfcv.initialize(decoder.sampleRate);
+
+      decoder.bitrate = nullptr;
+      decoder.modulation = nullptr;
+
+      carrierTrain = {};
+
+      frameSkip = true;
+   }
+
+   if (decoder.debug)
+      decoder.debug->begin(samples.elements());
+
+   decoder.nextSamples(samples, samples.available());
+
+   if (decoder.debug)
+      decoder.debug->write();
+}
+
+/**
+ * Process signal front end once and decode it with each sweep decoder, using its own protocol parameters
+ */
+std::vector<std::list<RawFrame>> NfcDecoder::Impl::nextFrames(hw::SignalBuffer &samples, std::vector<NfcDecoder> &sweep)
+{
+   // detected frames for each sweep decoder
+   std::vector<std::list<RawFrame>> frames(sweep.size());
+
+   // only process front end for valid sample buffer
+   if (samples.isValid())
+   {
+      // re-configure decoder parameters on sample rate changes
+      if (decoder.sampleRate != samples.sampleRate())
+      {
+         decoder.sampleRate = samples.sampleRate();
+
+         initialize();
+      }
+
+      // process shared front end over a copy to keep original buffer position for sweep decoders
+      hw::SignalBuffer buffer = samples;
+
+      decoder.nextFrontEnd(buffer, frontEndData);
    }
 
-   // return frame list
+   // decode protocol for each sweep decoder
+   auto decode = [&](unsigned int index) {
+
+      std::vector<RawFrame> detected;
+
+      NfcDecoderStatus &status = sweep[index].impl->decoder;
+
+      // each decoder consumes its own copy of sample buffer
+      hw::SignalBuffer buffer = samples;
+
+      if (buffer.isValid())
+      {
+         status.frontEnd = frontEndData.data();
+         status.frontEndBase = buffer.position();
+      }
+
+      sweep[index].impl->nextFrames(buffer, detected);
+
+      frames[index].assign(detected.begin(), detected.end());
+
+      status.frontEnd = nullptr;
+   };
+
+   // sweep decoders are spread over available cores, current thread included
+   if (!sweepPool)
+      sweepPool = std::make_shared<rt::ThreadPool>(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+   sweepPool->run(sweep.size(), decode);
+
    return frames;
 }
 
 /**
  * Detect carrier from signal buffer
  */
-void NfcDecoder::Impl::detectCarrier(std::list<RawFrame> &frames)
+void NfcDecoder::Impl::detectCarrier(std::vector<RawFrame> &frames)
 {
    // carrier present if signal average is over power Level Threshold
    if (decoder.signalAverage > decoder.signalHighThreshold)
@@ -478,18 +782,7 @@ void NfcDecoder::Impl::detectCarrier(std::list<RawFrame> &frames)
       {
          decoder.carrierOnTime = decoder.carrierEdgeTime ? decoder.carrierEdgeTime : decoder.signalClock;
 
-         RawFrame carrierOn = RawFrame(NfcAnyTech, NfcCarrierOn);
-
-         carrierOn.setFramePhase(NfcCarrierPhase);
-         carrierOn.setSampleStart(decoder.carrierOnTime);
-         carrierOn.setSampleEnd(decoder.carrierOnTime);
-         carrierOn.setSampleRate(decoder.sampleRate);
-         carrierOn.setTimeStart(static_cast<double>(decoder.carrierOnTime) / static_cast<double>(decoder.sampleRate));
-         carrierOn.setTimeEnd(static_cast<double>(decoder.carrierOnTime) / static_cast<double>(decoder.sampleRate));
-         carrierOn.setDateTime(decoder.streamTime + carrierOn.timeStart());
-         carrierOn.flip();
-
-         frames.push_back(carrierOn);
+         carrierEdge(NfcCarrierOn, decoder.carrierOnTime, frames);
 
          decoder.carrierOffTime = 0;
          decoder.carrierEdgeTime = 0;
@@ -503,23 +796,312 @@ void NfcDecoder::Impl::detectCarrier(std::list<RawFrame> &frames)
       {
          decoder.carrierOffTime = decoder.carrierEdgeTime ? decoder.carrierEdgeTime : decoder.signalClock;
 
-         RawFrame carrierOff = RawFrame(NfcAnyTech, NfcCarrierOff);
-
-         carrierOff.setFramePhase(NfcCarrierPhase);
-         carrierOff.setSampleStart(decoder.carrierOffTime);
-         carrierOff.setSampleEnd(decoder.carrierOffTime);
-         carrierOff.setSampleRate(decoder.sampleRate);
-         carrierOff.setTimeStart(static_cast<double>(decoder.carrierOffTime) / static_cast<double>(decoder.sampleRate));
-         carrierOff.setTimeEnd(static_cast<double>(decoder.carrierOffTime) / static_cast<double>(decoder.sampleRate));
-         carrierOff.setDateTime(decoder.streamTime + carrierOff.timeStart());
-         carrierOff.flip();
-
-         frames.push_back(carrierOff);
+         carrierEdge(NfcCarrierOff, decoder.carrierOffTime, frames);
 
          decoder.carrierOnTime = 0;
          decoder.carrierEdgeTime = 0;
       }
    }
+
+   // pending carrier pulse too long or pulse train finished
+   if (carrierTrain.expireClock && decoder.signalClock >= carrierTrain.expireClock)
+      carrierExpired(frames);
+}
+
+/**
+ * Process carrier edge, emitted directly or held back as part of a short pulse
+ */
+void NfcDecoder::Impl::carrierEdge(unsigned int type, unsigned int time, std::vector<RawFrame> &frames)
+{
+   if (!carrierTrainEnabled)
+   {
+      addCarrierFrame(type, time, frames);
+      return;
+   }
+
+   if (type == NfcCarrierOn)
+   {
+      // hold carrier on until pulse width is known
+      carrierTrain.pulseOn = time;
+   }
+   else if (!carrierTrain.pulseOn)
+   {
+      // carrier on already released, or stream starts without carrier
+      flushCarrierTrain(frames);
+
+      addCarrierFrame(NfcCarrierOff, time, frames);
+   }
+   else
+   {
+      unsigned int on = carrierTrain.pulseOn;
+
+      carrierTrain.pulseOn = 0;
+
+      if (time - on <= carrierPulseWidth)
+      {
+         addCarrierPulse(on, time, frames);
+      }
+      else
+      {
+         flushCarrierTrain(frames);
+
+         addCarrierFrame(NfcCarrierOn, on, frames);
+         addCarrierFrame(NfcCarrierOff, time, frames);
+      }
+   }
+
+   updateCarrierExpire();
+}
+
+/**
+ * Modulation found, current carrier on is not part of a pulse train
+ */
+void NfcDecoder::Impl::carrierModulated(std::vector<RawFrame> &frames)
+{
+   if (!carrierTrain.pulseOn)
+      return;
+
+   unsigned int on = carrierTrain.pulseOn;
+
+   carrierTrain.pulseOn = 0;
+
+   flushCarrierTrain(frames);
+
+   addCarrierFrame(NfcCarrierOn, on, frames);
+
+   updateCarrierExpire();
+}
+
+/**
+ * Current carrier on is longer than a pulse, or no more pulses arrived in time for current train
+ */
+void NfcDecoder::Impl::carrierExpired(std::vector<RawFrame> &frames)
+{
+   if (carrierTrain.pulseOn)
+      carrierModulated(frames);
+   else
+      flushCarrierTrain(frames);
+
+   updateCarrierExpire();
+}
+
+/**
+ * Add short pulse to current train, releasing previous pulses that are not periodic with it
+ */
+void NfcDecoder::Impl::addCarrierPulse(unsigned int on, unsigned int off, std::vector<RawFrame> &frames)
+{
+   while (carrierTrain.count && !isCarrierPeriodic(on))
+   {
+      if (carrierTrain.count >= CARRIER_TRAIN_PULSES)
+         flushCarrierTrain(frames);
+      else
+         releaseCarrierPulse(frames);
+   }
+
+   if (carrierTrain.count < CARRIER_TRAIN_PULSES)
+      carrierTrain.pulses[carrierTrain.count] = {on, off};
+
+   if (!carrierTrain.count)
+      carrierTrain.firstOn = on;
+
+   carrierTrain.count++;
+   carrierTrain.lastOn = on;
+   carrierTrain.lastOff = off;
+   carrierTrain.widthSum += off - on;
+
+   if (carrierTrain.count > 1)
+      carrierTrain.period = (on - carrierTrain.firstOn) / (carrierTrain.count - 1);
+}
+
+/**
+ * Emit first held pulse as individual carrier frames and remove it from unconfirmed train
+ */
+void NfcDecoder::Impl::releaseCarrierPulse(std::vector<RawFrame> &frames)
+{
+   const CarrierPulse first = carrierTrain.pulses[0];
+
+   addCarrierFrame(NfcCarrierOn, first.on, frames);
+   addCarrierFrame(NfcCarrierOff, first.off, frames);
+
+   for (unsigned int i = 1; i < carrierTrain.count; i++)
+      carrierTrain.pulses[i - 1] = carrierTrain.pulses[i];
+
+   carrierTrain.count--;
+   carrierTrain.widthSum -= first.off - first.on;
+   carrierTrain.firstOn = carrierTrain.pulses[0].on;
+   carrierTrain.period = carrierTrain.count > 1 ? (carrierTrain.lastOn - carrierTrain.firstOn) / (carrierTrain.count - 1) : 0;
+}
+
+/**
+ * Emit current train as a single frame if confirmed, or its held pulses as individual frames
+ */
+void NfcDecoder::Impl::flushCarrierTrain(std::vector<RawFrame> &frames)
+{
+   if (carrierTrain.count >= CARRIER_TRAIN_PULSES)
+   {
+      addCarrierTrainFrame(frames);
+   }
+   else
+   {
+      for (unsigned int i = 0; i < carrierTrain.count; i++)
+      {
+         addCarrierFrame(NfcCarrierOn, carrierTrain.pulses[i].on, frames);
+         addCarrierFrame(NfcCarrierOff, carrierTrain.pulses[i].off, frames);
+      }
+   }
+
+   carrierTrain.count = 0;
+   carrierTrain.period = 0;
+   carrierTrain.widthSum = 0;
+}
+
+/**
+ * Next signal clock to check current pulse width or train end
+ */
+void NfcDecoder::Impl::updateCarrierExpire()
+{
+   if (carrierTrain.pulseOn)
+      carrierTrain.expireClock = carrierTrain.pulseOn + carrierPulseWidth + 1;
+   else if (carrierTrain.count > 1)
+      carrierTrain.expireClock = carrierTrain.lastOn + carrierTrain.period + carrierTrain.period / 8 + 1;
+   else if (carrierTrain.count)
+      carrierTrain.expireClock = carrierTrain.lastOn + carrierPulsePeriod + 1;
+   else
+      carrierTrain.expireClock = 0;
+}
+
+/**
+ * Check if pulse starting at given time continues current train, within 1/8 of its period
+ */
+bool NfcDecoder::Impl::isCarrierPeriodic(unsigned int on) const
+{
+   unsigned int spacing = on - carrierTrain.lastOn;
+
+   if (carrierTrain.count == 1)
+      return spacing <= carrierPulsePeriod;
+
+   unsigned int tolerance = carrierTrain.period / 8;
+
+   return spacing + tolerance >= carrierTrain.period && spacing <= carrierTrain.period + tolerance;
+}
+
+/**
+ * Emit individual carrier on / off frame
+ */
+void NfcDecoder::Impl::addCarrierFrame(unsigned int type, unsigned int time, std::vector<RawFrame> &frames) const
+{
+   RawFrame carrierFrame = RawFrame(NfcAnyTech, type);
+
+   carrierFrame.setFramePhase(NfcCarrierPhase);
+   carrierFrame.setSampleStart(time);
+   carrierFrame.setSampleEnd(time);
+   carrierFrame.setSampleRate(decoder.sampleRate);
+   carrierFrame.setTimeStart(static_cast<double>(time) / static_cast<double>(decoder.sampleRate));
+   carrierFrame.setTimeEnd(static_cast<double>(time) / static_cast<double>(decoder.sampleRate));
+   carrierFrame.setDateTime(decoder.streamTime + carrierFrame.timeStart());
+   carrierFrame.flip();
+
+   frames.push_back(carrierFrame);
+}
+
+/**
+ * Emit current train summary, payload is pulse count, period and average pulse width, 32 bit big endian, times in nanoseconds
+ */
+void NfcDecoder::Impl::addCarrierTrainFrame(std::vector<RawFrame> &frames) const
+{
+   RawFrame trainFrame = RawFrame(12);
+
+   unsigned int values[3] = {
+      carrierTrain.count,
+      static_cast<unsigned int>(std::round(1E9 * carrierTrain.period / decoder.sampleRate)),
+      static_cast<unsigned int>(std::round(1E9 * carrierTrain.widthSum / carrierTrain.count / decoder.sampleRate))
+   };
+
+   for (unsigned int value: values)
+   {
+      trainFrame.put(static_cast<unsigned char>(value >> 24));
+      trainFrame.put(static_cast<unsigned char>(value >> 16));
+      trainFrame.put(static_cast<unsigned char>(value >> 8));
+      trainFrame.put(static_cast<unsigned char>(value));
+   }
+
+   trainFrame.setTechType(NfcAnyTech);
+   trainFrame.setFrameType(NfcCarrierTrain);
+   trainFrame.setFramePhase(NfcCarrierPhase);
+   trainFrame.setSampleStart(carrierTrain.firstOn);
+   trainFrame.setSampleEnd(carrierTrain.lastOff);
+   trainFrame.setSampleRate(decoder.sampleRate);
+   trainFrame.setTimeStart(static_cast<double>(carrierTrain.firstOn) / static_cast<double>(decoder.sampleRate));
+   trainFrame.setTimeEnd(static_cast<double>(carrierTrain.lastOff) / static_cast<double>(decoder.sampleRate));
+   trainFrame.setDateTime(decoder.streamTime + trainFrame.timeStart());
+   trainFrame.flip();
+
+   frames.push_back(trainFrame);
+}
+
+/**
+ * Capture current decoder status
+ */
+NfcDecoder::Checkpoint NfcDecoder::Impl::saveCheckpoint() const
+{
+   Checkpoint checkpoint;
+
+   checkpoint.sampleOffset = decoder.signalClock;
+   checkpoint.sampleRate = decoder.sampleRate;
+
+   NfcStateWriter writer(checkpoint.data);
+
+   writer.put(CHECKPOINT_VERSION);
+
+   decoder.saveState(writer);
+
+   nfca.saveState(writer);
+   nfcb.saveState(writer);
+   nfcf.saveState(writer);
+   nfcv.saveState(writer);
+
+   writer.put(carrierTrain);
+
+   return checkpoint;
+}
+
+/**
+ * Restore decoder status from previous checkpoint, decoder configuration must be the same used when checkpoint was taken
+ */
+bool NfcDecoder::Impl::loadCheckpoint(const Checkpoint &checkpoint)
+{
+   NfcStateReader reader(checkpoint.data);
+
+   unsigned int version;
+
+   if (!reader.get(version) || version != CHECKPOINT_VERSION)
+   {
+      log->warn("invalid checkpoint version");
+      return false;
+   }
+
+   // configure all signal and bitrate parameters for checkpoint sample rate
+   decoder.sampleRate = checkpoint.sampleRate;
+
+   initialize();
+
+   // then restore decoder status
+   if (!decoder.loadState(reader) || !nfca.loadState(reader) || !nfcb.loadState(reader) || !nfcf.loadState(reader) || !nfcv.loadState(reader) || !reader.get(carrierTrain))
+   {
+      log->warn("invalid checkpoint data, decoder reset");
+
+      initialize();
+
+      return false;
+   }
+
+   log->info("decoder restored from checkpoint at sample {}", {checkpoint.sampleOffset});
+
+   // next checkpoint after current sample clock
+   if (checkpointInterval)
+      checkpointClock = (decoder.signalClock / checkpointInterval + 1) * static_cast<unsigned long long>(checkpointInterval);
+
+   return true;
 }
 
-}
\ No newline at end of file
+}
@@ -25,72 +25,115 @@
 
 namespace lab {
 
-bool NfcDecoderStatus::nextSample(hw::SignalBuffer &buffer)
+/*
+ * Process one sample through envelope, DC removal, variance and carrier edge detectors, shared by single
+ * and block sample processing so status may be kept either in decoder members or in local copies
+ */
+static inline void nextStep(const NfcSignalParams &params, NfcTimeSample *sample, float lowThreshold, float highThreshold, float value,
+                            unsigned int &clock, unsigned int &filter, unsigned int &edgeTime, float &edgePeak,
+                            float &filtered, float &envelope, float &average, float &deviation, float &filterN0, float &filterN1)
 {
-   if (buffer.available() == 0 || buffer.type() != hw::SignalType::SIGNAL_TYPE_RAW_REAL)
-      return false;
-
    // update signal clock and pulse filter
-   ++signalClock;
-   ++pulseFilter;
-
-   buffer.get(signalValue);
+   ++clock;
+   ++filter;
 
-   float signalDiff = std::abs(signalValue - signalEnvelope) / signalEnvelope;
+   float signalDiff = std::abs(value - envelope) / envelope;
 
    // signal average envelope detector
-   if (signalDiff < 0.05f || pulseFilter > signalParams.elementaryTimeUnit * 10)
+   if (signalDiff < 0.05f || filter > static_cast<unsigned int>(params.elementaryTimeUnit * 10))
    {
       // reset silence counter
-      pulseFilter = 0;
+      filter = 0;
 
       // compute signal average
-      signalEnvelope = signalEnvelope * signalParams.signalEnveW0 + signalValue * signalParams.signalEnveW1;
+      envelope = envelope * params.signalEnveW0 + value * params.signalEnveW1;
    }
-   else if (signalClock < signalParams.elementaryTimeUnit)
+   else if (clock < static_cast<unsigned int>(params.elementaryTimeUnit))
    {
-      signalEnvelope = signalValue;
+      envelope = value;
    }
 
    // process new IIR filter value
-   signalFilterN0 = signalValue + signalFilterN1 * signalParams.signalIIRdcA;
+   filterN0 = value + filterN1 * params.signalIIRdcA;
 
    // update signal value for IIR removal filter
-   signalFiltered = signalFilterN0 - signalFilterN1;
+   filtered = filterN0 - filterN1;
 
    // update IIR filter component
-   signalFilterN1 = signalFilterN0;
+   filterN1 = filterN0;
 
    // compute signal variance
-   signalDeviation = signalDeviation * signalParams.signalMdevW0 + std::abs(signalFiltered) * signalParams.signalMdevW1;
+   deviation = deviation * params.signalMdevW0 + std::abs(filtered) * params.signalMdevW1;
 
    // process new signal envelope value
-   signalAverage = signalAverage * signalParams.signalMeanW0 + signalValue * signalParams.signalMeanW1;
+   average = average * params.signalMeanW0 + value * params.signalMeanW1;
 
    // store signal components in process buffer
-   sample[signalClock & (BUFFER_SIZE - 1)].samplingValue = signalValue;
-   sample[signalClock & (BUFFER_SIZE - 1)].filteredValue = signalFiltered;
-   sample[signalClock & (BUFFER_SIZE - 1)].meanDeviation = signalDeviation;
-   sample[signalClock & (BUFFER_SIZE - 1)].modulateDepth = (signalEnvelope - std::clamp(signalValue, 0.0f, signalEnvelope)) / signalEnvelope;
+   NfcTimeSample &entry = sample[clock & (BUFFER_SIZE - 1)];
+
+   entry.samplingValue = value;
+   entry.filteredValue = filtered;
+   entry.meanDeviation = deviation;
+   entry.modulateDepth = (envelope - std::clamp(value, 0.0f, envelope)) / envelope;
 
    // get absolute DC-removed signal for edge detector
-   float filteredRectified = std::fabs(signalFiltered);
+   float filteredRectified = std::fabs(filtered);
 
    // detect last carrier edge on/off
-   if (filteredRectified > signalHighThreshold)
+   if (filteredRectified > highThreshold)
    {
       // search maximum pulse value
-      if (filteredRectified > carrierEdgePeak)
+      if (filteredRectified > edgePeak)
       {
-         carrierEdgePeak = filteredRectified;
-         carrierEdgeTime = signalClock;
+         edgePeak = filteredRectified;
+         edgeTime = clock;
       }
    }
-   else if (filteredRectified < signalLowThreshold)
+   else if (filteredRectified < lowThreshold)
+   {
+      edgePeak = 0;
+   }
+}
+
+bool NfcDecoderStatus::nextSample(hw::SignalBuffer &buffer)
+{
+   if (buffer.available() == 0 || buffer.type() != hw::SignalType::SIGNAL_TYPE_RAW_REAL)
+      return false;
+
+   // take sample status from shared front end
+   if (frontEnd)
    {
-      carrierEdgePeak = 0;
+      const NfcFrontEndSample &entry = frontEnd[buffer.position() - frontEndBase];
+
+      ++signalClock;
+
+      buffer.get(signalValue);
+
+      pulseFilter = entry.pulseFilter;
+      carrierEdgePeak = entry.carrierEdgePeak;
+
+      // edge time is cleared by carrier detector of each decoder, so only new peaks are taken from front end
+      if (entry.carrierEdgeFound)
+         carrierEdgeTime = signalClock;
+
+      signalFiltered = entry.signalFiltered;
+      signalEnvelope = entry.signalEnvelope;
+      signalAverage = entry.signalAverage;
+      signalDeviation = entry.signalDeviation;
+      signalFilterN0 = entry.signalFilterN0;
+      signalFilterN1 = entry.signalFilterN0;
+
+      sample[signalClock & (BUFFER_SIZE - 1)] = entry.sample;
+
+      return true;
    }
 
+   buffer.get(signalValue);
+
+   nextStep(signalParams, sample, signalLowThreshold, signalHighThreshold, signalValue,
+            signalClock, pulseFilter, carrierEdgeTime, carrierEdgePeak,
+            signalFiltered, signalEnvelope, signalAverage, signalDeviation, signalFilterN0, signalFilterN1);
+
    if (debug)
    {
       debug->block(signalClock);
@@ -104,4 +147,139 @@ bool NfcDecoderStatus::nextSample(hw::SignalBuffer &buffer)
    return true;
 }
 
+unsigned int NfcDecoderStatus::nextSamples(hw::SignalBuffer &buffer, unsigned int count)
+{
+   if (buffer.type() != hw::SignalType::SIGNAL_TYPE_RAW_REAL)
+      return 0;
+
+   // shared front end and signal debug are processed sample by sample
+   if (frontEnd || debug)
+   {
+      unsigned int processed = 0;
+
+      while (processed < count && nextSample(buffer))
+         ++processed;
+
+      return processed;
+   }
+
+   count = std::min(count, buffer.available());
+
+   const float *data = buffer.pull(count);
+
+   // filter status is kept in locals as sample buffer stores may alias members
+   const NfcSignalParams params = signalParams;
+
+   unsigned int clock = signalClock;
+   unsigned int filter = pulseFilter;
+   unsigned int edgeTime = carrierEdgeTime;
+
+   float value = signalValue;
+   float filtered = signalFiltered;
+   float envelope = signalEnvelope;
+   float average = signalAverage;
+   float deviation = signalDeviation;
+   float filterN0 = signalFilterN0;
+   float filterN1 = signalFilterN1;
+   float edgePeak = carrierEdgePeak;
+   float lowThreshold = signalLowThreshold;
+   float highThreshold = signalHighThreshold;
+
+   for (unsigned int i = 0; i < count; i++)
+   {
+      value = data[i];
+
+      nextStep(params, sample, lowThreshold, highThreshold, value, clock, filter, edgeTime, edgePeak, filtered, envelope, average, deviation, filterN0, filterN1);
+   }
+
+   signalClock = clock;
+   pulseFilter = filter;
+   carrierEdgeTime = edgeTime;
+
+   signalValue = value;
+   signalFiltered = filtered;
+   signalEnvelope = envelope;
+   signalAverage = average;
+   signalDeviation = deviation;
+   signalFilterN0 = filterN0;
+   signalFilterN1 = filterN1;
+   carrierEdgePeak = edgePeak;
+
+   return count;
+}
+
+void NfcDecoderStatus::nextFrontEnd(hw::SignalBuffer &buffer, std::vector<NfcFrontEndSample> &result)
+{
+   result.clear();
+   result.reserve(buffer.available());
+
+   while (nextSample(buffer))
+   {
+      NfcFrontEndSample &entry = result.emplace_back();
+
+      entry.sample = sample[signalClock & (BUFFER_SIZE - 1)];
+      entry.pulseFilter = pulseFilter;
+      entry.carrierEdgeFound = carrierEdgeTime == signalClock;
+      entry.carrierEdgePeak = carrierEdgePeak;
+      entry.signalFiltered = signalFiltered;
+      entry.signalEnvelope = signalEnvelope;
+      entry.signalAverage = signalAverage;
+      entry.signalDeviation = signalDeviation;
+      entry.signalFilterN0 = signalFilterN0;
+   }
+}
+
+void NfcDecoderStatus::saveState(NfcStateWriter &writer) const
+{
+   writer.put(signalParams);
+   writer.put(sample);
+   writer.put(sampleRate);
+   writer.put(signalClock);
+   writer.put(streamTime);
+   writer.put(pulseFilter);
+   writer.put(powerLevelThreshold);
+   writer.put(signalValue);
+   writer.put(signalFiltered);
+   writer.put(signalEnvelope);
+   writer.put(signalAverage);
+   writer.put(signalDeviation);
+   writer.put(signalFilterN0);
+   writer.put(signalFilterN1);
+   writer.put(signalLowThreshold);
+   writer.put(signalHighThreshold);
+   writer.put(carrierEdgePeak);
+   writer.put(carrierEdgeTime);
+   writer.put(carrierOffTime);
+   writer.put(carrierOnTime);
+}
+
+bool NfcDecoderStatus::loadState(NfcStateReader &reader)
+{
+   // bitrate, pulse and modulation are restored later by owner tech
+   bitrate = nullptr;
+   pulse = nullptr;
+   modulation = nullptr;
+
+   return reader.get(signalParams) &&
+      reader.get(sample) &&
+      reader.get(sampleRate) &&
+      reader.get(signalClock) &&
+      reader.get(streamTime) &&
+      reader.get(pulseFilter) &&
+      reader.get(powerLevelThreshold) &&
+      reader.get(signalValue) &&
+      reader.get(signalFiltered) &&
+      reader.get(signalEnvelope) &&
+      reader.get(signalAverage) &&
+      reader.get(signalDeviation) &&
+      reader.get(signalFilterN0) &&
+      reader.get(signalFilterN1) &&
+      reader.get(signalLowThreshold) &&
+      reader.get(signalHighThreshold) &&
+      reader.get(carrierEdgePeak) &&
+      reader.get(carrierEdgeTime) &&
+      reader.get(carrierOffTime) &&
+      reader.get(carrierOnTime);
+}
+
 }
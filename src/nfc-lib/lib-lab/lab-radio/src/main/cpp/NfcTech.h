@@ -23,7 +23,10 @@
 #define NFC_NFCTECH_H
 
 #include <cmath>
+#include <cstring>
+#include <vector>
 #include <algorithm>
+#include <type_traits>
 
 #include <hw/SignalType.h>
 #include <hw/SignalBuffer.h>
@@ -215,6 +218,22 @@ struct NfcTimeSample
    float modulateDepth; // modulation deep at sample time
 };
 
+/*
+ * signal front end status after process one sample, shared between parameter sweep decoders
+ */
+struct NfcFrontEndSample
+{
+   NfcTimeSample sample; // processed sample values
+   unsigned int pulseFilter; // signal pulse filter
+   bool carrierEdgeFound; // carrier trigger peak found at this sample
+   float carrierEdgePeak; // carrier trigger peak value
+   float signalFiltered; // signal DC removed value
+   float signalEnvelope; // signal envelope value
+   float signalAverage; // signal average value
+   float signalDeviation; // signal variance value
+   float signalFilterN0; // signal DC-removal IIR filter
+};
+
 /*
  * modulation status (one for each symbol rate)
  */
@@ -314,6 +333,59 @@ struct NfcFrameStatus
    unsigned int requestGuardTime;
 };
 
+/*
+ * decoder state serializer, used for checkpoints
+ */
+struct NfcStateWriter
+{
+   std::vector<unsigned char> &data;
+
+   explicit NfcStateWriter(std::vector<unsigned char> &data) : data(data)
+   {
+   }
+
+   template <typename T>
+   void put(const T &value)
+   {
+      static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be serialized");
+
+      size_t offset = data.size();
+
+      data.resize(offset + sizeof(T));
+
+      std::memcpy(data.data() + offset, &value, sizeof(T));
+   }
+};
+
+/*
+ * decoder state deserializer, used for checkpoints
+ */
+struct NfcStateReader
+{
+   const std::vector<unsigned char> &data;
+
+   size_t offset = 0;
+
+   explicit NfcStateReader(const std::vector<unsigned char> &data) : data(data)
+   {
+   }
+
+   template <typename T>
+   bool get(T &value)
+   {
+      static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable types can be serialized");
+
+      if (offset + sizeof(T) > data.size())
+         return false;
+
+      std::memcpy(&value, data.data() + offset, sizeof(T));
+
+      offset += sizeof(T);
+
+      return true;
+   }
+};
+
 struct NfcDecoderStatus
 {
    // signal parameters
@@ -388,8 +460,51 @@ struct NfcDecoderStatus
    // signal debugger
    std::shared_ptr<NfcSignalDebug> debug;
 
+   // fast-forward listen frame guard time updating only running integrations, disabled with signal debug
+   bool guardSkip = true;
+
+   // bulk search of preamble candidates before sample blocks are processed, disabled with signal debug
+   bool preambleScan = true;
+
+   // precomputed front end, if present samples are taken from it instead of being processed
+   const NfcFrontEndSample *frontEnd = nullptr;
+
+   // buffer position for first front end sample
+   unsigned int frontEndBase = 0;
+
    // process next sample from signal buffer
    bool nextSample(hw::SignalBuffer &buffer);
+
+   // process up to count samples from signal buffer, returns number of processed samples
+   unsigned int nextSamples(hw::SignalBuffer &buffer, unsigned int count);
+
+   // process samples from signal buffer up to given clock calling update after each one, returns false if buffer ends before
+   template <typename T>
+   bool skipSamples(hw::SignalBuffer &buffer, unsigned int clock, T &&update)
+   {
+      while (signalClock < clock)
+      {
+         // front end runs up to one block ahead, far less than sample buffer delays so updates read the same samples
+         unsigned int count = nextSamples(buffer, std::min(clock - signalClock, 32u));
+
+         if (!count)
+            return false;
+
+         while (count--)
+            update();
+      }
+
+      return true;
+   }
+
+   // process all samples from signal buffer storing front end status for each one
+   void nextFrontEnd(hw::SignalBuffer &buffer, std::vector<NfcFrontEndSample> &result);
+
+   // serialize signal status, detected bitrate and modulation are stored by each tech
+   void saveState(NfcStateWriter &writer) const;
+
+   // restore signal status, detected bitrate and modulation are restored by each tech
+   bool loadState(NfcStateReader &reader);
 };
 
 struct NfcTech
@@ -417,7 +417,7 @@ struct NfcA::Impl : NfcTech
    /*
     * Decode next poll or listen frame
     */
-   void decodeFrame(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+   void decodeFrame(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
    {
       if (frameStatus.frameType == NfcPollFrame)
       {
@@ -433,7 +433,7 @@ struct NfcA::Impl : NfcTech
    /*
     * Decode next poll frame
     */
-   bool decodePollFrame(hw::SignalBuffer &buffer, std::list<RawFrame> &frames)
+   bool decodePollFrame(hw::SignalBuffer &buffer, std::vector<RawFrame> &frames)
    {
       int pattern;
       bool frameEnd = false, truncateError = false;
@@ -569,7 +569,7 @@ struct NfcA::Impl : NfcTech
    /*
     * Decode next listen frame
     */
-   bool decodeListenFrame(hw::SignalBuffer &buffer, std::list<RawFrame> &frames)
+   bool decodeListenFrame(hw::SignalBuffer &buffer, std::vector<RawFrame> &frames)
    {
       int pattern;
       bool frameEnd = false, truncateError = false;
@@ -949,6 +949,27 @@ struct NfcA::Impl : NfcTech
       unsigned int signalIndex = (bitrate->offsetSignalIndex + decoder->signalClock);
       unsigned int delay2Index = (bitrate->offsetDelay2Index + decoder->signalClock);
 
+      // fast-forward guard time up to one symbol before its end, correlation buffer is fully refilled after that
+      if (decoder->guardSkip && !decoder->debug && decoder->signalClock + bitrate->period1SymbolSamples < frameStatus.guardEnd)
+      {
+         bool completed = decoder->skipSamples(buffer, frameStatus.guardEnd - bitrate->period1SymbolSamples, [&] {
+            ++signalIndex;
+            ++futureIndex;
+            ++delay2Index;
+
+            float signalData = decoder->sample[signalIndex & (BUFFER_SIZE - 1)].filteredValue;
+
+            // same moving average as main loop
+            modulation->integrationData[signalIndex & (BUFFER_SIZE - 1)] = signalData * signalData * 10;
+            modulation->filterIntegrate += modulation->integrationData[signalIndex & (BUFFER_SIZE - 1)];
+            modulation->filterIntegrate -= modulation->integrationData[delay2Index & (BUFFER_SIZE - 1)];
+         });
+
+         // buffer exhausted before guard end
+         if (!completed)
+            return Invalid;
+      }
+
       while (decoder->nextSample(buffer))
       {
          ++signalIndex;
@@ -1231,6 +1252,21 @@ struct NfcA::Impl : NfcTech
       unsigned int delay4Index = (bitrate->offsetDelay4Index + decoder->signalClock);
       unsigned int futureIndex = (bitrate->offsetFutureIndex + decoder->signalClock);
 
+      // fast-forward guard time up to one symbol before its end, phase integration starts at guard end from the last 1/4 symbol
+      if (decoder->guardSkip && !decoder->debug && decoder->signalClock + bitrate->period1SymbolSamples < frameStatus.guardEnd)
+      {
+         bool completed = decoder->skipSamples(buffer, frameStatus.guardEnd - bitrate->period1SymbolSamples, [&] {
+            ++futureIndex;
+            ++signalIndex;
+            ++delay1Index;
+            ++delay4Index;
+         });
+
+         // buffer exhausted before guard end
+         if (!completed)
+            return Invalid;
+      }
+
       while (decoder->nextSample(buffer))
       {
          ++futureIndex;
@@ -1722,8 +1758,11 @@ struct NfcA::Impl : NfcTech
             // sets the activation frame waiting time for ATS response
             frameStatus.frameWaitingTime = static_cast<int>(decoder->signalParams.sampleTimeUnit * NFC_FWT_ACTIVATION);
 
-            log->debug("RATS frame parameters");
-            log->debug("  maxFrameSize {} bytes", {protocolStatus.maxFrameSize});
+            if (log->isDebugEnabled())
+            {
+               log->debug("RATS frame parameters");
+               log->debug("  maxFrameSize {} bytes", {protocolStatus.maxFrameSize});
+            }
 
             // set frame flags
             frame.setFramePhase(NfcSelectionPhase);
@@ -1778,9 +1817,12 @@ struct NfcA::Impl : NfcTech
                   protocolStatus.frameWaitingTime = static_cast<int>(decoder->signalParams.sampleTimeUnit * NFCA_FWT_DEF);
                }
 
-               log->debug("ATS protocol timing parameters");
-               log->debug("  startUpGuardTime {} samples ({} us)", {protocolStatus.startUpGuardTime, 1000000.0 * protocolStatus.startUpGuardTime / decoder->sampleRate});
-               log->debug("  frameWaitingTime {} samples ({} us)", {protocolStatus.frameWaitingTime, 1000000.0 * protocolStatus.frameWaitingTime / decoder->sampleRate});
+               if (log->isDebugEnabled())
+               {
+                  log->debug("ATS protocol timing parameters");
+                  log->debug("  startUpGuardTime {} samples ({} us)", {protocolStatus.startUpGuardTime, 1000000.0 * protocolStatus.startUpGuardTime / decoder->sampleRate});
+                  log->debug("  frameWaitingTime {} samples ({} us)", {protocolStatus.frameWaitingTime, 1000000.0 * protocolStatus.frameWaitingTime / decoder->sampleRate});
+               }
             }
 
             frame.setFramePhase(NfcSelectionPhase);
@@ -2007,6 +2049,52 @@ struct NfcA::Impl : NfcTech
 
       return parity;
    }
+   /*
+    * Serialize decoder status
+    */
+   void saveState(NfcStateWriter &writer) const
+   {
+      // detected bitrate and modulation are stored as index, or -1 if not owned by this tech
+      int bitrateIndex = decoder->bitrate >= bitrateParams && decoder->bitrate < bitrateParams + 4 ? static_cast<int>(decoder->bitrate - bitrateParams) : -1;
+      int modulationIndex = decoder->modulation >= modulationStatus && decoder->modulation < modulationStatus + 4 ? static_cast<int>(decoder->modulation - modulationStatus) : -1;
+
+      writer.put(bitrateIndex);
+      writer.put(modulationIndex);
+      writer.put(symbolStatus);
+      writer.put(streamStatus);
+      writer.put(frameStatus);
+      writer.put(protocolStatus);
+      writer.put(modulationStatus);
+      writer.put(lastFrameEnd);
+      writer.put(chainedFlags);
+   }
+
+   /*
+    * Restore decoder status
+    */
+   bool loadState(NfcStateReader &reader)
+   {
+      int bitrateIndex, modulationIndex;
+
+      if (!reader.get(bitrateIndex) ||
+         !reader.get(modulationIndex) ||
+         !reader.get(symbolStatus) ||
+         !reader.get(streamStatus) ||
+         !reader.get(frameStatus) ||
+         !reader.get(protocolStatus) ||
+         !reader.get(modulationStatus) ||
+         !reader.get(lastFrameEnd) ||
+         !reader.get(chainedFlags))
+         return false;
+
+      if (bitrateIndex >= 0 && bitrateIndex < 4)
+         decoder->bitrate = bitrateParams + bitrateIndex;
+
+      if (modulationIndex >= 0 && modulationIndex < 4)
+         decoder->modulation = modulationStatus + modulationIndex;
+
+      return true;
+   }
 };
 
 NfcA::NfcA(NfcDecoderStatus *decoder) : self(new Impl(decoder))
@@ -2067,9 +2155,25 @@ bool NfcA::detect()
 /*
  * Decode next poll or listen frame
  */
-void NfcA::decode(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+void NfcA::decode(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
 {
    self->decodeFrame(samples, frames);
 }
 
+/*
+ * Serialize NFC-A decoder status
+ */
+void NfcA::saveState(NfcStateWriter &writer) const
+{
+   self->saveState(writer);
+}
+
+/*
+ * Restore NFC-A decoder status
+ */
+bool NfcA::loadState(NfcStateReader &reader)
+{
+   return self->loadState(reader);
+}
+
 }
@@ -22,7 +22,7 @@
 #ifndef LAB_NFCA_H
 #define LAB_NFCA_H
 
-#include <list>
+#include <vector>
 
 #include <hw/SignalBuffer.h>
 
@@ -73,7 +73,11 @@ struct NfcA
 
    bool detect();
 
-   void decode(hw::SignalBuffer &samples, std::list<RawFrame> &frames);
+   void decode(hw::SignalBuffer &samples, std::vector<RawFrame> &frames);
+
+   void saveState(NfcStateWriter &writer) const;
+
+   bool loadState(NfcStateReader &reader);
 };
 
 }
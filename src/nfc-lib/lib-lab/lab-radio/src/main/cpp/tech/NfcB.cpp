@@ -438,7 +438,7 @@ struct NfcB::Impl : NfcTech
    /*
     * Decode next poll or listen frame
     */
-   void decodeFrame(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+   void decodeFrame(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
    {
       if (frameStatus.frameType == NfcPollFrame)
       {
@@ -454,7 +454,7 @@ struct NfcB::Impl : NfcTech
    /*
     * Decode next poll frame
     */
-   bool decodePollFrame(hw::SignalBuffer &buffer, std::list<RawFrame> &frames)
+   bool decodePollFrame(hw::SignalBuffer &buffer, std::vector<RawFrame> &frames)
    {
       int pattern;
       bool frameEnd = false, truncateError = false, streamError = false;
@@ -573,7 +573,7 @@ struct NfcB::Impl : NfcTech
    /*
     * Decode next listen frame
     */
-   bool decodeListenFrame(hw::SignalBuffer &buffer, std::list<RawFrame> &frames)
+   bool decodeListenFrame(hw::SignalBuffer &buffer, std::vector<RawFrame> &frames)
    {
       int pattern;
       bool frameEnd = false, truncateError = false, streamError = false;
@@ -778,6 +778,29 @@ struct NfcB::Impl : NfcTech
       unsigned int delay4Index = (bitrate->offsetDelay4Index + decoder->signalClock);
       unsigned int futureIndex = (bitrate->offsetFutureIndex + decoder->signalClock);
 
+      // fast-forward guard time up to one symbol before its end, phase integration runs on every sample
+      if (decoder->guardSkip && !decoder->debug && decoder->signalClock + bitrate->period1SymbolSamples < frameStatus.guardEnd)
+      {
+         bool completed = decoder->skipSamples(buffer, frameStatus.guardEnd - bitrate->period1SymbolSamples, [&] {
+            ++futureIndex;
+            ++signalIndex;
+            ++delay1Index;
+            ++delay4Index;
+
+            float signalData = decoder->sample[signalIndex & (BUFFER_SIZE - 1)].filteredValue;
+            float delay1Data = decoder->sample[delay1Index & (BUFFER_SIZE - 1)].filteredValue;
+
+            // same phase integration as main loop
+            modulation->integrationData[signalIndex & (BUFFER_SIZE - 1)] = signalData * delay1Data * 10;
+            modulation->phaseIntegrate += modulation->integrationData[signalIndex & (BUFFER_SIZE - 1)];
+            modulation->phaseIntegrate -= modulation->integrationData[delay4Index & (BUFFER_SIZE - 1)];
+         });
+
+         // buffer exhausted before guard end
+         if (!completed)
+            return Invalid;
+      }
+
       while (decoder->nextSample(buffer))
       {
          ++futureIndex;
@@ -1198,9 +1221,12 @@ struct NfcB::Impl : NfcTech
             frame.setFramePhase(NfcSelectionPhase);
             frame.setFrameFlags(!checkCrc(frame) ? CrcError : 0);
 
-            log->debug("ATQB protocol timing parameters");
-            log->debug("  maxFrameSize {} bytes", {protocolStatus.maxFrameSize});
-            log->debug("  frameWaitingTime {} samples ({} us)", {protocolStatus.frameWaitingTime, 1E6 * protocolStatus.frameWaitingTime / decoder->sampleRate});
+            if (log->isDebugEnabled())
+            {
+               log->debug("ATQB protocol timing parameters");
+               log->debug("  maxFrameSize {} bytes", {protocolStatus.maxFrameSize});
+               log->debug("  frameWaitingTime {} samples ({} us)", {protocolStatus.frameWaitingTime, 1E6 * protocolStatus.frameWaitingTime / decoder->sampleRate});
+            }
 
             return true;
          }
@@ -1285,6 +1311,52 @@ struct NfcB::Impl : NfcTech
 
       return res == crc;
    }
+   /*
+    * Serialize decoder status
+    */
+   void saveState(NfcStateWriter &writer) const
+   {
+      // detected bitrate and modulation are stored as index, or -1 if not owned by this tech
+      int bitrateIndex = decoder->bitrate >= bitrateParams && decoder->bitrate < bitrateParams + 4 ? static_cast<int>(decoder->bitrate - bitrateParams) : -1;
+      int modulationIndex = decoder->modulation >= modulationStatus && decoder->modulation < modulationStatus + 4 ? static_cast<int>(decoder->modulation - modulationStatus) : -1;
+
+      writer.put(bitrateIndex);
+      writer.put(modulationIndex);
+      writer.put(symbolStatus);
+      writer.put(streamStatus);
+      writer.put(frameStatus);
+      writer.put(protocolStatus);
+      writer.put(modulationStatus);
+      writer.put(lastFrameEnd);
+      writer.put(chainedFlags);
+   }
+
+   /*
+    * Restore decoder status
+    */
+   bool loadState(NfcStateReader &reader)
+   {
+      int bitrateIndex, modulationIndex;
+
+      if (!reader.get(bitrateIndex) ||
+         !reader.get(modulationIndex) ||
+         !reader.get(symbolStatus) ||
+         !reader.get(streamStatus) ||
+         !reader.get(frameStatus) ||
+         !reader.get(protocolStatus) ||
+         !reader.get(modulationStatus) ||
+         !reader.get(lastFrameEnd) ||
+         !reader.get(chainedFlags))
+         return false;
+
+      if (bitrateIndex >= 0 && bitrateIndex < 4)
+         decoder->bitrate = bitrateParams + bitrateIndex;
+
+      if (modulationIndex >= 0 && modulationIndex < 4)
+         decoder->modulation = modulationStatus + modulationIndex;
+
+      return true;
+   }
 };
 
 NfcB::NfcB(NfcDecoderStatus *decoder) : self(new Impl(decoder))
@@ -1336,9 +1408,19 @@ bool NfcB::detect()
    return self->detectModulation();
 }
 
-void NfcB::decode(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+void NfcB::decode(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
 {
    self->decodeFrame(samples, frames);
 }
 
+void NfcB::saveState(NfcStateWriter &writer) const
+{
+   self->saveState(writer);
+}
+
+bool NfcB::loadState(NfcStateReader &reader)
+{
+   return self->loadState(reader);
+}
+
 }
@@ -22,7 +22,7 @@
 #ifndef LAB_NFCB_H
 #define LAB_NFCB_H
 
-#include <list>
+#include <vector>
 
 #include <hw/SignalBuffer.h>
 
@@ -62,7 +62,11 @@ struct NfcB
 
    bool detect();
 
-   void decode(hw::SignalBuffer &samples, std::list<RawFrame> &frames);
+   void decode(hw::SignalBuffer &samples, std::vector<RawFrame> &frames);
+
+   void saveState(NfcStateWriter &writer) const;
+
+   bool loadState(NfcStateReader &reader);
 };
 
 }
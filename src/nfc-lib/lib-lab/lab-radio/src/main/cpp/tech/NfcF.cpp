@@ -19,6 +19,7 @@
 
 */
 
+#include <cmath>
 #include <cstring>
 
 #include <rt/Logger.h>
@@ -31,6 +32,9 @@
 #define SEARCH_MODE_OBSERVED 0
 #define SEARCH_MODE_REVERSED 1
 
+// preamble scan candidates extension, in symbols at each side
+#define SCAN_EXTENT 2
+
 namespace lab {
 
 enum PatternType
@@ -64,6 +68,15 @@ struct NfcProtocolStatus
    unsigned int requestGuardTime;
 };
 
+/*
+ * range of scanned block samples where preamble search must run
+ */
+struct NfcScanWindow
+{
+   unsigned int start;
+   unsigned int end;
+};
+
 struct NfcF::Impl : NfcTech
 {
    rt::Logger *log = rt::Logger::getLogger("decoder.NfcF");
@@ -103,6 +116,22 @@ struct NfcF::Impl : NfcTech
    // chained frame flags
    unsigned int chainedFlags = 0;
 
+   // signal clock before first sample of scanned block
+   unsigned int scanClock = 0;
+
+   // number of scanned samples, 0 if block was not scanned
+   unsigned int scanLength = 0;
+
+   // sample ranges of scanned block where preamble search must run, and first range not yet passed
+   std::vector<NfcScanWindow> scanWindows;
+   unsigned int scanNext = 0;
+
+   // prefix sums of scanned block
+   std::vector<double> scanSum;
+
+   // preamble search was skipped, integration must be rebuilt before next search
+   bool searchResync = false;
+
    Impl(NfcDecoderStatus *decoder) : decoder(decoder)
    {
    }
@@ -123,6 +152,10 @@ struct NfcF::Impl : NfcTech
       // clear chained flags
       chainedFlags = 0;
 
+      // clear preamble scan
+      scanLength = 0;
+      searchResync = false;
+
       // clear detected symbol status
       symbolStatus = {};
 
@@ -207,16 +240,150 @@ struct NfcF::Impl : NfcTech
       log->debug("\trequestGuardTime {} samples ({} us)", {protocolStatus.requestGuardTime, 1000000.0 * protocolStatus.requestGuardTime / decoder->sampleRate});
    }
 
+   /*
+    * Search preamble candidates over a whole sample block before it is processed. Correlation of each bitrate is
+    * computed in bulk from prefix sums, samples where it can't reach minimum correlation value for the lowest valid
+    * envelope are skipped by detectModulation while no search is in progress.
+    */
+   void scanPreamble(const hw::SignalBuffer &samples)
+   {
+      scanClock = decoder->signalClock;
+      scanLength = 0;
+      scanNext = 0;
+      scanWindows.clear();
+
+      // per sample correlation is written to signal debug
+      if (!decoder->preambleScan || decoder->debug || samples.type() != hw::SignalType::SIGNAL_TYPE_RAW_REAL)
+         return;
+
+      const NfcBitrateParams &rate1 = bitrateParams[r212k];
+      const NfcBitrateParams &rate2 = bitrateParams[r424k];
+
+      unsigned int length = samples.available();
+
+      const float *data = samples.data() + samples.position();
+
+      // candidates are extended so short gaps are searched, resync after each gap costs more than searching it
+      unsigned int extent = rate1.period1SymbolSamples * SCAN_EXTENT;
+
+      // merged windows are separated by gaps and span at least extent samples, so block size bounds their count
+      if (scanSum.size() < length + 1)
+      {
+         scanSum.resize(length + 1);
+         scanWindows.reserve(length / (extent + 1) + 2);
+      }
+
+      scanSum[0] = 0;
+
+      // detector ignores envelopes below power level, half of it leaves margin for integration rounding
+      double minimumCorrelationValue = decoder->powerLevelThreshold * correlationThreshold * 0.5;
+
+      double threshold1 = minimumCorrelationValue * rate1.period2SymbolSamples;
+      double threshold2 = minimumCorrelationValue * rate2.period2SymbolSamples;
+
+      // same correlation points as detectModulation, integration over 1/2 symbol ending at current, delayed and previous sample
+      int integrate1 = rate1.period2SymbolSamples;
+      int integrate2 = rate2.period2SymbolSamples;
+      int delay1 = rate1.period1SymbolSamples - rate1.period2SymbolSamples;
+      int delay2 = rate2.period1SymbolSamples - rate2.period2SymbolSamples;
+
+      // first samples have no history in this block
+      unsigned int first = std::min(length, rate1.period1SymbolSamples);
+
+      if (first)
+         scanWindows.push_back({0, first});
+
+      for (unsigned int i = 0; i < first; i++)
+         scanSum[i + 1] = scanSum[i] + data[i];
+
+      for (unsigned int i = first; i < length; i++)
+      {
+         double *sum = scanSum.data() + i + 1;
+
+         sum[0] = sum[-1] + data[i];
+
+         double correlated1 = (sum[0] - sum[-integrate1]) - 2 * (sum[-delay1] - sum[-delay1 - integrate1]) + (sum[-1] - sum[-1 - integrate1]);
+         double correlated2 = (sum[0] - sum[-integrate2]) - 2 * (sum[-delay2] - sum[-delay2 - integrate2]) + (sum[-1] - sum[-1 - integrate2]);
+
+         if (std::fabs(correlated1) > threshold1 || std::fabs(correlated2) > threshold2)
+         {
+            unsigned int start = i > extent ? i - extent : 0;
+            unsigned int end = std::min(length, i + extent + 1);
+
+            if (!scanWindows.empty() && start <= scanWindows.back().end)
+               scanWindows.back().end = end;
+            else
+               scanWindows.push_back({start, end});
+         }
+      }
+
+      scanLength = length;
+   }
+
+   /*
+    * Rebuild integration and correlation buffer of each bitrate from last samples, after skipped preamble search
+    */
+   void resyncModulation()
+   {
+      for (int rate = r212k; rate <= r424k; rate++)
+      {
+         NfcBitrateParams *bitrate = bitrateParams + rate;
+         NfcModulationStatus *modulation = modulationStatus + rate;
+
+         unsigned int signalIndex = bitrate->offsetSignalIndex + decoder->signalClock;
+         unsigned int startIndex = signalIndex - bitrate->period1SymbolSamples;
+
+         float filterIntegrate = 0;
+
+         for (unsigned int index = startIndex - bitrate->period2SymbolSamples; index < startIndex; index++)
+            filterIntegrate += decoder->sample[index & (BUFFER_SIZE - 1)].samplingValue;
+
+         for (unsigned int index = startIndex; index < signalIndex; index++)
+         {
+            filterIntegrate += decoder->sample[index & (BUFFER_SIZE - 1)].samplingValue;
+            filterIntegrate -= decoder->sample[(index - bitrate->period2SymbolSamples) & (BUFFER_SIZE - 1)].samplingValue;
+
+            modulation->correlationData[index % bitrate->period1SymbolSamples] = filterIntegrate;
+         }
+
+         modulation->filterIntegrate = filterIntegrate;
+      }
+   }
+
    inline bool detectModulation()
    {
       // wait until has enough data in buffer
       if (decoder->signalClock < BUFFER_SIZE)
          return false;
 
+      // no preamble candidates near this sample and no search in progress
+      unsigned int scanIndex = decoder->signalClock - scanClock - 1;
+
+      if (scanIndex < scanLength)
+      {
+         while (scanNext < scanWindows.size() && scanWindows[scanNext].end <= scanIndex)
+            scanNext++;
+
+         if ((scanNext == scanWindows.size() || scanIndex < scanWindows[scanNext].start) &&
+            !modulationStatus[r212k].searchEndTime && !modulationStatus[r212k].correlatedPeakTime &&
+            !modulationStatus[r424k].searchEndTime && !modulationStatus[r424k].correlatedPeakTime)
+         {
+            searchResync = true;
+            return false;
+         }
+      }
+
       // ignore low power signals
       if (decoder->signalEnvelope < decoder->powerLevelThreshold)
          return false;
 
+      // integration was not updated for skipped samples
+      if (searchResync)
+      {
+         resyncModulation();
+         searchResync = false;
+      }
+
       // minimum correlation value for valid NFC-F symbols
       float minimumCorrelationValue = decoder->signalEnvelope * correlationThreshold;
 
@@ -413,7 +580,7 @@ struct NfcF::Impl : NfcTech
 
    inline
 
-   void decodeFrame(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+   void decodeFrame(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
    {
       if (frameStatus.frameType == NfcPollFrame)
       {
@@ -429,7 +596,7 @@ struct NfcF::Impl : NfcTech
    /*
     * Decode next poll frame
     */
-   inline bool decodePollFrame(hw::SignalBuffer &buffer, std::list<RawFrame> &frames)
+   inline bool decodePollFrame(hw::SignalBuffer &buffer, std::vector<RawFrame> &frames)
    {
       int pattern;
       bool frameEnd = false, truncateError = false;
@@ -535,7 +702,7 @@ struct NfcF::Impl : NfcTech
    /*
     * Decode next listen frame
     */
-   inline bool decodeListenFrame(hw::SignalBuffer &buffer, std::list<RawFrame> &frames)
+   inline bool decodeListenFrame(hw::SignalBuffer &buffer, std::vector<RawFrame> &frames)
    {
       int pattern;
       bool frameEnd = false, truncateError = false;
@@ -758,6 +925,23 @@ struct NfcF::Impl : NfcTech
       unsigned int signalIndex = (bitrate->offsetSignalIndex + decoder->signalClock);
       unsigned int delay2Index = (bitrate->offsetDelay2Index + decoder->signalClock);
 
+      // fast-forward guard time until correlation starts one symbol before its end
+      if (decoder->guardSkip && !decoder->debug && decoder->signalClock + bitrate->period1SymbolSamples + 1 < frameStatus.guardEnd)
+      {
+         bool completed = decoder->skipSamples(buffer, frameStatus.guardEnd - bitrate->period1SymbolSamples - 1, [&] {
+            ++signalIndex;
+            ++delay2Index;
+
+            // same moving average as main loop
+            modulation->filterIntegrate += decoder->sample[signalIndex & (BUFFER_SIZE - 1)].samplingValue;
+            modulation->filterIntegrate -= decoder->sample[delay2Index & (BUFFER_SIZE - 1)].samplingValue;
+         });
+
+         // buffer exhausted before guard end
+         if (!completed)
+            return Invalid;
+      }
+
       while (decoder->nextSample(buffer))
       {
          ++signalIndex;
@@ -1228,6 +1412,57 @@ struct NfcF::Impl : NfcTech
 
       return res == crc;
    }
+   /*
+    * Serialize decoder status
+    */
+   void saveState(NfcStateWriter &writer) const
+   {
+      // detected bitrate and modulation are stored as index, or -1 if not owned by this tech
+      int bitrateIndex = decoder->bitrate >= bitrateParams && decoder->bitrate < bitrateParams + 4 ? static_cast<int>(decoder->bitrate - bitrateParams) : -1;
+      int modulationIndex = decoder->modulation >= modulationStatus && decoder->modulation < modulationStatus + 4 ? static_cast<int>(decoder->modulation - modulationStatus) : -1;
+
+      writer.put(bitrateIndex);
+      writer.put(modulationIndex);
+      writer.put(symbolStatus);
+      writer.put(streamStatus);
+      writer.put(frameStatus);
+      writer.put(protocolStatus);
+      writer.put(modulationStatus);
+      writer.put(lastFrameEnd);
+      writer.put(chainedFlags);
+      writer.put(searchResync);
+   }
+
+   /*
+    * Restore decoder status
+    */
+   bool loadState(NfcStateReader &reader)
+   {
+      int bitrateIndex, modulationIndex;
+
+      if (!reader.get(bitrateIndex) ||
+         !reader.get(modulationIndex) ||
+         !reader.get(symbolStatus) ||
+         !reader.get(streamStatus) ||
+         !reader.get(frameStatus) ||
+         !reader.get(protocolStatus) ||
+         !reader.get(modulationStatus) ||
+         !reader.get(lastFrameEnd) ||
+         !reader.get(chainedFlags) ||
+         !reader.get(searchResync))
+         return false;
+
+      // scanned block belongs to previous stream position
+      scanLength = 0;
+
+      if (bitrateIndex >= 0 && bitrateIndex < 4)
+         decoder->bitrate = bitrateParams + bitrateIndex;
+
+      if (modulationIndex >= 0 && modulationIndex < 4)
+         decoder->modulation = modulationStatus + modulationIndex;
+
+      return true;
+   }
 };
 
 NfcF::NfcF(NfcDecoderStatus *decoder) : self(new Impl(decoder))
@@ -1274,14 +1509,29 @@ void NfcF::initialize(unsigned int sampleRate)
    self->initialize(sampleRate);
 }
 
+void NfcF::scan(const hw::SignalBuffer &samples)
+{
+   self->scanPreamble(samples);
+}
+
 bool NfcF::detect()
 {
    return self->detectModulation();
 }
 
-void NfcF::decode(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+void NfcF::decode(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
 {
    self->decodeFrame(samples, frames);
 }
 
+void NfcF::saveState(NfcStateWriter &writer) const
+{
+   self->saveState(writer);
+}
+
+bool NfcF::loadState(NfcStateReader &reader)
+{
+   return self->loadState(reader);
+}
+
 }
@@ -22,7 +22,7 @@
 #ifndef LAB_NFCF_H
 #define LAB_NFCF_H
 
-#include <list>
+#include <vector>
 
 #include <hw/SignalBuffer.h>
 
@@ -59,9 +59,15 @@ struct NfcF
 
    void initialize(unsigned int sampleRate);
 
+   void scan(const hw::SignalBuffer &samples);
+
    bool detect();
 
-   void decode(hw::SignalBuffer &samples, std::list<RawFrame> &frames);
+   void decode(hw::SignalBuffer &samples, std::vector<RawFrame> &frames);
+
+   void saveState(NfcStateWriter &writer) const;
+
+   bool loadState(NfcStateReader &reader);
 };
 
 }
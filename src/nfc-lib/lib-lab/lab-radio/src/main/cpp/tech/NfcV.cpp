@@ -438,7 +438,7 @@ struct NfcV::Impl : NfcTech
       return false;
    }
 
-   inline void decodeFrame(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+   inline void decodeFrame(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
    {
       if (frameStatus.frameType == NfcPollFrame)
       {
@@ -451,7 +451,7 @@ struct NfcV::Impl : NfcTech
       }
    }
 
-   inline bool decodePollFrame(hw::SignalBuffer &buffer, std::list<RawFrame> &frames)
+   inline bool decodePollFrame(hw::SignalBuffer &buffer, std::vector<RawFrame> &frames)
    {
       int pattern;
       bool frameEnd = false, truncateError = false, streamError = false;
@@ -562,7 +562,7 @@ struct NfcV::Impl : NfcTech
    /*
     * Decode next listen frame
     */
-   inline bool decodeListenFrame(hw::SignalBuffer &buffer, std::list<RawFrame> &frames)
+   inline bool decodeListenFrame(hw::SignalBuffer &buffer, std::vector<RawFrame> &frames)
    {
       int pattern;
       bool frameEnd = false, truncateError = false, streamError = false;
@@ -811,6 +811,27 @@ struct NfcV::Impl : NfcTech
       unsigned int signalIndex = (bitrate->offsetSignalIndex + decoder->signalClock); // index for current signal sample
       unsigned int delay1Index = (bitrate->offsetDelay1Index + decoder->signalClock); // index for delayed signal (1/1 period delay)
 
+      // fast-forward guard time up to one correlation period before its end, correlation buffer is fully refilled after that
+      if (decoder->guardSkip && !decoder->debug && decoder->signalClock + bitrate->period0SymbolSamples < frameStatus.guardEnd)
+      {
+         bool completed = decoder->skipSamples(buffer, frameStatus.guardEnd - bitrate->period0SymbolSamples, [&] {
+            ++futureIndex;
+            ++signalIndex;
+            ++delay1Index;
+
+            float signalData = decoder->sample[signalIndex & (BUFFER_SIZE - 1)].filteredValue;
+
+            // same moving average as main loop
+            modulation->integrationData[signalIndex & (BUFFER_SIZE - 1)] = signalData * signalData * 10;
+            modulation->filterIntegrate += modulation->integrationData[signalIndex & (BUFFER_SIZE - 1)];
+            modulation->filterIntegrate -= modulation->integrationData[delay1Index & (BUFFER_SIZE - 1)];
+         });
+
+         // buffer exhausted before guard end
+         if (!completed)
+            return Invalid;
+      }
+
       while (decoder->nextSample(buffer))
       {
          ++futureIndex;
@@ -1207,6 +1228,58 @@ struct NfcV::Impl : NfcTech
 
       return res == crc;
    }
+   /*
+    * Serialize decoder status
+    */
+   void saveState(NfcStateWriter &writer) const
+   {
+      // detected bitrate, pulse and modulation are stored as index, or -1 if not owned by this tech
+      int bitrateIndex = decoder->bitrate == &bitrateParams ? 0 : -1;
+      int modulationIndex = decoder->modulation == &modulationStatus ? 0 : -1;
+      int pulseIndex = decoder->pulse >= pulseParams && decoder->pulse < pulseParams + 2 ? static_cast<int>(decoder->pulse - pulseParams) : -1;
+
+      writer.put(bitrateIndex);
+      writer.put(modulationIndex);
+      writer.put(pulseIndex);
+      writer.put(symbolStatus);
+      writer.put(streamStatus);
+      writer.put(frameStatus);
+      writer.put(protocolStatus);
+      writer.put(modulationStatus);
+      writer.put(lastFrameEnd);
+      writer.put(chainedFlags);
+   }
+
+   /*
+    * Restore decoder status
+    */
+   bool loadState(NfcStateReader &reader)
+   {
+      int bitrateIndex, modulationIndex, pulseIndex;
+
+      if (!reader.get(bitrateIndex) ||
+         !reader.get(modulationIndex) ||
+         !reader.get(pulseIndex) ||
+         !reader.get(symbolStatus) ||
+         !reader.get(streamStatus) ||
+         !reader.get(frameStatus) ||
+         !reader.get(protocolStatus) ||
+         !reader.get(modulationStatus) ||
+         !reader.get(lastFrameEnd) ||
+         !reader.get(chainedFlags))
+         return false;
+
+      if (bitrateIndex == 0)
+         decoder->bitrate = &bitrateParams;
+
+      if (modulationIndex == 0)
+         decoder->modulation = &modulationStatus;
+
+      if (pulseIndex >= 0 && pulseIndex < 2)
+         decoder->pulse = pulseParams + pulseIndex;
+
+      return true;
+   }
 };
 
 NfcV::NfcV(NfcDecoderStatus *decoder) : self(new Impl(decoder))
@@ -1258,9 +1331,19 @@ bool NfcV::detect()
    return self->detectModulation();
 }
 
-void NfcV::decode(hw::SignalBuffer &samples, std::list<RawFrame> &frames)
+void NfcV::decode(hw::SignalBuffer &samples, std::vector<RawFrame> &frames)
 {
    self->decodeFrame(samples, frames);
 }
 
+void NfcV::saveState(NfcStateWriter &writer) const
+{
+   self->saveState(writer);
+}
+
+bool NfcV::loadState(NfcStateReader &reader)
+{
+   return self->loadState(reader);
+}
+
 }
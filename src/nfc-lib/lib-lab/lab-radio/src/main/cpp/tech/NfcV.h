@@ -22,7 +22,7 @@
 #ifndef LAB_NFCV_H
 #define LAB_NFCV_H
 
-#include <list>
+#include <vector>
 
 #include <hw/SignalBuffer.h>
 
@@ -56,7 +56,11 @@ struct NfcV
 
    bool detect();
 
-   void decode(hw::SignalBuffer &samples, std::list<RawFrame> &frames);
+   void decode(hw::SignalBuffer &samples, std::vector<RawFrame> &frames);
+
+   void saveState(NfcStateWriter &writer) const;
+
+   bool loadState(NfcStateReader &reader);
 };
 
 }
@@ -23,6 +23,7 @@
 #define NFC_NFCDECODER_H
 
 #include <list>
+#include <vector>
 
 #include <hw/SignalBuffer.h>
 
@@ -34,6 +35,20 @@ class NfcDecoder
 {
       struct Impl;
 
+   public:
+
+      struct Checkpoint
+      {
+         // decoder sample clock when the checkpoint was taken
+         unsigned long long sampleOffset = 0;
+
+         // signal sample rate
+         unsigned int sampleRate = 0;
+
+         // serialized decoder state
+         std::vector<unsigned char> data;
+      };
+
    public:
 
       NfcDecoder();
@@ -44,10 +59,43 @@ class NfcDecoder
 
       std::list<RawFrame> nextFrames(hw::SignalBuffer samples);
 
+      // append detected frames to caller owned vector, reusing its capacity between calls
+      void nextFrames(hw::SignalBuffer samples, std::vector<RawFrame> &frames);
+
+      std::vector<std::list<RawFrame>> nextFrames(hw::SignalBuffer samples, std::vector<NfcDecoder> &sweep);
+
+      // process signal front end without searching frames, keeps decoder clock while nobody needs them
+      void skipFrames(hw::SignalBuffer samples);
+
+      std::list<Checkpoint> nextCheckpoints();
+
+      Checkpoint saveCheckpoint() const;
+
+      bool loadCheckpoint(const Checkpoint &checkpoint);
+
+      unsigned int checkpointInterval() const;
+
+      void setCheckpointInterval(unsigned int samples);
+
       bool isDebugEnabled() const;
 
       void setEnableDebug(bool enabled);
 
+      // report periodic unmodulated carrier pulses as a single NfcCarrierTrain frame instead of carrier on / off pairs
+      bool isCarrierTrainEnabled() const;
+
+      void setEnableCarrierTrain(bool enabled);
+
+      // fast-forward listen frame guard time, decoded frames are the same with or without it
+      bool isGuardSkipEnabled() const;
+
+      void setEnableGuardSkip(bool enabled);
+
+      // search NFC-F preamble candidates in bulk for each sample block, decoded frames are the same with or without it
+      bool isPreambleScanEnabled() const;
+
+      void setEnablePreambleScan(bool enabled);
+
       bool isNfcAEnabled() const;
 
       void setEnableNfcA(bool enabled);
@@ -101,6 +101,10 @@ struct FourierProcessTask::Impl : FourierProcessTask, AbstractTask
 
       // subscribe to signal events
       signalIqSubscription = signalIqStream->subscribe([=](const hw::SignalBuffer &buffer) {
+         // no spectrum consumers, nothing to keep
+         if (!frequencyStream->consumers())
+            return;
+
          if (signalMutex.try_lock())
          {
             signalBuffer = buffer;
@@ -148,7 +152,8 @@ struct FourierProcessTask::Impl : FourierProcessTask, AbstractTask
          }
       }
 
-      if (fourierTaskEnabled)
+      // only compute spectrum when enabled and there are consumers
+      if (fourierTaskEnabled && frequencyStream->consumers())
       {
          // process FFT at 100 fps (10ms / frame)
          wait(10);
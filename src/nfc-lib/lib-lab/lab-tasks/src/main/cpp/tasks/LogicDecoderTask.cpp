@@ -19,9 +19,12 @@
 
 */
 
+#include <vector>
+
 #include <rt/BlockingQueue.h>
 #include <rt/Throughput.h>
 
+#include <lab/data/FrameFilter.h>
 #include <lab/iso/IsoDecoder.h>
 
 #include <lab/tasks/LogicDecoderTask.h>
@@ -50,6 +53,12 @@ struct LogicDecoderTask::Impl : LogicDecoderTask, AbstractTask
    // decoder
    std::shared_ptr<IsoDecoder> decoder;
 
+   // reusable decoded frames, keeps its capacity between buffers
+   std::vector<RawFrame> decodedFrames;
+
+   // published frames filter
+   FrameFilter frameFilter;
+
    // last Throughput statistics
    std::chrono::time_point<std::chrono::steady_clock> lastStatus;
 
@@ -64,6 +73,8 @@ struct LogicDecoderTask::Impl : LogicDecoderTask, AbstractTask
 
    Impl() : AbstractTask("worker.LogicDecoder", "logic.decoder"), decoder(new IsoDecoder())
    {
+      decodedFrames.reserve(256);
+
       // access to signal subject stream
       logicSignalStream = rt::Subject<hw::SignalBuffer>::name("logic.signal.raw");
 
@@ -162,6 +173,8 @@ struct LogicDecoderTask::Impl : LogicDecoderTask, AbstractTask
 
       decoder->initialize();
 
+      frameFilter.resetCounters();
+
       command.resolve();
 
       updateDecoderStatus(Streaming);
@@ -180,9 +193,14 @@ struct LogicDecoderTask::Impl : LogicDecoderTask, AbstractTask
 
       logicSignalQueue.clear();
 
-      for (const auto &frame: decoder->nextFrames({}))
+      decodedFrames.clear();
+
+      decoder->nextFrames({}, decodedFrames);
+
+      for (const auto &frame: decodedFrames)
       {
-         decoderFrameStream->next(frame);
+         if (frameFilter.matches(frame))
+            decoderFrameStream->next(frame);
       }
 
       command.resolve();
@@ -207,6 +225,13 @@ struct LogicDecoderTask::Impl : LogicDecoderTask, AbstractTask
 
          log->info("change config: {}", {config.dump()});
 
+         // frame filter expression, invalid expression reject whole config
+         if (config.contains("frameFilter") && !frameFilter.compile(config["frameFilter"]))
+         {
+            command.reject(InvalidConfig);
+            return;
+         }
+
          // update current configuration
          currentConfig.merge_patch(config);
 
@@ -249,9 +274,14 @@ struct LogicDecoderTask::Impl : LogicDecoderTask, AbstractTask
          {
             logicSignalQueue.clear();
 
-            for (const auto &frame: decoder->nextFrames({}))
+            decodedFrames.clear();
+
+            decoder->nextFrames({}, decodedFrames);
+
+            for (const auto &frame: decodedFrames)
             {
-               decoderFrameStream->next(frame);
+               if (frameFilter.matches(frame))
+                  decoderFrameStream->next(frame);
             }
 
             logicDecoderStatus = Idle;
@@ -286,9 +316,14 @@ struct LogicDecoderTask::Impl : LogicDecoderTask, AbstractTask
 
          log->trace("decode new buffer {} offset {} with {} samples", {buffer->id(), buffer->offset(), buffer->elements()});
 
-         for (const auto &frame: decoder->nextFrames(buffer.value()))
+         decodedFrames.clear();
+
+         decoder->nextFrames(buffer.value(), decodedFrames);
+
+         for (const auto &frame: decodedFrames)
          {
-            decoderFrameStream->next(frame);
+            if (frameFilter.matches(frame))
+               decoderFrameStream->next(frame);
             frames++;
          }
 
@@ -317,6 +352,7 @@ struct LogicDecoderTask::Impl : LogicDecoderTask, AbstractTask
          {"sampleRate", decoder->sampleRate()},
          {"streamTime", decoder->streamTime()},
          {"debugEnabled", decoder->isDebugEnabled()},
+         {"frameFilter", frameFilter.expression()},
          {"sampleThroughput", taskThroughput.average()}
       });
 
@@ -333,6 +369,16 @@ struct LogicDecoderTask::Impl : LogicDecoderTask, AbstractTask
          data["protocol"] = protocol;
       }
 
+      if (!frameFilter.isEmpty())
+      {
+         json dropped = json::array();
+
+         for (const auto &clause: frameFilter.dropped())
+            dropped.push_back({{"clause", clause.first}, {"frames", clause.second}});
+
+         data["frameFilterStats"] = {{"accepted", frameFilter.accepted()}, {"dropped", dropped}};
+      }
+
       updateStatus(logicDecoderStatus, data);
    }
 };
@@ -236,6 +236,10 @@ struct LogicDeviceTask::Impl : LogicDeviceTask, AbstractTask
       if (config.contains("vThreshold"))
          device->set(hw::LogicDevice::PARAM_VOLTAGE_THRESHOLD, static_cast<float>(config["vThreshold"]));
 
+      // setup hardware run-length compression
+      if (config.contains("rleCompress"))
+         device->set(hw::LogicDevice::PARAM_RLE_COMPRESS, static_cast<bool>(config["rleCompress"]));
+
       // setup channels
       for (int c = 0; c < std::get<unsigned int>(device->get(hw::LogicDevice::PARAM_CHANNEL_TOTAL)); c++)
       {
@@ -20,10 +20,12 @@
 */
 
 #include <memory>
+#include <vector>
 
 #include <rt/BlockingQueue.h>
 #include <rt/Throughput.h>
 
+#include <lab/data/FrameFilter.h>
 #include <lab/nfc/NfcDecoder.h>
 
 #include <lab/tasks/RadioDecoderTask.h>
@@ -52,6 +54,12 @@ struct RadioDecoderTask::Impl : RadioDecoderTask, AbstractTask
    // decoder
    std::shared_ptr<NfcDecoder> decoder;
 
+   // reusable decoded frames, keeps its capacity between buffers
+   std::vector<RawFrame> decodedFrames;
+
+   // published frames filter
+   FrameFilter frameFilter;
+
    // last Throughput statistics
    std::chrono::time_point<std::chrono::steady_clock> lastStatus;
 
@@ -66,6 +74,8 @@ struct RadioDecoderTask::Impl : RadioDecoderTask, AbstractTask
 
    Impl() : AbstractTask("worker.RadioDecoder", "radio.decoder"), decoder(new NfcDecoder())
    {
+      decodedFrames.reserve(256);
+
       // access to signal subject stream
       radioSignalStream = rt::Subject<hw::SignalBuffer>::name("radio.signal.raw");
 
@@ -164,6 +174,8 @@ struct RadioDecoderTask::Impl : RadioDecoderTask, AbstractTask
 
       decoder->initialize();
 
+      frameFilter.resetCounters();
+
       command.resolve();
 
       updateDecoderStatus(Streaming);
@@ -182,9 +194,14 @@ struct RadioDecoderTask::Impl : RadioDecoderTask, AbstractTask
 
       radioSignalQueue.clear();
 
-      for (const auto &frame: decoder->nextFrames({}))
+      decodedFrames.clear();
+
+      decoder->nextFrames({}, decodedFrames);
+
+      for (const auto &frame: decodedFrames)
       {
-         decoderFrameStream->next(frame);
+         if (frameFilter.matches(frame))
+            decoderFrameStream->next(frame);
       }
 
       command.resolve();
@@ -209,6 +226,13 @@ struct RadioDecoderTask::Impl : RadioDecoderTask, AbstractTask
 
          log->info("change config: {}", {config.dump()});
 
+         // frame filter expression, invalid expression reject whole config
+         if (config.contains("frameFilter") && !frameFilter.compile(config["frameFilter"]))
+         {
+            command.reject(InvalidConfig);
+            return;
+         }
+
          // update current configuration
          currentConfig.merge_patch(config);
 
@@ -223,6 +247,10 @@ struct RadioDecoderTask::Impl : RadioDecoderTask, AbstractTask
          if (config.contains("debugEnabled"))
             decoder->setEnableDebug(config["debugEnabled"]);
 
+         // carrier pulse trains as single frame
+         if (config.contains("carrierTrainEnabled"))
+            decoder->setEnableCarrierTrain(config["carrierTrainEnabled"]);
+
          // global power level threshold
          if (config.contains("powerLevelThreshold"))
             decoder->setPowerLevelThreshold(config["powerLevelThreshold"]);
@@ -336,9 +364,14 @@ struct RadioDecoderTask::Impl : RadioDecoderTask, AbstractTask
          {
             radioSignalQueue.clear();
 
-            for (const auto &frame: decoder->nextFrames({}))
+            decodedFrames.clear();
+
+            decoder->nextFrames({}, decodedFrames);
+
+            for (const auto &frame: decodedFrames)
             {
-               decoderFrameStream->next(frame);
+               if (frameFilter.matches(frame))
+                  decoderFrameStream->next(frame);
             }
 
             radioDecoderStatus = Idle;
@@ -373,9 +406,18 @@ struct RadioDecoderTask::Impl : RadioDecoderTask, AbstractTask
 
          log->trace("decode new buffer {} offset {} with {} samples", {buffer->id(), buffer->offset(), buffer->elements()});
 
-         for (const auto &frame: decoder->nextFrames(buffer.value()))
+         decodedFrames.clear();
+
+         // without frame consumers only signal front end is processed, keeping decoder clock in sync
+         if (decoderFrameStream->consumers() > 0 || !buffer->isValid())
+            decoder->nextFrames(buffer.value(), decodedFrames);
+         else
+            decoder->skipFrames(buffer.value());
+
+         for (const auto &frame: decodedFrames)
          {
-            decoderFrameStream->next(frame);
+            if (frameFilter.matches(frame))
+               decoderFrameStream->next(frame);
             frames++;
          }
 
@@ -404,6 +446,8 @@ struct RadioDecoderTask::Impl : RadioDecoderTask, AbstractTask
          {"sampleRate", decoder->sampleRate()},
          {"streamTime", decoder->streamTime()},
          {"debugEnabled", decoder->isDebugEnabled()},
+         {"carrierTrainEnabled", decoder->isCarrierTrainEnabled()},
+         {"frameFilter", frameFilter.expression()},
          {"powerLevelThreshold", decoder->powerLevelThreshold()},
          {"sampleThroughput", taskThroughput.average()}
       });
@@ -448,6 +492,16 @@ struct RadioDecoderTask::Impl : RadioDecoderTask, AbstractTask
          data["protocol"] = protocol;
       }
 
+      if (!frameFilter.isEmpty())
+      {
+         json dropped = json::array();
+
+         for (const auto &clause: frameFilter.dropped())
+            dropped.push_back({{"clause", clause.first}, {"frames", clause.second}});
+
+         data["frameFilterStats"] = {{"accepted", frameFilter.accepted()}, {"dropped", dropped}};
+      }
+
       updateStatus(radioDecoderStatus, data);
    }
 };
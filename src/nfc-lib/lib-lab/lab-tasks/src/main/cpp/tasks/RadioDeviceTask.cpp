@@ -63,6 +63,9 @@ struct RadioDeviceTask::Impl : RadioDeviceTask, AbstractTask
    // signal stream queue buffer
    rt::BlockingQueue<hw::SignalBuffer> signalQueue;
 
+   // magnitude buffer reused while nobody consumes raw signal, its average is still needed for gain control
+   hw::SignalBuffer signalScratch;
+
    // throughput meter
    rt::Throughput taskThroughput;
 
@@ -477,7 +480,22 @@ struct RadioDeviceTask::Impl : RadioDeviceTask, AbstractTask
       if (auto entry = signalQueue.get(timeout))
       {
          hw::SignalBuffer buffer = entry.value();
-         hw::SignalBuffer result(buffer.elements(), 1, 1, buffer.sampleRate(), buffer.offset(), 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, buffer.id());
+         hw::SignalBuffer result;
+
+         // new magnitude buffer only when someone consumes it
+         bool realDemand = signalRawStream->consumers() > 0;
+
+         if (realDemand)
+         {
+            result = hw::SignalBuffer(buffer.elements(), 1, 1, buffer.sampleRate(), buffer.offset(), 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, buffer.id());
+         }
+         else
+         {
+            if (signalScratch.capacity() < buffer.elements())
+               signalScratch = hw::SignalBuffer(buffer.elements(), 1, 1, buffer.sampleRate(), 0, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL);
+
+            result = signalScratch;
+         }
 
          float *src = buffer.data();
          float *dst = result.pull(buffer.elements());
@@ -580,7 +598,8 @@ struct RadioDeviceTask::Impl : RadioDeviceTask, AbstractTask
          signalIqStream->next(buffer);
 
          // send Real value buffer
-         signalRawStream->next(result);
+         if (realDemand)
+            signalRawStream->next(result);
 
          // update receiver throughput
          taskThroughput.update(buffer.elements());
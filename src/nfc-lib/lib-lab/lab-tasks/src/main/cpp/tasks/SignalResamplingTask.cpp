@@ -19,6 +19,8 @@
 
 */
 
+#include <algorithm>
+#include <cmath>
 #include <mutex>
 
 #include <rt/BlockingQueue.h>
@@ -80,12 +82,14 @@ struct SignalResamplingTask::Impl : SignalResamplingTask, AbstractTask
 
       // subscribe to logic signal events
       logicSignalSubscription = logicSignalStream->subscribe([=](const hw::SignalBuffer &buffer) {
-         signalQueue.add(buffer);
+         if (!buffer.isValid() || adaptiveSignalStream->consumers())
+            signalQueue.add(buffer);
       });
 
       // subscribe to radio signal events
       radioSignalSubscription = radioSignalStream->subscribe([=](const hw::SignalBuffer &buffer) {
-         signalQueue.add(buffer);
+         if (!buffer.isValid() || adaptiveSignalStream->consumers())
+            signalQueue.add(buffer);
       });
    }
 
@@ -145,113 +149,163 @@ struct SignalResamplingTask::Impl : SignalResamplingTask, AbstractTask
          return;
       }
 
-      switch (buffer.type())
+      // consumers may have gone while buffer was queued
+      if (!adaptiveSignalStream->consumers())
+         return;
+
+      if (buffer.type() != hw::SignalType::SIGNAL_TYPE_RAW_LOGIC && buffer.type() != hw::SignalType::SIGNAL_TYPE_RAW_REAL)
+         return;
+
+      rt::Subject<hw::SignalBuffer>::Interest interest = adaptiveSignalStream->interest();
+
+      // range of samples inside required time window
+      int first = 0;
+      int end = static_cast<int>(buffer.limit());
+
+      if (interest.hasWindow())
       {
-         // adaptive resample for real signal
-         case hw::SignalType::SIGNAL_TYPE_RAW_LOGIC:
-         {
-            hw::SignalBuffer resampled(buffer.elements() * 2, 2, 1, buffer.sampleRate(), buffer.offset(), 0, hw::SignalType::SIGNAL_TYPE_ADV_LOGIC, buffer.id());
+         double windowStart = interest.timeStart * buffer.sampleRate() - static_cast<double>(buffer.offset());
+         double windowEnd = interest.timeEnd * buffer.sampleRate() - static_cast<double>(buffer.offset());
 
-            // get value of the first sample
-            float last = buffer[0];
+         first = static_cast<int>(std::clamp(std::ceil(windowStart), 0.0, static_cast<double>(end)));
+         end = static_cast<int>(std::clamp(std::floor(windowEnd) + 1, static_cast<double>(first), static_cast<double>(end)));
+      }
 
-            // and store in resampled buffer
-            resampled.put(last).put(0.0);
+      // samples per point for required resolution, limited to keep intervals in one byte
+      int step = std::min(static_cast<int>(interest.resolution * buffer.sampleRate()), RADIO_INTERVAL / 2);
 
-            // adaptive resample based values changes (logic)
-            for (int i = 1, c = 0; i < buffer.limit(); i++)
-            {
-               float value = buffer[i];
+      if (first < end)
+      {
+         unsigned int type = buffer.type() == hw::SignalType::SIGNAL_TYPE_RAW_LOGIC ? hw::SignalType::SIGNAL_TYPE_ADV_LOGIC : hw::SignalType::SIGNAL_TYPE_ADV_REAL;
 
-               // store new sample if different from last or every LOGIC_INTERVAL samples
-               if (value != last || (i - c) >= LOGIC_INTERVAL)
-               {
-                  resampled.put(value).put(static_cast<float>(i));
+         hw::SignalBuffer resampled((end - first) * 2, 2, 1, buffer.sampleRate(), buffer.offset(), 0, type, buffer.id());
 
-                  // update last value
-                  last = value;
+         if (step > 1)
+            resampleEnvelope(buffer, resampled, first, end, step);
+         else if (buffer.type() == hw::SignalType::SIGNAL_TYPE_RAW_LOGIC)
+            resampleLogic(buffer, resampled, first, end);
+         else
+            resampleRadio(buffer, resampled, first, end);
 
-                  // update control point index
-                  c = i;
-               }
-            }
+         resampled.flip();
 
-            resampled.flip();
+         adaptiveSignalStream->next(resampled);
+      }
 
-            adaptiveSignalStream->next(resampled);
+      taskThroughput.update(buffer.elements());
+   }
 
-            taskThroughput.update(buffer.elements());
+   /*
+    * Adaptive resample based on value changes, for logic signals
+    */
+   static void resampleLogic(const hw::SignalBuffer &buffer, hw::SignalBuffer &resampled, int first, int end)
+   {
+      // get value of the first sample
+      float last = buffer[first];
 
-            break;
-         }
+      // and store in resampled buffer
+      resampled.put(last).put(static_cast<float>(first));
+
+      // adaptive resample based values changes (logic)
+      for (int i = first + 1, c = first; i < end; i++)
+      {
+         float value = buffer[i];
 
-         case hw::SignalType::SIGNAL_TYPE_RAW_REAL:
+         // store new sample if different from last or every LOGIC_INTERVAL samples
+         if (value != last || (i - c) >= LOGIC_INTERVAL)
          {
-            hw::SignalBuffer resampled(buffer.elements() * 2, 2, 1, buffer.sampleRate(), buffer.offset(), 0, hw::SignalType::SIGNAL_TYPE_ADV_REAL, buffer.id());
+            resampled.put(value).put(static_cast<float>(i));
 
-            float avrg = 0;
-            float last = buffer[0];
-            float filter = THRESHOLD;
+            // update last value
+            last = value;
 
-            // initialize average
-            for (int i = 0; i < (WINDOW / 2); i++)
-               avrg += buffer[i];
+            // update control point index
+            c = i;
+         }
+      }
+   }
 
-            // always store first sample
-            resampled.put(buffer[0]).put(0.0);
+   /*
+    * Adaptive resample based on maximum average deviation, for radio signals
+    */
+   static void resampleRadio(const hw::SignalBuffer &buffer, hw::SignalBuffer &resampled, int first, int end)
+   {
+      float avrg = 0;
+      float last = buffer[first];
+      float filter = THRESHOLD;
 
-            // index of current point and last control point
-            int i = 0, c = 0, p = -1;
+      // initialize average
+      for (int i = first; i < first + (WINDOW / 2) && i < end; i++)
+         avrg += buffer[i];
 
-            // adaptive resample based on maximum average deviation
-            for (int r = i - (WINDOW / 2) - 1, a = i + (WINDOW / 2); i < buffer.limit(); i++, p++, a++, r++)
-            {
-               float value = buffer[i];
+      // always store first sample
+      resampled.put(buffer[first]).put(static_cast<float>(first));
 
-               // add new sample
-               if (a < buffer.limit())
-                  avrg += buffer[a];
+      // index of current point and last control point
+      int i = first, c = first, p = first - 1;
 
-               // remove old sample
-               if (r >= 0)
-                  avrg -= buffer[r];
+      // adaptive resample based on maximum average deviation
+      for (int r = i - (WINDOW / 2) - 1, a = i + (WINDOW / 2); i < end; i++, p++, a++, r++)
+      {
+         float value = buffer[i];
+
+         // add new sample
+         if (a < end)
+            avrg += buffer[a];
 
-               // detect deviation from average
-               float stdev = std::abs(value - (avrg / static_cast<float>(WINDOW)));
+         // remove old sample
+         if (r >= first)
+            avrg -= buffer[r];
 
-               // store new sample if different from last or every RADIO_INTERVAL samples
-               if (stdev > filter || (i - c) >= RADIO_INTERVAL)
-               {
-                  // append control point
-                  if (stdev > filter && c < p)
-                     resampled.put(last).put(static_cast<float>(p));
+         // detect deviation from average
+         float stdev = std::abs(value - (avrg / static_cast<float>(WINDOW)));
 
-                  // append new value
-                  resampled.put(value).put(static_cast<float>(i));
+         // store new sample if different from last or every RADIO_INTERVAL samples
+         if (stdev > filter || (i - c) >= RADIO_INTERVAL)
+         {
+            // append control point
+            if (stdev > filter && c < p)
+               resampled.put(last).put(static_cast<float>(p));
 
-                  // update control point index
-                  c = i;
-               }
+            // append new value
+            resampled.put(value).put(static_cast<float>(i));
 
-               // store last value
-               last = value;
-            }
+            // update control point index
+            c = i;
+         }
 
-            // store last sample
-            if (c < p)
-               resampled.put(last).put(float(p));
+         // store last value
+         last = value;
+      }
 
-            resampled.flip();
+      // store last sample
+      if (c < p)
+         resampled.put(last).put(float(p));
+   }
 
-            adaptiveSignalStream->next(resampled);
+   /*
+    * Minimum and maximum of each group of samples, in time order, for consumers with coarse resolution
+    */
+   static void resampleEnvelope(const hw::SignalBuffer &buffer, hw::SignalBuffer &resampled, int first, int end, int step)
+   {
+      for (int i = first; i < end; i += step)
+      {
+         int lower = i;
+         int upper = i;
 
-            taskThroughput.update(buffer.elements());
+         for (int j = i + 1; j < i + step && j < end; j++)
+         {
+            if (buffer[j] < buffer[lower])
+               lower = j;
 
-            break;
+            if (buffer[j] > buffer[upper])
+               upper = j;
          }
 
-         default:
-            break;
+         resampled.put(buffer[std::min(lower, upper)]).put(static_cast<float>(std::min(lower, upper)));
+
+         if (lower != upper)
+            resampled.put(buffer[std::max(lower, upper)]).put(static_cast<float>(std::max(lower, upper)));
       }
    }
 };
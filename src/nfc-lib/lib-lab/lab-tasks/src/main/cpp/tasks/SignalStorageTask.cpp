@@ -26,6 +26,7 @@
 #endif
 
 #include <iomanip>
+#include <numeric>
 #include <sstream>
 
 #include <hw/SignalType.h>
@@ -38,6 +39,306 @@
 
 namespace lab {
 
+/*
+ * Multi-channel frame assembler, scatter each incoming channel buffer directly into its own column of one interleaved frame.
+ *
+ * Channel set is learned while the first frame is assembled, then two frames are allocated once and used alternately,
+ * one is filled while the other one is written.
+ */
+struct SignalAssembler
+{
+   // preallocated frames, used alternately
+   hw::SignalBuffer frames[2];
+
+   // index of frame under construction
+   unsigned int current = 0;
+
+   // frame under construction
+   hw::SignalBuffer frame;
+
+   // last completed frame, ready to be written
+   hw::SignalBuffer ready;
+
+   // sample offset of frame under construction
+   unsigned long long offset = 0;
+
+   // samples per channel in current frame
+   unsigned int length = 0;
+
+   // channel set is complete and frames are allocated
+   bool fixed = false;
+
+   // columns used by each channel key
+   std::vector<unsigned int> widths;
+
+   // first column of each channel key
+   std::vector<unsigned int> columns;
+
+   // channel keys already stored in current frame
+   std::vector<bool> filled;
+
+   /*
+    * Add channel buffer to current frame, returns true when a new offset is received and previous frame is completed in ready buffer
+    */
+   bool add(std::vector<int> &keys, const hw::SignalBuffer &buffer)
+   {
+      bool completed = false;
+
+      // once offset changes current frame is completed
+      if (frame && offset != buffer.offset())
+      {
+         completed = flush(keys);
+      }
+
+      // get column for channel key
+      auto key = std::find(keys.begin(), keys.end(), static_cast<int>(buffer.id()));
+
+      unsigned int index = std::distance(keys.begin(), key);
+
+      // file layout is already set, channels not seen in first frame can not be stored
+      if (fixed && (key == keys.end() || index >= widths.size()))
+         return completed;
+
+      // unknown keys are appended to channel set while first frame is assembled
+      if (key == keys.end())
+         keys.push_back(static_cast<int>(buffer.id()));
+
+      if (widths.size() < keys.size())
+         widths.resize(keys.size(), buffer.stride());
+
+      if (filled.size() < keys.size())
+         filled.resize(keys.size(), false);
+
+      if (!fixed)
+         layout();
+
+      unsigned int stride = columns.back() + widths.back();
+
+      if (!frame)
+      {
+         // start new frame
+         offset = buffer.offset();
+         length = buffer.available() / buffer.stride();
+
+         if (!fixed)
+            frame = hw::SignalBuffer(length * stride, stride, 1, buffer.sampleRate(), buffer.offset(), buffer.decimation(), buffer.type());
+         else
+            frame = next(stride, buffer);
+      }
+
+      // new channel discovered after frame allocation, only happens while first frame is assembled
+      else if (frame.stride() != stride)
+      {
+         expand(stride, columns[index], widths[index]);
+      }
+
+      scatter(buffer, columns[index]);
+
+      filled[index] = true;
+
+      return completed;
+   }
+
+   /*
+    * Complete current frame and move it to ready buffer, missing channels are zero filled
+    */
+   bool flush(const std::vector<int> &keys)
+   {
+      if (!frame)
+         return false;
+
+      unsigned int stride = frame.stride();
+
+      for (unsigned int k = 0; k < keys.size() && k < widths.size(); k++)
+      {
+         if (!filled[k])
+         {
+            float *dst = frame.data() + columns[k];
+
+            for (unsigned int i = 0; i < length; i++, dst += stride)
+               std::fill(dst, dst + widths[k], 0.0f);
+         }
+
+         filled[k] = false;
+      }
+
+      // mark frame contents as written and prepare for read
+      frame.pull(length * stride);
+      frame.flip();
+
+      ready = frame;
+
+      // first frame sets the channel layout, from now on preallocated frames are used
+      if (!fixed)
+      {
+         frames[0] = frame;
+         frames[1] = hw::SignalBuffer(frame.capacity(), stride, 1, frame.sampleRate(), frame.offset(), frame.decimation(), frame.type());
+         current = 0;
+         fixed = true;
+      }
+
+      frame.reset();
+
+      return true;
+   }
+
+   /*
+    * Discard pending data
+    */
+   void reset()
+   {
+      frame.reset();
+      ready.reset();
+      frames[0].reset();
+      frames[1].reset();
+      widths.clear();
+      columns.clear();
+      filled.clear();
+      fixed = false;
+      offset = 0;
+      length = 0;
+   }
+
+   /*
+    * Compute first column of each channel
+    */
+   void layout()
+   {
+      columns.resize(widths.size());
+
+      for (unsigned int k = 0, column = 0; k < widths.size(); column += widths[k++])
+         columns[k] = column;
+   }
+
+   /*
+    * Take the preallocated frame not used by ready buffer, grown only if a longer buffer is received
+    */
+   hw::SignalBuffer next(unsigned int stride, const hw::SignalBuffer &buffer)
+   {
+      current ^= 1;
+
+      if (frames[current].capacity() < length * stride)
+         frames[current] = hw::SignalBuffer(length * stride, stride, 1, buffer.sampleRate(), buffer.offset(), buffer.decimation(), buffer.type());
+
+      frames[current].clear();
+
+      return frames[current];
+   }
+
+   /*
+    * Copy channel samples into frame column with frame stride
+    */
+   void scatter(const hw::SignalBuffer &buffer, unsigned int column)
+   {
+      unsigned int width = buffer.stride();
+      unsigned int stride = frame.stride();
+      unsigned int samples = std::min(length, buffer.available() / width);
+
+      const float *src = buffer.data() + buffer.position();
+      float *dst = frame.data() + column;
+
+      if (width == 1)
+      {
+         unsigned int i = 0;
+
+         // strided stores have no profitable SSE form, unroll to let compiler pipeline them
+#pragma GCC ivdep
+         for (; i + 4 <= samples; i += 4)
+         {
+            dst[(i + 0) * stride] = src[i + 0];
+            dst[(i + 1) * stride] = src[i + 1];
+            dst[(i + 2) * stride] = src[i + 2];
+            dst[(i + 3) * stride] = src[i + 3];
+         }
+
+         for (; i < samples; i++)
+         {
+            dst[i * stride] = src[i];
+         }
+      }
+      else
+      {
+         for (unsigned int i = 0; i < samples; i++)
+         {
+            std::memcpy(dst + i * stride, src + i * width, width * sizeof(float));
+         }
+      }
+   }
+
+   /*
+    * Rebuild current frame with more columns, opening space for a new channel
+    */
+   void expand(unsigned int stride, unsigned int column, unsigned int width)
+   {
+      hw::SignalBuffer expanded(length * stride, stride, 1, frame.sampleRate(), frame.offset(), frame.decimation(), frame.type());
+
+      unsigned int previous = frame.stride();
+
+      const float *src = frame.data();
+      float *dst = expanded.data();
+
+      for (unsigned int i = 0; i < length; i++, src += previous, dst += stride)
+      {
+         std::memcpy(dst, src, column * sizeof(float));
+         std::memcpy(dst + column + width, src + column, (previous - column) * sizeof(float));
+      }
+
+      frame = expanded;
+   }
+};
+
+/*
+ * Split interleaved block into one array per channel in a single pass, groups of 4 channels are transposed
+ * as 4x4 tiles with SSE2 so 4, 8 and 16 channel captures are fully vectorized, remaining channels are scalar
+ */
+static void deinterleave(const float *src, unsigned int channels, unsigned int samples, float *const *dst)
+{
+   unsigned int i = 0;
+
+#if defined(__SSE2__) && defined(USE_SSE2)
+
+   const unsigned int groups = channels & ~3u;
+
+   for (; i + 4 <= samples; i += 4)
+   {
+      const float *row = src + i * channels;
+
+      for (unsigned int c = 0; c < groups; c += 4)
+      {
+         __m128 r0 = _mm_loadu_ps(row + c + 0 * channels); // s0c0, s0c1, s0c2, s0c3
+         __m128 r1 = _mm_loadu_ps(row + c + 1 * channels); // s1c0, s1c1, s1c2, s1c3
+         __m128 r2 = _mm_loadu_ps(row + c + 2 * channels); // s2c0, s2c1, s2c2, s2c3
+         __m128 r3 = _mm_loadu_ps(row + c + 3 * channels); // s3c0, s3c1, s3c2, s3c3
+
+         // rows become channels: s0cN, s1cN, s2cN, s3cN
+         _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+         _mm_storeu_ps(dst[c + 0] + i, r0);
+         _mm_storeu_ps(dst[c + 1] + i, r1);
+         _mm_storeu_ps(dst[c + 2] + i, r2);
+         _mm_storeu_ps(dst[c + 3] + i, r3);
+      }
+
+      for (unsigned int c = groups; c < channels; c++)
+      {
+         dst[c][i + 0] = row[c + 0 * channels];
+         dst[c][i + 1] = row[c + 1 * channels];
+         dst[c][i + 2] = row[c + 2 * channels];
+         dst[c][i + 3] = row[c + 3 * channels];
+      }
+   }
+
+#endif
+
+   for (; i < samples; i++)
+   {
+      for (unsigned int c = 0; c < channels; c++)
+      {
+         dst[c][i] = src[i * channels + c];
+      }
+   }
+}
+
 struct SignalStorageTask::Impl : SignalStorageTask, AbstractTask
 {
    // decoder status
@@ -61,9 +362,9 @@ struct SignalStorageTask::Impl : SignalStorageTask, AbstractTask
    rt::BlockingQueue<hw::SignalBuffer> logicSignalQueue;
    rt::BlockingQueue<hw::SignalBuffer> radioSignalQueue;
 
-   // signal buffer cache
-   hw::SignalBuffer logicBufferCache;
-   hw::SignalBuffer radioBufferCache;
+   // multi-channel frame assemblers
+   SignalAssembler logicAssembler;
+   SignalAssembler radioAssembler;
 
    // signal keys vector
    std::vector<int> logicBufferKeys;
@@ -72,6 +373,9 @@ struct SignalStorageTask::Impl : SignalStorageTask, AbstractTask
    // base filename
    std::string storagePath;
 
+   // store radio and logic signals in lossless compressed containers
+   bool storageCompress = false;
+
    Impl() : AbstractTask("worker.SignalStorage", "recorder"), status(Idle)
    {
       // access to signal subject stream
@@ -224,11 +528,19 @@ struct SignalStorageTask::Impl : SignalStorageTask, AbstractTask
 
          storagePath = config["storagePath"];
 
-         log->info("data storage path: {}", {storagePath});
+         storageCompress = config.value("compress", false);
+
+         log->info("data storage path: {}, compress: {}", {storagePath, storageCompress});
 
          logicSignalQueue.clear();
          radioSignalQueue.clear();
 
+         logicBufferKeys.clear();
+         radioBufferKeys.clear();
+
+         logicAssembler.reset();
+         radioAssembler.reset();
+
          command.resolve();
 
          updateStorageStatus(Writing);
@@ -288,31 +600,26 @@ struct SignalStorageTask::Impl : SignalStorageTask, AbstractTask
       {
          if (!buffer->isEmpty())
          {
-            // integrate new buffer interleaving with previous one store every offset change
-            if (interleaveBuffer(logicBufferKeys, logicBufferCache, *buffer))
+            // scatter new buffer in current frame, completed frame is ready to store on every offset change
+            if (logicAssembler.add(logicBufferKeys, *buffer))
             {
-               // create new storage file before first buffer is completed
+               // create new storage file before first frame is completed
                if (!logicStorage)
                {
-                  logicStorage = open(fileName("logic"), logicBufferCache.sampleRate(), hw::SAMPLE_SIZE_8, logicBufferCache.stride(), logicBufferKeys, hw::RecordDevice::Mode::Write);
+                  logicStorage = open(fileName("logic", storageCompress ? ".nfl" : ".wav"), logicAssembler.ready.sampleRate(), hw::SAMPLE_SIZE_8, logicAssembler.ready.stride(), logicBufferKeys, hw::RecordDevice::Mode::Write);
                   writeFinished = !logicStorage;
                }
 
+               // write frame to storage
                if (!writeFinished)
-               {
-                  // write buffer to storage
-                  logicStorage->write(logicBufferCache);
-
-                  // and start again with new buffer
-                  logicBufferCache = *buffer;
-               }
+                  logicStorage->write(logicAssembler.ready);
             }
          }
          else if (logicStorage)
          {
-            // write cache if has pending buffer
-            if (logicBufferCache)
-               logicStorage->write(logicBufferCache);
+            // write pending frame
+            if (logicAssembler.flush(logicBufferKeys))
+               logicStorage->write(logicAssembler.ready);
 
             // close storage
             logicStorage->close();
@@ -327,31 +634,26 @@ struct SignalStorageTask::Impl : SignalStorageTask, AbstractTask
       {
          if (!buffer->isEmpty())
          {
-            // integrate new buffer interleaving with previous one store every offset change
-            if (interleaveBuffer(radioBufferKeys, radioBufferCache, *buffer))
+            // scatter new buffer in current frame, completed frame is ready to store on every offset change
+            if (radioAssembler.add(radioBufferKeys, *buffer))
             {
-               // create new storage file before first buffer is completed
+               // create new storage file before first frame is completed
                if (!radioStorage)
                {
-                  radioStorage = open(fileName("radio"), radioBufferCache.sampleRate(), hw::SAMPLE_SIZE_16, radioBufferCache.stride(), radioBufferKeys, hw::RecordDevice::Mode::Write);
+                  radioStorage = open(fileName("radio", storageCompress ? ".nfz" : ".wav"), radioAssembler.ready.sampleRate(), hw::SAMPLE_SIZE_16, radioAssembler.ready.stride(), radioBufferKeys, hw::RecordDevice::Mode::Write);
                   writeFinished = !radioStorage;
                }
 
+               // write frame to storage
                if (!writeFinished)
-               {
-                  // write buffer to storage
-                  radioStorage->write(radioBufferCache);
-
-                  // and start again with new buffer
-                  radioBufferCache = *buffer;
-               }
+                  radioStorage->write(radioAssembler.ready);
             }
          }
          else if (radioStorage)
          {
-            // write cache if has pending buffer
-            if (radioBufferCache)
-               radioStorage->write(radioBufferCache);
+            // write pending frame
+            if (radioAssembler.flush(radioBufferKeys))
+               radioStorage->write(radioAssembler.ready);
 
             radioStorage->close();
             radioStorage.reset();
@@ -374,44 +676,6 @@ struct SignalStorageTask::Impl : SignalStorageTask, AbstractTask
       }
    }
 
-   static bool interleaveBuffer(std::vector<int> &keys, hw::SignalBuffer &cache, hw::SignalBuffer &buffer)
-   {
-      // integrate new buffer interleaving with previous cache
-      if (cache && cache.offset() == buffer.offset())
-      {
-         // integrate new buffer interleaving with previous cache
-         hw::SignalBuffer interleaved(cache.size() + buffer.size(), cache.stride() + buffer.stride(), 1, cache.sampleRate(), cache.offset(), cache.decimation(), cache.type());
-
-         for (int i = 0; i < cache.elements(); i++)
-         {
-            // copy current buffer keep space to interleave new buffer
-            cache.get(interleaved.pull(cache.stride()), cache.stride());
-
-            // add incoming buffer
-            buffer.get(interleaved.pull(buffer.stride()), buffer.stride());
-         }
-
-         // flip buffer pointers
-         interleaved.flip();
-
-         // use interleaved buffer as new cache
-         cache = interleaved;
-      }
-
-      // initialize cache on first buffer
-      else if (!cache)
-      {
-         cache = buffer;
-      }
-
-      // check if keys contains buffer id
-      if (std::find(keys.begin(), keys.end(), buffer.id()) == keys.end())
-         keys.push_back(static_cast<int>(buffer.id()));
-
-      // return true if buffer offset has changed (cache is full and must be written)
-      return cache.offset() != buffer.offset();
-   }
-
    std::shared_ptr<hw::RecordDevice> open(const std::string &filename, unsigned int sampleRate, unsigned int sampleSize, unsigned int channels, std::vector<int> &keys, hw::RecordDevice::Mode mode)
    {
       auto storage = std::make_shared<hw::RecordDevice>(filename);
@@ -451,15 +715,23 @@ struct SignalStorageTask::Impl : SignalStorageTask, AbstractTask
 
       if (logicStorage->read(block) > 0)
       {
+         unsigned int samples = block.elements();
+
+         std::vector<hw::SignalBuffer> buffers;
+         std::vector<float *> columns;
+
          for (int c = 0; c < block.stride(); c++)
          {
-            hw::SignalBuffer buffer(65536, 1, 1, sampleRate, sampleOffset / channelCount, 0, hw::SignalType::SIGNAL_TYPE_RAW_LOGIC, c < logicBufferKeys.size() ? logicBufferKeys[c] : c);
+            buffers.emplace_back(samples, 1, 1, sampleRate, sampleOffset / channelCount, 0, hw::SignalType::SIGNAL_TYPE_RAW_LOGIC, c < logicBufferKeys.size() ? logicBufferKeys[c] : c);
 
-            for (unsigned int i = 0; i < block.size(); i += block.stride())
-            {
-               buffer.put(block[c + i]);
-            }
+            columns.push_back(buffers.back().pull(samples));
+         }
 
+         // fill all channel buffers in one pass over the block
+         deinterleave(block.data(), block.stride(), samples, columns.data());
+
+         for (hw::SignalBuffer &buffer: buffers)
+         {
             buffer.flip();
 
             log->debug("streaming logic [{}]: {} length {}", {buffer.id(), buffer.offset(), buffer.elements()});
@@ -591,13 +863,13 @@ struct SignalStorageTask::Impl : SignalStorageTask, AbstractTask
       }
    }
 
-   std::string fileName(const std::string &type) const
+   std::string fileName(const std::string &type, const std::string &extension) const
    {
       std::ostringstream oss;
       std::time_t time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
       const std::tm *tm = std::localtime(&time);
 
-      oss << storagePath << "/" << type << "-" << std::put_time(tm, "%Y%m%dT%H%M%S") << ".wav";
+      oss << storagePath << "/" << type << "-" << std::put_time(tm, "%Y%m%dT%H%M%S") << extension;
 
       return oss.str();
    }
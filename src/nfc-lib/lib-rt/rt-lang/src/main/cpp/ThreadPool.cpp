@@ -0,0 +1,175 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include <rt/ThreadPool.h>
+
+namespace rt {
+
+struct ThreadPool::Impl
+{
+   // pool threads
+   std::vector<std::thread> threads;
+
+   // serialize concurrent runs
+   std::mutex runMutex;
+
+   // protects run state below
+   std::mutex syncMutex;
+
+   // signals new run or shutdown to pool threads
+   std::condition_variable startSync;
+
+   // signals end of run to caller
+   std::condition_variable doneSync;
+
+   // current job
+   const std::function<void(unsigned int)> *job = nullptr;
+
+   // number of job indexes in current run
+   unsigned int count = 0;
+
+   // next job index to process
+   std::atomic<unsigned int> next {0};
+
+   // run generation, incremented for each run
+   unsigned long long generation = 0;
+
+   // pool threads still working on current run
+   unsigned int active = 0;
+
+   // shutdown flag
+   bool shutdown = false;
+
+   explicit Impl(unsigned int size)
+   {
+      threads.reserve(size);
+
+      for (unsigned int i = 0; i < size; i++)
+         threads.emplace_back([this] { exec(); });
+   }
+
+   ~Impl()
+   {
+      {
+         std::lock_guard lock(syncMutex);
+         shutdown = true;
+      }
+
+      startSync.notify_all();
+
+      for (auto &thread: threads)
+         thread.join();
+   }
+
+   void exec()
+   {
+      unsigned long long seen = 0;
+
+      while (true)
+      {
+         {
+            std::unique_lock lock(syncMutex);
+
+            startSync.wait(lock, [&] { return shutdown || generation != seen; });
+
+            if (shutdown)
+               return;
+
+            seen = generation;
+         }
+
+         process();
+
+         {
+            std::lock_guard lock(syncMutex);
+
+            if (--active == 0)
+               doneSync.notify_one();
+         }
+      }
+   }
+
+   void process()
+   {
+      unsigned int index;
+
+      while ((index = next.fetch_add(1)) < count)
+         (*job)(index);
+   }
+
+   void run(unsigned int jobs, const std::function<void(unsigned int)> &task)
+   {
+      std::lock_guard runLock(runMutex);
+
+      // no threads or single job, run in current thread
+      if (threads.empty() || jobs < 2)
+      {
+         for (unsigned int i = 0; i < jobs; i++)
+            task(i);
+
+         return;
+      }
+
+      {
+         std::lock_guard lock(syncMutex);
+
+         job = &task;
+         count = jobs;
+         next = 0;
+         active = threads.size();
+         generation++;
+      }
+
+      startSync.notify_all();
+
+      // calling thread takes part in the run
+      process();
+
+      // wait until all pool threads have left current job
+      std::unique_lock lock(syncMutex);
+
+      doneSync.wait(lock, [&] { return active == 0; });
+
+      job = nullptr;
+   }
+};
+
+ThreadPool::ThreadPool(unsigned int threads) : impl(std::make_shared<Impl>(threads))
+{
+}
+
+unsigned int ThreadPool::size() const
+{
+   return impl->threads.size();
+}
+
+void ThreadPool::run(unsigned int count, const std::function<void(unsigned int index)> &job)
+{
+   impl->run(count, job);
+}
+
+}
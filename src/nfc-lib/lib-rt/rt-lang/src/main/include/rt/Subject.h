@@ -22,11 +22,14 @@
 #ifndef RT_SUBJECT_H
 #define RT_SUBJECT_H
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
-#include <list>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 #include <rt/Logger.h>
 #include <rt/Finally.h>
@@ -44,12 +47,29 @@ class Subject
       typedef std::function<void(int, std::string)> ErrorHandler;
       typedef std::function<void()> CloseHandler;
 
+      /*
+       * Optional description of the values required by current consumers, producers may use it to skip or
+       * downscale work. An empty time window means the whole stream and zero resolution means full detail.
+       */
+      struct Interest
+      {
+         double timeStart = 0; // start of required time window, in seconds
+         double timeEnd = 0; // end of required time window, in seconds
+         double resolution = 0; // coarsest time step that can be rendered, in seconds
+
+         bool hasWindow() const
+         {
+            return timeEnd > timeStart;
+         }
+      };
+
       struct Observer
       {
          int index;
          NextHandler next;
          ErrorHandler error;
          CloseHandler close;
+         std::atomic<bool> active {true};
 
          Observer(int index, NextHandler next, ErrorHandler error, CloseHandler close) : index(index), next(std::move(next)), error(std::move(error)), close(std::move(close))
          {
@@ -65,66 +85,125 @@ class Subject
 
       void next(const T &value, bool retain = false)
       {
-         for (auto observer = observers.begin(); observer != observers.end(); ++observer)
+         auto targets = snapshot();
+
+         for (auto observer = targets->begin(); observer != targets->end(); ++observer)
          {
-            if (observer->next)
+            if ((*observer)->next && (*observer)->active)
             {
-               observer->next(value);
+               (*observer)->next(value);
             }
          }
 
          if (retain)
          {
+            std::lock_guard lock(observersMutex);
+
             retained = std::make_shared<T>(value);
          }
       }
 
       void error(int error, const std::string &message)
       {
-         for (auto observer = observers.begin(); observer != observers.end(); ++observer)
+         auto targets = snapshot();
+
+         for (auto observer = targets->begin(); observer != targets->end(); ++observer)
          {
-            if (observer->error)
+            if ((*observer)->error && (*observer)->active)
             {
-               observer->error(error, message);
+               (*observer)->error(error, message);
             }
          }
       }
 
       void close()
       {
-         for (auto observer = observers.begin(); observer != observers.end(); ++observer)
+         auto targets = snapshot();
+
+         for (auto observer = targets->begin(); observer != targets->end(); ++observer)
          {
-            if (observer->close)
+            if ((*observer)->close && (*observer)->active)
             {
-               observer->close();
+               (*observer)->close();
             }
          }
       }
 
       Subscription subscribe(NextHandler next, ErrorHandler error = nullptr, CloseHandler close = nullptr)
       {
-         // append observer to list
-         auto &observer = observers.emplace_back(observers.size() + 1, next, error, close);
-         log->debug("created subscription {} ({}) on subject {}", {observer.index, static_cast<void *>(&observer), id});
+         std::shared_ptr<Observer> observer;
+         std::shared_ptr<T> last;
+
+         {
+            std::lock_guard lock(observersMutex);
+
+            // append observer to a new copy of the list, deliveries in progress keep using the previous one
+            auto list = std::make_shared<ObserverList>(*observers);
+
+            observer = list->emplace_back(std::make_shared<Observer>(list->size() + 1, next, error, close));
+            observers = list;
+
+            log->debug("created subscription {} ({}) on subject {}", {observer->index, static_cast<void *>(observer.get()), id});
+
+            // update active consumers
+            consumerCount.fetch_add(1);
+
+            last = retained;
+         }
 
          // emit retained values
-         if (retained)
+         if (last)
          {
-            if (observer.next)
+            if (observer->next)
             {
-               observer.next(*retained);
+               observer->next(*last);
             }
          }
 
          // returns finisher to remove observer when destroyed
          return {
-            [this, &observer] {
-               log->debug("removed subscription {} ({}) from subject {}", {observer.index, static_cast<void *>(&observer), id});
-               observers.remove(observer);
+            [this, observer] {
+               std::lock_guard lock(observersMutex);
+
+               log->debug("removed subscription {} ({}) from subject {}", {observer->index, static_cast<void *>(observer.get()), id});
+
+               // deliveries already holding a snapshot skip it from now on
+               observer->active = false;
+
+               auto list = std::make_shared<ObserverList>(*observers);
+
+               list->erase(std::remove(list->begin(), list->end(), observer), list->end());
+               observers = list;
+
+               // without consumers previous interest no longer applies
+               if (consumerCount.fetch_sub(1) == 1)
+                  interest({});
             }
          };
       }
 
+      // number of active consumers, producers can skip work for subjects nobody observes
+      int consumers() const
+      {
+         return consumerCount.load(std::memory_order_relaxed);
+      }
+
+      // current consumers interest
+      Interest interest() const
+      {
+         std::lock_guard lock(interestMutex);
+
+         return required;
+      }
+
+      // set consumers interest, replaces previous one
+      void interest(const Interest &value)
+      {
+         std::lock_guard lock(interestMutex);
+
+         required = value;
+      }
+
       static Subject *name(const std::string &name)
       {
          std::lock_guard lock(mutex);
@@ -144,6 +223,16 @@ class Subject
 
    private:
 
+      typedef std::vector<std::shared_ptr<Observer>> ObserverList;
+
+      // current observers, taken under lock so handlers are called without holding it
+      std::shared_ptr<const ObserverList> snapshot()
+      {
+         std::lock_guard lock(observersMutex);
+
+         return observers;
+      }
+
       // subject logger
       static Logger *log;
 
@@ -156,8 +245,20 @@ class Subject
       // subject name id
       std::string id;
 
-      // subject observers subscriptions
-      std::list<Observer> observers;
+      // subject observers subscriptions, replaced on each change so snapshots are never modified
+      std::shared_ptr<const ObserverList> observers = std::make_shared<ObserverList>();
+
+      // observers list and retained value mutex, never held while calling handlers
+      std::mutex observersMutex;
+
+      // number of subscriptions
+      std::atomic<int> consumerCount {0};
+
+      // interest mutex
+      mutable std::mutex interestMutex;
+
+      // consumers interest
+      Interest required;
 
       // last value
       std::shared_ptr<T> retained;
@@ -0,0 +1,55 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef RT_THREADPOOL_H
+#define RT_THREADPOOL_H
+
+#include <memory>
+#include <functional>
+
+namespace rt {
+
+/*
+ * Fixed set of threads for short parallel jobs, unlike Executor that runs long lived tasks. Threads are created
+ * once and wait between runs, each run spreads job indexes over the pool and the calling thread.
+ */
+class ThreadPool
+{
+      struct Impl;
+
+   public:
+
+      explicit ThreadPool(unsigned int threads);
+
+      // number of pool threads, without the calling thread
+      unsigned int size() const;
+
+      // run job for each index from 0 to count - 1 and wait for all of them, calls from several threads are serialized
+      void run(unsigned int count, const std::function<void(unsigned int index)> &job);
+
+   private:
+
+      std::shared_ptr<Impl> impl;
+};
+
+}
+
+#endif
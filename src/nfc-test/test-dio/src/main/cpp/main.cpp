@@ -19,16 +19,531 @@
 
 */
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
 
 #include <rt/Logger.h>
 
+#include <hw/SignalType.h>
+#include <hw/RecordDevice.h>
+
 #include <hw/logic/DSLogicDevice.h>
+#include <hw/logic/LogicRunLength.h>
+#include <hw/logic/LogicRunSplitter.h>
+
+#include <lab/iso/IsoDecoder.h>
 
 using namespace rt;
 using namespace hw;
+using namespace lab;
+
+/*
+ * Generate packed ISO7816 I/O line at given sample rate, idle high with 9600 baud characters and random guard gaps
+ */
+std::vector<unsigned char> generateLine(unsigned int sampleRate, unsigned int samples)
+{
+   std::vector<unsigned char> data((samples + 7) / 8, 0xFF);
+
+   unsigned int etu = sampleRate / 9600;
+   unsigned int seed = 12345;
+   unsigned int i = etu * 20;
+
+   while (i + etu * 12 < samples)
+   {
+      seed = seed * 1103515245 + 12345;
+
+      unsigned int value = (seed >> 16) & 0xFF;
+
+      // start bit, 8 data bits and parity, stop bits are idle
+      for (unsigned int b = 0; b < 10; b++)
+      {
+         bool level = b == 0 ? false : b < 9 ? (value >> (b - 1)) & 1 : __builtin_parity(value);
+
+         for (unsigned int s = 0; s < etu; s++, i++)
+         {
+            if (!level)
+               data[i >> 3] &= ~(1 << (i & 7));
+         }
+      }
+
+      // guard time plus random idle time between characters
+      i += etu * (2 + (seed >> 8) % 64);
+   }
+
+   return data;
+}
+
+/*
+ * Round trip synthetic line through run-length encoder and decoder, expanded buffers and edge list must match
+ */
+bool testRunLength(Logger *log)
+{
+   bool passed = true;
+
+   for (unsigned int sampleRate: {100000000u, 200000000u, 500000000u})
+   {
+      unsigned int samples = sampleRate / 100;
+
+      std::vector<unsigned char> data = generateLine(sampleRate, samples);
+      std::vector<unsigned short> words;
+      std::vector<unsigned long long> edges;
+
+      LogicRunLength::encode(data.data(), samples, words);
+
+      // expand into small buffers so runs span several of them
+      LogicRunLength decoder;
+
+      unsigned int consumed = 0, position = 0;
+
+      while (consumed < words.size() || decoder.pending())
+      {
+         SignalBuffer buffer(10007, 1, 1, sampleRate, position, 0, SIGNAL_TYPE_RAW_LOGIC);
+
+         consumed += decoder.expand(words.data() + consumed, words.size() - consumed, buffer);
+
+         buffer.flip();
+
+         for (unsigned int i = 0; i < buffer.limit(); i++, position++)
+         {
+            if (buffer[i] != static_cast<float>(data[position >> 3] >> (position & 7) & 1))
+               passed = false;
+         }
+      }
+
+      passed = passed && position == samples;
+
+      // edge list must contain every level change
+      LogicRunLength tracker;
+
+      tracker.edges(words.data(), words.size(), edges);
+
+      unsigned int expected = (data[0] & 1) ? 1 : 0;
+
+      for (unsigned int i = 1; i < samples; i++)
+      {
+         if ((data[i >> 3] >> (i & 7) & 1) != (data[(i - 1) >> 3] >> ((i - 1) & 7) & 1))
+            expected++;
+      }
+
+      passed = passed && edges.size() == expected;
+
+      log->info("RLE at {} MHz: {} raw bytes, {} compressed bytes, bandwidth saved {.2}%", {sampleRate / 1000000, data.size(), words.size() * 2, 100.0 - 100.0 * words.size() * 2 / data.size()});
+   }
+
+   return passed;
+}
+
+/*
+ * Synthetic compressed transfers with four interleaved channels split at odd sizes, expanded buffers and edge lists must
+ * match the original lines
+ */
+bool testRunTransfer(Logger *log)
+{
+   bool passed = true;
+
+   for (unsigned int sampleRate: {100000000u, 200000000u, 500000000u})
+   {
+      unsigned int samples = sampleRate / 100;
+
+      // I/O line, clock at 1/28 of sample rate during first millisecond, idle reset and constant low VCC
+      std::vector<std::vector<unsigned char>> lines(4, std::vector<unsigned char>((samples + 7) / 8, 0));
+
+      lines[0] = generateLine(sampleRate, samples);
+
+      for (unsigned int i = 0; i < sampleRate / 1000; i++)
+      {
+         if ((i / 14) & 1)
+            lines[1][i >> 3] |= 1 << (i & 7);
+      }
+
+      std::fill(lines[2].begin(), lines[2].end(), 0xFF);
+
+      std::vector<std::vector<unsigned short>> words(lines.size());
+      std::vector<unsigned char> data;
+
+      for (unsigned int c = 0; c < lines.size(); c++)
+         LogicRunLength::encode(lines[c].data(), samples, words[c]);
+
+      LogicRunSplitter::interleave(words, data);
+
+      // expand in odd sized transfers, so atoms and runs are split between them
+      std::vector<unsigned int> channels {0, 1, 2, 3};
+      std::vector<SignalBuffer> buffers;
+
+      LogicRunSplitter splitter;
+
+      splitter.reset(channels, 65536, sampleRate);
+
+      auto start = std::chrono::steady_clock::now();
+
+      for (unsigned int offset = 0; offset < data.size(); offset += 16381)
+         splitter.split(data.data() + offset, std::min(16381u, static_cast<unsigned int>(data.size() - offset)), buffers);
+
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      passed = passed && splitter.bytes() == data.size() && buffers.size() == splitter.samples() / 65536 * channels.size();
+
+      for (unsigned int b = 0; b < buffers.size() && passed; b++)
+      {
+         const SignalBuffer &buffer = buffers[b];
+
+         unsigned int c = b % channels.size();
+
+         passed = buffer.id() == channels[c] && buffer.offset() == b / channels.size() * 65536 && buffer.elements() == 65536;
+
+         for (unsigned int i = 0; i < buffer.elements() && passed; i++)
+         {
+            unsigned long long position = buffer.offset() + i;
+
+            // padding after end of synthetic lines is not checked
+            if (position < samples && buffer[i] != static_cast<float>(lines[c][position >> 3] >> (position & 7) & 1))
+               passed = false;
+         }
+      }
+
+      // edge lists from same transfers
+      std::vector<std::vector<unsigned long long>> edges;
+
+      LogicRunSplitter tracker;
+
+      tracker.reset(channels, 65536, sampleRate);
+
+      for (unsigned int offset = 0; offset < data.size(); offset += 16381)
+         tracker.edges(data.data() + offset, std::min(16381u, static_cast<unsigned int>(data.size() - offset)), edges);
+
+      for (unsigned int c = 0; c < lines.size() && passed; c++)
+      {
+         std::vector<unsigned long long> expected;
+
+         for (unsigned int i = 0; i < samples; i++)
+         {
+            bool level = lines[c][i >> 3] >> (i & 7) & 1;
+            bool previous = i > 0 ? lines[c][(i - 1) >> 3] >> ((i - 1) & 7) & 1 : false;
+
+            if (level != previous)
+               expected.push_back(i);
+         }
+
+         std::vector<unsigned long long> found;
+
+         std::copy_if(edges[c].begin(), edges[c].end(), std::back_inserter(found), [samples](unsigned long long edge) { return edge < samples; });
+
+         passed = found == expected;
+      }
+
+      unsigned long long rawBytes = static_cast<unsigned long long>(samples) / 8 * lines.size();
+
+      log->info("RLE transfer at {} MHz: {} channels, {} raw bytes, {} compressed bytes, bandwidth saved {.2}%, expanded at {.1} Msps per channel", {sampleRate / 1000000, lines.size(), rawBytes, data.size(), 100.0 - 100.0 * data.size() / rawBytes, splitter.samples() / elapsed / 1E6});
+   }
+
+   return passed;
+}
+
+/*
+ * Synthetic ISO7816 session with I/O, clock, reset and VCC lines, clock runs only during first block
+ */
+float sessionSample(const std::vector<unsigned char> &line, unsigned int channel, unsigned int i)
+{
+   switch (channel)
+   {
+      case 0:
+         return static_cast<float>(line[i >> 3] >> (i & 7) & 1);
+      case 1:
+         return i < 300000 ? static_cast<float>(i & 1) : 0.0f;
+      case 2:
+         return i > 1000 ? 1.0f : 0.0f;
+      default:
+         return 1.0f;
+   }
+}
+
+/*
+ * Round trip synthetic logic session through compressed container, check contents, size and seek
+ */
+bool testContainer(Logger *log)
+{
+   const unsigned int sampleRate = 1000000;
+   const unsigned int channels = 4;
+   const unsigned int samples = sampleRate * 10;
+
+   std::string path = std::filesystem::temp_directory_path().string() + "/test-logic.nfl";
+
+   std::vector<unsigned char> line = generateLine(sampleRate, samples);
+
+   RecordDevice target(path);
+
+   target.set(SignalDevice::PARAM_SAMPLE_RATE, sampleRate);
+   target.set(SignalDevice::PARAM_SAMPLE_SIZE, 8u);
+   target.set(SignalDevice::PARAM_CHANNEL_COUNT, channels);
+   target.set(SignalDevice::PARAM_CHANNEL_KEYS, std::vector<int> {0, 1, 2, 3});
+
+   if (!target.open(RecordDevice::Write))
+      return false;
+
+   for (unsigned int offset = 0; offset < samples; offset += 65536)
+   {
+      unsigned int length = std::min(65536u, samples - offset);
+
+      SignalBuffer buffer(length * channels, channels, 1, sampleRate, offset, 0, SIGNAL_TYPE_RAW_LOGIC);
+
+      for (unsigned int i = offset; i < offset + length; i++)
+      {
+         for (unsigned int c = 0; c < channels; c++)
+            buffer.put(sessionSample(line, c, i));
+      }
+
+      buffer.flip();
+
+      target.write(buffer);
+   }
+
+   target.close();
+
+   RecordDevice source(path);
+
+   if (!source.open(RecordDevice::Read))
+      return false;
+
+   bool passed = std::get<unsigned int>(source.get(SignalDevice::PARAM_SAMPLE_SIZE)) == 8 && std::get<unsigned int>(source.get(SignalDevice::PARAM_CHANNEL_COUNT)) == channels;
+
+   unsigned int position = 0;
+
+   auto start = std::chrono::steady_clock::now();
+
+   while (passed && !source.isEof())
+   {
+      SignalBuffer buffer(65536 * channels, channels, 1, sampleRate, 0, 0, SIGNAL_TYPE_RAW_LOGIC);
+
+      if (source.read(buffer) <= 0)
+         break;
+
+      for (unsigned int i = 0; i < buffer.limit(); i++)
+      {
+         if (buffer[i] != sessionSample(line, i % channels, position + i / channels))
+            passed = false;
+      }
+
+      position += buffer.limit() / channels;
+   }
+
+   double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   // 8 bit WAV stores one byte per sample and channel
+   double ratio = static_cast<double>(samples) * channels / static_cast<double>(std::filesystem::file_size(path));
+
+   log->info("logic container: {} bytes, compression ratio {.1}, replay {.1} Msps", {static_cast<unsigned long long>(std::filesystem::file_size(path)), ratio, samples / elapsed / 1E6});
+
+   passed = passed && position == samples && ratio > 100;
+
+   // seek into the middle of a block
+   unsigned int offset = (samples / 2 + 12345) * channels;
+
+   SignalBuffer buffer(4096 * channels, channels, 1, sampleRate, 0, 0, SIGNAL_TYPE_RAW_LOGIC);
+
+   if (!source.set(SignalDevice::PARAM_SAMPLE_OFFSET, offset) || source.read(buffer) <= 0)
+      passed = false;
+
+   for (unsigned int i = 0; passed && i < buffer.limit(); i++)
+   {
+      if (buffer[i] != sessionSample(line, i % channels, offset / channels + i / channels))
+         passed = false;
+   }
+
+   source.close();
+
+   std::remove(path.c_str());
+
+   return passed;
+}
+
+/*
+ * Synthetic ISO7816 T=0 session at 9600 baud, I/O line stored as list of level changes starting idle high
+ */
+struct IsoSession
+{
+   unsigned int vccHigh;
+   unsigned int rstHigh;
+   unsigned int rstLow;
+   unsigned int vccLow;
+   unsigned int samples;
+
+   std::vector<unsigned int> edges;
+   std::vector<std::vector<unsigned char>> frames;
+};
+
+/*
+ * Add one character in direct convention, start bit, 8 data bits and even parity, line stays high for error and guard bits
+ */
+void sessionCharacter(IsoSession &session, double etu, double start, unsigned int value)
+{
+   bool level = true;
+
+   for (unsigned int b = 0; b < 10; b++)
+   {
+      bool bit = b == 0 ? false : b < 9 ? (value >> (b - 1)) & 1 : __builtin_parity(value);
+
+      if (bit != level)
+      {
+         session.edges.push_back(std::lround(start + b * etu));
+         level = bit;
+      }
+   }
+
+   if (!level)
+      session.edges.push_back(std::lround(start + 10 * etu));
+}
+
+IsoSession sessionExchange(unsigned int sampleRate, unsigned int exchanges)
+{
+   IsoSession session {};
+
+   double etu = sampleRate / 9600.0;
+   unsigned int seed = 12345;
+
+   session.vccHigh = 1000;
+   session.rstHigh = 5000;
+
+   // minimal ATR, direct convention with T=0 and no interface or historical bytes
+   session.frames.push_back({0x3B, 0x00});
+
+   // READ BINARY commands answered with ACK, data and status word
+   for (unsigned int i = 0; i < exchanges; i++)
+   {
+      seed = seed * 1103515245 + 12345;
+
+      unsigned int length = 1 + (seed >> 16) % 32;
+
+      std::vector<unsigned char> frame = {0x00, 0xB0, static_cast<unsigned char>(i >> 8), static_cast<unsigned char>(i), static_cast<unsigned char>(length), 0xB0};
+
+      for (unsigned int n = 0; n < length; n++)
+      {
+         seed = seed * 1103515245 + 12345;
+         frame.push_back((seed >> 16) & 0xFF);
+      }
+
+      frame.push_back(0x90);
+      frame.push_back(0x00);
+
+      session.frames.push_back(frame);
+   }
+
+   double time = 20000;
+
+   for (const auto &frame: session.frames)
+   {
+      for (unsigned char value: frame)
+      {
+         sessionCharacter(session, etu, time, value);
+
+         // character guard time plus up to 2 extra ETUs
+         seed = seed * 1103515245 + 12345;
+         time += etu * (12 + (seed >> 16) % 3);
+      }
+
+      // idle time between exchanges, below character waiting time
+      time += etu * 300;
+   }
+
+   session.rstLow = std::lround(time + etu * 1000);
+   session.vccLow = session.rstLow + 5000;
+   session.samples = session.vccLow + 5000;
+
+   return session;
+}
+
+/*
+ * Decode long synthetic ISO7816 session, frames must match generated exchanges exactly
+ */
+bool testIso7816(Logger *log)
+{
+   const unsigned int sampleRate = 4000000;
+   const unsigned int chunkSize = 65536;
+
+   IsoSession session = sessionExchange(sampleRate, 200);
+
+   IsoDecoder decoder;
+
+   decoder.setSampleRate(sampleRate);
+   decoder.initialize();
+
+   std::vector<RawFrame> frames, decoded;
+
+   double elapsed = 0;
+   unsigned int edge = 0;
+   bool level = true;
+
+   for (unsigned int offset = 0; offset < session.samples; offset += chunkSize)
+   {
+      unsigned int length = std::min(chunkSize, session.samples - offset);
+
+      SignalBuffer buffer(length * 3, 3, 1, sampleRate, offset, 0, SIGNAL_TYPE_RAW_LOGIC);
+
+      for (unsigned int i = offset; i < offset + length; i++)
+      {
+         while (edge < session.edges.size() && session.edges[edge] <= i)
+         {
+            level = !level;
+            edge++;
+         }
+
+         float sample[3] = {level ? 1.0f : 0.0f, i >= session.rstHigh && i < session.rstLow ? 1.0f : 0.0f, i >= session.vccHigh && i < session.vccLow ? 1.0f : 0.0f};
+
+         buffer.put(sample, 3);
+      }
+
+      buffer.flip();
+
+      auto start = std::chrono::steady_clock::now();
+
+      decoded.clear();
+      decoder.nextFrames(buffer, decoded);
+
+      elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      frames.insert(frames.end(), decoded.begin(), decoded.end());
+   }
+
+   auto start = std::chrono::steady_clock::now();
+
+   decoded.clear();
+   decoder.nextFrames({}, decoded);
+
+   elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   frames.insert(frames.end(), decoded.begin(), decoded.end());
+
+   // line changes around ATR and all exchanges
+   std::vector<unsigned int> expected = {IsoVccHigh, IsoRstHigh, IsoATRFrame};
+
+   expected.insert(expected.end(), session.frames.size() - 1, IsoExchangeFrame);
+   expected.insert(expected.end(), {IsoRstLow, IsoVccLow});
+
+   bool passed = frames.size() == expected.size();
+
+   for (unsigned int i = 0, n = 0; passed && i < frames.size(); i++)
+   {
+      RawFrame &frame = frames[i];
+
+      passed = frame.frameType() == expected[i] && !frame.frameFlags();
+
+      if (frame.techType() == Iso7816Tech)
+      {
+         const auto &data = session.frames[n++];
+
+         passed = passed && frame.limit() == data.size() && std::equal(data.begin(), data.end(), frame.data());
+      }
+   }
+
+   log->info("ISO7816 session of {} exchanges, {} samples decoded in {.3} ms, {.1} Msps", {session.frames.size() - 1, session.samples, elapsed * 1000, session.samples / elapsed / 1000000});
+
+   return passed;
+}
 
 int main(int argc, char *argv[])
 {
@@ -40,6 +555,14 @@ int main(int argc, char *argv[])
    log->info("NFC laboratory, 2024 Jose Vicente Campos Martinez - <josevcm@gmail.com>");
    log->info("***********************************************************************");
 
+   std::cout << "TEST RLE: " << (testRunLength(log) ? "PASS" : "FAIL") << std::endl;
+
+   std::cout << "TEST RLE TRANSFER: " << (testRunTransfer(log) ? "PASS" : "FAIL") << std::endl;
+
+   std::cout << "TEST CONTAINER: " << (testContainer(log) ? "PASS" : "FAIL") << std::endl;
+
+   std::cout << "TEST ISO7816: " << (testIso7816(log) ? "PASS" : "FAIL") << std::endl;
+
    for (std::string name: DSLogicDevice::enumerate())
    {
       log->info("found device: {}", {name});
@@ -0,0 +1,260 @@
+/*
+
+  This file is part of NFC-LABORATORY.
+
+  Copyright (C) 2024 Jose Vicente Campos Martinez, <josevcm@gmail.com>
+
+  NFC-LABORATORY is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  NFC-LABORATORY is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with NFC-LABORATORY. If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include <QApplication>
+
+#include <rt/Logger.h>
+
+#include <hw/SignalType.h>
+#include <hw/SignalBuffer.h>
+
+#include <lab/data/RawFrame.h>
+
+#include <graph/MarkerBrackets.h>
+#include <graph/MarkerRibbon.h>
+#include <graph/SignalData.h>
+
+#include <protocol/ProtocolFrame.h>
+#include <protocol/ProtocolParser.h>
+
+#include <styles/Theme.h>
+
+using namespace rt;
+
+Logger *logger = Logger::getLogger("main");
+
+/*
+ * Insert 100k frames into signal markers as RadioWidget does and render at increasing zoom levels. Insert must not
+ * request any label, labels are only requested for frames drawn and each one only once.
+ */
+bool testBrackets()
+{
+   // 10 seconds at 1 Msps, one 40us frame every 100us
+   const unsigned int sampleRate = 1000000;
+   const unsigned int blockSize = 65536;
+   const int frameCount = 100000;
+   const double framePeriod = 100E-6;
+   const double frameLength = 40E-6;
+
+   const QVector<QString> events = {"REQA", "ATQA", "SEL1", "UID", "RATS", "ATS", "I-Block", "R(ACK)"};
+
+   QCustomPlot plot;
+
+   plot.resize(1920, 480);
+   plot.yAxis->setRange(0, 1);
+
+   SignalData signalData;
+   MarkerBrackets bracketMarker(&plot);
+   MarkerRibbon ribbonMarker(&plot);
+
+   int requests = 0;
+
+   bracketMarker.setLabelMapper([&](int key) {
+      requests++;
+      return events[key % events.size()];
+   });
+
+   unsigned long long sampleCount = static_cast<unsigned long long>(frameCount * framePeriod * sampleRate);
+
+   std::vector<float> block(blockSize);
+
+   for (unsigned long long offset = 0; offset < sampleCount; offset += blockSize)
+   {
+      for (unsigned int i = 0; i < blockSize; i++)
+         block[i] = 0.25f + static_cast<float>((offset + i) % 97) / 400.0f;
+
+      signalData.append(hw::SignalBuffer(block.data(), blockSize, 1, 1, sampleRate, offset, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL));
+   }
+
+   QColor techColor = Theme::defaultNfcAColor;
+
+   techColor.setAlpha(0xE0);
+
+   auto insertStart = std::chrono::steady_clock::now();
+
+   for (int row = 0; row < frameCount; row++)
+   {
+      double start = row * framePeriod;
+      double end = start + frameLength;
+
+      double maxValue = qMax(0.0, signalData.maximum(start, end));
+
+      bracketMarker.addBracket(start, end, maxValue, row);
+      ribbonMarker.addRange(start, end, "ISO 14443-A", QPen(techColor), QBrush(techColor));
+   }
+
+   double insertTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - insertStart).count();
+
+   logger->info("insert {} frames in {.2} ms, {.3} us per frame, {} labels requested", {frameCount, insertTime, insertTime * 1000 / frameCount, requests});
+
+   bool passed = requests == 0;
+
+   double center = frameCount * framePeriod / 2;
+
+   // visible spans from whole capture down to a few frames
+   for (double span: {10.0, 1.0, 1E-1, 1E-2, 2E-3, 1E-3, 5E-4})
+   {
+      plot.xAxis->setRange(center - span / 2, center + span / 2);
+
+      int before = requests;
+
+      auto renderStart = std::chrono::steady_clock::now();
+
+      plot.toPixmap(1920, 480);
+
+      double renderTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - renderStart).count();
+
+      int requested = requests - before;
+
+      // second render of same range must use cached labels
+      plot.toPixmap(1920, 480);
+
+      int repeated = requests - before - requested;
+
+      logger->info("zoom {.4} s, {} frames visible, render {.2} ms, {} labels requested, {} on repeat", {span, static_cast<int>(span / framePeriod), renderTime, requested, repeated});
+
+      passed = passed && repeated == 0 && requested <= span / framePeriod + 2;
+   }
+
+   return passed;
+}
+
+/*
+ * Parse frames with the frame view protocol parsers and compare trees, including field byte ranges used for bit
+ * level annotations, against the trees shown by the former per-technology parsers.
+ */
+bool testParser()
+{
+   std::list<lab::RawFrame> frames;
+
+   auto add = [&](unsigned int tech, unsigned int type, std::initializer_list<unsigned char> data, unsigned int flags = 0) {
+      frames.emplace_back(tech, type);
+
+      for (unsigned char value: data)
+         frames.back().put(value);
+
+      frames.back().setFrameFlags(flags);
+      frames.back().flip();
+   };
+
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcPollFrame, {0x60, 0x08, 0xBD, 0xF7});
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcListenFrame, {0x49, 0xB5, 0x18, 0x7D});
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcPollFrame, {0x20, 0x0D, 0x25, 0x13, 0x4B, 0x39, 0x7A, 0xD1}, lab::FrameFlags::Encrypted);
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcPollFrame, {0xE0, 0x80, 0x31, 0x73});
+   add(lab::FrameTech::NfcBTech, lab::FrameType::NfcPollFrame, {0x05, 0x00, 0x08, 0x39, 0x73});
+   add(lab::FrameTech::NfcBTech, lab::FrameType::NfcListenFrame, {0x50, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x80, 0x81, 0x71, 0x00, 0x00});
+   add(lab::FrameTech::NfcFTech, lab::FrameType::NfcPollFrame, {0x06, 0x00, 0xFF, 0xFF, 0x00, 0x03, 0x39, 0x42});
+   add(lab::FrameTech::NfcVTech, lab::FrameType::NfcPollFrame, {0x02, 0xA1, 0x04, 0x05, 0x00, 0x00});
+   add(lab::FrameTech::NfcVTech, lab::FrameType::NfcListenFrame, {0x00, 0x01, 0x02, 0x00, 0x00});
+   add(lab::FrameTech::Iso7816Tech, lab::FrameType::IsoResponseFrame, {0xFF, 0x71, 0x95, 0x01, 0x02, 0x00});
+   add(lab::FrameTech::Iso7816Tech, lab::FrameType::IsoResponseFrame, {0x00, 0x91, 0x00, 0x91});
+   add(lab::FrameTech::Iso7816Tech, lab::FrameType::IsoRequestFrame, {0x00, 0xC1, 0x01, 0xFE, 0x3E});
+
+   ProtocolParser parser;
+   std::vector<std::string> trees;
+
+   // flatten each tree as "depth:name=value@start..end" items, root shows its type flags instead of range
+   std::function<void(ProtocolFrame *, int, std::string &)> flatten = [&](ProtocolFrame *node, int depth, std::string &tree) {
+
+      QVariant info = node->data(ProtocolFrame::Data);
+      QString value;
+
+      if (info.typeId() == QMetaType::QByteArray)
+      {
+         for (char it: info.toByteArray())
+            value.append(QString("%1").arg(it & 0xff, 2, 16, QLatin1Char('0')));
+      }
+      else
+      {
+         value = info.toString();
+      }
+
+      tree += std::to_string(depth) + ":" + node->data(ProtocolFrame::Name).toString().toStdString() + "=" + value.toStdString();
+
+      if (depth == 0)
+         tree += "#" + std::to_string(node->data(ProtocolFrame::Flags).toInt() & 0xff00);
+      else if (node->rangeStart() >= 0)
+         tree += "@" + std::to_string(node->rangeStart()) + ".." + std::to_string(node->rangeEnd());
+
+      tree += "; ";
+
+      for (int i = 0; i < node->childCount(); i++)
+         flatten(node->child(i), depth + 1, tree);
+   };
+
+   for (const auto &frame: frames)
+   {
+      std::string tree;
+
+      if (ProtocolFrame *root = parser.parse(frame))
+      {
+         flatten(root, 0, tree);
+
+         delete root;
+      }
+
+      trees.push_back(tree);
+   }
+
+   bool match = trees.size() == 12 &&
+                trees[0] == "0:AUTH(A)=6008bdf7#8448; 1:BLOCK=8@1..1; 1:CRC=bdf7@2..3; " &&
+                trees[1] == "0:=49b5187d#8704; 1:CRC=187d@2..3; " &&
+                trees[2] == "0:AUTH(A)=200d25134b397ad1#8448; 1:TOKEN=200d25134b397ad1@0..7; " &&
+                trees[3] == "0:RATS=e0803173#2304; 1:PARAM=80 [10000000]@1..1; 2:=[1000....] FSD max frame size 256; 2:=[....0000] CDI logical channel 0; 1:CRC=3173@2..3; " &&
+                trees[4] == "0:WUPB=0500083973#1280; 1:AFI=00@1..1; 2:=[00000000] All families and sub-families; 1:PARAM=08@2..2; 2:=[....1...] WUPB command; 2:=[.....000] number of slots: 1; 1:CRC=3973@3..4; " &&
+                trees[5] == "0:=5001020304050607088081710000#1536; 1:PUPI=01020304@1..4; 1:APP=05060708@5..8; 1:PROTO=808171@9..11; 2:RATE=80@9..9; 3:=[1.......] only support same rate for both directions; 3:=[.0000000] only 106 kbps supported; 2:FRAME=81@10..10; 3:=[1000....] maximum frame size, 256 bytes; 3:=[....0001] PICC compliant with ISO/IEC 14443-4; 2:OTHER=71@11..11; 3:=[0111....] frame waiting time FWT = 38.66 ms; 3:=[....00..] application is proprietary; 3:=[.......1] CID supported by the PICC; 1:CRC=0000@12..13; " &&
+                trees[6] == "0:REQC=0600ffff00033942#1280; 1:LEN=06@0..0; 1:CMD=00@1..1; 1:PARAM=ffff0003@2..5; 1:CRC=3942@6..7; " &&
+                trees[7] == "0:CMD a1=02a104050000#256; 1:FLAGS=02@0..0; 2:=[.......0] A single sub-carrier frequency shall be used by the VICC; 2:=[......1.] High data rate shall be used; 2:=[....0...] No protocol format extension; 2:=[...0.0..] Request shall be executed by any VICC according to the setting of Address flag; 2:=[..0..0..] Request is not addressed. UID field is not present. It shall be executed by any VICC; 2:=[.0...0..] Custom flag. Meaning is defined by the Custom command; 2:=[0....0..] Reserved for future use; 1:CMD=a1@1..1; 1:DATA=0405@2..3; 1:CRC=0000@4..5; " &&
+                trees[8] == "0:=0001020000#512; 1:FLAGS=00@0..0; 2:=[.......0] No error; 2:=[.....00.] Reserved for future use; 2:=[....0...] No protocol format extension; 2:=[0000....] Reserved for future use; 1:PARAMS=0102@1..2; 1:CRC=0000@3..4; " &&
+                trees[9] == "0:PPS=ff7195010200#512; 1:PPS0=71 [01110001]@1..1; 2:=[.1......] PPS3 transmitted; 2:=[..1.....] PPS2 transmitted; 2:=[...1....] PPS1 transmitted; 2:=[....0001] T=1 protocol selection; 1:PPS1=95 [10010101]@2..2; 2:=[1001....] Frequency adjustment, Fi = 9 (512); 2:=[....0101] Baud rate divisor, Di = 5, (1/16); 1:PPS2=01 [00000001]@3..3; 1:PPS3=02 [00000010]@4..4; 1:PCK=00@5..5; " &&
+                trees[10] == "0:R-Block=00910091#4608; 1:NAD=00@0..0; 1:PCB=91 [10010001]@1..1; 2:=[10......] R-Block; 2:=[..1.....] NACK (error); 2:=[....0001] Redundancy code error or a character parity error; 1:LEN=00@2..2; 1:LRC=91@3..3; " &&
+                trees[11] == "0:S(IFS)=00c101fe3e#4352; 1:NAD=00@0..0; 1:PCB=c1 [11000001]@1..1; 2:=[11......] S-Block; 2:=[..0.....] Request block; 2:=[...00001] IFS (information field size block); 1:LEN=01@2..2; 1:IFS=fe [11111110]@3..3; 2:=[11111110] Information field size, 254 bytes; 1:LRC=3e@4..4; ";
+
+   if (!match)
+   {
+      for (const auto &tree: trees)
+         logger->warn("parser tree: {}", {tree});
+   }
+
+   return match;
+}
+
+int main(int argc, char *argv[])
+{
+   //   Logger::init(std::cout, false);
+
+   // plots are rendered off screen
+   if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+      qputenv("QT_QPA_PLATFORM", "offscreen");
+
+   QApplication app(argc, argv);
+
+   std::cout << "TEST BRACKETS: " << (testBrackets() ? "PASS" : "FAIL") << std::endl;
+   std::cout << "TEST PARSER: " << (testParser() ? "PASS" : "FAIL") << std::endl;
+
+   return 0;
+}
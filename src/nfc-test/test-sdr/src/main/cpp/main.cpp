@@ -19,27 +19,198 @@
 
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <new>
+#include <filesystem>
 #include <iomanip>
+#include <mutex>
+#include <thread>
 #include <nlohmann/json.hpp>
 
+#include <rt/Executor.h>
 #include <rt/Logger.h>
 #include <rt/FileSystem.h>
+#include <rt/Subject.h>
 
 #include <hw/SignalType.h>
 #include <hw/RecordDevice.h>
+#include <hw/RecordWriter.h>
 
 #include <lab/data/RawFrame.h>
+#include <lab/data/FrameCache.h>
+#include <lab/data/FrameDissector.h>
+#include <lab/data/FrameFilter.h>
+#include <lab/data/FrameWriter.h>
+#include <lab/data/IsoDepAssembler.h>
 
 #include <lab/nfc/Nfc.h>
 #include <lab/nfc/NfcDecoder.h>
 
+#include <lab/tasks/SignalResamplingTask.h>
+
 using namespace rt;
 using namespace nlohmann;
 
 Logger *logger = Logger::getLogger("main");
 
+// number of heap allocations, used to check decoder steady state
+static std::atomic<unsigned long long> heapAllocations {0};
+
+// all global allocation forms are replaced so every allocation is counted and released with its matching function
+static void *allocate(std::size_t size, bool nothrow = false)
+{
+   heapAllocations++;
+
+   if (void *ptr = std::malloc(size ? size : 1))
+      return ptr;
+
+   if (nothrow)
+      return nullptr;
+
+   throw std::bad_alloc();
+}
+
+// kept out of line, otherwise the compiler sees free() on pointers returned by operator new and warns about mismatched pairs
+[[gnu::noinline]] static void release(void *ptr) noexcept
+{
+   std::free(ptr);
+}
+
+// over-aligned blocks keep the malloc pointer just before the aligned address
+static void *allocate(std::size_t size, std::align_val_t alignment, bool nothrow = false)
+{
+   std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void *));
+
+   heapAllocations++;
+
+   if (void *block = std::malloc(size + align + sizeof(void *)))
+   {
+      auto address = (reinterpret_cast<std::uintptr_t>(block) + sizeof(void *) + align - 1) & ~(align - 1);
+
+      reinterpret_cast<void **>(address)[-1] = block;
+
+      return reinterpret_cast<void *>(address);
+   }
+
+   if (nothrow)
+      return nullptr;
+
+   throw std::bad_alloc();
+}
+
+[[gnu::noinline]] static void release(void *ptr, std::align_val_t) noexcept
+{
+   if (ptr)
+      std::free(static_cast<void **>(ptr)[-1]);
+}
+
+void *operator new(std::size_t size)
+{
+   return allocate(size);
+}
+
+void *operator new[](std::size_t size)
+{
+   return allocate(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+   return allocate(size, true);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+   return allocate(size, true);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+   return allocate(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+   return allocate(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+   return allocate(size, alignment, true);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+   return allocate(size, alignment, true);
+}
+
+void operator delete(void *ptr) noexcept
+{
+   release(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+   release(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+   release(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+   release(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+   release(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+   release(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t alignment) noexcept
+{
+   release(ptr, alignment);
+}
+
+void operator delete[](void *ptr, std::align_val_t alignment) noexcept
+{
+   release(ptr, alignment);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t alignment) noexcept
+{
+   release(ptr, alignment);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t alignment) noexcept
+{
+   release(ptr, alignment);
+}
+
+void operator delete(void *ptr, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+   release(ptr, alignment);
+}
+
+void operator delete[](void *ptr, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+   release(ptr, alignment);
+}
+
 /*
  * Read frames from JSON storage
  */
@@ -178,82 +349,1817 @@ bool readSignal(const std::string &path, std::list<lab::RawFrame> &list)
    return true;
 }
 
-int testFile(const std::string &signal)
+/*
+ * Decode WAV file from checkpoint, or from start if checkpoint is empty, optionally collecting checkpoints and frames decoded after each one
+ */
+bool decodeSignal(const std::string &path, const lab::NfcDecoder::Checkpoint *start, std::list<std::pair<lab::NfcDecoder::Checkpoint, std::list<lab::RawFrame>>> &result)
 {
-   size_t pos1 = signal.find(".wav");
-   size_t pos2 = signal.rfind("/");
+   hw::RecordDevice source(path);
 
-   if (pos1 == std::string::npos)
-      return -1;
+   if (!source.open(hw::RecordDevice::Mode::Read))
+      return false;
 
-   std::string target = signal.substr(0, pos1) + ".json";
-   std::string filename = signal;
+   unsigned int channelCount = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_CHANNEL_COUNT));
+   unsigned int sampleRate = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_SAMPLE_RATE));
 
-   if (pos2 != std::string::npos)
-      filename = signal.substr(pos2 + 1, pos1 - 4);
+   lab::NfcDecoder decoder;
 
-   std::list<lab::RawFrame> list1;
-   std::list<lab::RawFrame> list2;
+   decoder.setEnableNfcA(true);
+   decoder.setEnableNfcB(true);
+   decoder.setEnableNfcF(true);
+   decoder.setEnableNfcV(true);
+   decoder.setCheckpointInterval(16384);
 
-   // decode frames from signal
-   if (readSignal(signal, list1))
+   // initial entry for frames decoded before first checkpoint
+   result.emplace_back();
+
+   // resume from checkpoint
+   if (start)
    {
-      // read frames from json file
-      if (readFrames(target, list2))
-      {
-         // show result
-         std::cout << "TEST FILE " << filename << ": " << (list1 == list2 ? "PASS" : "FAIL") << std::endl;
-      }
-      else
+      if (!decoder.loadCheckpoint(*start))
+         return false;
+
+      if (!source.set(hw::SignalDevice::PARAM_SAMPLE_OFFSET, static_cast<unsigned int>(start->sampleOffset * channelCount)))
+         return false;
+   }
+
+   while (!source.isEof())
+   {
+      hw::SignalBuffer samples(16384 * channelCount, channelCount, 1, sampleRate, 0, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, 0);
+
+      if (source.read(samples) > 0)
       {
-         // or create json file if not exists at first time
-         writeFrames(target, list1);
+         for (const lab::RawFrame &frame: decoder.nextFrames(samples))
+         {
+            if (frame.frameType() == lab::FrameType::NfcPollFrame || frame.frameType() == lab::FrameType::NfcListenFrame)
+            {
+               result.back().second.push_back(frame);
+            }
+         }
 
-         std::cout << "TEST FILE " << filename << ": TEST UPDATED!" << std::endl;
+         for (auto &checkpoint: decoder.nextCheckpoints())
+         {
+            result.emplace_back(checkpoint, std::list<lab::RawFrame>());
+         }
       }
    }
 
-   return 0;
+   return true;
 }
 
-int testPath(const std::string &path)
+/*
+ * Resume decoding from each checkpoint and compare with full decoding
+ */
+bool testCheckpoints(const std::string &path)
 {
-   for (const auto &entry: FileSystem::directoryList(path))
+   std::list<std::pair<lab::NfcDecoder::Checkpoint, std::list<lab::RawFrame>>> full;
+
+   if (!decodeSignal(path, nullptr, full))
+      return false;
+
+   // test up to 8 checkpoints evenly distributed over the signal
+   size_t step = full.size() > 8 ? full.size() / 8 : 1;
+
+   // skip initial entry, has no checkpoint
+   for (auto it = std::next(full.begin()); it != full.end(); it = static_cast<size_t>(std::distance(it, full.end())) > step ? std::next(it, step) : full.end())
    {
-      if (entry.name.find(".wav") != std::string::npos)
-      {
-         testFile(entry.name);
-      }
+      std::list<std::pair<lab::NfcDecoder::Checkpoint, std::list<lab::RawFrame>>> partial;
+
+      if (!decodeSignal(path, &it->first, partial))
+         return false;
+
+      std::list<lab::RawFrame> expected;
+      std::list<lab::RawFrame> obtained;
+
+      for (auto e = it; e != full.end(); ++e)
+         expected.insert(expected.end(), e->second.begin(), e->second.end());
+
+      for (auto &entry: partial)
+         obtained.insert(obtained.end(), entry.second.begin(), entry.second.end());
+
+      if (expected != obtained)
+         return false;
    }
 
-   return 0;
+   return true;
 }
 
-int main(int argc, char *argv[])
+/*
+ * Parameter sets used for sweep decoding, first one with default values
+ */
+void configureSweep(lab::NfcDecoder &decoder, unsigned int config)
 {
-   //   Logger::init(std::cout, false);
+   switch (config)
+   {
+      case 1:
+         decoder.setCorrelationThresholdNfcA(0.90f);
+         decoder.setModulationThresholdNfcA(0.95f, 1.00f);
+         break;
 
-   logger->info("***********************************************************************");
-   logger->info("NFC laboratory, 2024 Jose Vicente Campos Martinez - <josevcm@gmail.com>");
-   logger->info("***********************************************************************");
+      case 2:
+         decoder.setCorrelationThresholdNfcB(0.40f);
+         decoder.setModulationThresholdNfcB(0.05f, 0.90f);
+         decoder.setCorrelationThresholdNfcF(0.60f);
+         break;
 
-   for (int i = 1; i < argc; i++)
+      case 3:
+         decoder.setCorrelationThresholdNfcV(0.60f);
+         decoder.setModulationThresholdNfcV(0.80f, 1.00f);
+         break;
+   }
+}
+
+/*
+ * Decode WAV file with shared front end and several parameter sets, each one must match an independent decoder with same parameters
+ */
+bool testSweep(const std::string &path, const std::list<lab::RawFrame> &expected)
+{
+   static constexpr unsigned int configs = 4;
+
+   hw::RecordDevice source(path);
+
+   if (!source.open(hw::RecordDevice::Mode::Read))
+      return false;
+
+   unsigned int channelCount = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_CHANNEL_COUNT));
+   unsigned int sampleRate = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_SAMPLE_RATE));
+
+   lab::NfcDecoder decoder;
+
+   std::vector<lab::NfcDecoder> sweep(configs);
+   std::vector<lab::NfcDecoder> single(configs);
+
+   for (unsigned int i = 0; i < configs; i++)
    {
-      std::string path {argv[i]};
+      configureSweep(sweep[i], i);
+      configureSweep(single[i], i);
+   }
 
-      if (FileSystem::isDirectory(path))
-      {
-         logger->info("processing path {}", {path});
+   std::vector<std::list<lab::RawFrame>> result(configs);
+   std::vector<std::list<lab::RawFrame>> reference(configs);
 
-         testPath(path);
-      }
-      else if (FileSystem::isRegularFile(path))
+   while (!source.isEof())
+   {
+      hw::SignalBuffer samples(65536 * channelCount, channelCount, 1, sampleRate, 0, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, 0);
+
+      if (source.read(samples) > 0)
       {
-         logger->info("processing file {}", {path});
+         auto frames = decoder.nextFrames(samples, sweep);
 
-         testFile(path);
+         for (unsigned int i = 0; i < configs; i++)
+         {
+            result[i].splice(result[i].end(), frames[i]);
+            reference[i].splice(reference[i].end(), single[i].nextFrames(samples));
+         }
       }
    }
 
+   // final carrier status
+   auto frames = decoder.nextFrames({}, sweep);
+
+   for (unsigned int i = 0; i < configs; i++)
+   {
+      result[i].splice(result[i].end(), frames[i]);
+      reference[i].splice(reference[i].end(), single[i].nextFrames({}));
+
+      // all frames must match, including carrier events
+      if (result[i] != reference[i])
+         return false;
+   }
+
+   std::list<lab::RawFrame> decoded;
+
+   std::copy_if(result[0].begin(), result[0].end(), std::back_inserter(decoded), [](const lab::RawFrame &frame) {
+      return frame.frameType() == lab::FrameType::NfcPollFrame || frame.frameType() == lab::FrameType::NfcListenFrame;
+   });
+
+   return decoded == expected;
+}
+
+/*
+ * Decode synthetic signal with periodic short carrier pulses followed by a long carrier, with and without pulse train detection
+ */
+bool decodeCarrier(bool trainEnabled, std::vector<lab::RawFrame> &frames)
+{
+   const unsigned int sampleRate = 3200000;
+   const unsigned int period = 32000; // 10 ms
+   const unsigned int width = 320; // 100 us
+   const unsigned int pulses = 8;
+   const unsigned int length = 16384;
+
+   // pulse train, then 5 ms carrier starting 50 ms after last pulse, then 50 ms without carrier
+   auto sampleValue = [=](unsigned int i) {
+      if (i < pulses * period)
+         return i % period >= period / 2 && i % period < period / 2 + width ? 0.5f : 0.0f;
+      return i >= (pulses + 5) * period && i < (pulses + 5) * period + period / 2 ? 0.5f : 0.0f;
+   };
+
+   lab::NfcDecoder decoder;
+
+   decoder.setEnableCarrierTrain(trainEnabled);
+
+   for (unsigned int offset = 0; offset < (pulses + 10) * period; offset += length)
+   {
+      hw::SignalBuffer samples(length, 1, 1, sampleRate, offset, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, 0);
+
+      for (unsigned int i = 0; i < length; i++)
+         samples.put(sampleValue(offset + i));
+
+      samples.flip();
+
+      decoder.nextFrames(samples, frames);
+   }
+
+   // end of stream
+   decoder.nextFrames({}, frames);
+
+   return true;
+}
+
+/*
+ * Check carrier pulse train is reported as one frame and long carrier as individual edges
+ */
+bool testCarrierTrain()
+{
+   std::vector<lab::RawFrame> edges;
+   std::vector<lab::RawFrame> train;
+
+   decodeCarrier(false, edges);
+   decodeCarrier(true, train);
+
+   auto count = [](const std::vector<lab::RawFrame> &frames, unsigned int type) {
+      return std::count_if(frames.begin(), frames.end(), [=](const lab::RawFrame &frame) { return frame.frameType() == type; });
+   };
+
+   // every pulse reported as carrier on / off pair, plus long carrier
+   if (count(edges, lab::FrameType::NfcCarrierOn) != 9 || count(edges, lab::FrameType::NfcCarrierTrain) != 0)
+      return false;
+
+   // single train frame, only long carrier reported as edges
+   if (count(train, lab::FrameType::NfcCarrierOn) != 1 || count(train, lab::FrameType::NfcCarrierTrain) != 1)
+      return false;
+
+   // all other frames must be the same, in time order
+   if (train.size() != edges.size() - 2 * 8 + 1)
+      return false;
+
+   for (size_t i = 1; i < train.size(); i++)
+   {
+      if (train[i].timeStart() < train[i - 1].timeStart())
+         return false;
+   }
+
+   auto frame = std::find_if(train.begin(), train.end(), [](const lab::RawFrame &frame) { return frame.frameType() == lab::FrameType::NfcCarrierTrain; });
+
+   auto value = [&](unsigned int offset) {
+      return static_cast<unsigned int>((*frame)[offset]) << 24 | (*frame)[offset + 1] << 16 | (*frame)[offset + 2] << 8 | (*frame)[offset + 3];
+   };
+
+   // pulse count, 10 ms period and 100 us width
+   if (frame->limit() != 12 || value(0) != 8 || value(4) < 9900000 || value(4) > 10100000 || value(8) < 80000 || value(8) > 120000)
+      return false;
+
+   // train spans from first to last pulse
+   return frame->timeStart() > 0.004 && frame->timeStart() < 0.006 && frame->timeEnd() > 0.075 && frame->timeEnd() < 0.076;
+}
+
+/*
+ * Record synthetic signal larger than the writer ring with injected storage latency, paced capture must never wait while
+ * a burst over ring capacity must, contents and patched headers must be preserved
+ */
+bool testRecord(const std::string &path)
+{
+   const unsigned int channels = 2;
+   const unsigned int buffers = 64;
+   const unsigned int length = 65536 * channels;
+   const unsigned int delay = 10;
+
+   auto sampleValue = [](unsigned int i) {
+      return static_cast<float>(static_cast<int>(i * 7 % 65536) - 32768) / 32768.0f;
+   };
+
+   // header patch when data ends on a block boundary, unaligned write must not use direct I/O
+   {
+      hw::RecordWriter writer(4096, 4);
+
+      std::vector<unsigned char> data(4096 * 3, 0x55);
+      std::vector<unsigned char> header(44, 0xAA);
+
+      if (!writer.open(path) || !writer.write(data.data(), data.size()) || !writer.patch(header.data(), header.size(), 0))
+         return false;
+
+      writer.close();
+
+      std::ifstream file(path, std::ios::binary);
+
+      std::vector<unsigned char> stored(data.size());
+
+      if (!file.read(reinterpret_cast<char *>(stored.data()), stored.size()) || !std::equal(header.begin(), header.end(), stored.begin()))
+         return false;
+   }
+
+   hw::RecordDevice target(path);
+
+   target.set(hw::SignalDevice::PARAM_SAMPLE_RATE, 10000000u);
+   target.set(hw::SignalDevice::PARAM_SAMPLE_SIZE, 16u);
+   target.set(hw::SignalDevice::PARAM_CHANNEL_COUNT, channels);
+   target.set(hw::RecordDevice::PARAM_WRITE_DELAY, delay);
+
+   if (!target.open(hw::RecordDevice::Mode::Write))
+      return false;
+
+   std::chrono::steady_clock::duration longest {};
+
+   auto next = std::chrono::steady_clock::now();
+
+   // paced capture of twice the 8 x 1MB writer ring, 256KB every 10ms while storage takes 10ms per 1MB block
+   for (unsigned int b = 0; b < buffers * 2; b++)
+   {
+      hw::SignalBuffer samples(length, channels, 1, 10000000, b * length / channels, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, 0);
+
+      for (unsigned int i = 0; i < length; i++)
+         samples.put(sampleValue(b * length + i));
+
+      samples.flip();
+
+      // second half is written back to back, faster than storage
+      if (b < buffers)
+      {
+         next += std::chrono::milliseconds(10);
+
+         std::this_thread::sleep_until(next);
+      }
+
+      auto start = std::chrono::steady_clock::now();
+
+      target.write(samples);
+
+      if (b < buffers)
+         longest = std::max(longest, std::chrono::steady_clock::now() - start);
+
+      if (b == buffers - 1 && std::get<unsigned int>(target.get(hw::RecordDevice::PARAM_WRITE_WAITS)))
+         return false;
+   }
+
+   unsigned int waits = std::get<unsigned int>(target.get(hw::RecordDevice::PARAM_WRITE_WAITS));
+
+   target.close();
+
+   logger->info("record test, longest paced write {} us, writer waits after burst {}", {std::chrono::duration_cast<std::chrono::microseconds>(longest).count(), waits});
+
+   // paced capture must never wait for storage, burst larger than the ring must
+   if (longest >= std::chrono::milliseconds(delay) || !waits)
+      return false;
+
+   hw::RecordDevice source(path);
+
+   if (!source.open(hw::RecordDevice::Mode::Read))
+      return false;
+
+   unsigned int index = 0;
+
+   while (!source.isEof())
+   {
+      hw::SignalBuffer samples(length, channels, 1, 10000000, 0, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, 0);
+
+      source.read(samples);
+
+      for (unsigned int i = 0; i < samples.limit(); i++, index++)
+      {
+         if (samples.data()[i] != sampleValue(index))
+            return false;
+      }
+   }
+
+   return index == buffers * 2 * length;
+}
+
+/*
+ * Round trip signal through compressed container, check bit exactness, seeking and decoding speed
+ */
+bool testCodec(const std::string &signal, const std::string &path, const std::list<lab::RawFrame> &expected)
+{
+   hw::RecordDevice source(signal);
+
+   if (!source.open(hw::RecordDevice::Mode::Read))
+      return false;
+
+   unsigned int channelCount = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_CHANNEL_COUNT));
+   unsigned int sampleRate = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_SAMPLE_RATE));
+
+   if (std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_SAMPLE_SIZE)) != 16)
+      return true;
+
+   hw::RecordDevice target(path);
+
+   target.set(hw::SignalDevice::PARAM_SAMPLE_RATE, sampleRate);
+   target.set(hw::SignalDevice::PARAM_SAMPLE_SIZE, 16u);
+   target.set(hw::SignalDevice::PARAM_CHANNEL_COUNT, channelCount);
+   target.set(hw::SignalDevice::PARAM_STREAM_TIME, std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_STREAM_TIME)));
+
+   if (!target.open(hw::RecordDevice::Mode::Write))
+      return false;
+
+   std::vector<float> original;
+
+   while (!source.isEof())
+   {
+      hw::SignalBuffer samples(65536 * channelCount, channelCount, 1, sampleRate, 0, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, 0);
+
+      if (source.read(samples) > 0)
+      {
+         original.insert(original.end(), samples.data(), samples.data() + samples.limit());
+
+         target.write(samples);
+      }
+   }
+
+   target.close();
+
+   hw::RecordDevice compressed(path);
+
+   if (!compressed.open(hw::RecordDevice::Mode::Read))
+      return false;
+
+   std::vector<float> decoded;
+
+   auto start = std::chrono::steady_clock::now();
+
+   while (!compressed.isEof())
+   {
+      hw::SignalBuffer samples(65536 * channelCount, channelCount, 1, sampleRate, 0, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, 0);
+
+      if (compressed.read(samples) <= 0)
+         break;
+
+      decoded.insert(decoded.end(), samples.data(), samples.data() + samples.limit());
+   }
+
+   double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   double duration = static_cast<double>(original.size()) / channelCount / sampleRate;
+   double ratio = static_cast<double>(std::filesystem::file_size(signal)) / static_cast<double>(std::filesystem::file_size(path));
+
+   logger->info("codec test, compression ratio {.2}, decoding {.1}x real time", {ratio, duration / elapsed});
+
+   if (decoded != original || ratio <= 1 || elapsed >= duration)
+      return false;
+
+   // seek into the middle of a block
+   unsigned int offset = original.size() / 2 + 12345 * channelCount;
+
+   hw::SignalBuffer samples(4096 * channelCount, channelCount, 1, sampleRate, 0, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, 0);
+
+   if (!compressed.set(hw::SignalDevice::PARAM_SAMPLE_OFFSET, offset) || compressed.read(samples) <= 0)
+      return false;
+
+   if (!std::equal(samples.data(), samples.data() + samples.limit(), original.begin() + offset))
+      return false;
+
+   compressed.close();
+
+   // decoded frames must be identical to uncompressed source
+   std::list<lab::RawFrame> frames;
+
+   return readSignal(path, frames) && frames == expected;
+}
+
+/*
+ * Build ISO-DEP test block, CRC is not verified by assembler so it is filled with zeros
+ */
+lab::RawFrame buildBlock(unsigned int frameType, std::initializer_list<unsigned char> data)
+{
+   lab::RawFrame frame(lab::FrameTech::NfcATech, frameType);
+
+   for (unsigned char value: data)
+      frame.put(value);
+
+   frame.put(static_cast<unsigned char>(0)).put(static_cast<unsigned char>(0)).flip();
+
+   frame.setFramePhase(lab::FramePhase::NfcApplicationPhase);
+
+   return frame;
+}
+
+/*
+ * Reassemble chained command and response with retransmission and WTX, directly and through frame writer
+ */
+bool testIsoDep()
+{
+   std::list<lab::RawFrame> frames;
+
+   // chained SELECT command in two blocks, second block repeated
+   frames.push_back(buildBlock(lab::FrameType::NfcPollFrame, {0x12, 0x00, 0xA4, 0x04}));
+   frames.push_back(buildBlock(lab::FrameType::NfcListenFrame, {0xA3}));
+   frames.push_back(buildBlock(lab::FrameType::NfcPollFrame, {0x03, 0x00, 0x02, 0x3F, 0x00}));
+   frames.push_back(buildBlock(lab::FrameType::NfcPollFrame, {0x03, 0x00, 0x02, 0x3F, 0x00}));
+
+   // waiting time extension
+   frames.push_back(buildBlock(lab::FrameType::NfcListenFrame, {0xF2, 0x01}));
+   frames.push_back(buildBlock(lab::FrameType::NfcPollFrame, {0xF2, 0x01}));
+
+   // chained response with CID
+   frames.push_back(buildBlock(lab::FrameType::NfcListenFrame, {0x1B, 0x00, 0x6F, 0x10}));
+   frames.push_back(buildBlock(lab::FrameType::NfcPollFrame, {0xAA, 0x00}));
+   frames.push_back(buildBlock(lab::FrameType::NfcListenFrame, {0x0A, 0x00, 0x90, 0x00}));
+
+   // second command without response
+   frames.push_back(buildBlock(lab::FrameType::NfcPollFrame, {0x02, 0x00, 0xB0, 0x00, 0x00, 0x10}));
+
+   lab::IsoDepAssembler assembler;
+
+   assembler.process(frames);
+   assembler.flush();
+
+   auto &exchanges = assembler.exchanges();
+
+   if (exchanges.size() != 2)
+      return false;
+
+   const auto &first = exchanges[0];
+   const auto &second = exchanges[1];
+
+   // exchange lookup by frame index
+   if (assembler.find(0) != &first || assembler.find(7) != &first || assembler.find(9) != &second || assembler.find(10))
+      return false;
+
+   // writer assembles while writing, exchanges reference frame positions in output stream
+   std::list<lab::RawFrame> stream = frames;
+
+   stream.emplace_front(lab::FrameTech::NoneTech, lab::FrameType::NfcCarrierOn);
+   stream.front().flip();
+
+   std::vector<nlohmann::json> records;
+
+   if (FILE *output = std::tmpfile())
+   {
+      lab::FrameWriter writer(output, lab::FrameWriter::Json);
+
+      writer.setAssemble(true);
+
+      for (const auto &frame: stream)
+         writer.write(frame);
+
+      writer.close();
+
+      std::rewind(output);
+
+      char line[4096];
+
+      while (std::fgets(line, sizeof(line), output))
+      {
+         auto entry = nlohmann::json::parse(line, nullptr, false);
+
+         if (!entry.is_discarded() && entry.contains("apdu"))
+            records.push_back(entry["apdu"]);
+      }
+
+      std::fclose(output);
+   }
+
+   if (records.size() != 2 ||
+       records[0]["first"] != 1 || records[0]["last"] != 9 || records[0]["command"] != "00A40400023F00" || records[0]["response"] != "6F109000" ||
+       records[1]["first"] != 10 || records[1]["last"] != 10 || records[1]["flags"] != lab::ApduExchange::ResponseMissing)
+      return false;
+
+   return assembler.command(first) == std::vector<unsigned char> {0x00, 0xA4, 0x04, 0x00, 0x02, 0x3F, 0x00} &&
+          assembler.response(first) == std::vector<unsigned char> {0x6F, 0x10, 0x90, 0x00} &&
+          first.commandFirst == 0 && first.commandLast == 2 && first.responseFirst == 6 && first.responseLast == 8 &&
+          first.commandBlocks == 2 && first.responseBlocks == 2 && first.retransmissions == 1 && first.waitExtensions == 1 && first.flags == 0 &&
+          assembler.command(second) == std::vector<unsigned char> {0x00, 0xB0, 0x00, 0x00, 0x10} &&
+          second.commandFirst == 9 && second.flags == lab::ApduExchange::ResponseMissing;
+}
+
+/*
+ * Feed a stream with late frames in batches as the stream model does, resuming reassembly from the
+ * first shifted row must give the same exchanges than a full pass, with far fewer processed frames
+ */
+bool testIsoDepRewind()
+{
+   std::vector<lab::RawFrame> source;
+   std::vector<lab::RawFrame> late;
+
+   for (int i = 0; i < 2000; i++)
+   {
+      double time = i * 1E-3;
+
+      auto command = buildBlock(lab::FrameType::NfcPollFrame, {static_cast<unsigned char>(0x02 | (i & 1)), 0x00, 0xB0, static_cast<unsigned char>(i), 0x00});
+      auto response = buildBlock(lab::FrameType::NfcListenFrame, {static_cast<unsigned char>(0x02 | (i & 1)), static_cast<unsigned char>(i), 0x90, 0x00});
+
+      command.setTimeStart(time);
+      command.setTimeEnd(time + 2E-4);
+      response.setTimeStart(time + 4E-4);
+      response.setTimeEnd(time + 6E-4);
+
+      source.push_back(command);
+
+      // some responses and some frames from other technology are delivered late
+      (i % 97 == 0 ? late : source).push_back(response);
+
+      if (i % 13 == 0)
+      {
+         lab::RawFrame other(lab::FrameTech::NfcVTech, lab::FrameType::NfcPollFrame);
+         other.put(static_cast<unsigned char>(0x26)).flip();
+         other.setTimeStart(time + 8E-4);
+         late.push_back(other);
+      }
+
+      // late frames arrive a few exchanges later
+      if (i % 5 == 4)
+      {
+         source.insert(source.end(), late.begin(), late.end());
+         late.clear();
+      }
+   }
+
+   source.insert(source.end(), late.begin(), late.end());
+
+   lab::IsoDepAssembler assembler;
+   std::vector<lab::RawFrame> frames;
+   unsigned int processed = 0;
+
+   for (size_t next = 0; next < source.size();)
+   {
+      int shifted = -1;
+
+      for (size_t end = std::min(next + 16, source.size()); next < end; next++)
+      {
+         auto it = std::upper_bound(frames.begin(), frames.end(), source[next]);
+
+         int row = static_cast<int>(it - frames.begin());
+
+         if (row < static_cast<int>(frames.size()) && (shifted < 0 || row < shifted))
+            shifted = row;
+
+         frames.insert(it, source[next]);
+
+         if (shifted < 0)
+         {
+            assembler.process(source[next], row);
+            processed++;
+         }
+      }
+
+      if (shifted >= 0)
+      {
+         for (unsigned int row = assembler.rewind(shifted); row < frames.size(); row++, processed++)
+            assembler.process(frames[row], row);
+      }
+   }
+
+   lab::IsoDepAssembler reference;
+
+   reference.process(std::list<lab::RawFrame>(frames.begin(), frames.end()));
+
+   auto &result = assembler.exchanges();
+   auto &expected = reference.exchanges();
+
+   logger->info("reassembled {} exchanges, processed {} frames for {} in stream", {result.size(), processed, frames.size()});
+
+   if (result.size() != expected.size() || result.size() != 2000)
+      return false;
+
+   for (size_t i = 0; i < result.size(); i++)
+   {
+      if (result[i].commandFirst != expected[i].commandFirst || result[i].commandLast != expected[i].commandLast ||
+          result[i].responseFirst != expected[i].responseFirst || result[i].responseLast != expected[i].responseLast ||
+          result[i].flags != expected[i].flags || result[i].retransmissions != expected[i].retransmissions ||
+          assembler.command(result[i]) != reference.command(expected[i]) || assembler.response(result[i]) != reference.response(expected[i]))
+         return false;
+   }
+
+   // each late frame only repeats a few exchanges, not the whole stream
+   return processed < frames.size() * 2;
+}
+
+/*
+ * Dissect synthetic NFC-A, NFC-V and ISO7816 exchanges, check the node trees and measure bulk throughput
+ */
+bool testDissector()
+{
+   std::list<lab::RawFrame> frames;
+
+   auto add = [&](unsigned int tech, unsigned int type, std::initializer_list<unsigned char> data) {
+      frames.emplace_back(tech, type);
+
+      for (unsigned char value: data)
+         frames.back().put(value);
+
+      frames.back().flip();
+   };
+
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcCarrierOn, {});
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcPollFrame, {0x26});
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcListenFrame, {0x44, 0x00});
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcPollFrame, {0x93, 0x70, 0x88, 0x04, 0x11, 0x22, 0xBF, 0x00, 0x00});
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcListenFrame, {0x04, 0x00, 0x00});
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcPollFrame, {0xE0, 0x80, 0x00, 0x00});
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcListenFrame, {0x05, 0x78, 0x80, 0x70, 0x02, 0x00, 0x00});
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcPollFrame, {0x02, 0x00, 0xA4, 0x04, 0x00, 0x02, 0x3F, 0x00, 0x00, 0x00});
+   add(lab::FrameTech::NfcATech, lab::FrameType::NfcListenFrame, {0x02, 0x90, 0x00, 0x00, 0x00});
+   add(lab::FrameTech::NfcVTech, lab::FrameType::NfcPollFrame, {0x22, 0x20, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0xE0, 0x05, 0x00, 0x00});
+   add(lab::FrameTech::NfcVTech, lab::FrameType::NfcListenFrame, {0x00, 0xAA, 0xBB, 0xCC, 0xDD, 0x00, 0x00});
+   add(lab::FrameTech::NfcVTech, lab::FrameType::NfcPollFrame, {0x02, 0x2B, 0x00, 0x00});
+   add(lab::FrameTech::NfcVTech, lab::FrameType::NfcListenFrame, {0x00, 0x0F, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0xE0, 0x01, 0x00, 0x3F, 0x03, 0x02, 0x00, 0x00});
+   add(lab::FrameTech::Iso7816Tech, lab::FrameType::IsoATRFrame, {0x3B, 0x80, 0x01, 0x81});
+   add(lab::FrameTech::Iso7816Tech, lab::FrameType::IsoExchangeFrame, {0x00, 0xB0, 0x00, 0x00, 0x02, 0xB0, 0x12, 0x34, 0x90, 0x00});
+
+   lab::FrameDissector dissector;
+   std::vector<lab::FrameDissector::Node> nodes;
+   std::vector<std::string> trees;
+
+   // flatten each tree as "depth:name@offset+length" items
+   for (const auto &frame: frames)
+   {
+      std::string tree;
+
+      dissector.dissect(frame, nodes);
+
+      for (const auto &node: nodes)
+         tree += std::to_string(node.depth) + ":" + lab::FrameDissector::name(node.field) + "@" + std::to_string(node.offset) + "+" + std::to_string(node.length) + " ";
+
+      trees.push_back(tree);
+   }
+
+   bool match = trees.size() == 15 &&
+                trees[0].empty() &&
+                trees[1] == "0:REQA@0+1 " &&
+                trees[2] == "0:@0+2 1:ATQA@0+2 " &&
+                trees[3] == "0:SEL1@0+9 1:NVB@1+1 1:CT@2+1 1:UID@3+3 1:BCC@6+1 1:CRC@7+2 " &&
+                trees[4] == "0:@0+3 1:SAK@0+1 1:CRC@1+2 " &&
+                trees[5] == "0:RATS@0+4 1:PARAM@1+1 1:CRC@2+2 " &&
+                trees[6] == "0:@0+7 1:TL@0+1 1:ATS@1+4 2:T0@1+1 2:TA@2+1 2:TB@3+1 2:TC@4+1 1:CRC@5+2 " &&
+                trees[7] == "0:I-Block@0+10 1:PCB@0+1 1:APDU@1+7 2:CLA@1+1 2:INS@2+1 2:P1@3+1 2:P2@4+1 2:LC@5+1 2:DATA@6+2 1:CRC@8+2 " &&
+                trees[8] == "0:I-Block@0+5 1:PCB@0+1 1:DATA@1+2 1:CRC@3+2 " &&
+                trees[9] == "0:ReadBlock@0+13 1:FLAGS@0+1 1:CMD@1+1 1:UID@2+8 1:BLOCK@10+1 1:CRC@11+2 " &&
+                trees[10] == "0:@0+7 1:FLAGS@0+1 1:DATA@1+4 1:CRC@5+2 " &&
+                trees[11] == "0:SysInfo@0+4 1:FLAGS@0+1 1:CMD@1+1 1:CRC@2+2 " &&
+                trees[12] == "0:@0+17 1:FLAGS@0+1 1:INFO@1+1 1:UID@2+8 1:DSFID@10+1 1:AFI@11+1 1:MEMORY@12+2 1:IC@14+1 1:CRC@15+2 " &&
+                trees[13] == "0:ATR@0+4 1:TS@0+1 1:T0@1+1 1:TD@2+1 1:TCK@3+1 " &&
+                trees[14] == "0:TPDU@0+10 1:HEADER@0+5 2:CLA@0+1 2:INS@1+1 2:P1@2+1 2:P2@3+1 2:P3@4+1 1:ACK@5+1 1:DATA@6+2 1:SW@8+2 ";
+
+   if (!match)
+   {
+      for (const auto &tree: trees)
+         logger->warn("dissection tree: {}", {tree});
+
+      return false;
+   }
+
+   // bulk dissection must not allocate once nodes vector has grown
+   unsigned long long allocations = heapAllocations;
+   unsigned long long count = 0;
+
+   auto start = std::chrono::steady_clock::now();
+
+   for (int i = 0; i < 20000; i++)
+   {
+      for (const auto &frame: frames)
+         count += dissector.dissect(frame, nodes) > 0;
+   }
+
+   double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   allocations = heapAllocations - allocations;
+
+   logger->info("dissected {} frames in {.3} ms, {.1} Mframes/s, {} allocations", {count, elapsed * 1E3, count / elapsed / 1E6, allocations});
+
+   return allocations == 0;
+}
+
+/*
+ * Compile filter expressions and check accepted and dropped frames
+ */
+bool testFilter()
+{
+   std::list<lab::RawFrame> frames;
+
+   frames.emplace_back(lab::FrameTech::NfcATech, lab::FrameType::NfcCarrierOn);
+   frames.back().flip();
+   frames.push_back(buildBlock(lab::FrameType::NfcPollFrame, {0x26}));
+   frames.push_back(buildBlock(lab::FrameType::NfcListenFrame, {0x44, 0x00}));
+   frames.push_back(buildBlock(lab::FrameType::NfcPollFrame, {0x02, 0x00, 0xA4, 0x04}));
+   frames.push_back(buildBlock(lab::FrameType::NfcListenFrame, {0x02, 0x90, 0x00}));
+   frames.back().setFrameFlags(lab::FrameFlags::CrcError);
+   frames.emplace_back(lab::FrameTech::NfcATech, lab::FrameType::NfcCarrierOff);
+   frames.back().flip();
+
+   lab::FrameFilter filter;
+
+   auto count = [&](const std::string &expression) -> int {
+
+      if (!filter.compile(expression))
+         return -1;
+
+      int accepted = 0;
+
+      for (const auto &frame: frames)
+         accepted += filter.matches(frame);
+
+      return accepted;
+   };
+
+   // invalid expressions are rejected and previous filter is kept
+   if (count("type == listen") != 2 || filter.compile("type = poll") || filter.compile("data starts 0") || filter.expression() != "type == listen")
+      return false;
+
+   if (count("tech == nfca and not type == carrier-on and type != carrier-off") != 4)
+      return false;
+
+   auto dropped = filter.dropped();
+
+   if (dropped.size() != 3 || dropped[1].first != "not type == carrier-on" || dropped[1].second != 1 || dropped[2].second != 1 || filter.accepted() != 4)
+      return false;
+
+   return count("") == 6 &&
+          count("type == poll or crc-error") == 3 &&
+          count("data[0] & 0xF0 == 0x00 and length > 3") == 2 &&
+          count("data starts 02 and data contains A404") == 1 &&
+          count("!crc-error and data contains 9000") == 0 &&
+          count("time >= 0 and rate == 0") == 6;
+}
+
+/*
+ * Track subject consumers and interest while subscriptions are created and released
+ */
+bool testSubject()
+{
+   rt::Subject<int> subject("test.subject");
+
+   int received = 0;
+
+   if (subject.consumers() != 0)
+      return false;
+
+   auto first = subject.subscribe([&](int value) { received += value; });
+   auto second = std::make_unique<rt::Subject<int>::Subscription>(subject.subscribe([&](int value) { received += value; }));
+
+   subject.interest({1.0, 2.0, 1E-3});
+
+   subject.next(1);
+
+   if (subject.consumers() != 2 || received != 2)
+      return false;
+
+   // interest is kept while there are consumers
+   second.reset();
+
+   if (subject.consumers() != 1 || !subject.interest().hasWindow() || subject.interest().resolution != 1E-3)
+      return false;
+
+   // and cleared when last one is gone, values are no longer delivered
+   first = {};
+
+   subject.next(1);
+
+   if (subject.consumers() != 0 || subject.interest().hasWindow() || subject.interest().resolution != 0 || received != 2)
+      return false;
+
+   // handlers are called without subject lock, so they can subscribe and release from inside a delivery
+   rt::Subject<int>::Subscription inner;
+
+   bool subscribed = false;
+
+   auto outer = subject.subscribe([&](int) {
+      if (!subscribed)
+         inner = subject.subscribe([&](int value) { received += 10 * value; });
+
+      subscribed = true;
+   });
+
+   // first delivery uses the list taken before inner subscription
+   subject.next(1);
+
+   if (subject.consumers() != 2 || received != 2)
+      return false;
+
+   // second one reaches inner
+   subject.next(1);
+
+   if (subject.consumers() != 2 || received != 12)
+      return false;
+
+   // observers released by a handler are skipped by the delivery in progress
+   rt::Subject<int>::Subscription victim;
+
+   auto killer = subject.subscribe([&](int) { victim = {}; });
+
+   victim = subject.subscribe([&](int value) { received += 100 * value; });
+
+   subject.next(1);
+
+   return subject.consumers() == 3 && received == 22;
+}
+
+/*
+ * Resample radio signal without adaptive stream consumers, with full detail and with view interest, check only requested detail is produced
+ */
+bool testInterest()
+{
+   struct Result
+   {
+      unsigned long long points = 0;
+      double timeStart = 1E9;
+      double timeEnd = 0;
+      double elapsed = 0;
+   };
+
+   rt::Executor executor(4, 1);
+
+   executor.submit(lab::SignalResamplingTask::construct());
+
+   rt::Subject<hw::SignalBuffer> *radioSignalStream = rt::Subject<hw::SignalBuffer>::name("radio.signal.raw");
+   rt::Subject<hw::SignalBuffer> *adaptiveSignalStream = rt::Subject<hw::SignalBuffer>::name("adaptive.signal");
+
+   // one second of noise at 10 Msps, every sample deviates from average so full detail keeps most of them
+   std::vector<hw::SignalBuffer> signal;
+
+   unsigned int seed = 1;
+
+   for (unsigned long long offset = 0; offset < 10000000; offset += 65536)
+   {
+      hw::SignalBuffer buffer(65536, 1, 1, 10000000, offset, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL);
+
+      for (int i = 0; i < 65536; i++)
+      {
+         seed = seed * 1103515245 + 12345;
+         buffer.put(static_cast<float>(seed >> 16 & 0x7fff) / 32768.0f);
+      }
+
+      buffer.flip();
+
+      signal.push_back(buffer);
+   }
+
+   auto resample = [&](bool consume, const rt::Subject<hw::SignalBuffer>::Interest &interest) {
+      Result result;
+      std::mutex mutex;
+      std::condition_variable done;
+      bool finished = false;
+
+      auto handler = [&](const hw::SignalBuffer &buffer) {
+         std::lock_guard lock(mutex);
+
+         if (!buffer.isValid())
+         {
+            finished = true;
+            done.notify_all();
+            return;
+         }
+
+         for (unsigned int i = 0; i < buffer.elements(); i++)
+         {
+            double time = (static_cast<double>(buffer.offset()) + buffer[i * 2 + 1]) / buffer.sampleRate();
+
+            result.timeStart = std::min(result.timeStart, time);
+            result.timeEnd = std::max(result.timeEnd, time);
+         }
+
+         result.points += buffer.elements();
+      };
+
+      rt::Subject<hw::SignalBuffer>::Subscription subscription;
+
+      if (consume)
+      {
+         subscription = adaptiveSignalStream->subscribe(handler);
+         adaptiveSignalStream->interest(interest);
+      }
+
+      auto start = std::chrono::steady_clock::now();
+
+      for (const auto &buffer: signal)
+         radioSignalStream->next(buffer);
+
+      // without consumers subscribe only to wait end of stream, buffers must already be discarded
+      if (!consume)
+         subscription = adaptiveSignalStream->subscribe(handler);
+
+      radioSignalStream->next({});
+
+      std::unique_lock lock(mutex);
+
+      done.wait(lock, [&] { return finished; });
+
+      result.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      return result;
+   };
+
+   Result none = resample(false, {});
+   Result full = resample(true, {});
+
+   // 100 ms view on 1000 pixels, as reported by radio view
+   Result view = resample(true, {0.4, 0.5, 0.1 / 1000 / 64});
+
+   logger->info("resampling without consumers {} points in {.3} s", {none.points, none.elapsed});
+   logger->info("resampling full signal {} points in {.3} s", {full.points, full.elapsed});
+   logger->info("resampling view interest {} points in {.3} s", {view.points, view.elapsed});
+
+   return none.points == 0 && full.points > 5000000 &&
+          view.points > 0 && view.points < full.points / 50 &&
+          view.timeStart >= 0.4 && view.timeEnd <= 0.5 + 1E-7;
+}
+
+/*
+ * Store, load, invalidate and evict cached frames for synthetic signal file, check stale entries are not reused
+ */
+bool testCache(const std::string &path)
+{
+   std::list<lab::RawFrame> frames;
+
+   frames.emplace_back(lab::FrameTech::NfcATech, lab::FrameType::NfcCarrierOn, 0.5, 0.5);
+   frames.back().flip();
+   frames.push_back(buildBlock(lab::FrameType::NfcPollFrame, {0x02, 0x00, 0xA4, 0x04}));
+   frames.back().setTimeStart(1.25);
+   frames.back().setDateTime(1000.25);
+   frames.back().setSampleStart(12500000);
+   frames.back().setSampleRate(10000000);
+   frames.back().setFrameRate(105938);
+   frames.push_back(buildBlock(lab::FrameType::NfcListenFrame, {0x02, 0x90, 0x00}));
+   frames.back().setFrameFlags(lab::FrameFlags::CrcError);
+
+   std::filesystem::path directory = std::filesystem::path(path) / "cache";
+   std::filesystem::path signal = std::filesystem::path(path) / "signal.wav";
+
+   std::filesystem::remove_all(directory);
+
+   // synthetic signal bigger than sampled size
+   {
+      std::vector<char> data(8 << 20);
+
+      for (size_t i = 0; i < data.size(); i++)
+         data[i] = static_cast<char>(i * 2654435761U >> 24);
+
+      std::ofstream(signal, std::ios::binary).write(data.data(), data.size());
+   }
+
+   auto key1 = lab::FrameCache::key(signal.string(), R"({"nfca":{"enabled":true}})");
+   auto key2 = lab::FrameCache::key(signal.string(), R"({"nfca":{"enabled":false}})");
+
+   lab::FrameCache cache(directory.string(), 0);
+
+   std::list<lab::RawFrame> loaded;
+
+   if (!key1.content || key1.content != key2.content || key1.config == key2.config)
+      return false;
+
+   // store and load same frames
+   if (cache.contains(key1) || !cache.store(key1, frames) || !cache.load(key1, loaded) || loaded != frames)
+      return false;
+
+   if (loaded.back().limit() != 5 || loaded.front().timeStart() != 0.5 || std::next(loaded.begin())->dateTime() != 1000.25)
+      return false;
+
+   // decoder settings change is a miss
+   if (cache.contains(key2) || cache.load(key2, loaded))
+      return false;
+
+   // explicit invalidation
+   if (!cache.invalidate(key1) || cache.contains(key1))
+      return false;
+
+   // entry from other decoder version is stale
+   lab::FrameCache::Key older = key1;
+
+   older.version--;
+
+   if (!cache.store(older, frames) || cache.load(key1, loaded))
+      return false;
+
+   // signal change away from file edges, keeping size and modification time, is a miss
+   cache.store(key1, frames);
+
+   auto modified = std::filesystem::last_write_time(signal);
+
+   {
+      std::fstream file(signal, std::ios::binary | std::ios::in | std::ios::out);
+      file.seekp((1 << 20) + 70000);
+      file.put(0x55);
+   }
+
+   std::filesystem::last_write_time(signal, modified);
+
+   auto changed = lab::FrameCache::key(signal.string(), R"({"nfca":{"enabled":true}})");
+
+   if (changed.content == key1.content || changed.size != key1.size || changed.modified != key1.modified || cache.load(changed, loaded))
+      return false;
+
+   // touched signal is a miss
+   cache.store(changed, frames);
+
+   std::filesystem::last_write_time(signal, modified + std::chrono::seconds(1));
+
+   auto touched = lab::FrameCache::key(signal.string(), R"({"nfca":{"enabled":true}})");
+
+   if (touched.content != changed.content || touched.modified == changed.modified || cache.load(touched, loaded))
+      return false;
+
+   // corrupted entry is removed on load
+   cache.store(key1, frames);
+
+   for (const auto &entry: std::filesystem::directory_iterator(directory))
+      std::filesystem::resize_file(entry.path(), 20);
+
+   if (cache.load(key1, loaded) || cache.entries() != 0)
+      return false;
+
+   // least recently used entries are evicted when size limit is exceeded
+   lab::FrameCache::Key key3 = key1;
+
+   key3.config++;
+
+   cache.store(key1, frames);
+
+   unsigned long long entrySize = cache.size();
+
+   cache.setSizeLimit(entrySize * 5 / 2);
+
+   std::this_thread::sleep_for(std::chrono::milliseconds(20));
+   cache.store(key2, frames);
+
+   std::this_thread::sleep_for(std::chrono::milliseconds(20));
+   cache.load(key1, loaded);
+
+   std::this_thread::sleep_for(std::chrono::milliseconds(20));
+   cache.store(key3, frames);
+
+   if (cache.entries() != 2 || !cache.contains(key1) || cache.contains(key2) || !cache.contains(key3) || cache.size() > cache.sizeLimit())
+      return false;
+
+   // invalidate all entries for signal content
+   if (cache.invalidate(key1.content) != 2 || cache.entries() != 0)
+      return false;
+
+   cache.store(key1, frames);
+   cache.clear();
+
+   bool result = cache.entries() == 0;
+
+   std::filesystem::remove_all(directory);
+   std::filesystem::remove(signal);
+
+   return result;
+}
+
+/*
+ * Decode signal into caller owned frame vector, checking same frames as list interface, no heap allocations for buffers
+ * without frames and for buffers with frames only the two allocations of each frame, its data buffer and its attributes
+ */
+bool testSink(const std::string &path, const std::list<lab::RawFrame> &expected)
+{
+   hw::RecordDevice source(path);
+
+   if (!source.open(hw::RecordDevice::Mode::Read))
+      return false;
+
+   lab::NfcDecoder decoder;
+
+   decoder.setEnableNfcA(true);
+   decoder.setEnableNfcB(true);
+   decoder.setEnableNfcF(true);
+   decoder.setEnableNfcV(true);
+
+   unsigned int channelCount = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_CHANNEL_COUNT));
+   unsigned int sampleRate = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_SAMPLE_RATE));
+
+   std::list<lab::RawFrame> obtained;
+   std::vector<lab::RawFrame> frames;
+
+   frames.reserve(256);
+
+   unsigned int buffers = 0;
+   unsigned long long allocations = 0;
+   unsigned long long frameAllocations = 0;
+
+   while (!source.isEof())
+   {
+      hw::SignalBuffer samples(65536 * channelCount, channelCount, 1, sampleRate, 0, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, 0);
+
+      if (source.read(samples) > 0)
+      {
+         frames.clear();
+
+         unsigned long long before = heapAllocations;
+
+         decoder.nextFrames(samples, frames);
+
+         unsigned long long count = heapAllocations - before;
+
+         // first buffer initializes decoder, then buffers without frames must not allocate and
+         // buffers with frames only allocate the data buffer and attributes of each emitted frame
+         if (buffers++ > 0)
+         {
+            if (frames.empty())
+               allocations += count;
+            else if (count > frames.size() * 2)
+               frameAllocations += count - frames.size() * 2;
+         }
+
+         for (const lab::RawFrame &frame: frames)
+         {
+            if (frame.frameType() == lab::FrameType::NfcPollFrame || frame.frameType() == lab::FrameType::NfcListenFrame)
+               obtained.push_back(frame);
+         }
+      }
+   }
+
+   if (allocations || frameAllocations)
+      logger->warn("decoder allocations: {} in buffers without frames, {} extra in buffers with frames", {allocations, frameAllocations});
+
+   return allocations == 0 && frameAllocations == 0 && obtained == expected;
+}
+
+/*
+ * Decode signal buffers with or without listen guard time fast-forward
+ */
+void decodeGuard(const std::vector<hw::SignalBuffer> &buffers, bool guardSkip, std::vector<lab::RawFrame> &frames, double &elapsed)
+{
+   lab::NfcDecoder decoder;
+
+   decoder.setEnableGuardSkip(guardSkip);
+
+   auto start = std::chrono::steady_clock::now();
+
+   for (const hw::SignalBuffer &samples: buffers)
+      decoder.nextFrames(samples, frames);
+
+   elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Decode signal with and without guard time fast-forward, best of several runs, returns true if frames are identical
+ */
+bool benchGuard(std::vector<float> &signal, unsigned int sampleRate, int runs, const std::string &name)
+{
+   std::vector<hw::SignalBuffer> buffers;
+
+   for (size_t offset = 0; offset < signal.size(); offset += 65536)
+   {
+      unsigned int length = std::min(signal.size() - offset, static_cast<size_t>(65536));
+
+      buffers.emplace_back(signal.data() + offset, length, 1, 1, sampleRate, offset, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL);
+   }
+
+   double fullTime = 1E9;
+   double skipTime = 1E9;
+
+   std::vector<lab::RawFrame> full;
+   std::vector<lab::RawFrame> skip;
+
+   // alternate both modes so machine load changes affects them alike
+   for (int i = 0; i < runs; i++)
+   {
+      double elapsed;
+
+      full.clear();
+      decodeGuard(buffers, false, full, elapsed);
+      fullTime = std::min(fullTime, elapsed);
+
+      skip.clear();
+      decodeGuard(buffers, true, skip, elapsed);
+      skipTime = std::min(skipTime, elapsed);
+   }
+
+   logger->info("guard skip {}, {} samples, {} frames, full decode {.2} ms, guard skip {.2} ms, {.1}% faster", {name, signal.size(), skip.size(), fullTime * 1E3, skipTime * 1E3, (fullTime / skipTime - 1) * 100});
+
+   return full == skip;
+}
+
+/*
+ * Check guard time fast-forward over the recorded signal and over a dense replay of its first quick request / response
+ * exchange, each request followed only by its response delay so fast-forward covers a large part of the replay
+ */
+bool testGuardSkip(const std::string &path, const std::list<lab::RawFrame> &expected)
+{
+   hw::RecordDevice source(path);
+
+   if (!source.open(hw::RecordDevice::Mode::Read))
+      return false;
+
+   unsigned int channelCount = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_CHANNEL_COUNT));
+   unsigned int sampleRate = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_SAMPLE_RATE));
+
+   if (channelCount != 1)
+      return false;
+
+   std::vector<float> signal;
+
+   while (!source.isEof())
+   {
+      hw::SignalBuffer samples(65536, 1, 1, sampleRate, 0, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, 0);
+
+      if (source.read(samples) > 0)
+         signal.insert(signal.end(), samples.data(), samples.data() + samples.elements());
+   }
+
+   if (!benchGuard(signal, sampleRate, 1, "recorded"))
+      return false;
+
+   // replay from 10us before request up to 10us before response, only unmodulated carrier at both ends
+   unsigned long margin = sampleRate / 100000;
+   unsigned long exchangeStart = 0;
+   unsigned long exchangeEnd = 0;
+   unsigned long previousEnd = 0;
+
+   for (auto it = expected.begin(); it != expected.end() && std::next(it) != expected.end(); previousEnd = it->sampleEnd(), ++it)
+   {
+      const lab::RawFrame &request = *it;
+      const lab::RawFrame &response = *std::next(it);
+
+      if (request.frameType() != lab::FrameType::NfcPollFrame || response.frameType() != lab::FrameType::NfcListenFrame)
+         continue;
+
+      if (request.sampleStart() < previousEnd + 2 * margin || response.sampleStart() > signal.size())
+         continue;
+
+      // take first exchange answered in less than 1ms
+      if (response.sampleStart() - request.sampleEnd() < sampleRate / 1000)
+      {
+         exchangeStart = request.sampleStart() - margin;
+         exchangeEnd = response.sampleStart() - margin;
+         break;
+      }
+   }
+
+   if (!exchangeEnd)
+      return true;
+
+   // about 50ms of back to back exchanges after the recorded signal start
+   std::vector<float> dense(signal.begin(), signal.begin() + exchangeStart);
+
+   for (unsigned long length = 0; length < sampleRate / 20; length += exchangeEnd - exchangeStart)
+      dense.insert(dense.end(), signal.begin() + exchangeStart, signal.begin() + exchangeEnd);
+
+   return benchGuard(dense, sampleRate, 25, "replay");
+}
+
+/*
+ * Decode recorded signal with and without NFC-F preamble scan, best of several runs, returns true if frames are identical
+ */
+bool testPreambleScan(const std::string &path)
+{
+   hw::RecordDevice source(path);
+
+   if (!source.open(hw::RecordDevice::Mode::Read))
+      return false;
+
+   unsigned int channelCount = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_CHANNEL_COUNT));
+   unsigned int sampleRate = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_SAMPLE_RATE));
+
+   if (channelCount != 1)
+      return false;
+
+   std::vector<hw::SignalBuffer> buffers;
+
+   while (!source.isEof())
+   {
+      hw::SignalBuffer samples(65536, 1, 1, sampleRate, 0, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, 0);
+
+      if (source.read(samples) > 0)
+         buffers.push_back(samples);
+   }
+
+   double fullTime = 1E9;
+   double scanTime = 1E9;
+
+   std::vector<lab::RawFrame> full;
+   std::vector<lab::RawFrame> scan;
+
+   // alternate both modes so machine load changes affects them alike
+   for (int run = 0; run < 5; run++)
+   {
+      for (bool preambleScan: {false, true})
+      {
+         std::vector<lab::RawFrame> &frames = preambleScan ? scan : full;
+
+         lab::NfcDecoder decoder;
+
+         decoder.setEnablePreambleScan(preambleScan);
+
+         frames.clear();
+
+         auto start = std::chrono::steady_clock::now();
+
+         for (hw::SignalBuffer samples: buffers)
+            decoder.nextFrames(samples, frames);
+
+         double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+         if (preambleScan)
+            scanTime = std::min(scanTime, elapsed);
+         else
+            fullTime = std::min(fullTime, elapsed);
+      }
+   }
+
+   logger->info("preamble scan, {} buffers, {} frames, full search {.2} ms, preamble scan {.2} ms, {.1}% faster", {buffers.size(), scan.size(), fullTime * 1E3, scanTime * 1E3, (fullTime / scanTime - 1) * 100});
+
+   return full == scan;
+}
+
+/*
+ * Check decoding resumes after a window of skipped buffers, frames once decoder settles must match full decoding
+ */
+bool testSkipFrames(const std::string &path, const std::list<lab::RawFrame> &expected)
+{
+   hw::RecordDevice source(path);
+
+   if (!source.open(hw::RecordDevice::Mode::Read))
+      return false;
+
+   unsigned int channelCount = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_CHANNEL_COUNT));
+   unsigned int sampleRate = std::get<unsigned int>(source.get(hw::SignalDevice::PARAM_SAMPLE_RATE));
+
+   if (channelCount != 1)
+      return false;
+
+   std::vector<hw::SignalBuffer> buffers;
+
+   while (!source.isEof())
+   {
+      hw::SignalBuffer samples(16384, 1, 1, sampleRate, 0, 0, hw::SignalType::SIGNAL_TYPE_RAW_REAL, 0);
+
+      if (source.read(samples) > 0)
+         buffers.push_back(samples);
+   }
+
+   if (buffers.size() < 3)
+      return true;
+
+   // skip from second buffer up to the middle of the signal, as if frame consumers went away and came back
+   size_t skipEnd = buffers.size() / 2;
+   unsigned long resumeSample = skipEnd * 16384;
+
+   std::list<lab::RawFrame> result;
+
+   lab::NfcDecoder decoder;
+
+   for (size_t i = 0; i < buffers.size(); i++)
+   {
+      hw::SignalBuffer samples = buffers[i];
+
+      if (i > 0 && i < skipEnd)
+      {
+         decoder.skipFrames(samples);
+         continue;
+      }
+
+      for (const auto &frame: decoder.nextFrames(samples))
+         result.push_back(frame);
+   }
+
+   // allow 10ms for carrier and protocol detection after decoding resumes
+   unsigned long settleSample = resumeSample + sampleRate / 100;
+
+   std::list<lab::RawFrame> resumed;
+   std::list<lab::RawFrame> reference;
+
+   // reference frames only include protocol frames
+   for (const auto &frame: result)
+   {
+      if (frame.sampleStart() >= settleSample && (frame.frameType() == lab::FrameType::NfcPollFrame || frame.frameType() == lab::FrameType::NfcListenFrame))
+         resumed.push_back(frame);
+   }
+
+   for (const auto &frame: expected)
+   {
+      if (frame.sampleStart() >= settleSample)
+         reference.push_back(frame);
+   }
+
+   // front end only processing for the whole signal compared with full decoding
+   double decodeTime = 1E9;
+   double skipTime = 1E9;
+
+   for (int run = 0; run < 5; run++)
+   {
+      lab::NfcDecoder full;
+      lab::NfcDecoder skip;
+
+      auto start = std::chrono::steady_clock::now();
+
+      for (hw::SignalBuffer samples: buffers)
+         full.nextFrames(samples);
+
+      auto middle = std::chrono::steady_clock::now();
+
+      for (hw::SignalBuffer samples: buffers)
+         skip.skipFrames(samples);
+
+      auto end = std::chrono::steady_clock::now();
+
+      decodeTime = std::min(decodeTime, std::chrono::duration<double>(middle - start).count());
+      skipTime = std::min(skipTime, std::chrono::duration<double>(end - middle).count());
+   }
+
+   logger->info("skip frames, {} buffers, full decode {.2} ms, front end only {.2} ms", {buffers.size(), decodeTime * 1E3, skipTime * 1E3});
+
+   return resumed == reference;
+}
+
+int testFile(const std::string &signal)
+{
+   size_t pos1 = signal.find(".wav");
+   size_t pos2 = signal.rfind("/");
+
+   if (pos1 == std::string::npos)
+      return -1;
+
+   std::string target = signal.substr(0, pos1) + ".json";
+   std::string filename = signal;
+
+   if (pos2 != std::string::npos)
+      filename = signal.substr(pos2 + 1, pos1 - 4);
+
+   std::list<lab::RawFrame> list1;
+   std::list<lab::RawFrame> list2;
+
+   // decode frames from signal
+   if (readSignal(signal, list1))
+   {
+      // read frames from json file
+      if (readFrames(target, list2))
+      {
+         // show result
+         std::cout << "TEST FILE " << filename << ": " << (list1 == list2 ? "PASS" : "FAIL") << std::endl;
+
+         // check parameter sweep decoding with shared front end
+         std::cout << "TEST SWEEP " << filename << ": " << (testSweep(signal, list1) ? "PASS" : "FAIL") << std::endl;
+
+         // check decoder resume from checkpoints
+         std::cout << "TEST CHECKPOINT " << filename << ": " << (testCheckpoints(signal) ? "PASS" : "FAIL") << std::endl;
+
+         // check listen guard time fast-forward does not change decoded frames
+         std::cout << "TEST GUARD " << filename << ": " << (testGuardSkip(signal, list1) ? "PASS" : "FAIL") << std::endl;
+
+         // check NFC-F preamble scan does not change decoded frames
+         std::cout << "TEST SCAN " << filename << ": " << (testPreambleScan(signal) ? "PASS" : "FAIL") << std::endl;
+
+         // check decoding resumes after skipped buffers
+         std::cout << "TEST SKIP " << filename << ": " << (testSkipFrames(signal, list1) ? "PASS" : "FAIL") << std::endl;
+
+         // check decoding into caller owned frame vector
+         std::cout << "TEST SINK " << filename << ": " << (testSink(signal, list1) ? "PASS" : "FAIL") << std::endl;
+
+         // check lossless compressed container
+         std::string compressed = std::filesystem::temp_directory_path().string() + "/test-codec.nfz";
+
+         std::cout << "TEST CODEC " << filename << ": " << (testCodec(signal, compressed, list1) ? "PASS" : "FAIL") << std::endl;
+
+         std::remove(compressed.c_str());
+      }
+      else
+      {
+         // or create json file if not exists at first time
+         writeFrames(target, list1);
+
+         std::cout << "TEST FILE " << filename << ": TEST UPDATED!" << std::endl;
+      }
+   }
+
+   return 0;
+}
+
+int testPath(const std::string &path)
+{
+   for (const auto &entry: FileSystem::directoryList(path))
+   {
+      if (entry.name.find(".wav") != std::string::npos)
+      {
+         testFile(entry.name);
+      }
+   }
+
+   return 0;
+}
+
+/*
+ * Previous nfc-rx console output, used as reference for text format and benchmark
+ */
+void printFrame(FILE *stream, const lab::RawFrame &frame)
+{
+   static std::map<unsigned int, std::string> frameType {
+         {lab::FrameType::NfcCarrierOff, "CarrierOff"},
+         {lab::FrameType::NfcCarrierOn, "CarrierOn"},
+         {lab::FrameType::NfcPollFrame, "PCD->PICC"},
+         {lab::FrameType::NfcListenFrame, "PICC->PCD"}
+   };
+
+   static std::map<unsigned int, std::string> frameTech {
+         {lab::FrameTech::NoneTech, "None"},
+         {lab::FrameTech::NfcATech, "NfcA"},
+         {lab::FrameTech::NfcBTech, "NfcB"},
+         {lab::FrameTech::NfcFTech, "NfcF"},
+         {lab::FrameTech::NfcVTech, "NfcV"}
+   };
+
+   int offset = 0;
+   char buffer[16384];
+
+   offset += snprintf(buffer + offset, sizeof(buffer) - offset, "%010.3f ", frame.timeStart());
+   offset += snprintf(buffer + offset, sizeof(buffer) - offset, "(%s) ", frameType[frame.frameType()].c_str());
+
+   if (frame.frameType() == lab::FrameType::NfcPollFrame || frame.frameType() == lab::FrameType::NfcListenFrame)
+   {
+      offset += snprintf(buffer + offset, sizeof(buffer) - offset, "[%s@%.0f]: ", frameTech[frame.techType()].c_str(), roundf(float(frame.frameRate()) / 1000.0f));
+
+      for (unsigned int i = 0; i < frame.size(); i++)
+         offset += snprintf(buffer + offset, sizeof(buffer) - offset, "%02X ", (unsigned int) frame[i]);
+   }
+
+   fprintf(stream, "%s\n", buffer);
+}
+
+/*
+ * Check frame writer formats against reference output and measure throughput to null device
+ */
+bool testWriter(const std::string &path)
+{
+   std::vector<lab::RawFrame> frames;
+
+   static const unsigned int techs[] = {lab::FrameTech::NfcATech, lab::FrameTech::NfcBTech, lab::FrameTech::NfcFTech, lab::FrameTech::NfcVTech};
+   static const unsigned int rates[] = {105938, 211875, 423750, 26484};
+
+   for (unsigned int i = 0; i < 200000; i++)
+   {
+      unsigned int kind = i % 16;
+      double time = i * 0.0001234567 + 0.0000005;
+
+      if (kind == 0)
+      {
+         frames.emplace_back(lab::FrameTech::NoneTech, i & 16 ? lab::FrameType::NfcCarrierOff : lab::FrameType::NfcCarrierOn, time, time);
+         frames.back().flip();
+         continue;
+      }
+
+      frames.emplace_back(techs[i % 4], kind & 1 ? lab::FrameType::NfcPollFrame : lab::FrameType::NfcListenFrame);
+
+      for (unsigned int n = 0; n < 1 + (i * 7) % 48; n++)
+         frames.back().put(static_cast<unsigned char>(i * 31 + n * 17));
+
+      frames.back().flip();
+      frames.back().setFrameRate(rates[i % 4]);
+      frames.back().setTimeStart(time);
+      frames.back().setTimeEnd(time + 0.0001);
+   }
+
+   std::string reference = path + "/test-writer-reference.txt";
+   std::string text = path + "/test-writer.txt";
+   std::string lines = path + "/test-writer.json";
+
+   auto readAll = [](const std::string &file) {
+      std::ifstream input(file, std::ios::binary);
+      return std::string((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+   };
+
+   // text format must match previous output
+   {
+      FILE *stream = fopen(reference.c_str(), "wb");
+
+      for (const auto &frame: frames)
+         printFrame(stream, frame);
+
+      fclose(stream);
+   }
+
+   {
+      FILE *stream = fopen(text.c_str(), "wb");
+
+      {
+         lab::FrameWriter writer(stream, lab::FrameWriter::Text, 65536);
+
+         for (const auto &frame: frames)
+            writer.write(frame);
+      }
+
+      fclose(stream);
+   }
+
+   // json lines must be valid and complete
+   {
+      FILE *stream = fopen(lines.c_str(), "wb");
+
+      {
+         lab::FrameWriter writer(stream, lab::FrameWriter::Json);
+
+         for (const auto &frame: frames)
+            writer.write(frame);
+      }
+
+      fclose(stream);
+   }
+
+   bool textMatch = readAll(reference) == readAll(text);
+
+   unsigned int jsonCount = 0;
+   bool jsonMatch = true;
+
+   {
+      std::ifstream input(lines);
+      std::string line;
+
+      while (std::getline(input, line))
+      {
+         auto entry = nlohmann::json::parse(line, nullptr, false);
+         const auto &frame = frames[jsonCount++];
+
+         if (entry.is_discarded() || entry["data"].get<std::string>().size() != frame.limit() * 2 || std::abs(entry["time"].get<double>() - frame.timeStart()) > 1E-6)
+            jsonMatch = false;
+      }
+   }
+
+   std::remove(reference.c_str());
+   std::remove(text.c_str());
+   std::remove(lines.c_str());
+
+   // throughput to null device
+#ifdef _WIN32
+   FILE *null = fopen("NUL", "wb");
+#else
+   FILE *null = fopen("/dev/null", "wb");
+#endif
+
+   if (!null)
+      return false;
+
+   auto start = std::chrono::steady_clock::now();
+
+   for (const auto &frame: frames)
+      printFrame(null, frame);
+
+   fflush(null);
+
+   double before = frames.size() / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   for (int format: {lab::FrameWriter::Text, lab::FrameWriter::Json, lab::FrameWriter::Csv, lab::FrameWriter::Binary})
+   {
+      lab::FrameWriter writer(null, format);
+
+      start = std::chrono::steady_clock::now();
+
+      for (const auto &frame: frames)
+         writer.write(frame);
+
+      writer.flush();
+
+      double after = frames.size() / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      logger->info("writer format {}: {.0} frames/s, previous text output {.0} frames/s", {format, after, before});
+   }
+
+   fclose(null);
+
+   return textMatch && jsonMatch && jsonCount == frames.size();
+}
+
+int main(int argc, char *argv[])
+{
+   //   Logger::init(std::cout, false);
+
+   logger->info("***********************************************************************");
+   logger->info("NFC laboratory, 2024 Jose Vicente Campos Martinez - <josevcm@gmail.com>");
+   logger->info("***********************************************************************");
+
+   for (int i = 1; i < argc; i++)
+   {
+      std::string path {argv[i]};
+
+      if (FileSystem::isDirectory(path))
+      {
+         logger->info("processing path {}", {path});
+
+         testPath(path);
+      }
+      else if (FileSystem::isRegularFile(path))
+      {
+         logger->info("processing file {}", {path});
+
+         testFile(path);
+      }
+   }
+
+   std::cout << "TEST FILTER: " << (testFilter() ? "PASS" : "FAIL") << std::endl;
+
+   std::cout << "TEST ISODEP: " << (testIsoDep() ? "PASS" : "FAIL") << std::endl;
+   std::cout << "TEST ISODEP REWIND: " << (testIsoDepRewind() ? "PASS" : "FAIL") << std::endl;
+
+   std::cout << "TEST DISSECTOR: " << (testDissector() ? "PASS" : "FAIL") << std::endl;
+
+   std::cout << "TEST SUBJECT: " << (testSubject() ? "PASS" : "FAIL") << std::endl;
+
+   std::cout << "TEST INTEREST: " << (testInterest() ? "PASS" : "FAIL") << std::endl;
+
+   std::cout << "TEST CARRIER: " << (testCarrierTrain() ? "PASS" : "FAIL") << std::endl;
+
+   std::string record = std::filesystem::temp_directory_path().string() + "/test-record.wav";
+
+   std::cout << "TEST RECORD: " << (testRecord(record) ? "PASS" : "FAIL") << std::endl;
+
+   std::cout << "TEST CACHE: " << (testCache(std::filesystem::temp_directory_path().string()) ? "PASS" : "FAIL") << std::endl;
+
+   std::cout << "TEST WRITER: " << (testWriter(std::filesystem::temp_directory_path().string()) ? "PASS" : "FAIL") << std::endl;
+
+   std::remove(record.c_str());
+
    return 0;
 }